@@ -0,0 +1,9 @@
+#!/bin/sh
+
+prefix=/usr/local
+exec_prefix=/usr/local
+libdir=${exec_prefix}/lib
+
+LD_PRELOAD=${libdir}/libjemalloc.so
+export LD_PRELOAD
+exec "$@"
@@ -0,0 +1,63 @@
+#ifndef JEMALLOC_INTERNAL_ALLOC_TAG_H
+#define JEMALLOC_INTERNAL_ALLOC_TAG_H
+
+#include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/atomic.h"
+#include "jemalloc/internal/tsd_types.h"
+
+/*
+ * Allocation tags attribute memory to application components without heap
+ * profiling.  A thread sets its current tag through the thread.tag mallctl, and
+ * the bytes it allocates and deallocates from then on are charged to that tag.
+ * This builds on the thread.allocated / thread.deallocated counters: each
+ * thread remembers where they were when its tag last changed, and the deltas
+ * since are folded into the per-tag totals when the tag changes again, on
+ * (most) peak events, and at thread exit.  Nothing is added to the fast paths.
+ *
+ * Large (and sampled) allocations additionally record their tag in the extent,
+ * whether they come from the arena or from a tcache, and are debited from it
+ * when freed under another tag, e.g. by another thread.  Small objects don't
+ * carry a tag; one freed under a different tag than it was allocated under is
+ * charged to both, so the live bytes of a tag are only exact for components
+ * that free their own small objects.
+ *
+ * Tag 0 means untagged, and is what threads start out with.
+ */
+#define LG_ALLOC_TAG_NTAGS 5
+#define ALLOC_TAG_NTAGS (1U << LG_ALLOC_TAG_NTAGS)
+
+typedef struct alloc_tag_tsd_s alloc_tag_tsd_t;
+struct alloc_tag_tsd_s {
+	unsigned tag;
+	/* thread.allocated and thread.deallocated when last folded. */
+	uint64_t allocated_last;
+	uint64_t deallocated_last;
+};
+#define ALLOC_TAG_TSD_INITIALIZER                                              \
+	{ 0, 0, 0 }
+
+/*
+ * Set once any thread switches to a non-zero tag.  Until then, everything is
+ * charged to tag 0 anyway, and extents don't need to be looked at.
+ */
+extern atomic_b_t alloc_tag_used;
+
+/* Charges the thread's activity since the last call to its current tag. */
+void     alloc_tag_flush(tsd_t *tsd);
+unsigned alloc_tag_get(tsd_t *tsd);
+/* Returns true if tag is out of range. */
+bool alloc_tag_set(tsd_t *tsd, unsigned tag);
+void alloc_tag_read(unsigned tag, uint64_t *allocated, uint64_t *deallocated);
+/* The tag that the large allocation at ptr is to be debited from. */
+unsigned alloc_tag_large_get(tsd_t *tsd, const void *ptr);
+/* Charges the large allocation at ptr, reused from a tcache, to the thread. */
+void alloc_tag_large_stamp(tsd_t *tsd, const void *ptr);
+/* Debits usize bytes from tag; called before thread.deallocated grows. */
+void alloc_tag_dalloc(tsd_t *tsd, unsigned tag, size_t usize);
+
+static inline bool
+alloc_tag_used_get(void) {
+	return atomic_load_b(&alloc_tag_used, ATOMIC_RELAXED);
+}
+
+#endif /* JEMALLOC_INTERNAL_ALLOC_TAG_H */
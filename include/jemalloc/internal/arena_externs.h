@@ -28,6 +28,9 @@ extern div_info_t arena_binind_div_info[SC_NBINS];
 extern emap_t arena_emap_global;
 
 extern size_t opt_oversize_threshold;
+extern size_t opt_lec_max_bytes;
+extern size_t opt_lec_max_alloc;
+extern bool   opt_arena_stats_enabled;
 extern size_t oversize_threshold;
 
 extern bool      opt_huge_arena_pac_thp;
@@ -46,7 +49,11 @@ void arena_stats_merge(tsdn_t *tsdn, arena_t *arena, unsigned *nthreads,
     const char **dss, ssize_t *dirty_decay_ms, ssize_t *muzzy_decay_ms,
     size_t *nactive, size_t *ndirty, size_t *nmuzzy, arena_stats_t *astats,
     bin_stats_data_t *bstats, arena_stats_large_t *lstats, pac_estats_t *estats,
-    hpa_shard_stats_t *hpastats);
+    hpa_shard_stats_t *hpastats, unsigned what);
+bool arena_stats_enabled_set(arena_t *arena, bool enabled);
+bool arena_resident_scan(tsdn_t *tsdn, arena_t *arena);
+void arena_large_stats_tcache_flush(
+    tsdn_t *tsdn, arena_t *arena, tcache_slow_t *tcache_slow);
 void arena_handle_deferred_work(tsdn_t *tsdn, arena_t *arena);
 edata_t *arena_extent_alloc_large(
     tsdn_t *tsdn, arena_t *arena, size_t usize, size_t alignment, bool zero);
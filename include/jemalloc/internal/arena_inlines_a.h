@@ -24,4 +24,11 @@ arena_internal_get(arena_t *arena) {
 	return atomic_load_zu(&arena->stats.internal, ATOMIC_RELAXED);
 }
 
+/* Whether the arena maintains its stats counters. */
+static inline bool
+arena_stats_enabled_get(arena_t *arena) {
+	return config_stats
+	    && atomic_load_b(&arena->stats_enabled, ATOMIC_RELAXED);
+}
+
 #endif /* JEMALLOC_INTERNAL_ARENA_INLINES_A_H */
@@ -25,6 +25,17 @@ arena_get_from_edata(edata_t *edata) {
 	    &arenas[edata_arena_ind_get(edata)], ATOMIC_RELAXED);
 }
 
+static inline arena_large_shard_t *
+arena_large_shard_get(arena_t *arena, const edata_t *edata) {
+	/*
+	 * Fibonacci hashing of the edata address; the low bits are mostly
+	 * alignment and carry no information.
+	 */
+	uint64_t h = (uint64_t)((uintptr_t)edata >> LG_CACHELINE)
+	    * KQU(0x9e3779b97f4a7c15);
+	return &arena->large[h >> (64 - LG_ARENA_LARGE_NSHARDS)];
+}
+
 JEMALLOC_ALWAYS_INLINE arena_t *
 arena_choose_maybe_huge(tsd_t *tsd, arena_t *arena, size_t size) {
 	if (arena != NULL) {
@@ -156,12 +167,12 @@ arena_prof_tctx_reset_sampled(tsd_t *tsd, const void *ptr) {
 }
 
 JEMALLOC_ALWAYS_INLINE void
-arena_prof_info_set(
-    tsd_t *tsd, edata_t *edata, prof_tctx_t *tctx, size_t size) {
+arena_prof_info_set(tsd_t *tsd, edata_t *edata, prof_tctx_t *tctx,
+    size_t size, unsigned sample_step) {
 	cassert(config_prof);
 
 	assert(!edata_slab_get(edata));
-	large_prof_info_set(edata, tctx, size);
+	large_prof_info_set(edata, tctx, size, sample_step);
 }
 
 JEMALLOC_ALWAYS_INLINE void
@@ -623,7 +634,9 @@ JEMALLOC_ALWAYS_INLINE void
 arena_dalloc_bin_locked_finish(tsdn_t *tsdn, arena_t *arena, bin_t *bin,
     arena_dalloc_bin_locked_info_t *info) {
 	if (config_stats) {
-		bin->stats.ndalloc += info->ndalloc;
+		if (arena_stats_enabled_get(arena)) {
+			bin->stats.ndalloc += info->ndalloc;
+		}
 		assert(bin->stats.curregs >= (size_t)info->ndalloc);
 		bin->stats.curregs -= (size_t)info->ndalloc;
 	}
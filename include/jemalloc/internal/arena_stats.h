@@ -3,6 +3,7 @@
 
 #include "jemalloc/internal/jemalloc_preamble.h"
 #include "jemalloc/internal/atomic.h"
+#include "jemalloc/internal/latency.h"
 #include "jemalloc/internal/lockedint.h"
 #include "jemalloc/internal/mutex.h"
 #include "jemalloc/internal/mutex_prof.h"
@@ -44,6 +45,20 @@ struct arena_stats_large_s {
 	size_t curlextents; /* Derived. */
 };
 
+/* What arena_resident_scan() finds resident, by extent state. */
+typedef enum {
+	/* Only arenas.create arenas keep track of all their active extents. */
+	arena_resident_scan_active_manual,
+	arena_resident_scan_dirty,
+	arena_resident_scan_muzzy,
+	arena_resident_scan_retained,
+	/* See psset_resident_ranges(). */
+	arena_resident_scan_hpa_nonfull,
+	arena_resident_scan_hpa_nonfull_huge,
+
+	arena_resident_scan_nkinds
+} arena_resident_scan_kind_t;
+
 /*
  * Arena stats.  Note that fields marked "derived" are not directly maintained
  * within the arena code; rather their values are derived during stats merge
@@ -66,6 +81,9 @@ struct arena_stats_s {
 
 	atomic_zu_t internal;
 
+	/* Bytes, as of the last arena.<i>.resident_scan. */
+	atomic_zu_t resident_scan[arena_resident_scan_nkinds];
+
 	size_t   allocated_large; /* Derived. */
 	uint64_t nmalloc_large;   /* Derived. */
 	uint64_t ndalloc_large;   /* Derived. */
@@ -89,6 +107,13 @@ struct arena_stats_s {
 	/* One element for each large size class. */
 	arena_stats_large_t lstats[SC_NSIZES - SC_NBINS];
 
+	/*
+	 * Sampled slow path latencies (see opt_stats_latency_sample).  Kept
+	 * out of pa_shard_stats even for the pa sites, so that partial stats
+	 * refreshes can leave them alone.
+	 */
+	latency_stats_t latency;
+
 	/* Arena uptime. */
 	nstime_t uptime;
 };
@@ -3,6 +3,7 @@
 
 #include "jemalloc/internal/jemalloc_preamble.h"
 #include "jemalloc/internal/arena_stats.h"
+#include "jemalloc/internal/arena_types.h"
 #include "jemalloc/internal/atomic.h"
 #include "jemalloc/internal/bin.h"
 #include "jemalloc/internal/bitmap.h"
@@ -18,6 +19,18 @@
 #include "jemalloc/internal/sc.h"
 #include "jemalloc/internal/ticker.h"
 
+/*
+ * One slice of an arena's extant large allocations.  Each large edata is
+ * assigned to a shard by hashing its address, so that concurrent large
+ * allocation / deallocation in the same arena rarely contend on one mutex.
+ */
+struct arena_large_shard_s {
+	/* Synchronizes insertion into and removal from list. */
+	malloc_mutex_t mtx;
+	/* Synchronization: mtx. */
+	edata_list_active_t list;
+} JEMALLOC_ALIGNED(CACHELINE);
+
 struct arena_s {
 	/*
 	 * Number of threads currently assigned to this arena.  Each thread has
@@ -46,6 +59,20 @@ struct arena_s {
 
 	/* Synchronization: internal. */
 	arena_stats_t stats;
+	/*
+	 * Whether the event counters in stats (and in the bins) are maintained;
+	 * see arena.<i>.stats_enabled.  Only ever goes from true to false.
+	 *
+	 * Synchronization: atomic.
+	 */
+	atomic_b_t stats_enabled;
+	/*
+	 * Earliest time, in ms since create_time, at which the next
+	 * arena.<i>.resident_scan may start.
+	 *
+	 * Synchronization: atomic.
+	 */
+	atomic_zu_t resident_scan_next_ms;
 
 	/*
 	 * Lists of tcaches and cache_bin_array_descriptors for extant threads
@@ -66,13 +93,13 @@ struct arena_s {
 	atomic_u_t dss_prec;
 
 	/*
-	 * Extant large allocations.
+	 * Extant large allocations, only tracked for manual arenas (see
+	 * arena_bin_slabs_full_insert()).  Use arena_large_shard_get() to find
+	 * the shard an extent belongs to.
 	 *
-	 * Synchronization: large_mtx.
+	 * Synchronization: internal.
 	 */
-	edata_list_active_t large;
-	/* Synchronizes all large allocation/update/deallocation. */
-	malloc_mutex_t large_mtx;
+	arena_large_shard_t large[ARENA_LARGE_NSHARDS];
 
 	/* The page-level allocator shard this arena uses. */
 	pa_shard_t pa_shard;
@@ -11,8 +11,32 @@
 #define ARENA_DECAY_NTICKS_PER_UPDATE 1000
 /* Maximum length of the arena name. */
 #define ARENA_NAME_LEN 32
+/*
+ * Number of independently locked lists tracking extant large allocations in
+ * manual arenas.  Must be a power of two.
+ */
+#define LG_ARENA_LARGE_NSHARDS 3
+#define ARENA_LARGE_NSHARDS (1U << LG_ARENA_LARGE_NSHARDS)
+/* Minimum time between the starts of two resident scans of an arena. */
+#define ARENA_RESIDENT_SCAN_INTERVAL_MS 100
+
+/*
+ * Optional groups of statistics gathered by arena_stats_merge(); the basic
+ * counters, which need no locks beyond the (atomic on most platforms) stats
+ * counters, are always gathered.
+ */
+#define ARENA_STATS_MERGE_BINS MALLCTL_STATS_REFRESH_BINS
+#define ARENA_STATS_MERGE_LARGE MALLCTL_STATS_REFRESH_LARGE
+/* Per size extent stats, HPA stats and large extent cache stats. */
+#define ARENA_STATS_MERGE_EXTENTS MALLCTL_STATS_REFRESH_EXTENTS
+#define ARENA_STATS_MERGE_TCACHE MALLCTL_STATS_REFRESH_TCACHE
+#define ARENA_STATS_MERGE_MUTEXES MALLCTL_STATS_REFRESH_MUTEXES
+/* Sampled slow path latency histograms. */
+#define ARENA_STATS_MERGE_LATENCY MALLCTL_STATS_REFRESH_LATENCY
+#define ARENA_STATS_MERGE_ALL MALLCTL_STATS_REFRESH_ALL
 
 typedef struct arena_s arena_t;
+typedef struct arena_large_shard_s arena_large_shard_t;
 
 typedef enum {
 	percpu_arena_mode_names_base = 0, /* Used for options processing. */
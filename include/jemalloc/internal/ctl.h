@@ -2,12 +2,14 @@
 #define JEMALLOC_INTERNAL_CTL_H
 
 #include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/alloc_tag.h"
 #include "jemalloc/internal/arena_stats.h"
 #include "jemalloc/internal/background_thread_structs.h"
 #include "jemalloc/internal/bin_stats.h"
 #include "jemalloc/internal/jemalloc_internal_types.h"
 #include "jemalloc/internal/malloc_io.h"
 #include "jemalloc/internal/mutex_prof.h"
+#include "jemalloc/internal/prof_callsite.h"
 #include "jemalloc/internal/ql.h"
 #include "jemalloc/internal/sc.h"
 #include "jemalloc/internal/stats.h"
@@ -66,6 +68,9 @@ typedef struct ctl_stats_s {
 
 	background_thread_stats_t background_thread;
 	mutex_prof_data_t mutex_prof_data[mutex_prof_num_global_mutexes];
+	uint64_t          tag_allocated[ALLOC_TAG_NTAGS];
+	uint64_t          tag_deallocated[ALLOC_TAG_NTAGS];
+	prof_callsite_t   prof_callsites[PROF_CALLSITE_NTOP];
 } ctl_stats_t;
 
 typedef struct ctl_arena_s ctl_arena_t;
@@ -4,6 +4,7 @@
 #include "jemalloc/internal/jemalloc_preamble.h"
 #include "jemalloc/internal/eset.h"
 #include "jemalloc/internal/mutex.h"
+#include "jemalloc/internal/pages.h"
 #include "jemalloc/internal/san.h"
 
 typedef struct ecache_s ecache_t;
@@ -49,7 +50,10 @@ ecache_ind_get(ecache_t *ecache) {
 
 bool ecache_init(tsdn_t *tsdn, ecache_t *ecache, extent_state_t state,
     unsigned ind, bool delay_coalesce);
-void ecache_prefork(tsdn_t *tsdn, ecache_t *ecache);
+/* Copies out the ranges of the cached extents; see pages_ranges_copy_t. */
+size_t ecache_resident_ranges(
+    tsdn_t *tsdn, ecache_t *ecache, pages_range_t *ranges, size_t nranges);
+void   ecache_prefork(tsdn_t *tsdn, ecache_t *ecache);
 void ecache_postfork_parent(tsdn_t *tsdn, ecache_t *ecache);
 void ecache_postfork_child(tsdn_t *tsdn, ecache_t *ecache);
 
@@ -2,6 +2,7 @@
 #define JEMALLOC_INTERNAL_EDATA_H
 
 #include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/alloc_tag.h"
 #include "jemalloc/internal/atomic.h"
 #include "jemalloc/internal/bin_info.h"
 #include "jemalloc/internal/bit_util.h"
@@ -58,12 +59,14 @@ struct e_prof_info_s {
 	nstime_t e_prof_alloc_time;
 	/* Allocation request size. */
 	size_t e_prof_alloc_size;
+	/* prof_sample_step at the time this was sampled. */
+	unsigned e_prof_sample_step;
 	/* Points to a prof_tctx_t. */
 	atomic_p_t e_prof_tctx;
 	/*
 	 * Points to a prof_recent_t for the allocation; NULL
 	 * means the recent allocation record no longer exists.
-	 * Protected by prof_recent_alloc_mtx.
+	 * Changed only under the lock of the slot it points to.
 	 */
 	atomic_p_t e_prof_recent_alloc;
 };
@@ -110,8 +113,10 @@ struct edata_s {
 	 * i: szind
 	 * f: nfree
 	 * s: bin_shard
+	 * h: is_head
+	 * l: alloc_tag
 	 *
-	 * 00000000 ... 0000ssss ssffffff ffffiiii iiiitttg zpcbaaaa aaaaaaaa
+	 * ... 000000ll lllhssss ssffffff ffffiiii iiiitttg zpcbaaaa aaaaaaaa
 	 *
 	 * arena_ind: Arena from which this extent came, or all 1 bits if
 	 *            unassociated.
@@ -145,6 +150,9 @@ struct edata_s {
 	 * nfree: Number of free regions in slab.
 	 *
 	 * bin_shard: the shard of the bin from which this extent came.
+	 *
+	 * alloc_tag: The allocation tag that large (and sampled) allocations
+	 *            were charged to, so that they can be debited on free.
 	 */
 	uint64_t e_bits;
 #define MASK(CURRENT_FIELD_WIDTH, CURRENT_FIELD_SHIFT)                         \
@@ -210,6 +218,12 @@ struct edata_s {
 #define EDATA_BITS_IS_HEAD_MASK                                                \
 	MASK(EDATA_BITS_IS_HEAD_WIDTH, EDATA_BITS_IS_HEAD_SHIFT)
 
+#define EDATA_BITS_ALLOC_TAG_WIDTH LG_ALLOC_TAG_NTAGS
+#define EDATA_BITS_ALLOC_TAG_SHIFT                                             \
+	(EDATA_BITS_IS_HEAD_WIDTH + EDATA_BITS_IS_HEAD_SHIFT)
+#define EDATA_BITS_ALLOC_TAG_MASK                                              \
+	MASK(EDATA_BITS_ALLOC_TAG_WIDTH, EDATA_BITS_ALLOC_TAG_SHIFT)
+
 	/* Pointer to the extent that this structure is responsible for. */
 	void *e_addr;
 
@@ -271,6 +285,9 @@ struct edata_s {
 
 		/* Profiling data, used for large objects. */
 		e_prof_info_t e_prof_info;
+
+		/* When the extent was cached, while in the lec (see lec.h). */
+		size_t e_lec_seq;
 	};
 };
 
@@ -490,6 +507,11 @@ edata_prof_alloc_size_get(const edata_t *edata) {
 	return edata->e_prof_info.e_prof_alloc_size;
 }
 
+static inline unsigned
+edata_prof_sample_step_get(const edata_t *edata) {
+	return edata->e_prof_info.e_prof_sample_step;
+}
+
 static inline prof_recent_t *
 edata_prof_recent_alloc_get_dont_call_directly(const edata_t *edata) {
 	return (prof_recent_t *)atomic_load_p(
@@ -637,6 +659,11 @@ edata_prof_alloc_size_set(edata_t *edata, size_t size) {
 	edata->e_prof_info.e_prof_alloc_size = size;
 }
 
+static inline void
+edata_prof_sample_step_set(edata_t *edata, unsigned sample_step) {
+	edata->e_prof_info.e_prof_sample_step = sample_step;
+}
+
 static inline void
 edata_prof_recent_alloc_set_dont_call_directly(
     edata_t *edata, prof_recent_t *recent_alloc) {
@@ -656,6 +683,29 @@ edata_is_head_set(edata_t *edata, bool is_head) {
 	    | ((uint64_t)is_head << EDATA_BITS_IS_HEAD_SHIFT);
 }
 
+static inline unsigned
+edata_alloc_tag_get(const edata_t *edata) {
+	return (unsigned)((edata->e_bits & EDATA_BITS_ALLOC_TAG_MASK)
+	    >> EDATA_BITS_ALLOC_TAG_SHIFT);
+}
+
+static inline void
+edata_alloc_tag_set(edata_t *edata, unsigned tag) {
+	assert(tag < ALLOC_TAG_NTAGS);
+	edata->e_bits = (edata->e_bits & ~EDATA_BITS_ALLOC_TAG_MASK)
+	    | ((uint64_t)tag << EDATA_BITS_ALLOC_TAG_SHIFT);
+}
+
+static inline size_t
+edata_lec_seq_get(const edata_t *edata) {
+	return edata->e_lec_seq;
+}
+
+static inline void
+edata_lec_seq_set(edata_t *edata, size_t seq) {
+	edata->e_lec_seq = seq;
+}
+
 static inline bool
 edata_state_in_transition(extent_state_t state) {
 	return state >= extent_state_transition;
@@ -686,6 +736,7 @@ edata_init(edata_t *edata, unsigned arena_ind, void *addr, size_t size,
 	edata_committed_set(edata, committed);
 	edata_pai_set(edata, pai);
 	edata_is_head_set(edata, is_head == EXTENT_IS_HEAD);
+	edata_alloc_tag_set(edata, 0);
 	if (config_prof) {
 		edata_prof_tctx_set(edata, NULL);
 	}
@@ -11,7 +11,12 @@ typedef enum emitter_output_e emitter_output_t;
 enum emitter_output_e {
 	emitter_output_json,
 	emitter_output_json_compact,
-	emitter_output_table
+	emitter_output_table,
+	/*
+	 * OpenMetrics text exposition format.  Only the emitter_metric_* calls
+	 * produce output in this mode; the JSON and table calls are no-ops.
+	 */
+	emitter_output_openmetrics
 };
 
 typedef enum emitter_justify_e emitter_justify_t;
@@ -40,6 +45,13 @@ enum emitter_type_e {
 	emitter_type_title,
 };
 
+typedef enum emitter_metric_type_e emitter_metric_type_t;
+enum emitter_metric_type_e {
+	emitter_metric_type_gauge,
+	/* Gets a "_total" suffix on the sample lines. */
+	emitter_metric_type_counter
+};
+
 typedef struct emitter_col_s emitter_col_t;
 struct emitter_col_s {
 	/* Filled in by the user. */
@@ -79,6 +91,9 @@ struct emitter_s {
 	bool item_at_depth;
 	/* True if we emitted a key and will emit corresponding value next. */
 	bool emitted_key;
+	/* OpenMetrics only; the family subsequent samples belong to. */
+	const char           *metric_family;
+	emitter_metric_type_t metric_type;
 };
 
 static inline bool
@@ -270,6 +285,8 @@ emitter_init(emitter_t *emitter, emitter_output_t emitter_output,
 	emitter->item_at_depth = false;
 	emitter->emitted_key = false;
 	emitter->nesting_depth = 0;
+	emitter->metric_family = NULL;
+	emitter->metric_type = emitter_metric_type_gauge;
 }
 
 /******************************************************************************/
@@ -449,6 +466,53 @@ emitter_col_init(emitter_col_t *col, emitter_row_t *row) {
 	ql_tail_insert(&row->cols, col, link);
 }
 
+/******************************************************************************/
+/* OpenMetrics public API. */
+
+/*
+ * Starts a metric family; all of its samples must be emitted before the next
+ * family begins.  The name gets a "jemalloc_" prefix.  help may be NULL.
+ */
+static inline void
+emitter_metric_family_begin(emitter_t *emitter, const char *name,
+    emitter_metric_type_t type, const char *help) {
+	if (emitter->output != emitter_output_openmetrics) {
+		return;
+	}
+	emitter->metric_family = name;
+	emitter->metric_type = type;
+	emitter_printf(emitter, "# TYPE jemalloc_%s %s\n", name,
+	    type == emitter_metric_type_counter ? "counter" : "gauge");
+	if (help != NULL) {
+		emitter_printf(emitter, "# HELP jemalloc_%s %s\n", name, help);
+	}
+}
+
+/*
+ * Emits one sample of the current family.  labels is the already formatted
+ * label set without the braces (e.g. "arena=\"0\",size=\"8\""), or NULL.
+ */
+static inline void
+emitter_metric_sample(emitter_t *emitter, const char *labels,
+    emitter_type_t value_type, const void *value) {
+	if (emitter->output != emitter_output_openmetrics) {
+		return;
+	}
+	assert(emitter->metric_family != NULL);
+	assert(value_type != emitter_type_bool
+	    && value_type != emitter_type_string
+	    && value_type != emitter_type_title);
+	emitter_printf(emitter, "jemalloc_%s%s", emitter->metric_family,
+	    emitter->metric_type == emitter_metric_type_counter ? "_total" : "");
+	if (labels != NULL && labels[0] != '\0') {
+		emitter_printf(emitter, "{%s}", labels);
+	}
+	emitter_printf(emitter, " ");
+	emitter_print_value(
+	    emitter, emitter_justify_none, -1, value_type, value);
+	emitter_printf(emitter, "\n");
+}
+
 /******************************************************************************/
 /*
  * Generalized public API. Emits using either JSON or table, according to
@@ -524,6 +588,8 @@ emitter_end(emitter_t *emitter) {
 		emitter_printf(emitter, "%s",
 		    emitter->output == emitter_output_json_compact ? "}"
 		                                                   : "\n}\n");
+	} else if (emitter->output == emitter_output_openmetrics) {
+		emitter_printf(emitter, "# EOF\n");
 	}
 }
 
@@ -157,6 +157,9 @@ bool hpa_shard_init(tsdn_t *tsdn, hpa_shard_t *shard, hpa_central_t *central,
 void hpa_shard_stats_accum(hpa_shard_stats_t *dst, hpa_shard_stats_t *src);
 void hpa_shard_stats_merge(
     tsdn_t *tsdn, hpa_shard_t *shard, hpa_shard_stats_t *dst);
+/* See psset_resident_ranges(). */
+size_t hpa_shard_resident_ranges(
+    tsdn_t *tsdn, hpa_shard_t *shard, pages_range_t *ranges, size_t nranges);
 
 /*
  * Notify the shard that we won't use it for allocations much longer.  Due to
@@ -44,6 +44,9 @@
 #	ifdef JEMALLOC_OS_UNFAIR_LOCK
 #		include <os/lock.h>
 #	endif
+#	ifdef JEMALLOC_FUTEX_MUTEX
+#		include <linux/futex.h>
+#	endif
 #	ifdef JEMALLOC_GLIBC_MALLOC_HOOK
 #		include <sched.h>
 #	endif
@@ -0,0 +1,153 @@
+#ifndef JEMALLOC_INTERNAL_LATENCY_H
+#define JEMALLOC_INTERNAL_LATENCY_H
+
+#include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/bit_util.h"
+#include "jemalloc/internal/lockedint.h"
+#include "jemalloc/internal/mutex.h"
+#include "jemalloc/internal/nstime.h"
+#include "jemalloc/internal/thread_event_registry.h"
+#include "jemalloc/internal/tsd_types.h"
+
+/*
+ * Sampled latency histograms for allocator slow paths.
+ *
+ * Timing every slow path call would cost two clock reads each; instead, a
+ * thread event fires every opt_stats_latency_sample bytes of allocation and
+ * arms all sites for the thread.  The next timed operation at each site on that
+ * thread then reads the clock, records its duration into the histogram of the
+ * site in the owning arena's stats, and disarms the site.  Arming the sites
+ * separately keeps frequent operations (say, the pa_dalloc of every free) from
+ * consuming all the samples.  The fast paths never look at any of this.
+ *
+ * Histograms are HDR-style: values below LATENCY_NSUB ns get a bucket each,
+ * and every power of two above that is divided into LATENCY_NSUB linear
+ * sub-buckets, which bounds the relative error of a bucket by 1/LATENCY_NSUB.
+ * Durations of 2^LATENCY_LG_MAX ns (~69s) or more go into the last bucket.
+ */
+
+#define LATENCY_LG_SUB 2
+#define LATENCY_NSUB (1U << LATENCY_LG_SUB)
+#define LATENCY_LG_MAX 36
+#define LATENCY_NBUCKETS ((LATENCY_LG_MAX - LATENCY_LG_SUB + 1) * LATENCY_NSUB)
+
+#define LATENCY_SAMPLE_DEFAULT (-1)
+
+/*
+ * The timed sites.
+ *   tcache_fill:  refilling a tcache bin from the arena (tcache miss).
+ *   tcache_flush: flushing a batch of tcache items back to their slabs.
+ *   large_alloc:  a large allocation, including any page allocation.
+ *   pa_alloc:     getting an extent from the page allocator.
+ *   pa_dalloc:    returning an extent to the page allocator.
+ *   pages_map:    mapping new memory from the OS (through the extent hooks).
+ */
+#define LATENCY_SITES                                                          \
+	OP(tcache_fill)                                                        \
+	OP(tcache_flush)                                                       \
+	OP(large_alloc)                                                        \
+	OP(pa_alloc)                                                           \
+	OP(pa_dalloc)                                                          \
+	OP(pages_map)
+
+typedef enum {
+#define OP(site) latency_site_##site,
+	LATENCY_SITES
+#undef OP
+	    latency_nsites
+} latency_site_t;
+
+extern const char *const latency_site_names[latency_nsites];
+
+/* Bitmask of the armed sites, as kept in tsd. */
+typedef uint8_t latency_sites_t;
+#define LATENCY_SITES_ALL ((latency_sites_t)((1U << latency_nsites) - 1))
+
+typedef struct latency_hist_s latency_hist_t;
+struct latency_hist_s {
+	/* Number of samples, and the sum of their durations. */
+	locked_u64_t count;
+	locked_u64_t total_ns;
+	locked_u64_t buckets[LATENCY_NBUCKETS];
+};
+
+typedef struct latency_stats_s latency_stats_t;
+struct latency_stats_s {
+	latency_hist_t hists[latency_nsites];
+};
+
+typedef struct latency_timer_s latency_timer_t;
+struct latency_timer_s {
+	nstime_t       start;
+	latency_site_t site;
+	bool           sampled;
+};
+
+extern int64_t      opt_stats_latency_sample;
+extern te_base_cb_t latency_sample_te_handler;
+
+static inline unsigned
+latency_bucket_ind(uint64_t ns) {
+	if (ns < LATENCY_NSUB) {
+		return (unsigned)ns;
+	}
+	unsigned lg = fls_u64(ns);
+	if (lg >= LATENCY_LG_MAX) {
+		return LATENCY_NBUCKETS - 1;
+	}
+	unsigned sub = (unsigned)(ns >> (lg - LATENCY_LG_SUB))
+	    & (LATENCY_NSUB - 1);
+	return (lg - LATENCY_LG_SUB + 1) * LATENCY_NSUB + sub;
+}
+
+/* Smallest duration (in ns) that falls into bucket ind. */
+static inline uint64_t
+latency_bucket_lower_ns(unsigned ind) {
+	assert(ind < LATENCY_NBUCKETS);
+	if (ind < LATENCY_NSUB) {
+		return ind;
+	}
+	unsigned lg = ind / LATENCY_NSUB + LATENCY_LG_SUB - 1;
+	uint64_t sub = ind % LATENCY_NSUB;
+	return (LATENCY_NSUB + sub) << (lg - LATENCY_LG_SUB);
+}
+
+void latency_record(tsdn_t *tsdn, latency_stats_t *stats,
+    malloc_mutex_t *stats_mtx, latency_site_t site, uint64_t ns);
+/* The caller must hold stats_mtx (if any); dst is unsynchronized. */
+void latency_stats_merge(tsdn_t *tsdn, malloc_mutex_t *stats_mtx,
+    latency_stats_t *dst, latency_stats_t *src);
+void latency_stats_accum(latency_stats_t *dst, latency_stats_t *src);
+/*
+ * Returns the (inclusive) upper bound of the bucket holding the ppm'th
+ * quantile of an unsynchronized histogram, or 0 if it is empty.
+ */
+uint64_t latency_hist_quantile_ns(latency_hist_t *hist, uint64_t ppm);
+
+void latency_timer_start_hard(tsdn_t *tsdn, latency_timer_t *timer);
+void latency_timer_stop_hard(tsdn_t *tsdn, latency_timer_t *timer,
+    latency_stats_t *stats, malloc_mutex_t *stats_mtx);
+
+/*
+ * Starts timing an operation at site, if the site is armed for the current
+ * thread; latency_timer_stop() then records the duration into stats.
+ */
+static inline void
+latency_timer_start(
+    tsdn_t *tsdn, latency_timer_t *timer, latency_site_t site) {
+	timer->site = site;
+	timer->sampled = false;
+	if (config_stats && opt_stats_latency_sample >= 0) {
+		latency_timer_start_hard(tsdn, timer);
+	}
+}
+
+static inline void
+latency_timer_stop(tsdn_t *tsdn, latency_timer_t *timer,
+    latency_stats_t *stats, malloc_mutex_t *stats_mtx) {
+	if (timer->sampled) {
+		latency_timer_stop_hard(tsdn, timer, stats, stats_mtx);
+	}
+}
+
+#endif /* JEMALLOC_INTERNAL_LATENCY_H */
@@ -0,0 +1,139 @@
+#ifndef JEMALLOC_INTERNAL_LEC_H
+#define JEMALLOC_INTERNAL_LEC_H
+
+#include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/atomic.h"
+#include "jemalloc/internal/base.h"
+#include "jemalloc/internal/edata.h"
+#include "jemalloc/internal/mutex.h"
+#include "jemalloc/internal/nstime.h"
+
+/*
+ * Large extent cache.
+ *
+ * Recently freed large (i.e. non-slab) extents are kept here instead of being
+ * returned to the page allocator, so that a subsequent allocation of exactly
+ * the same size can reuse them without touching the ecache (and its mutex).
+ * Extents are binned by pszind; each bin is an LRU list with the most recently
+ * freed extent at its head.  Since usizes above USIZE_GROW_SLOW_THRESHOLD may
+ * be page-granular, a bin can hold extents of different sizes, and allocation
+ * searches a bounded prefix of the list for an exact match.
+ *
+ * Allocation and deallocation only lock the bin of the extent.  The total
+ * number of cached bytes is bounded by max_bytes, but going over it is left to
+ * lec_gc(), which the owner calls periodically: it evicts the least recently
+ * freed extents, whatever their bin, according to the sequence number that
+ * extents are stamped with when cached.  Until it runs, caching can go up to
+ * twice max_bytes; past that, lec_dalloc() evicts from its own bin.  lec_gc()
+ * also evicts the extents that were not reused during the whole previous
+ * interval (tracked with a per-bin low water mark, the same way the tcache GC
+ * does).  Evicted extents go back to the page allocator, where the regular
+ * dirty decay takes over.
+ */
+
+/* Maximum number of extents examined per allocation attempt. */
+#define LEC_SEARCH_MAX 16
+/*
+ * Number of GC intervals per dirty decay period; i.e. an extent that is not
+ * reused for about dirty_decay_ms / LEC_GC_NINTERVALS gets evicted.
+ */
+#define LEC_GC_NINTERVALS 8
+
+#define LEC_MAX_BYTES_DEFAULT 0
+#define LEC_MAX_ALLOC_DEFAULT ((size_t)4 << 20)
+
+typedef struct lec_stats_s lec_stats_t;
+struct lec_stats_s {
+	/* Bytes currently cached. */
+	size_t bytes;
+	/* Number of allocations served from the cache. */
+	uint64_t nhits;
+	/* Number of supported allocations that could not be served. */
+	uint64_t nmisses;
+	/* Number of extents evicted, due to either max_bytes or GC. */
+	uint64_t nevictions;
+};
+
+static inline void
+lec_stats_accum(lec_stats_t *dst, const lec_stats_t *src) {
+	dst->bytes += src->bytes;
+	dst->nhits += src->nhits;
+	dst->nmisses += src->nmisses;
+	dst->nevictions += src->nevictions;
+}
+
+typedef struct lec_bin_s lec_bin_t;
+struct lec_bin_s {
+	malloc_mutex_t mtx;
+
+	/* All fields below are protected by mtx. */
+	size_t              bytes_cur;
+	/* Minimum of bytes_cur since the last GC pass. */
+	size_t              bytes_low_water;
+	edata_list_active_t lru;
+	uint64_t            nhits;
+	uint64_t            nmisses;
+	uint64_t            nevictions;
+};
+
+typedef struct lec_s lec_t;
+struct lec_s {
+	/* Zero if the cache is disabled. */
+	size_t     max_bytes;
+	size_t     max_alloc;
+	pszind_t   npsizes;
+	lec_bin_t *bins;
+
+	/* Sum of bytes_cur across all bins. */
+	atomic_zu_t bytes;
+	/* Source of the edata_lec_seq of cached extents. */
+	atomic_zu_t seq;
+
+	/* Serializes GC passes and protects gc_next. */
+	malloc_mutex_t gc_mtx;
+	nstime_t       gc_next;
+};
+
+static inline bool
+lec_is_used(lec_t *lec) {
+	return lec->max_bytes != 0;
+}
+
+static inline bool
+lec_size_supported(lec_t *lec, size_t size) {
+	return lec_is_used(lec) && size <= lec->max_alloc;
+}
+
+/* Returns true on error.  A max_bytes of 0 leaves the cache disabled. */
+bool lec_init(tsdn_t *tsdn, lec_t *lec, base_t *base, size_t max_bytes,
+    size_t max_alloc);
+
+/* Returns NULL if no cached extent of exactly size bytes is available. */
+edata_t *lec_alloc(tsdn_t *tsdn, lec_t *lec, size_t size);
+/*
+ * Caches edata, and returns true if the cache is now over max_bytes, i.e. if
+ * lec_gc() should run soon.  Extents evicted from the bin of edata to stay
+ * under twice max_bytes (possibly edata itself) are appended to to_evict,
+ * which the caller is responsible for deallocating.
+ */
+bool lec_dalloc(
+    tsdn_t *tsdn, lec_t *lec, edata_t *edata, edata_list_active_t *to_evict);
+/*
+ * Evicts the least recently freed extents while over max_bytes, and, if at
+ * least interval_ms passed since the last pass, the extents that went unused
+ * in the meantime.
+ */
+void lec_gc(tsdn_t *tsdn, lec_t *lec, uint64_t interval_ms,
+    edata_list_active_t *to_evict);
+/* Evicts everything. */
+void lec_flush(tsdn_t *tsdn, lec_t *lec, edata_list_active_t *to_evict);
+
+void lec_stats_merge(tsdn_t *tsdn, lec_t *lec, lec_stats_t *stats);
+void lec_mutex_stats_read(
+    tsdn_t *tsdn, lec_t *lec, mutex_prof_data_t *mutex_prof_data);
+
+void lec_prefork2(tsdn_t *tsdn, lec_t *lec);
+void lec_postfork_parent(tsdn_t *tsdn, lec_t *lec);
+void lec_postfork_child(tsdn_t *tsdn, lec_t *lec);
+
+#endif /* JEMALLOC_INTERNAL_LEC_H */
@@ -19,6 +19,103 @@ typedef enum {
 	malloc_mutex_address_ordered
 } malloc_mutex_lock_order_t;
 
+#ifdef JEMALLOC_FUTEX_MUTEX
+/*
+ * A futex-based lock whose waiters are served in FIFO order.
+ *
+ * The state word holds the lock bit, a bit telling that the waiter queue is
+ * non-empty, and a bit protecting the queue.  An uncontended lock / unlock is a
+ * single CAS on the state.  A thread that can't get the lock queues itself and
+ * sleeps on a futex of its own, and unlocking wakes up the queue head.
+ *
+ * The woken thread first competes for the lock with the running threads, as
+ * handing the lock to a thread that isn't running yet would make everyone else
+ * wait for it to be scheduled (and, on a busy machine, form a convoy).  If it
+ * loses, it goes back to the head of the queue, and the next unlock hands the
+ * lock over to it directly, keeping the lock bit set throughout.  A waiter thus
+ * gets the lock within two unlocks of reaching the head of the queue.  Only the
+ * queue lock holder may clear the lock bit of a lock with waiters.
+ */
+#	define MALLOC_FUTEX_LOCKED ((uint32_t)1U)
+#	define MALLOC_FUTEX_WAITERS ((uint32_t)2U)
+#	define MALLOC_FUTEX_QLOCKED ((uint32_t)4U)
+
+typedef struct malloc_futex_waiter_s malloc_futex_waiter_t;
+struct malloc_futex_waiter_s {
+	malloc_futex_waiter_t *next;
+	/* Whether the waiter lost the race after being woken up before. */
+	bool requeued;
+	/* MALLOC_FUTEX_WAKE_*, set by the thread waking the waiter up. */
+	atomic_u32_t wake;
+};
+#	define MALLOC_FUTEX_WAKE_NONE ((uint32_t)0U)
+/* The lock is free; try to get it. */
+#	define MALLOC_FUTEX_WAKE_RETRY ((uint32_t)1U)
+/* The lock has been handed over; the waiter owns it. */
+#	define MALLOC_FUTEX_WAKE_HANDOFF ((uint32_t)2U)
+
+typedef struct malloc_futex_s malloc_futex_t;
+struct malloc_futex_s {
+	atomic_u32_t state;
+	/* Waiter queue, protected by MALLOC_FUTEX_QLOCKED. */
+	malloc_futex_waiter_t *head;
+	malloc_futex_waiter_t *tail;
+};
+
+#	define MALLOC_FUTEX_INITIALIZER                                       \
+		{ ATOMIC_INIT(0), NULL, NULL }
+
+/*
+ * Thin futex(2) wrappers.  malloc_futex_wait() sleeps as long as *word equals
+ * expected, until abstime (CLOCK_REALTIME) if non-NULL, and returns 0 or an
+ * errno value (ETIMEDOUT, EAGAIN, EINTR).
+ */
+int  malloc_futex_wait(
+     atomic_u32_t *word, uint32_t expected, const struct timespec *abstime);
+void malloc_futex_wake(atomic_u32_t *word, int nwake);
+void malloc_futex_lock_slow(malloc_futex_t *futex);
+void malloc_futex_unlock_slow(malloc_futex_t *futex);
+
+/* Returns false if the lock is successfully acquired. */
+static inline bool
+malloc_futex_trylock(malloc_futex_t *futex) {
+	uint32_t state = atomic_load_u32(&futex->state, ATOMIC_RELAXED);
+	/* The queue bit may be set while the lock is free; keep it. */
+	while ((state & MALLOC_FUTEX_LOCKED) == 0) {
+		if (atomic_compare_exchange_weak_u32(&futex->state, &state,
+		        state | MALLOC_FUTEX_LOCKED, ATOMIC_ACQUIRE,
+		        ATOMIC_RELAXED)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static inline void
+malloc_futex_lock(malloc_futex_t *futex) {
+	if (malloc_futex_trylock(futex)) {
+		malloc_futex_lock_slow(futex);
+	}
+}
+
+static inline void
+malloc_futex_unlock(malloc_futex_t *futex) {
+	uint32_t state = MALLOC_FUTEX_LOCKED;
+	if (!atomic_compare_exchange_strong_u32(&futex->state, &state, 0,
+	        ATOMIC_RELEASE, ATOMIC_RELAXED)) {
+		/* Waiters to wake up, or a locker busy with the queue. */
+		malloc_futex_unlock_slow(futex);
+	}
+}
+
+static inline bool
+malloc_futex_has_waiters(malloc_futex_t *futex) {
+	return (atomic_load_u32(&futex->state, ATOMIC_RELAXED)
+	           & MALLOC_FUTEX_WAITERS)
+	    != 0;
+}
+#endif
+
 typedef struct malloc_mutex_s malloc_mutex_t;
 struct malloc_mutex_s {
 	union {
@@ -48,6 +145,8 @@ struct malloc_mutex_s {
 #	endif
 #elif (defined(JEMALLOC_OS_UNFAIR_LOCK))
 			os_unfair_lock lock;
+#elif (defined(JEMALLOC_FUTEX_MUTEX))
+			malloc_futex_t lock;
 #elif (defined(JEMALLOC_MUTEX_INIT_CB))
 			pthread_mutex_t lock;
 			malloc_mutex_t *postponed_next;
@@ -90,6 +189,10 @@ struct malloc_mutex_s {
 #	define MALLOC_MUTEX_LOCK(m) os_unfair_lock_lock(&(m)->lock)
 #	define MALLOC_MUTEX_UNLOCK(m) os_unfair_lock_unlock(&(m)->lock)
 #	define MALLOC_MUTEX_TRYLOCK(m) (!os_unfair_lock_trylock(&(m)->lock))
+#elif (defined(JEMALLOC_FUTEX_MUTEX))
+#	define MALLOC_MUTEX_LOCK(m) malloc_futex_lock(&(m)->lock)
+#	define MALLOC_MUTEX_UNLOCK(m) malloc_futex_unlock(&(m)->lock)
+#	define MALLOC_MUTEX_TRYLOCK(m) malloc_futex_trylock(&(m)->lock)
 #else
 #	define MALLOC_MUTEX_LOCK(m) pthread_mutex_lock(&(m)->lock)
 #	define MALLOC_MUTEX_UNLOCK(m) pthread_mutex_unlock(&(m)->lock)
@@ -99,7 +202,7 @@ struct malloc_mutex_s {
 #define LOCK_PROF_DATA_INITIALIZER                                             \
 	{                                                                      \
 		NSTIME_ZERO_INITIALIZER, NSTIME_ZERO_INITIALIZER, 0, 0, 0,     \
-		    ATOMIC_INIT(0), 0, NULL, 0                                 \
+		    ATOMIC_INIT(0), {0}, 0, NULL, 0                            \
 	}
 
 #ifdef _WIN32
@@ -123,6 +226,27 @@ struct malloc_mutex_s {
 				        "mutex", WITNESS_RANK_OMIT)            \
 			}
 #	endif
+#elif (defined(JEMALLOC_FUTEX_MUTEX))
+#	if defined(JEMALLOC_DEBUG)
+#		define MALLOC_MUTEX_INITIALIZER                               \
+			{                                                      \
+				{{LOCK_PROF_DATA_INITIALIZER,                  \
+				    ATOMIC_INIT(false),                        \
+				    MALLOC_FUTEX_INITIALIZER}},                \
+				    WITNESS_INITIALIZER(                       \
+				        "mutex", WITNESS_RANK_OMIT),           \
+				    0                                          \
+			}
+#	else
+#		define MALLOC_MUTEX_INITIALIZER                               \
+			{                                                      \
+				{{LOCK_PROF_DATA_INITIALIZER,                  \
+				    ATOMIC_INIT(false),                        \
+				    MALLOC_FUTEX_INITIALIZER}},                \
+				    WITNESS_INITIALIZER(                       \
+				        "mutex", WITNESS_RANK_OMIT)            \
+			}
+#	endif
 #elif (defined(JEMALLOC_MUTEX_INIT_CB))
 #	if (defined(JEMALLOC_DEBUG))
 #		define MALLOC_MUTEX_INITIALIZER                               \
@@ -184,7 +308,7 @@ void malloc_mutex_postfork_child(tsdn_t *tsdn, malloc_mutex_t *mutex);
 bool malloc_mutex_boot(void);
 void malloc_mutex_prof_data_reset(tsdn_t *tsdn, malloc_mutex_t *mutex);
 
-void malloc_mutex_lock_slow(malloc_mutex_t *mutex);
+void malloc_mutex_lock_slow(tsdn_t *tsdn, malloc_mutex_t *mutex);
 
 static inline void
 malloc_mutex_lock_final(malloc_mutex_t *mutex) {
@@ -256,6 +380,9 @@ malloc_mutex_prof_merge(mutex_prof_data_t *sum, mutex_prof_data_t *data) {
 	    + atomic_load_u32(&data->n_waiting_thds, ATOMIC_RELAXED);
 	atomic_store_u32(
 	    &sum->n_waiting_thds, new_n_waiting_thds, ATOMIC_RELAXED);
+	for (unsigned i = 0; i < MUTEX_PROF_WAIT_NBUCKETS; i++) {
+		sum->wait_hist[i] += data->wait_hist[i];
+	}
 	sum->n_owner_switches += data->n_owner_switches;
 	sum->n_lock_ops += data->n_lock_ops;
 }
@@ -265,7 +392,7 @@ malloc_mutex_lock(tsdn_t *tsdn, malloc_mutex_t *mutex) {
 	witness_assert_not_owner(tsdn_witness_tsdp_get(tsdn), &mutex->witness);
 	if (isthreaded) {
 		if (malloc_mutex_trylock_final(mutex)) {
-			malloc_mutex_lock_slow(mutex);
+			malloc_mutex_lock_slow(tsdn, mutex);
 		}
 		assert(malloc_mutex_is_locked(mutex));
 		mutex_owner_stats_update(tsdn, mutex);
@@ -335,6 +462,9 @@ malloc_mutex_prof_accum(
 	}
 	/* n_wait_thds is not reported. */
 	atomic_store_u32(&data->n_waiting_thds, 0, ATOMIC_RELAXED);
+	for (unsigned i = 0; i < MUTEX_PROF_WAIT_NBUCKETS; i++) {
+		data->wait_hist[i] += source->wait_hist[i];
+	}
 	data->n_owner_switches += source->n_owner_switches;
 	data->n_lock_ops += source->n_lock_ops;
 }
@@ -368,6 +498,11 @@ malloc_mutex_prof_max_update(
 	if (source->n_lock_ops > data->n_lock_ops) {
 		data->n_lock_ops = source->n_lock_ops;
 	}
+	for (unsigned i = 0; i < MUTEX_PROF_WAIT_NBUCKETS; i++) {
+		if (source->wait_hist[i] > data->wait_hist[i]) {
+			data->wait_hist[i] = source->wait_hist[i];
+		}
+	}
 	/* n_wait_thds is not reported. */
 }
 
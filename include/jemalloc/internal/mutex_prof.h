@@ -3,6 +3,7 @@
 
 #include "jemalloc/internal/jemalloc_preamble.h"
 #include "jemalloc/internal/atomic.h"
+#include "jemalloc/internal/bit_util.h"
 #include "jemalloc/internal/nstime.h"
 #include "jemalloc/internal/tsd_types.h"
 
@@ -36,7 +37,8 @@ typedef enum {
 	OP(tcache_list)                                                        \
 	OP(hpa_shard)                                                          \
 	OP(hpa_shard_grow)                                                     \
-	OP(hpa_sec)
+	OP(hpa_sec)                                                            \
+	OP(lec)
 
 typedef enum {
 #define OP(mtx) arena_prof_mutex_##mtx,
@@ -83,6 +85,16 @@ COUNTER_ENUM(MUTEX_PROF_UINT32_COUNTERS, uint32_t)
 #undef COUNTER_ENUM
 #undef OP
 
+/*
+ * Wait times are also kept as a histogram with power-of-4 buckets: bucket 0
+ * counts the waits shorter than 2^MUTEX_PROF_WAIT_LG_MIN ns (~1us), bucket j
+ * the ones in [2^(MUTEX_PROF_WAIT_LG_MIN + 2(j - 1)),
+ * 2^(MUTEX_PROF_WAIT_LG_MIN + 2j)) ns, and the last bucket everything from ~1s
+ * up.
+ */
+#define MUTEX_PROF_WAIT_LG_MIN 10
+#define MUTEX_PROF_WAIT_NBUCKETS 12
+
 typedef struct {
 	/*
 	 * Counters touched on the slow path, i.e. when there is lock
@@ -100,6 +112,8 @@ typedef struct {
 	uint32_t max_n_thds;
 	/* Current # of threads waiting on the lock.  Atomic synced. */
 	atomic_u32_t n_waiting_thds;
+	/* # of wait-acquired lock operations, by wait time. */
+	uint64_t wait_hist[MUTEX_PROF_WAIT_NBUCKETS];
 
 	/*
 	 * Data touched on the fast path.  These are modified right after we
@@ -115,4 +129,14 @@ typedef struct {
 	uint64_t n_lock_ops;
 } mutex_prof_data_t;
 
+static inline unsigned
+mutex_prof_wait_bucket(uint64_t ns) {
+	if (ns < ((uint64_t)1 << MUTEX_PROF_WAIT_LG_MIN)) {
+		return 0;
+	}
+	unsigned ind = (fls_u64(ns) - MUTEX_PROF_WAIT_LG_MIN) / 2 + 1;
+	return ind < MUTEX_PROF_WAIT_NBUCKETS ? ind
+	                                      : MUTEX_PROF_WAIT_NBUCKETS - 1;
+}
+
 #endif /* JEMALLOC_INTERNAL_MUTEX_PROF_H */
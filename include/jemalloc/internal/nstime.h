@@ -51,10 +51,14 @@ extern nstime_monotonic_t *JET_MUTABLE nstime_monotonic;
 typedef void(nstime_update_t)(nstime_t *);
 extern nstime_update_t *JET_MUTABLE nstime_update;
 
+/* A finer grained (and possibly slower) clock, for timing short intervals. */
+extern nstime_update_t *JET_MUTABLE nstime_precise_update;
+
 typedef void(nstime_prof_update_t)(nstime_t *);
 extern nstime_prof_update_t *JET_MUTABLE nstime_prof_update;
 
 void nstime_init_update(nstime_t *time);
+void nstime_precise_init_update(nstime_t *time);
 void nstime_prof_init_update(nstime_t *time);
 
 enum prof_time_res_e { prof_time_res_default = 0, prof_time_res_high = 1 };
@@ -0,0 +1,67 @@
+#ifndef JEMALLOC_INTERNAL_OWNEDINT_H
+#define JEMALLOC_INTERNAL_OWNEDINT_H
+
+#include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/atomic.h"
+
+/*
+ * A counter that only a single thread (its owner) ever updates, but that any
+ * thread may read.  The owner updates it with a plain load and store rather
+ * than an atomic read-modify-write, and the cache line stays with the owner
+ * until someone reads it.  Hot shared stats can be kept as per-owner deltas in
+ * these, which readers sum up on demand (see lockedint.h for the shared
+ * counterpart).  Arithmetic wraps around, so a delta may go "negative" and
+ * still add up correctly.
+ *
+ * Tear-free reads need 64-bit atomics; without them, owned counters are not
+ * supported, and callers should update the shared counter instead.
+ */
+typedef struct owned_u64_s owned_u64_t;
+#ifdef JEMALLOC_ATOMIC_U64
+#	define OWNED_U64_SUPPORTED true
+struct owned_u64_s {
+	atomic_u64_t val;
+};
+#else
+#	define OWNED_U64_SUPPORTED false
+struct owned_u64_s {
+	uint64_t val;
+};
+#endif
+
+static inline uint64_t
+owned_read_u64(owned_u64_t *p) {
+#ifdef JEMALLOC_ATOMIC_U64
+	return atomic_load_u64(&p->val, ATOMIC_RELAXED);
+#else
+	return p->val;
+#endif
+}
+
+/* Owner only. */
+static inline void
+owned_add_u64(owned_u64_t *p, uint64_t x) {
+#ifdef JEMALLOC_ATOMIC_U64
+	atomic_store_u64(&p->val, atomic_load_u64(&p->val, ATOMIC_RELAXED) + x,
+	    ATOMIC_RELAXED);
+#else
+	p->val += x;
+#endif
+}
+
+/*
+ * Returns the value and resets it to 0.  Owner only, or with the owner known
+ * not to run.
+ */
+static inline uint64_t
+owned_take_u64(owned_u64_t *p) {
+	uint64_t val = owned_read_u64(p);
+#ifdef JEMALLOC_ATOMIC_U64
+	atomic_store_u64(&p->val, 0, ATOMIC_RELAXED);
+#else
+	p->val = 0;
+#endif
+	return val;
+}
+
+#endif /* JEMALLOC_INTERNAL_OWNEDINT_H */
@@ -8,6 +8,8 @@
 #include "jemalloc/internal/edata_cache.h"
 #include "jemalloc/internal/emap.h"
 #include "jemalloc/internal/hpa.h"
+#include "jemalloc/internal/latency.h"
+#include "jemalloc/internal/lec.h"
 #include "jemalloc/internal/lockedint.h"
 #include "jemalloc/internal/pac.h"
 #include "jemalloc/internal/pai.h"
@@ -48,6 +50,8 @@ struct pa_shard_stats_s {
 	 * npurges don't.
 	 */
 	pac_stats_t pac_stats;
+	/* Stats of the large extent cache in front of the PAIs. */
+	lec_stats_t lec_stats; /* Derived. */
 };
 
 /*
@@ -98,6 +102,12 @@ struct pa_shard_s {
 
 	hpa_shard_t hpa_shard;
 
+	/*
+	 * Caches recently freed large extents ahead of whichever pai_t they
+	 * came from.  Disabled unless pa_shard_enable_lec() is called.
+	 */
+	lec_t lec;
+
 	/* The source of edata_t objects. */
 	edata_cache_t edata_cache;
 
@@ -105,6 +115,8 @@ struct pa_shard_s {
 
 	malloc_mutex_t   *stats_mtx;
 	pa_shard_stats_t *stats;
+	/* Owned by the arena; protected by stats_mtx as well. */
+	latency_stats_t *latency;
 
 	/* The emap this shard is tied to. */
 	emap_t *emap;
@@ -131,8 +143,8 @@ bool pa_central_init(pa_central_t *central, base_t *base, bool hpa,
 /* Returns true on error. */
 bool pa_shard_init(tsdn_t *tsdn, pa_shard_t *shard, pa_central_t *central,
     emap_t *emap, base_t *base, unsigned ind, pa_shard_stats_t *stats,
-    malloc_mutex_t *stats_mtx, nstime_t *cur_time, size_t oversize_threshold,
-    ssize_t dirty_decay_ms, ssize_t muzzy_decay_ms);
+    latency_stats_t *latency, malloc_mutex_t *stats_mtx, nstime_t *cur_time,
+    size_t oversize_threshold, ssize_t dirty_decay_ms, ssize_t muzzy_decay_ms);
 
 /*
  * This isn't exposed to users; we allow late enablement of the HPA shard so
@@ -141,6 +153,10 @@ bool pa_shard_init(tsdn_t *tsdn, pa_shard_t *shard, pa_central_t *central,
 bool pa_shard_enable_hpa(tsdn_t *tsdn, pa_shard_t *shard,
     const hpa_shard_opts_t *hpa_opts, const sec_opts_t *hpa_sec_opts);
 
+/* Turns on the large extent cache; returns true on error. */
+bool pa_shard_enable_lec(
+    tsdn_t *tsdn, pa_shard_t *shard, size_t max_bytes, size_t max_alloc);
+
 /*
  * We stop using the HPA when custom extent hooks are installed, but still
  * redirect deallocations to it.
@@ -199,6 +215,8 @@ ssize_t pa_decay_ms_get(pa_shard_t *shard, extent_state_t state);
 void pa_shard_set_deferral_allowed(
     tsdn_t *tsdn, pa_shard_t *shard, bool deferral_allowed);
 void     pa_shard_do_deferred_work(tsdn_t *tsdn, pa_shard_t *shard);
+/* Ages out large extent cache entries, paced by the dirty decay time. */
+void     pa_shard_lec_gc(tsdn_t *tsdn, pa_shard_t *shard);
 void     pa_shard_try_deferred_work(tsdn_t *tsdn, pa_shard_t *shard);
 uint64_t pa_shard_time_until_deferred_work(tsdn_t *tsdn, pa_shard_t *shard);
 
@@ -228,6 +246,31 @@ size_t pa_shard_nmuzzy(pa_shard_t *shard);
 void pa_shard_basic_stats_merge(
     pa_shard_t *shard, size_t *nactive, size_t *ndirty, size_t *nmuzzy);
 
+/*
+ * Bytes found resident in a shard's cached extents and HPA pageslabs, by
+ * checking every page with the OS.
+ */
+typedef struct pa_resident_scan_s pa_resident_scan_t;
+struct pa_resident_scan_s {
+	size_t dirty;
+	size_t muzzy;
+	size_t retained;
+	/* See psset_resident_ranges(). */
+	size_t hpa_nonfull;
+	size_t hpa_nonfull_huge;
+};
+
+/*
+ * Adds to *scan; slow, since it checks every extent with the OS, though with
+ * the shard's locks released.  Returns true on OOM.
+ */
+bool pa_shard_resident_scan(
+    tsdn_t *tsdn, pa_shard_t *shard, pa_resident_scan_t *scan);
+
+/*
+ * estats_out and hpa_stats_out may be NULL, in which case the per size extent,
+ * HPA and large extent cache stats (all of which require locking) are skipped.
+ */
 void pa_shard_stats_merge(tsdn_t *tsdn, pa_shard_t *shard,
     pa_shard_stats_t *pa_shard_stats_out, pac_estats_t *estats_out,
     hpa_shard_stats_t *hpa_stats_out, size_t *resident);
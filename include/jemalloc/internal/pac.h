@@ -6,6 +6,7 @@
 #include "jemalloc/internal/ecache.h"
 #include "jemalloc/internal/edata_cache.h"
 #include "jemalloc/internal/exp_grow.h"
+#include "jemalloc/internal/latency.h"
 #include "jemalloc/internal/lockedint.h"
 #include "jemalloc/internal/pai.h"
 #include "san_bump.h"
@@ -118,8 +119,9 @@ struct pac_s {
 	decay_t decay_dirty; /* dirty --> muzzy */
 	decay_t decay_muzzy; /* muzzy --> retained */
 
-	malloc_mutex_t *stats_mtx;
-	pac_stats_t    *stats;
+	malloc_mutex_t  *stats_mtx;
+	pac_stats_t     *stats;
+	latency_stats_t *latency;
 
 	/* Extent serial number generator state. */
 	atomic_zu_t extent_sn_next;
@@ -153,7 +155,7 @@ struct pac_thp_s {
 bool pac_init(tsdn_t *tsdn, pac_t *pac, base_t *base, emap_t *emap,
     edata_cache_t *edata_cache, nstime_t *cur_time, size_t oversize_threshold,
     ssize_t dirty_decay_ms, ssize_t muzzy_decay_ms, pac_stats_t *pac_stats,
-    malloc_mutex_t *stats_mtx);
+    latency_stats_t *latency, malloc_mutex_t *stats_mtx);
 
 static inline size_t
 pac_mapped(pac_t *pac) {
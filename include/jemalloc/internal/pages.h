@@ -135,6 +135,33 @@ bool pages_nohuge(void *addr, size_t size);
 bool pages_collapse(void *addr, size_t size);
 bool pages_dontdump(void *addr, size_t size);
 bool pages_dodump(void *addr, size_t size);
+/*
+ * Sets *resident to the number of bytes in the range that are backed by
+ * physical memory right now.  Returns true if the system can't tell.
+ */
+bool pages_resident(void *addr, size_t size, size_t *resident);
+/* A range of pages to be checked by pages_ranges_resident(). */
+typedef struct pages_range_s pages_range_t;
+struct pages_range_s {
+	void  *addr;
+	size_t size;
+	/* Whether the range counts towards *huge as well. */
+	bool huge;
+};
+/*
+ * Copies up to nranges ranges to ranges, and returns how many there are in
+ * total.  Called with ranges == NULL and nranges == 0 to count them.
+ */
+typedef size_t(pages_ranges_copy_t)(
+    void *arg, pages_range_t *ranges, size_t nranges);
+/*
+ * Adds how many bytes of the ranges copied out by copy() are resident to
+ * *resident (and *huge).  copy() typically holds a lock while it walks the
+ * ranges; they are only checked after it returns, so that no lock is held
+ * across the system calls.  Returns true on OOM.
+ */
+bool pages_ranges_resident(
+    pages_ranges_copy_t *copy, void *arg, size_t *resident, size_t *huge);
 bool pages_boot(void);
 void pages_set_thp_state(void *ptr, size_t size);
 void pages_mark_guards(void *head, void *tail);
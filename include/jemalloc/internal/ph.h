@@ -498,6 +498,41 @@ ph_enumerate_next(
 	return ret;
 }
 
+/*
+ * Unlike the enumeration above, a walk visits every element, in no particular
+ * order, and needs no extra space: it goes down through lchild, across through
+ * next (which also covers the root's aux list), and back up through prev, which
+ * for the first of a list of siblings is their parent.  The heap must not be
+ * modified during the walk.
+ */
+JEMALLOC_ALWAYS_INLINE void *
+ph_walk_next(ph_t *ph, void *phn, size_t offset) {
+	void *lchild = phn_lchild_get(phn, offset);
+	if (lchild != NULL) {
+		return lchild;
+	}
+	while (true) {
+		void *next = phn_next_get(phn, offset);
+		if (next != NULL) {
+			return next;
+		}
+		/* Done with phn's list of siblings; find their parent. */
+		void *prev;
+		while (true) {
+			if (phn == ph->root) {
+				return NULL;
+			}
+			prev = phn_prev_get(phn, offset);
+			assert(prev != NULL);
+			if (phn_lchild_get(prev, offset) == phn) {
+				break;
+			}
+			phn = prev;
+		}
+		phn = prev;
+	}
+}
+
 #define ph_structs(a_prefix, a_type, a_max_queue_size)                         \
 	typedef struct {                                                       \
 		phn_link_t link;                                               \
@@ -530,7 +565,8 @@ ph_enumerate_next(
 	       a_prefix##_enumerate_helper_t *helper, uint16_t max_visit_num,  \
 	       uint16_t max_queue_size);                                       \
 	a_attr a_type *a_prefix##_enumerate_next(                              \
-	    a_prefix##_t *ph, a_prefix##_enumerate_helper_t *helper);
+	    a_prefix##_t *ph, a_prefix##_enumerate_helper_t *helper);          \
+	a_attr a_type *a_prefix##_walk_next(a_prefix##_t *ph, a_type *phn);
 
 /* The ph_gen() macro generates a type-specific pairing heap implementation. */
 #define ph_gen(a_attr, a_prefix, a_type, a_field, a_cmp)                       \
@@ -589,6 +625,14 @@ ph_enumerate_next(
 	    a_prefix##_t *ph, a_prefix##_enumerate_helper_t *helper) {         \
 		return ph_enumerate_next(&ph->ph, offsetof(a_type, a_field),   \
 		    helper->bfs_queue, &helper->vars);                         \
+	}                                                                      \
+                                                                               \
+	/* Pass NULL to start the walk. */                                     \
+	a_attr a_type *a_prefix##_walk_next(a_prefix##_t *ph, a_type *phn) {   \
+		if (phn == NULL) {                                             \
+			return (a_type *)ph->ph.root;                          \
+		}                                                              \
+		return ph_walk_next(&ph->ph, phn, offsetof(a_type, a_field));  \
 	}
 
 #endif /* JEMALLOC_INTERNAL_PH_H */
@@ -0,0 +1,58 @@
+#ifndef JEMALLOC_INTERNAL_PROF_CALLSITE_H
+#define JEMALLOC_INTERNAL_PROF_CALLSITE_H
+
+#include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/base.h"
+#include "jemalloc/internal/mutex.h"
+#include "jemalloc/internal/tsd_types.h"
+
+/*
+ * Callsite profiling: a cheap alternative to backtraces.
+ *
+ * With opt_prof_callsite, a sampled allocation doesn't capture a backtrace or
+ * become a sampled object; all that is recorded is the return address of the
+ * public allocation function, i.e. the allocation's immediate caller.  Each
+ * thread counts its samples per callsite in a small table in its prof_tdata_t,
+ * and folds it into the global table every PROF_CALLSITE_FLUSH_NSAMPLES
+ * samples, when the table fills up, on stats refreshes (its own table only),
+ * and at thread exit.  The counts are unbiased the same way as in heap
+ * profiles, and are cumulative: nothing is subtracted when objects are freed,
+ * so the busiest callsites, not the largest live ones, come out on top.
+ *
+ * The global table has a fixed size; samples from callsites that don't fit
+ * are charged to the NULL callsite.
+ */
+
+/* Number of callsites reported, busiest (by bytes) first. */
+#define PROF_CALLSITE_NTOP 16
+#define LG_PROF_CALLSITE_TDATA_NSLOTS 4
+#define PROF_CALLSITE_TDATA_NSLOTS (1U << LG_PROF_CALLSITE_TDATA_NSLOTS)
+#define PROF_CALLSITE_FLUSH_NSAMPLES 64
+
+typedef struct prof_callsite_s prof_callsite_t;
+struct prof_callsite_s {
+	/* NULL for the callsites that didn't fit in the global table. */
+	const void *addr;
+	/*
+	 * Unbiased object count, scaled like curobjs_shifted_unbiased; never 0
+	 * for a slot in use.
+	 */
+	uint64_t objs_shifted;
+	/* Unbiased bytes. */
+	uint64_t bytes;
+};
+
+extern malloc_mutex_t prof_callsite_mtx;
+
+bool prof_callsite_init(tsdn_t *tsdn, base_t *base);
+/* Charges a sampled allocation of usize bytes to callsite. */
+void prof_callsite_record(tsd_t *tsd, const void *callsite, size_t usize);
+/* Folds the thread's counts into the global table. */
+void prof_callsite_flush(tsd_t *tsd);
+/*
+ * Fills top with the busiest callsites, zeroing the slots left over; returns
+ * the number filled.
+ */
+unsigned prof_callsite_top(tsdn_t *tsdn, prof_callsite_t *top, unsigned ntop);
+
+#endif /* JEMALLOC_INTERNAL_PROF_CALLSITE_H */
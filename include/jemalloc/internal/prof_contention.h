@@ -0,0 +1,57 @@
+#ifndef JEMALLOC_INTERNAL_PROF_CONTENTION_H
+#define JEMALLOC_INTERNAL_PROF_CONTENTION_H
+
+#include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/base.h"
+#include "jemalloc/internal/jemalloc_internal_types.h"
+#include "jemalloc/internal/tsd_types.h"
+
+/*
+ * Mutex contention profiling.
+ *
+ * With opt_prof_contention, malloc_mutex_lock_slow() samples one in
+ * 2^opt_lg_prof_contention_sample of the acquisitions that are about to block,
+ * takes a backtrace before blocking, and charges the time spent waiting to it.
+ * The backtrace starts inside the allocator, so it names both the internal path
+ * that ran into the contended mutex and the application callsite.  Samples are
+ * aggregated per backtrace and dumped in the contention profile format that
+ * jeprof (and pprof) read.
+ *
+ * The sampling thread may hold any number of allocator mutexes, so the
+ * aggregation table is fixed-size and updated with atomics only; samples that
+ * don't fit are counted as discarded.  For the same reason, backtraces come
+ * from walking frame pointers within the thread's stack rather than from the
+ * profiling unwinder, which may allocate or take the loader lock.
+ */
+
+#define PROF_CONTENTION_BT_MAX 32
+#define LG_PROF_CONTENTION_SAMPLE_DEFAULT 0
+
+typedef struct prof_contention_sample_s prof_contention_sample_t;
+struct prof_contention_sample_s {
+	unsigned len;
+	void    *vec[PROF_CONTENTION_BT_MAX];
+};
+
+bool prof_contention_init(tsdn_t *tsdn, base_t *base);
+bool prof_contention_sample_hard(tsdn_t *tsdn, prof_contention_sample_t *sample);
+void prof_contention_record(prof_contention_sample_t *sample, uint64_t wait_ns);
+void prof_contention_reset(void);
+/* Writes the profile, except for the memory map. */
+void prof_contention_write(write_cb_t *write_cb, void *cbopaque);
+bool prof_contention_dump(tsd_t *tsd, const char *filename);
+
+/*
+ * Decides whether to profile a blocking acquisition, and if so, fills sample
+ * with the current backtrace.  The caller then reports the time it waited
+ * through prof_contention_record().
+ */
+static inline bool
+prof_contention_sample(tsdn_t *tsdn, prof_contention_sample_t *sample) {
+	if (!config_prof || !opt_prof_contention) {
+		return false;
+	}
+	return prof_contention_sample_hard(tsdn, sample);
+}
+
+#endif /* JEMALLOC_INTERNAL_PROF_CONTENTION_H */
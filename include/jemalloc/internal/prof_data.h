@@ -2,27 +2,45 @@
 #define JEMALLOC_INTERNAL_PROF_DATA_H
 
 #include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/base.h"
 #include "jemalloc/internal/mutex.h"
+#include "jemalloc/internal/prof_pprof.h"
 
-extern malloc_mutex_t bt2gctx_mtx;
 extern malloc_mutex_t tdatas_mtx;
 extern malloc_mutex_t prof_dump_mtx;
 
+extern malloc_mutex_t *bt2gctx_locks;
 extern malloc_mutex_t *gctx_locks;
 extern malloc_mutex_t *tdata_locks;
 
-extern size_t prof_unbiased_sz[PROF_SC_NSIZES];
-extern size_t prof_shifted_unbiased_cnt[PROF_SC_NSIZES];
+/* Indexed by sampling step, then size class. */
+extern size_t prof_unbiased_sz[PROF_SAMPLE_NSTEPS][PROF_SC_NSIZES];
+extern size_t prof_shifted_unbiased_cnt[PROF_SAMPLE_NSTEPS][PROF_SC_NSIZES];
+/*
+ * The effective sampling rate as of the start of the ongoing dump, which the
+ * dump reports and unbiases for; protected by prof_dump_mtx.
+ */
+extern size_t prof_dump_lg_sample;
 
 void prof_bt_hash(const void *key, size_t r_hash[2]);
 bool prof_bt_keycomp(const void *k1, const void *k2);
 
-bool         prof_data_init(tsd_t *tsd);
+bool         prof_data_init(tsd_t *tsd, base_t *base);
 prof_tctx_t *prof_lookup(tsd_t *tsd, prof_bt_t *bt);
 int          prof_thread_name_set_impl(tsd_t *tsd, const char *thread_name);
 void         prof_unbias_map_init(void);
 void prof_dump_impl(tsd_t *tsd, write_cb_t *prof_dump_write, void *cbopaque,
     prof_tdata_t *tdata, bool leakcheck);
+void prof_dump_pprof_impl(
+    tsd_t *tsd, prof_pprof_t *pprof, prof_tdata_t *tdata, bool leakcheck);
+/*
+ * Calls cb with the live counts, as a dump would report them, of each gctx
+ * that has sampled objects.
+ */
+typedef void(prof_gctx_cnts_cb_t)(tsd_t *tsd, void *opaque,
+    const prof_bt_t *bt, uint64_t curobjs, uint64_t curbytes);
+void prof_gctx_cnts_iter(tsd_t *tsd, prof_tdata_t *tdata,
+    prof_gctx_cnts_cb_t *cb, void *opaque);
 prof_tdata_t *prof_tdata_init_impl(tsd_t *tsd, uint64_t thr_uid,
     uint64_t thr_discrim, char *thread_name, bool active);
 void          prof_tdata_detach(tsd_t *tsd, prof_tdata_t *tdata);
@@ -21,6 +21,7 @@ extern bool    opt_prof_leak;           /* Dump leak summary at exit. */
 extern bool    opt_prof_leak_error; /* Exit with error code if memory leaked */
 extern bool    opt_prof_accum;      /* Report cumulative bytes. */
 extern bool    opt_prof_log;        /* Turn logging on at boot. */
+extern bool    opt_prof_log_binary; /* Stream the log in binary form. */
 extern char    opt_prof_prefix[
 /* Minimize memory bloat for non-prof builds. */
 #ifdef JEMALLOC_PROF
@@ -41,6 +42,31 @@ extern bool opt_prof_sys_thread_name;
 /* Whether to record per size class counts and request size totals. */
 extern bool opt_prof_stats;
 
+/* Record callsites instead of backtraces; see prof_callsite.h. */
+extern bool opt_prof_callsite;
+
+/* Mutex contention profiling; see prof_contention.h. */
+extern bool   opt_prof_contention;
+extern size_t opt_lg_prof_contention_sample;
+
+/* Write heap profiles in pprof's format; see prof_pprof.h. */
+extern bool opt_prof_pprof;
+
+/*
+ * Minimum time between interval / growth triggered dumps, which are then left
+ * to a background thread; -1 dumps synchronously instead.
+ */
+extern ssize_t opt_prof_bg_dump_ms;
+
+/* Record per backtrace histograms of sampled objects' lifetimes. */
+extern bool opt_prof_lifetime;
+
+/*
+ * Target for the CPU time spent taking samples, in parts per million of
+ * elapsed time; 0 keeps the sampling rate fixed.
+ */
+extern unsigned opt_prof_overhead_ppm;
+
 /* Accessed via prof_active_[gs]et{_unlocked,}(). */
 extern bool prof_active_state;
 
@@ -56,6 +82,12 @@ extern uint64_t prof_interval;
  */
 extern size_t lg_prof_sample;
 
+/*
+ * How many times opt_prof_overhead_ppm has currently doubled the sampling
+ * interval on top of lg_prof_sample; accessed via prof_sample_step_get().
+ */
+extern atomic_u_t prof_sample_step;
+
 extern bool prof_booted;
 
 void                  prof_backtrace_hook_set(prof_backtrace_hook_t hook);
@@ -86,6 +118,13 @@ prof_tctx_t *prof_tctx_create(tsd_t *tsd);
 void         prof_idump(tsdn_t *tsdn);
 bool         prof_mdump(tsd_t *tsd, const char *filename);
 void         prof_gdump(tsdn_t *tsdn);
+/* For background thread 0; see opt_prof_bg_dump_ms. */
+uint64_t prof_bg_dump_ns_until(void);
+void     prof_bg_dump(tsd_t *tsd);
+/* Wakes background thread 0 for deferred profiling work, if it's running. */
+void prof_bg_thread0_wakeup(tsdn_t *tsdn);
+/* Called by background thread 0 before it looks for deferred work. */
+void prof_bg_thread0_wakeup_clear(void);
 
 void        prof_tdata_cleanup(tsd_t *tsd);
 bool        prof_active_get(tsdn_t *tsdn);
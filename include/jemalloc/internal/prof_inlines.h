@@ -32,6 +32,17 @@ prof_active_get_unlocked(void) {
 	return prof_active_state;
 }
 
+JEMALLOC_ALWAYS_INLINE unsigned
+prof_sample_step_get(void) {
+	return atomic_load_u(&prof_sample_step, ATOMIC_RELAXED);
+}
+
+/* The sampling rate in effect, adjusted for opt_prof_overhead_ppm. */
+JEMALLOC_ALWAYS_INLINE size_t
+prof_lg_sample_effective(void) {
+	return lg_prof_sample + prof_sample_step_get();
+}
+
 JEMALLOC_ALWAYS_INLINE bool
 prof_gdump_get_unlocked(void) {
 	/*
@@ -128,12 +139,14 @@ prof_tctx_reset_sampled(tsd_t *tsd, const void *ptr) {
 }
 
 JEMALLOC_ALWAYS_INLINE void
-prof_info_set(tsd_t *tsd, edata_t *edata, prof_tctx_t *tctx, size_t size) {
+prof_info_set(tsd_t *tsd, edata_t *edata, prof_tctx_t *tctx, size_t size,
+    unsigned sample_step) {
 	cassert(config_prof);
 	assert(edata != NULL);
 	assert(prof_tctx_is_valid(tctx));
+	assert(sample_step < PROF_SAMPLE_NSTEPS);
 
-	arena_prof_info_set(tsd, edata, tctx, size);
+	arena_prof_info_set(tsd, edata, tctx, size, sample_step);
 }
 
 JEMALLOC_ALWAYS_INLINE bool
@@ -160,13 +173,21 @@ prof_sample_should_skip(tsd_t *tsd, bool sample_event) {
 	return !tdata->active;
 }
 
+/*
+ * callsite is the return address of the public allocation function, which is
+ * all that gets recorded of a sampled allocation with opt_prof_callsite.
+ */
 JEMALLOC_ALWAYS_INLINE prof_tctx_t *
-prof_alloc_prep(tsd_t *tsd, bool prof_active, bool sample_event) {
+prof_alloc_prep(tsd_t *tsd, bool prof_active, bool sample_event, size_t usize,
+    const void *callsite) {
 	prof_tctx_t *ret;
 
 	if (!prof_active
 	    || likely(prof_sample_should_skip(tsd, sample_event))) {
 		ret = PROF_TCTX_SENTINEL;
+	} else if (opt_prof_callsite) {
+		prof_callsite_record(tsd, callsite, usize);
+		ret = PROF_TCTX_SENTINEL;
 	} else {
 		ret = prof_tctx_create(tsd);
 	}
@@ -4,10 +4,52 @@
 #include "jemalloc/internal/jemalloc_preamble.h"
 #include "jemalloc/internal/mutex.h"
 
+/*
+ * With opt_prof_log_binary, the log is streamed to its file as it is taken,
+ * rather than kept in memory and emitted as JSON by prof_log_stop.  The file
+ * is PROF_LOG_BINARY_MAGIC followed by records, each a prof_log_record_t tag
+ * byte and the fields below, integers being unsigned LEB128 varints and
+ * strings a varint length followed by the bytes:
+ *
+ *   info:   version (string), lg_sample_rate, prof_time_resolution (string),
+ *           pid
+ *   thread: thr_uid, thr_name (string)
+ *   trace:  number of frames, then the frame addresses
+ *   alloc:  alloc_thread, free_thread, alloc_trace, free_trace,
+ *           alloc_timestamp, free_timestamp, usize
+ *   end:    duration
+ *
+ * i.e. the fields of the JSON log.  Threads and traces are numbered in the
+ * order of their records, which always come before the first alloc record
+ * referring to them.  The info record comes first, and the end record last,
+ * unless logging was cut short.  test/analyze/prof_log_json converts a binary
+ * log to JSON.
+ */
+#define PROF_LOG_BINARY_MAGIC "jeprflog"
+#define PROF_LOG_BINARY_MAGIC_LEN 8
+
+typedef enum prof_log_record_e prof_log_record_t;
+enum prof_log_record_e {
+	prof_log_record_info = 1,
+	prof_log_record_thread = 2,
+	prof_log_record_trace = 3,
+	prof_log_record_alloc = 4,
+	prof_log_record_end = 5
+};
+
 extern malloc_mutex_t log_mtx;
+extern malloc_mutex_t log_write_mtx;
 
 void prof_try_log(tsd_t *tsd, size_t usize, prof_info_t *prof_info);
 bool prof_log_init(tsd_t *tsdn);
+/* For background thread 0, which writes out the binary log. */
+bool prof_log_flush_pending(void);
+void prof_log_flush(tsdn_t *tsdn);
+/*
+ * Called with no locks held after prof_try_log; writes out the full buffers of
+ * the binary log if background thread 0 isn't there to do it, or is behind.
+ */
+void prof_log_flush_backlog(tsdn_t *tsdn);
 
 /* Used in unit tests. */
 size_t prof_log_bt_count(void);
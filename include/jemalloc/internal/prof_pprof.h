@@ -0,0 +1,55 @@
+#ifndef JEMALLOC_INTERNAL_PROF_PPROF_H
+#define JEMALLOC_INTERNAL_PROF_PPROF_H
+
+#include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/ckh.h"
+#include "jemalloc/internal/tsd_types.h"
+
+/*
+ * Heap profiles in pprof's profile.proto format, uncompressed.
+ *
+ * With opt_prof_pprof, heap profile dumps are written in this format instead
+ * of the text format that jeprof reads, so that pprof (and anything else that
+ * understands profile.proto) can read them directly.  A profile has one sample
+ * per backtrace, with {alloc_objects, alloc_space,} inuse_objects and
+ * inuse_space values (the alloc ones only with opt_prof_accum), unbiased the
+ * same way as in the text format.  Locations carry addresses only; the
+ * mappings, taken from the process' memory map, let pprof symbolize them.
+ *
+ * Nested messages are length-delimited, so the writer never has to go back:
+ * samples are written as the dump walks the backtraces, locations and mappings
+ * once all the samples are out.
+ */
+
+typedef void(prof_pprof_write_cb_t)(void *cbopaque, const void *s, size_t len);
+
+typedef struct prof_pprof_s prof_pprof_t;
+struct prof_pprof_s {
+	prof_pprof_write_cb_t *write_cb;
+	void                  *cbopaque;
+	unsigned char         *buf;
+	size_t                 buf_size;
+	size_t                 buf_end;
+
+	/* Number of values per sample; 4 with opt_prof_accum, 2 otherwise. */
+	unsigned nvalues;
+	/* Address --> location id, for the addresses seen in samples so far. */
+	ckh_t    locations;
+	uint64_t nlocations;
+	/* Set when a sample had to be left out for lack of memory. */
+	bool oom;
+};
+
+bool prof_pprof_init(tsd_t *tsd, prof_pprof_t *pprof,
+    prof_pprof_write_cb_t *write_cb, void *cbopaque, char *buf,
+    size_t buf_size, uint64_t period);
+/* values has pprof->nvalues elements, in sample type order. */
+void prof_pprof_sample(
+    tsd_t *tsd, prof_pprof_t *pprof, const prof_bt_t *bt, const uint64_t *values);
+/*
+ * Writes out the locations, and the mappings read from maps_fd (-1 if there is
+ * no memory map to read).  Returns true if any sample was left out.
+ */
+bool prof_pprof_finish(tsd_t *tsd, prof_pprof_t *pprof, int maps_fd);
+
+#endif /* JEMALLOC_INTERNAL_PROF_PPROF_H */
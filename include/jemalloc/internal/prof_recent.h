@@ -13,10 +13,13 @@ void prof_recent_alloc(tsd_t *tsd, edata_t *edata, size_t size, size_t usize);
 void prof_recent_alloc_reset(tsd_t *tsd, edata_t *edata);
 bool prof_recent_init(void);
 void edata_prof_recent_alloc_init(edata_t *edata);
+void prof_recent_prefork(tsdn_t *tsdn);
+void prof_recent_postfork_parent(tsdn_t *tsdn);
+void prof_recent_postfork_child(tsdn_t *tsdn);
 
 /* Used in unit tests. */
-typedef ql_head(prof_recent_t) prof_recent_list_t;
-extern prof_recent_list_t prof_recent_alloc_list;
+size_t prof_recent_alloc_records_test(
+    prof_recent_t **records, size_t nrecords_max);
 edata_t *prof_recent_alloc_edata_get_no_lock_test(const prof_recent_t *node);
 prof_recent_t *edata_prof_recent_alloc_get_no_lock_test(const edata_t *edata);
 
@@ -0,0 +1,33 @@
+#ifndef JEMALLOC_INTERNAL_PROF_SNAPSHOT_H
+#define JEMALLOC_INTERNAL_PROF_SNAPSHOT_H
+
+#include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/jemalloc_internal_types.h"
+#include "jemalloc/internal/tsd_types.h"
+
+/*
+ * In-memory heap profile snapshots, for finding slow leaks without writing
+ * and diffing whole profiles.
+ *
+ * A snapshot (prof.snapshot) keeps only the backtrace hash and the live
+ * counts of each gctx.  A diff (prof.diff) against it goes through the gctxs
+ * again, and reports the backtraces whose live bytes grew by more than a
+ * threshold since, with their counts then and now.  At most PROF_SNAPSHOT_MAX
+ * snapshots are kept; beyond that, taking one drops the oldest.
+ */
+
+#define PROF_SNAPSHOT_MAX 8
+/* Including the terminating '\0'. */
+#define PROF_SNAPSHOT_NAME_MAX 64
+
+/* Replaces any snapshot of the same name; returns true on OOM. */
+bool prof_snapshot_take(tsd_t *tsd, const char *name);
+/*
+ * Writes out, as JSON, the backtraces whose live bytes grew by more than
+ * threshold since the named snapshot; returns true if there is no such
+ * snapshot.
+ */
+bool prof_snapshot_diff(tsd_t *tsd, const char *name, size_t threshold,
+    write_cb_t *write_cb, void *cbopaque);
+
+#endif /* JEMALLOC_INTERNAL_PROF_SNAPSHOT_H */
@@ -5,6 +5,7 @@
 #include "jemalloc/internal/ckh.h"
 #include "jemalloc/internal/edata.h"
 #include "jemalloc/internal/mutex.h"
+#include "jemalloc/internal/prof_callsite.h"
 #include "jemalloc/internal/prng.h"
 #include "jemalloc/internal/rb.h"
 
@@ -97,6 +98,12 @@ struct prof_tctx_s {
 	 * dump_mtx.
 	 */
 	prof_cnt_t dump_cnts;
+
+	/*
+	 * Linkage for gctx->dump_tctxs, the tctx's captured by the ongoing dump,
+	 * protected by dump_mtx.
+	 */
+	prof_tctx_t *dump_next;
 };
 typedef rb_tree(prof_tctx_t) prof_tctx_tree_t;
 
@@ -107,10 +114,12 @@ struct prof_info_s {
 	prof_tctx_t *alloc_tctx;
 	/* Allocation request size. */
 	size_t alloc_size;
+	/* The sampling rate the allocation was sampled at; see prof_sample_step. */
+	unsigned sample_step;
 };
 
 struct prof_gctx_s {
-	/* Protects nlimbo, cnt_summed, and tctxs. */
+	/* Protects nlimbo, dumping, and tctxs. */
 	malloc_mutex_t *lock;
 
 	/*
@@ -131,11 +140,31 @@ struct prof_gctx_s {
 	 */
 	prof_tctx_tree_t tctxs;
 
-	/* Linkage for tree of contexts to be dumped. */
+	/*
+	 * True while the ongoing dump includes this gctx, i.e. from when the
+	 * dump snapshots bt2gctx until it is done with the gctx.  A gctx created
+	 * in between isn't part of the dump, and neither are its tctx's.
+	 */
+	bool dumping;
+
+	/* Linkage for tree of contexts to be dumped, protected by dump_mtx. */
 	rb_node(prof_gctx_t) dump_link;
 
-	/* Temporary storage for summation during dump. */
-	prof_cnt_t cnt_summed;
+	/*
+	 * Temporary storage for summation during dump, and the list of tctx's
+	 * that the dump captured, in tctxs order.  Both are protected by
+	 * dump_mtx, so that the dump can write them out without holding lock.
+	 */
+	prof_cnt_t   cnt_summed;
+	prof_tctx_t *dump_tctxs;
+
+	/*
+	 * Number of sampled objects freed so far, by lifetime bucket, if
+	 * opt_prof_lifetime; dump_lifetimes is the dump's copy, protected by
+	 * dump_mtx.
+	 */
+	atomic_zu_t lifetimes[PROF_LIFETIME_NBUCKETS];
+	size_t      dump_lifetimes[PROF_LIFETIME_NBUCKETS];
 
 	/* Associated backtrace. */
 	prof_bt_t bt;
@@ -204,14 +233,25 @@ struct prof_tdata_s {
 
 	/* Backtrace vector, used for calls to prof_backtrace(). */
 	void **vec;
+
+	/*
+	 * Callsite counts not yet folded into the global table, or NULL
+	 * without opt_prof_callsite; see prof_callsite.h.
+	 */
+	prof_callsite_t *callsites;
+	unsigned         callsites_nsamples;
 };
 typedef rb_tree(prof_tdata_t) prof_tdata_tree_t;
 
+/* A slot in the ring of recent allocation records; see prof_recent.c. */
 struct prof_recent_s {
-	nstime_t alloc_time;
-	nstime_t dalloc_time;
+	/* Spin lock protecting the slot. */
+	atomic_b_t locked;
+	/* Position of the record in allocation order; 0 for an empty slot. */
+	size_t seq;
 
-	ql_elm(prof_recent_t) link;
+	nstime_t     alloc_time;
+	nstime_t     dalloc_time;
 	size_t       size;
 	size_t       usize;
 	atomic_p_t   alloc_edata; /* NULL means allocation has been freed. */
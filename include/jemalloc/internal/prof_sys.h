@@ -14,11 +14,13 @@ void prof_hooks_init(void);
 void prof_unwind_init(void);
 void prof_sys_thread_name_fetch(tsd_t *tsd);
 int  prof_getpid(void);
-void prof_get_default_filename(tsdn_t *tsdn, char *filename, uint64_t ind);
+void prof_get_default_filename(
+    tsdn_t *tsdn, char *filename, uint64_t ind, const char *ext);
 bool prof_prefix_set(tsdn_t *tsdn, const char *prefix);
 void prof_fdump_impl(tsd_t *tsd);
 void prof_idump_impl(tsd_t *tsd);
 bool prof_mdump_impl(tsd_t *tsd, const char *filename);
+bool prof_contention_dump_impl(tsd_t *tsd, const char *filename);
 void prof_gdump_impl(tsd_t *tsd);
 int  prof_thread_stack_range(uintptr_t fp, uintptr_t *low, uintptr_t *high);
 
@@ -67,6 +67,26 @@ typedef struct prof_recent_s prof_recent_t;
  */
 #define PROF_NTDATA_LOCKS 256
 
+/*
+ * Number of shards of the backtrace-->gctx table.  Each shard has its own lock,
+ * so that sampled allocations with different backtraces don't serialize on a
+ * single mutex.
+ */
+#define LG_PROF_BT2GCTX_NSHARDS 6
+#define PROF_BT2GCTX_NSHARDS (1U << LG_PROF_BT2GCTX_NSHARDS)
+
+/*
+ * Buckets of the per-backtrace lifetime histograms (opt_prof_lifetime): under
+ * 1us, then one per power of 10 up to 10^4s (a bit under 3 hours), and longer.
+ */
+#define PROF_LIFETIME_NBUCKETS 12
+
+/*
+ * Number of sampling rates that opt_prof_overhead_ppm moves between: step s
+ * samples every 2^(lg_prof_sample + s) bytes on average.
+ */
+#define PROF_SAMPLE_NSTEPS 7
+
 /* Minimize memory bloat for non-prof builds. */
 #ifdef JEMALLOC_PROF
 #	define PROF_DUMP_FILENAME_LEN (PATH_MAX + 1)
@@ -130,6 +130,14 @@ hpdata_t *psset_pick_purge(psset_t *psset, const nstime_t *now);
 /* Pick one to hugify. */
 hpdata_t *psset_pick_hugify(psset_t *psset);
 
+/*
+ * Copies out the ranges of the pageslabs with free space, flagging the
+ * hugified ones; see pages_ranges_copy_t.  Full pageslabs aren't kept in any
+ * container, so they are left out.
+ */
+size_t psset_resident_ranges(
+    psset_t *psset, pages_range_t *ranges, size_t nranges);
+
 void psset_insert(psset_t *psset, hpdata_t *ps);
 void psset_remove(psset_t *psset, hpdata_t *ps);
 
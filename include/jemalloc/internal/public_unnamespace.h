@@ -0,0 +1,27 @@
+#undef je_aligned_alloc
+#undef je_calloc
+#undef je_dallocx
+#undef je_free
+#undef je_free_sized
+#undef je_free_aligned_sized
+#undef je_mallctl
+#undef je_mallctlbymib
+#undef je_mallctlnametomib
+#undef je_malloc
+#undef je_malloc_conf
+#undef je_malloc_conf_2_conf_harder
+#undef je_malloc_message
+#undef je_malloc_stats_print
+#undef je_malloc_usable_size
+#undef je_mallocx
+#undef je_smallocx_000000missin
+#undef je_nallocx
+#undef je_posix_memalign
+#undef je_rallocx
+#undef je_realloc
+#undef je_sallocx
+#undef je_sdallocx
+#undef je_xallocx
+#undef je_memalign
+#undef je_valloc
+#undef je_pvalloc
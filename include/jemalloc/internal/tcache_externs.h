@@ -17,6 +17,10 @@ extern unsigned opt_tcache_nslots_large;
 extern ssize_t  opt_lg_tcache_shift;
 extern size_t   opt_tcache_gc_incr_bytes;
 extern size_t   opt_tcache_gc_delay_bytes;
+extern size_t   opt_tcache_bytes_budget;
+extern ssize_t  opt_tcache_idle_reclaim_ms;
+extern unsigned opt_tcache_pool_max;
+extern bool     opt_tcache_pool_keep_cached;
 extern unsigned opt_lg_tcache_flush_small_div;
 extern unsigned opt_lg_tcache_flush_large_div;
 
@@ -65,15 +69,22 @@ void tcache_arena_reassociate(
     tsdn_t *tsdn, tcache_slow_t *tcache_slow, tcache_t *tcache, arena_t *arena);
 tcache_t *tcache_create_explicit(tsd_t *tsd);
 void      thread_tcache_max_set(tsd_t *tsd, size_t tcache_max);
+void      thread_tcache_bytes_budget_set(tsd_t *tsd, size_t bytes_budget);
 void      tcache_cleanup(tsd_t *tsd);
+void      tcache_idle_reclaim_sync(tsd_t *tsd);
+void      tcache_idle_reclaim_exit(tsd_t *tsd);
+uint64_t  tcache_idle_reclaim_interval_ns(void);
+void      tcache_idle_reclaim(tsd_t *tsd, arena_t *arena);
 void      tcache_stats_merge(tsdn_t *tsdn, tcache_t *tcache, arena_t *arena);
 bool      tcaches_create(tsd_t *tsd, base_t *base, unsigned *r_ind);
 void      tcaches_flush(tsd_t *tsd, unsigned ind);
 void      tcaches_destroy(tsd_t *tsd, unsigned ind);
+void      tcache_pool_flush(tsd_t *tsd);
 bool      tcache_boot(tsdn_t *tsdn, base_t *base);
 void      tcache_arena_associate(
          tsdn_t *tsdn, tcache_slow_t *tcache_slow, tcache_t *tcache, arena_t *arena);
-void tcache_prefork(tsdn_t *tsdn);
+void tcache_prefork0(tsdn_t *tsdn);
+void tcache_prefork1(tsdn_t *tsdn);
 void tcache_postfork_parent(tsdn_t *tsdn);
 void tcache_postfork_child(tsdn_t *tsdn);
 void tcache_flush(tsd_t *tsd);
@@ -2,6 +2,7 @@
 #define JEMALLOC_INTERNAL_TCACHE_INLINES_H
 
 #include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/alloc_tag.h"
 #include "jemalloc/internal/arena_externs.h"
 #include "jemalloc/internal/bin.h"
 #include "jemalloc/internal/jemalloc_internal_inlines_b.h"
@@ -166,6 +167,10 @@ tcache_alloc_large(tsd_t *tsd, arena_t *arena, tcache_t *tcache, size_t size,
 
 		if (config_stats) {
 			bin->tstats.nrequests++;
+			/* Still stamped with the tag of its previous owner. */
+			if (unlikely(alloc_tag_used_get())) {
+				alloc_tag_large_stamp(tsd, ret);
+			}
 		}
 	}
 
@@ -238,4 +243,36 @@ tcaches_get(tsd_t *tsd, unsigned ind) {
 	return elm->tcache;
 }
 
+/*
+ * Brackets the slow path allocator calls of a thread, so that the background
+ * thread never reclaims its tcache meanwhile; see tcache_idle_reclaim().
+ * Returns whether tcache_idle_reclaim_busy_end() has to be called, i.e. false
+ * if the feature is off, or for calls nested in another one, e.g. from hooks.
+ */
+JEMALLOC_ALWAYS_INLINE bool
+tcache_idle_reclaim_busy_begin(tsd_t *tsd) {
+	if (!config_stats || opt_tcache_idle_reclaim_ms < 0) {
+		return false;
+	}
+	tcache_slow_t *tcache_slow = tsd_tcache_slowp_get_unsafe(tsd);
+	uint8_t        state = atomic_fetch_or_u8(&tcache_slow->reclaim_state,
+	           tcache_reclaim_busy, ATOMIC_ACQUIRE);
+	if (state & tcache_reclaim_busy) {
+		return false;
+	}
+	if (unlikely(state != tcache_reclaim_none)) {
+		tcache_idle_reclaim_sync(tsd);
+	}
+	return true;
+}
+
+JEMALLOC_ALWAYS_INLINE void
+tcache_idle_reclaim_busy_end(tsd_t *tsd, bool busy) {
+	if (busy) {
+		atomic_fetch_and_u8(
+		    &tsd_tcache_slowp_get_unsafe(tsd)->reclaim_state,
+		    (uint8_t)~tcache_reclaim_busy, ATOMIC_RELEASE);
+	}
+}
+
 #endif /* JEMALLOC_INTERNAL_TCACHE_INLINES_H */
@@ -2,11 +2,15 @@
 #define JEMALLOC_INTERNAL_TCACHE_STRUCTS_H
 
 #include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/atomic.h"
 #include "jemalloc/internal/cache_bin.h"
+#include "jemalloc/internal/nstime.h"
+#include "jemalloc/internal/ownedint.h"
 #include "jemalloc/internal/ql.h"
 #include "jemalloc/internal/sc.h"
 #include "jemalloc/internal/tcache_types.h"
 #include "jemalloc/internal/ticker.h"
+#include "jemalloc/internal/tsd_types.h"
 
 /*
  * The tcache state is split into the slow and hot path data.  Each has a
@@ -18,6 +22,23 @@
  * TSD tcache and those called with a manual tcache.
  */
 
+/*
+ * Large stats that a thread keeps for the extents it allocates and frees in its
+ * tcache's arena, so that these hot paths don't bounce the arena's counters
+ * between cores.  Only classes up to TCACHE_MAXCLASS_LIMIT are covered; larger
+ * extents are expensive enough anyway.  Readers add up the counters of the
+ * tcaches in the arena's tcache_ql (under tcache_ql_mtx) and the arena's own,
+ * and the counters are flushed into the arena when the tcache leaves it.
+ */
+#define TCACHE_LSTATS_NCLASSES (TCACHE_NBINS_MAX - SC_NBINS)
+typedef struct tcache_lstats_s tcache_lstats_t;
+struct tcache_lstats_s {
+	owned_u64_t nmalloc;
+	owned_u64_t ndalloc;
+	/* Wraps around after freeing extents allocated by other threads. */
+	owned_u64_t active_bytes;
+};
+
 struct tcache_slow_s {
 	/* Lets us track all the tcaches in an arena. */
 	ql_elm(tcache_slow_t) link;
@@ -33,6 +54,11 @@ struct tcache_slow_s {
 	arena_t *arena;
 	/* The number of bins activated in the tcache. */
 	unsigned tcache_nbins;
+	/*
+	 * Maximum number of bytes to keep cached across all bins, or 0 for no
+	 * limit.  Enforced at GC events.
+	 */
+	size_t bytes_budget;
 	/* Last time GC has been performed.  */
 	nstime_t last_gc_time;
 	/* Next bin to GC. */
@@ -57,6 +83,25 @@ struct tcache_slow_s {
 
 	/* The associated bins. */
 	tcache_t *tcache;
+
+	/*
+	 * Idle reclamation state, see tcache_idle_reclaim().  owner is NULL
+	 * for explicit tcaches, which are never reclaimed, and is cleared
+	 * under the arena's tcache_ql_mtx when the owner exits.  The idle_*
+	 * fields are only used by the background thread, under the arena's
+	 * tcache_ql_mtx.
+	 */
+	tsd_t      *owner;
+	atomic_u8_t reclaim_state;
+	/* Owner's allocated + deallocated bytes when last looked at. */
+	uint64_t idle_activity;
+	/* Since when idle_activity has not changed. */
+	nstime_t idle_since;
+	/* Whether the cache was flushed since the owner was last active. */
+	bool idle_reclaimed;
+
+	/* The owner's large stats in arena; unused for explicit tcaches. */
+	tcache_lstats_t lstats[TCACHE_LSTATS_NCLASSES];
 };
 
 struct tcache_s {
@@ -64,6 +109,16 @@ struct tcache_s {
 	cache_bin_t    bins[TCACHE_NBINS_MAX];
 };
 
+/*
+ * A tcache detached from an exited thread, waiting to be adopted by a new one.
+ * tcache_slow.arena is the arena it was last associated with.
+ */
+struct tcache_pool_elm_s {
+	tcache_pool_elm_t *next;
+	tcache_slow_t      tcache_slow;
+	tcache_t           tcache;
+};
+
 /* Linkage for list of available (previously used) explicit tcache IDs. */
 struct tcaches_s {
 	union {
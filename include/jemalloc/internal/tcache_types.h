@@ -7,6 +7,7 @@
 typedef struct tcache_slow_s tcache_slow_t;
 typedef struct tcache_s      tcache_t;
 typedef struct tcaches_s     tcaches_t;
+typedef struct tcache_pool_elm_s tcache_pool_elm_t;
 
 /* Used in TSD static initializer only. Real init in tsd_tcache_data_init(). */
 #define TCACHE_ZERO_INITIALIZER                                                \
@@ -33,5 +34,22 @@ typedef struct tcaches_s     tcaches_t;
 #define TCACHE_GC_INTERVAL_NS ((uint64_t)10 * KQU(1000000)) /* 10ms */
 #define TCACHE_GC_SMALL_NBINS_MAX ((SC_NBINS > 8) ? (SC_NBINS >> 3) : 1)
 #define TCACHE_GC_LARGE_NBINS_MAX 1
+/* Max number of tcaches flushed per tcache_ql_mtx hold by idle reclamation. */
+#define TCACHE_IDLE_RECLAIM_BATCH 16
+
+/* Upper bound for opt_tcache_pool_max. */
+#define TCACHE_POOL_MAX_LIMIT 4096
+
+/* Bits of tcache_slow_t.reclaim_state; see tcache_idle_reclaim(). */
+enum {
+	/* Owned by the thread, as usual. */
+	tcache_reclaim_none = 0,
+	/* Owner forced off the fast path; reclaimable if it stays idle. */
+	tcache_reclaim_pending = 1,
+	/* Being flushed by the background thread; the owner has to wait. */
+	tcache_reclaim_active = 2,
+	/* Owner in a slow path allocator call; it can't be claimed. */
+	tcache_reclaim_busy = 4
+};
 
 #endif /* JEMALLOC_INTERNAL_TCACHE_TYPES_H */
@@ -16,6 +16,7 @@ enum te_alloc_e {
 #ifdef JEMALLOC_STATS
 	te_alloc_prof_threshold,
 	te_alloc_peak,
+	te_alloc_latency_sample,
 #endif
 	te_alloc_user0,
 	te_alloc_user1,
@@ -5,6 +5,7 @@
 
 #include "jemalloc/internal/jemalloc_preamble.h"
 #include "jemalloc/internal/activity_callback.h"
+#include "jemalloc/internal/alloc_tag.h"
 #include "jemalloc/internal/arena_types.h"
 #include "jemalloc/internal/assert.h"
 #include "jemalloc/internal/bin_types.h"
@@ -83,7 +84,9 @@ typedef ql_elm(tsd_t) tsd_link_t;
 	O(binshards, tsd_binshards_t, tsd_binshards_t)                         \
 	O(tsd_link, tsd_link_t, tsd_link_t)                                    \
 	O(in_hook, bool, bool)                                                 \
+	O(latency_sites_armed, uint8_t, uint8_t)                               \
 	O(peak, peak_t, peak_t)                                                \
+	O(alloc_tag, alloc_tag_tsd_t, alloc_tag_tsd_t)                         \
 	O(activity_callback_thunk, activity_callback_thunk_t,                  \
 	    activity_callback_thunk_t)                                         \
 	O(tcache_slow, tcache_slow_t, tcache_slow_t)                           \
@@ -105,7 +108,10 @@ typedef ql_elm(tsd_t) tsd_link_t;
 	    /* sec_shard */ (uint8_t) - 1,                                     \
 	    /* binshards */ TSD_BINSHARDS_ZERO_INITIALIZER,                    \
 	    /* tsd_link */ {NULL}, /* in_hook */ false,                        \
-	    /* peak */ PEAK_INITIALIZER, /* activity_callback_thunk */         \
+	    /* latency_sites_armed */ 0,                                       \
+	    /* peak */ PEAK_INITIALIZER,                                       \
+	    /* alloc_tag */ ALLOC_TAG_TSD_INITIALIZER,                         \
+	    /* activity_callback_thunk */                                      \
 	    ACTIVITY_CALLBACK_THUNK_INITIALIZER,                               \
 	    /* tcache_slow */ TCACHE_SLOW_ZERO_INITIALIZER,                    \
 	    /* rtree_ctx */ RTREE_CTX_INITIALIZER,
@@ -163,6 +169,8 @@ void   tsd_postfork_child(tsd_t *tsd);
 void tsd_global_slow_inc(tsdn_t *tsdn);
 void tsd_global_slow_dec(tsdn_t *tsdn);
 bool tsd_global_slow(void);
+/* Takes a single remote thread down the slow paths, once. */
+bool tsd_force_recompute_one(tsdn_t *tsdn, tsd_t *tsd);
 
 #define TSD_MIN_INIT_STATE_MAX_FETCHED (128)
 
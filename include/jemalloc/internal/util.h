@@ -82,6 +82,14 @@ get_errno(void) {
 		} while (0)
 #endif
 
+/* The address the calling function will return to. */
+#ifdef _MSC_VER
+#	include <intrin.h>
+#	define util_return_address() _ReturnAddress()
+#else
+#	define util_return_address() __builtin_return_address(0)
+#endif
+
 /* Allows compiler constant folding on inlined paths. */
 #if defined(__has_builtin)
 #	if __has_builtin(__builtin_constant_p)
@@ -31,10 +31,13 @@ enum witness_rank_e {
 	WITNESS_RANK_PROF_BT2GCTX,
 	WITNESS_RANK_PROF_TDATAS,
 	WITNESS_RANK_PROF_TDATA,
+	WITNESS_RANK_PROF_LOG_WRITE,
 	WITNESS_RANK_PROF_LOG,
 	WITNESS_RANK_PROF_GCTX,
 	WITNESS_RANK_PROF_RECENT_DUMP,
+	WITNESS_RANK_PROF_RECENT_ALLOC,
 	WITNESS_RANK_BACKGROUND_THREAD,
+	WITNESS_RANK_TCACHE_POOL,
 	/*
 	 * Used as an argument to witness_assert_depth_to_rank() in order to
 	 * validate depth excluding non-core locks with lower ranks.  Since the
@@ -47,6 +50,7 @@ enum witness_rank_e {
 	WITNESS_RANK_TCACHE_QL,
 
 	WITNESS_RANK_SEC_BIN,
+	WITNESS_RANK_LEC = WITNESS_RANK_SEC_BIN,
 
 	WITNESS_RANK_EXTENT_GROW,
 	WITNESS_RANK_HPA_SHARD_GROW = WITNESS_RANK_EXTENT_GROW,
@@ -71,10 +75,10 @@ enum witness_rank_e {
 	WITNESS_RANK_COUNTER_ACCUM = WITNESS_RANK_LEAF,
 	WITNESS_RANK_DSS = WITNESS_RANK_LEAF,
 	WITNESS_RANK_PROF_ACTIVE = WITNESS_RANK_LEAF,
+	WITNESS_RANK_PROF_CALLSITE = WITNESS_RANK_LEAF,
 	WITNESS_RANK_PROF_DUMP_FILENAME = WITNESS_RANK_LEAF,
 	WITNESS_RANK_PROF_GDUMP = WITNESS_RANK_LEAF,
 	WITNESS_RANK_PROF_NEXT_THR_UID = WITNESS_RANK_LEAF,
-	WITNESS_RANK_PROF_RECENT_ALLOC = WITNESS_RANK_LEAF,
 	WITNESS_RANK_PROF_STATS = WITNESS_RANK_LEAF,
 	WITNESS_RANK_PROF_THREAD_ACTIVE_INIT = WITNESS_RANK_LEAF,
 	WITNESS_RANK_THREAD_EVENTS_USER = WITNESS_RANK_LEAF,
@@ -0,0 +1,117 @@
+#include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/jemalloc_internal_includes.h"
+
+#include "jemalloc/internal/alloc_tag.h"
+#include "jemalloc/internal/assert.h"
+#include "jemalloc/internal/emap.h"
+
+/*
+ * Folded in at most every PEAK_EVENT_WAIT bytes per thread, so atomics are
+ * cheap enough.  Without 64-bit atomics, the totals wrap around much sooner.
+ */
+#ifdef JEMALLOC_ATOMIC_U64
+typedef atomic_u64_t alloc_tag_counter_t;
+#	define alloc_tag_counter_load atomic_load_u64
+#	define alloc_tag_counter_add atomic_fetch_add_u64
+#else
+typedef atomic_zu_t alloc_tag_counter_t;
+#	define alloc_tag_counter_load atomic_load_zu
+#	define alloc_tag_counter_add atomic_fetch_add_zu
+#endif
+
+typedef struct alloc_tag_stats_s alloc_tag_stats_t;
+struct alloc_tag_stats_s {
+	alloc_tag_counter_t allocated;
+	alloc_tag_counter_t deallocated;
+};
+
+/* Zero initialized. */
+static alloc_tag_stats_t alloc_tag_stats[ALLOC_TAG_NTAGS];
+atomic_b_t alloc_tag_used = ATOMIC_INIT(false);
+
+void
+alloc_tag_flush(tsd_t *tsd) {
+	cassert(config_stats);
+	alloc_tag_tsd_t *tag_tsd = tsd_alloc_tagp_get(tsd);
+	assert(tag_tsd->tag < ALLOC_TAG_NTAGS);
+	alloc_tag_stats_t *stats = &alloc_tag_stats[tag_tsd->tag];
+
+	uint64_t allocated = tsd_thread_allocated_get(tsd);
+	uint64_t deallocated = tsd_thread_deallocated_get(tsd);
+	if (allocated != tag_tsd->allocated_last) {
+		alloc_tag_counter_add(&stats->allocated,
+		    allocated - tag_tsd->allocated_last, ATOMIC_RELAXED);
+		tag_tsd->allocated_last = allocated;
+	}
+	if (deallocated != tag_tsd->deallocated_last) {
+		alloc_tag_counter_add(&stats->deallocated,
+		    deallocated - tag_tsd->deallocated_last, ATOMIC_RELAXED);
+		tag_tsd->deallocated_last = deallocated;
+	}
+}
+
+unsigned
+alloc_tag_get(tsd_t *tsd) {
+	cassert(config_stats);
+	return tsd_alloc_tagp_get(tsd)->tag;
+}
+
+bool
+alloc_tag_set(tsd_t *tsd, unsigned tag) {
+	cassert(config_stats);
+	if (tag >= ALLOC_TAG_NTAGS) {
+		return true;
+	}
+	/* What happened so far belongs to the old tag. */
+	alloc_tag_flush(tsd);
+	tsd_alloc_tagp_get(tsd)->tag = tag;
+	if (tag != 0 && !alloc_tag_used_get()) {
+		atomic_store_b(&alloc_tag_used, true, ATOMIC_RELAXED);
+	}
+	return false;
+}
+
+unsigned
+alloc_tag_large_get(tsd_t *tsd, const void *ptr) {
+	cassert(config_stats);
+	if (!alloc_tag_used_get()) {
+		return 0;
+	}
+	edata_t *edata = emap_edata_lookup(
+	    tsd_tsdn(tsd), &arena_emap_global, ptr);
+	return edata_alloc_tag_get(edata);
+}
+
+void
+alloc_tag_large_stamp(tsd_t *tsd, const void *ptr) {
+	cassert(config_stats);
+	edata_t *edata = emap_edata_lookup(
+	    tsd_tsdn(tsd), &arena_emap_global, ptr);
+	edata_alloc_tag_set(edata, alloc_tag_get(tsd));
+}
+
+void
+alloc_tag_dalloc(tsd_t *tsd, unsigned tag, size_t usize) {
+	cassert(config_stats);
+	assert(tag < ALLOC_TAG_NTAGS);
+	alloc_tag_tsd_t *tag_tsd = tsd_alloc_tagp_get(tsd);
+	if (tag == tag_tsd->tag) {
+		/* The thread.deallocated delta takes care of it. */
+		return;
+	}
+	/* Keep the bytes out of the delta charged to the current tag. */
+	tag_tsd->deallocated_last += usize;
+	alloc_tag_counter_add(
+	    &alloc_tag_stats[tag].deallocated, usize, ATOMIC_RELAXED);
+}
+
+void
+alloc_tag_read(unsigned tag, uint64_t *allocated, uint64_t *deallocated) {
+	cassert(config_stats);
+	assert(tag < ALLOC_TAG_NTAGS);
+	alloc_tag_stats_t *stats = &alloc_tag_stats[tag];
+	*allocated = (uint64_t)alloc_tag_counter_load(
+	    &stats->allocated, ATOMIC_RELAXED);
+	*deallocated = (uint64_t)alloc_tag_counter_load(
+	    &stats->deallocated, ATOMIC_RELAXED);
+}
@@ -37,7 +37,10 @@ static pa_central_t arena_pa_central_global;
 div_info_t arena_binind_div_info[SC_NBINS];
 
 size_t opt_oversize_threshold = OVERSIZE_THRESHOLD_DEFAULT;
+size_t opt_lec_max_bytes = LEC_MAX_BYTES_DEFAULT;
+size_t opt_lec_max_alloc = LEC_MAX_ALLOC_DEFAULT;
 size_t oversize_threshold = OVERSIZE_THRESHOLD_DEFAULT;
+bool   opt_arena_stats_enabled = true;
 
 uint32_t        arena_bin_offsets[SC_NBINS];
 static unsigned nbins_total;
@@ -84,34 +87,99 @@ arena_basic_stats_merge(tsdn_t *tsdn, arena_t *arena, unsigned *nthreads,
 	pa_shard_basic_stats_merge(&arena->pa_shard, nactive, ndirty, nmuzzy);
 }
 
-void
-arena_stats_merge(tsdn_t *tsdn, arena_t *arena, unsigned *nthreads,
-    const char **dss, ssize_t *dirty_decay_ms, ssize_t *muzzy_decay_ms,
-    size_t *nactive, size_t *ndirty, size_t *nmuzzy, arena_stats_t *astats,
-    bin_stats_data_t *bstats, arena_stats_large_t *lstats, pac_estats_t *estats,
-    hpa_shard_stats_t *hpastats) {
-	cassert(config_stats);
+/* Currently cached bytes and sanitizer-stashed bytes in tcache. */
+static void
+arena_tcache_bytes_merge(arena_t *arena, arena_stats_t *astats) {
+	astats->tcache_bytes = 0;
+	astats->tcache_stashed_bytes = 0;
+	cache_bin_array_descriptor_t *descriptor;
+	ql_foreach (descriptor, &arena->cache_bin_array_descriptor_ql, link) {
+		for (szind_t i = 0; i < TCACHE_NBINS_MAX; i++) {
+			cache_bin_t *cache_bin = &descriptor->bins[i];
+			if (cache_bin_disabled(cache_bin)) {
+				continue;
+			}
 
-	arena_basic_stats_merge(tsdn, arena, nthreads, dss, dirty_decay_ms,
-	    muzzy_decay_ms, nactive, ndirty, nmuzzy);
+			cache_bin_sz_t ncached, nstashed;
+			cache_bin_nitems_get_remote(
+			    cache_bin, &ncached, &nstashed);
+			astats->tcache_bytes += ncached * sz_index2size(i);
+			astats->tcache_stashed_bytes += nstashed
+			    * sz_index2size(i);
+		}
+	}
+}
 
-	size_t base_allocated, base_edata_allocated, base_rtree_allocated,
-	    base_resident, base_mapped, metadata_thp;
-	base_stats_get(tsdn, arena->base, &base_allocated,
-	    &base_edata_allocated, &base_rtree_allocated, &base_resident,
-	    &base_mapped, &metadata_thp);
-	size_t pac_mapped_sz = pac_mapped(&arena->pa_shard.pac);
-	astats->mapped += base_mapped + pac_mapped_sz;
-	astats->resident += base_resident;
+/* Gather per arena mutex profiling data, except for tcache_list. */
+static void
+arena_mutex_stats_read(tsdn_t *tsdn, arena_t *arena, arena_stats_t *astats) {
+#define READ_ARENA_MUTEX_PROF_DATA(mtx, ind)                                   \
+	malloc_mutex_lock(tsdn, &arena->mtx);                                  \
+	malloc_mutex_prof_read(                                                \
+	    tsdn, &astats->mutex_prof_data[ind], &arena->mtx);                 \
+	malloc_mutex_unlock(tsdn, &arena->mtx);
 
-	LOCKEDINT_MTX_LOCK(tsdn, arena->stats.mtx);
+	READ_ARENA_MUTEX_PROF_DATA(base->mtx, arena_prof_mutex_base);
+#undef READ_ARENA_MUTEX_PROF_DATA
+	for (unsigned i = 0; i < ARENA_LARGE_NSHARDS; i++) {
+		malloc_mutex_t *mtx = &arena->large[i].mtx;
+		malloc_mutex_lock(tsdn, mtx);
+		malloc_mutex_prof_accum(tsdn,
+		    &astats->mutex_prof_data[arena_prof_mutex_large], mtx);
+		malloc_mutex_unlock(tsdn, mtx);
+	}
+	pa_shard_mtx_stats_read(
+	    tsdn, &arena->pa_shard, astats->mutex_prof_data);
+}
 
-	astats->base += base_allocated;
-	astats->metadata_edata += base_edata_allocated;
-	astats->metadata_rtree += base_rtree_allocated;
-	atomic_load_add_store_zu(&astats->internal, arena_internal_get(arena));
-	astats->metadata_thp += metadata_thp;
+/*
+ * Sums up one of the tcache_lstats_t counters (at offset field) over the
+ * tcaches in the arena.  Called with tcache_ql_mtx held.
+ */
+static uint64_t
+arena_large_stats_tcache_sum(arena_t *arena, szind_t hindex, size_t field) {
+	if (!OWNED_U64_SUPPORTED || hindex >= TCACHE_LSTATS_NCLASSES) {
+		return 0;
+	}
+	uint64_t       sum = 0;
+	tcache_slow_t *tcache_slow;
+	ql_foreach (tcache_slow, &arena->tcache_ql, link) {
+		sum += owned_read_u64((owned_u64_t *)((byte_t *)&tcache_slow
+		        ->lstats[hindex] + field));
+	}
+	return sum;
+}
+
+/* Moves the counters into the arena's; by the owner of tcache_slow only. */
+void
+arena_large_stats_tcache_flush(
+    tsdn_t *tsdn, arena_t *arena, tcache_slow_t *tcache_slow) {
+	cassert(config_stats);
+	if (!OWNED_U64_SUPPORTED) {
+		return;
+	}
+	LOCKEDINT_MTX_LOCK(tsdn, arena->stats.mtx);
+	for (szind_t i = 0; i < TCACHE_LSTATS_NCLASSES; i++) {
+		arena_stats_large_t *lstats = &arena->stats.lstats[i];
+		tcache_lstats_t     *local = &tcache_slow->lstats[i];
+		locked_inc_u64(tsdn, LOCKEDINT_MTX(arena->stats.mtx),
+		    &lstats->nmalloc, owned_take_u64(&local->nmalloc));
+		locked_inc_u64(tsdn, LOCKEDINT_MTX(arena->stats.mtx),
+		    &lstats->ndalloc, owned_take_u64(&local->ndalloc));
+		locked_inc_u64(tsdn, LOCKEDINT_MTX(arena->stats.mtx),
+		    &lstats->active_bytes, owned_take_u64(&local->active_bytes));
+	}
+	LOCKEDINT_MTX_UNLOCK(tsdn, arena->stats.mtx);
+}
 
+/*
+ * Called with the arena stats mutex held (when it exists), and tcache_ql_mtx
+ * held.
+ */
+static void
+arena_large_stats_merge(tsdn_t *tsdn, arena_t *arena, arena_stats_t *astats,
+    arena_stats_large_t *lstats) {
+	malloc_mutex_assert_owner(tsdn, &arena->tcache_ql_mtx);
 	for (szind_t i = 0; i < SC_NSIZES - SC_NBINS; i++) {
 		/* ndalloc should be read before nmalloc,
 		 * since otherwise it is possible for ndalloc to be incremented,
@@ -119,12 +187,16 @@ arena_stats_merge(tsdn_t *tsdn, arena_t *arena, unsigned *nthreads,
 		uint64_t ndalloc = locked_read_u64(tsdn,
 		    LOCKEDINT_MTX(arena->stats.mtx),
 		    &arena->stats.lstats[i].ndalloc);
+		ndalloc += arena_large_stats_tcache_sum(arena, i,
+		    offsetof(tcache_lstats_t, ndalloc));
 		locked_inc_u64_unsynchronized(&lstats[i].ndalloc, ndalloc);
 		astats->ndalloc_large += ndalloc;
 
 		uint64_t nmalloc = locked_read_u64(tsdn,
 		    LOCKEDINT_MTX(arena->stats.mtx),
 		    &arena->stats.lstats[i].nmalloc);
+		nmalloc += arena_large_stats_tcache_sum(arena, i,
+		    offsetof(tcache_lstats_t, nmalloc));
 		locked_inc_u64_unsynchronized(&lstats[i].nmalloc, nmalloc);
 		astats->nmalloc_large += nmalloc;
 
@@ -153,62 +225,99 @@ arena_stats_merge(tsdn_t *tsdn, arena_t *arena, unsigned *nthreads,
 		uint64_t active_bytes = locked_read_u64(tsdn,
 		    LOCKEDINT_MTX(arena->stats.mtx),
 		    &arena->stats.lstats[i].active_bytes);
+		active_bytes += arena_large_stats_tcache_sum(arena, i,
+		    offsetof(tcache_lstats_t, active_bytes));
 		locked_inc_u64_unsynchronized(
 		    &lstats[i].active_bytes, active_bytes);
 		astats->allocated_large += active_bytes;
 	}
+}
 
-	pa_shard_stats_merge(tsdn, &arena->pa_shard, &astats->pa_shard_stats,
-	    estats, hpastats, &astats->resident);
+void
+arena_stats_merge(tsdn_t *tsdn, arena_t *arena, unsigned *nthreads,
+    const char **dss, ssize_t *dirty_decay_ms, ssize_t *muzzy_decay_ms,
+    size_t *nactive, size_t *ndirty, size_t *nmuzzy, arena_stats_t *astats,
+    bin_stats_data_t *bstats, arena_stats_large_t *lstats, pac_estats_t *estats,
+    hpa_shard_stats_t *hpastats, unsigned what) {
+	cassert(config_stats);
 
-	LOCKEDINT_MTX_UNLOCK(tsdn, arena->stats.mtx);
+	arena_basic_stats_merge(tsdn, arena, nthreads, dss, dirty_decay_ms,
+	    muzzy_decay_ms, nactive, ndirty, nmuzzy);
 
-	/* Currently cached bytes and sanitizer-stashed bytes in tcache. */
-	astats->tcache_bytes = 0;
-	astats->tcache_stashed_bytes = 0;
-	malloc_mutex_lock(tsdn, &arena->tcache_ql_mtx);
-	cache_bin_array_descriptor_t *descriptor;
-	ql_foreach (descriptor, &arena->cache_bin_array_descriptor_ql, link) {
-		for (szind_t i = 0; i < TCACHE_NBINS_MAX; i++) {
-			cache_bin_t *cache_bin = &descriptor->bins[i];
-			if (cache_bin_disabled(cache_bin)) {
-				continue;
-			}
+	size_t base_allocated, base_edata_allocated, base_rtree_allocated,
+	    base_resident, base_mapped, metadata_thp;
+	base_stats_get(tsdn, arena->base, &base_allocated,
+	    &base_edata_allocated, &base_rtree_allocated, &base_resident,
+	    &base_mapped, &metadata_thp);
+	size_t pac_mapped_sz = pac_mapped(&arena->pa_shard.pac);
+	astats->mapped += base_mapped + pac_mapped_sz;
+	astats->resident += base_resident;
 
-			cache_bin_sz_t ncached, nstashed;
-			cache_bin_nitems_get_remote(
-			    cache_bin, &ncached, &nstashed);
-			astats->tcache_bytes += ncached * sz_index2size(i);
-			astats->tcache_stashed_bytes += nstashed
-			    * sz_index2size(i);
-		}
+	bool large = (what & ARENA_STATS_MERGE_LARGE) != 0;
+	if (large) {
+		malloc_mutex_lock(tsdn, &arena->tcache_ql_mtx);
 	}
-	malloc_mutex_prof_read(tsdn,
-	    &astats->mutex_prof_data[arena_prof_mutex_tcache_list],
-	    &arena->tcache_ql_mtx);
-	malloc_mutex_unlock(tsdn, &arena->tcache_ql_mtx);
+	LOCKEDINT_MTX_LOCK(tsdn, arena->stats.mtx);
 
-#define READ_ARENA_MUTEX_PROF_DATA(mtx, ind)                                   \
-	malloc_mutex_lock(tsdn, &arena->mtx);                                  \
-	malloc_mutex_prof_read(                                                \
-	    tsdn, &astats->mutex_prof_data[ind], &arena->mtx);                 \
-	malloc_mutex_unlock(tsdn, &arena->mtx);
+	astats->base += base_allocated;
+	astats->metadata_edata += base_edata_allocated;
+	astats->metadata_rtree += base_rtree_allocated;
+	atomic_load_add_store_zu(&astats->internal, arena_internal_get(arena));
+	for (unsigned i = 0; i < arena_resident_scan_nkinds; i++) {
+		atomic_load_add_store_zu(&astats->resident_scan[i],
+		    atomic_load_zu(&arena->stats.resident_scan[i], ATOMIC_RELAXED));
+	}
+	astats->metadata_thp += metadata_thp;
 
-	/* Gather per arena mutex profiling data. */
-	READ_ARENA_MUTEX_PROF_DATA(large_mtx, arena_prof_mutex_large);
-	READ_ARENA_MUTEX_PROF_DATA(base->mtx, arena_prof_mutex_base);
-#undef READ_ARENA_MUTEX_PROF_DATA
-	pa_shard_mtx_stats_read(
-	    tsdn, &arena->pa_shard, astats->mutex_prof_data);
+	if (large) {
+		arena_large_stats_merge(tsdn, arena, astats, lstats);
+	}
+
+	bool extents = (what & ARENA_STATS_MERGE_EXTENTS) != 0;
+	pa_shard_stats_merge(tsdn, &arena->pa_shard, &astats->pa_shard_stats,
+	    extents ? estats : NULL, extents ? hpastats : NULL,
+	    &astats->resident);
+
+	if ((what & ARENA_STATS_MERGE_LATENCY) != 0) {
+		latency_stats_merge(tsdn, LOCKEDINT_MTX(arena->stats.mtx),
+		    &astats->latency, &arena->stats.latency);
+	}
+
+	LOCKEDINT_MTX_UNLOCK(tsdn, arena->stats.mtx);
+	if (large) {
+		malloc_mutex_unlock(tsdn, &arena->tcache_ql_mtx);
+	}
 
 	nstime_copy(&astats->uptime, &arena->create_time);
 	nstime_update(&astats->uptime);
 	nstime_subtract(&astats->uptime, &arena->create_time);
 
-	for (szind_t i = 0; i < SC_NBINS; i++) {
-		for (unsigned j = 0; j < bin_infos[i].n_shards; j++) {
-			bin_stats_merge(
-			    tsdn, &bstats[i], arena_get_bin(arena, i, j));
+	bool tcache = (what & ARENA_STATS_MERGE_TCACHE) != 0;
+	bool mutexes = (what & ARENA_STATS_MERGE_MUTEXES) != 0;
+	if (tcache || mutexes) {
+		malloc_mutex_lock(tsdn, &arena->tcache_ql_mtx);
+		if (tcache) {
+			arena_tcache_bytes_merge(arena, astats);
+		}
+		if (mutexes) {
+			malloc_mutex_prof_read(tsdn,
+			    &astats->mutex_prof_data
+			        [arena_prof_mutex_tcache_list],
+			    &arena->tcache_ql_mtx);
+		}
+		malloc_mutex_unlock(tsdn, &arena->tcache_ql_mtx);
+	}
+
+	if (mutexes) {
+		arena_mutex_stats_read(tsdn, arena, astats);
+	}
+
+	if ((what & ARENA_STATS_MERGE_BINS) != 0) {
+		for (szind_t i = 0; i < SC_NBINS; i++) {
+			for (unsigned j = 0; j < bin_infos[i].n_shards; j++) {
+				bin_stats_merge(tsdn, &bstats[i],
+				    arena_get_bin(arena, i, j));
+			}
 		}
 	}
 }
@@ -227,6 +336,134 @@ arena_background_thread_inactivity_check(
 	}
 }
 
+/*
+ * Objects allocated while the counters were off would break the invariants
+ * (e.g. nmalloc >= ndalloc) if they were freed after turning them back on, so
+ * once off, stats stay off.
+ */
+bool
+arena_stats_enabled_set(arena_t *arena, bool enabled) {
+	cassert(config_stats);
+	if (enabled) {
+		return !arena_stats_enabled_get(arena);
+	}
+	atomic_store_b(&arena->stats_enabled, false, ATOMIC_RELAXED);
+	return false;
+}
+
+static size_t
+arena_active_resident_range(
+    edata_t *edata, pages_range_t *ranges, size_t nranges, size_t n) {
+	if (n < nranges) {
+		ranges[n].addr = edata_base_get(edata);
+		ranges[n].size = edata_size_get(edata);
+		ranges[n].huge = false;
+	}
+	return n + 1;
+}
+
+typedef struct arena_active_resident_ranges_arg_s
+    arena_active_resident_ranges_arg_t;
+struct arena_active_resident_ranges_arg_s {
+	tsdn_t  *tsdn;
+	arena_t *arena;
+};
+
+/* See pages_ranges_copy_t. */
+static size_t
+arena_active_resident_ranges(
+    void *varg, pages_range_t *ranges, size_t nranges) {
+	arena_active_resident_ranges_arg_t *arg =
+	    (arena_active_resident_ranges_arg_t *)varg;
+	tsdn_t  *tsdn = arg->tsdn;
+	arena_t *arena = arg->arena;
+	/* See arena_bin_slabs_full_insert(). */
+	assert(!arena_is_auto(arena));
+	size_t n = 0;
+	for (unsigned i = 0; i < SC_NBINS; i++) {
+		for (unsigned j = 0; j < bin_infos[i].n_shards; j++) {
+			bin_t *bin = arena_get_bin(arena, i, j);
+			malloc_mutex_lock(tsdn, &bin->lock);
+			if (bin->slabcur != NULL) {
+				n = arena_active_resident_range(
+				    bin->slabcur, ranges, nranges, n);
+			}
+			for (edata_t *slab = edata_heap_walk_next(
+			         &bin->slabs_nonfull, NULL);
+			     slab != NULL; slab = edata_heap_walk_next(
+			                       &bin->slabs_nonfull, slab)) {
+				n = arena_active_resident_range(
+				    slab, ranges, nranges, n);
+			}
+			for (edata_t *slab = edata_list_active_first(
+			         &bin->slabs_full);
+			     slab != NULL; slab = edata_list_active_next(
+			                       &bin->slabs_full, slab)) {
+				n = arena_active_resident_range(
+				    slab, ranges, nranges, n);
+			}
+			malloc_mutex_unlock(tsdn, &bin->lock);
+		}
+	}
+	for (unsigned i = 0; i < ARENA_LARGE_NSHARDS; i++) {
+		arena_large_shard_t *shard = &arena->large[i];
+		malloc_mutex_lock(tsdn, &shard->mtx);
+		for (edata_t *edata = edata_list_active_first(&shard->list);
+		     edata != NULL;
+		     edata = edata_list_active_next(&shard->list, edata)) {
+			n = arena_active_resident_range(
+			    edata, ranges, nranges, n);
+		}
+		malloc_mutex_unlock(tsdn, &shard->mtx);
+	}
+	return n;
+}
+
+/*
+ * Asks the OS which pages of the arena's extents are resident, and stores the
+ * results in the arena stats.  Returns true if the arena was scanned too
+ * recently, or on OOM.  The extents are copied out under the arena's locks,
+ * and checked with the locks released.
+ */
+bool
+arena_resident_scan(tsdn_t *tsdn, arena_t *arena) {
+	cassert(config_stats);
+	size_t now_ms = (size_t)nstime_ms_since(&arena->create_time);
+	size_t next_ms = atomic_load_zu(
+	    &arena->resident_scan_next_ms, ATOMIC_RELAXED);
+	if (now_ms < next_ms
+	    || !atomic_compare_exchange_strong_zu(&arena->resident_scan_next_ms,
+	        &next_ms, now_ms + ARENA_RESIDENT_SCAN_INTERVAL_MS,
+	        ATOMIC_RELAXED, ATOMIC_RELAXED)) {
+		return true;
+	}
+
+	size_t resident[arena_resident_scan_nkinds] = {0};
+	if (!arena_is_auto(arena)) {
+		arena_active_resident_ranges_arg_t arg = {tsdn, arena};
+		size_t                             huge = 0;
+		if (pages_ranges_resident(arena_active_resident_ranges, &arg,
+		        &resident[arena_resident_scan_active_manual], &huge)) {
+			return true;
+		}
+	}
+	pa_resident_scan_t pa_scan = {0};
+	if (pa_shard_resident_scan(tsdn, &arena->pa_shard, &pa_scan)) {
+		return true;
+	}
+	resident[arena_resident_scan_dirty] = pa_scan.dirty;
+	resident[arena_resident_scan_muzzy] = pa_scan.muzzy;
+	resident[arena_resident_scan_retained] = pa_scan.retained;
+	resident[arena_resident_scan_hpa_nonfull] = pa_scan.hpa_nonfull;
+	resident[arena_resident_scan_hpa_nonfull_huge] =
+	    pa_scan.hpa_nonfull_huge;
+	for (unsigned i = 0; i < arena_resident_scan_nkinds; i++) {
+		atomic_store_zu(
+		    &arena->stats.resident_scan[i], resident[i], ATOMIC_RELAXED);
+	}
+	return false;
+}
+
 /*
  * React to deferred work generated by a PAI function.
  */
@@ -306,6 +543,23 @@ arena_slab_reg_alloc_batch(
 	edata_nfree_sub(slab, cnt);
 }
 
+/*
+ * Returns the calling thread's own counters for hindex in arena, or NULL if it
+ * has to update the arena's.
+ */
+static tcache_lstats_t *
+arena_large_stats_local_get(tsdn_t *tsdn, arena_t *arena, szind_t hindex) {
+	if (!OWNED_U64_SUPPORTED || tsdn_null(tsdn)
+	    || hindex >= TCACHE_LSTATS_NCLASSES) {
+		return NULL;
+	}
+	tcache_slow_t *tcache_slow = tcache_slow_get(tsdn_tsd(tsdn));
+	if (tcache_slow == NULL || tcache_slow->arena != arena) {
+		return NULL;
+	}
+	return &tcache_slow->lstats[hindex];
+}
+
 static void
 arena_large_malloc_stats_update(tsdn_t *tsdn, arena_t *arena, size_t usize) {
 	cassert(config_stats);
@@ -321,7 +575,14 @@ arena_large_malloc_stats_update(tsdn_t *tsdn, arena_t *arena, size_t usize) {
 		malloc_mutex_unlock(tsdn, &bin->lock);
 	} else {
 		assert(index >= SC_NBINS);
-		szind_t hindex = index - SC_NBINS;
+		szind_t          hindex = index - SC_NBINS;
+		tcache_lstats_t *local = arena_large_stats_local_get(
+		    tsdn, arena, hindex);
+		if (local != NULL) {
+			owned_add_u64(&local->nmalloc, 1);
+			owned_add_u64(&local->active_bytes, usize);
+			return;
+		}
 		LOCKEDINT_MTX_LOCK(tsdn, arena->stats.mtx);
 		locked_inc_u64(tsdn, LOCKEDINT_MTX(arena->stats.mtx),
 		    &arena->stats.lstats[hindex].nmalloc, 1);
@@ -346,12 +607,24 @@ arena_large_dalloc_stats_update(tsdn_t *tsdn, arena_t *arena, size_t usize) {
 		malloc_mutex_unlock(tsdn, &bin->lock);
 	} else {
 		assert(index >= SC_NBINS);
-		szind_t hindex = index - SC_NBINS;
+		szind_t          hindex = index - SC_NBINS;
+		tcache_lstats_t *local = arena_large_stats_local_get(
+		    tsdn, arena, hindex);
+		if (local != NULL) {
+			owned_add_u64(&local->ndalloc, 1);
+			owned_add_u64(&local->active_bytes, (uint64_t)0 - usize);
+			return;
+		}
 		LOCKEDINT_MTX_LOCK(tsdn, arena->stats.mtx);
 		locked_inc_u64(tsdn, LOCKEDINT_MTX(arena->stats.mtx),
 		    &arena->stats.lstats[hindex].ndalloc, 1);
-		locked_dec_u64(tsdn, LOCKEDINT_MTX(arena->stats.mtx),
-		    &arena->stats.lstats[hindex].active_bytes, usize);
+		/*
+		 * Not locked_dec_u64(): the extent may have been counted in some
+		 * thread's local stats, in which case only the sum of the two
+		 * is meaningful.
+		 */
+		locked_inc_u64(tsdn, LOCKEDINT_MTX(arena->stats.mtx),
+		    &arena->stats.lstats[hindex].active_bytes, (uint64_t)0 - usize);
 		LOCKEDINT_MTX_UNLOCK(tsdn, arena->stats.mtx);
 	}
 }
@@ -389,7 +662,7 @@ arena_extent_alloc_large(
 		return NULL;
 	}
 
-	if (config_stats) {
+	if (arena_stats_enabled_get(arena)) {
 		arena_large_malloc_stats_update(tsdn, arena, usize);
 	}
 	if (sz_large_pad != 0) {
@@ -411,7 +684,7 @@ arena_extent_alloc_large(
 
 void
 arena_extent_dalloc_large_prep(tsdn_t *tsdn, arena_t *arena, edata_t *edata) {
-	if (config_stats) {
+	if (arena_stats_enabled_get(arena)) {
 		arena_large_dalloc_stats_update(
 		    tsdn, arena, edata_usize_get(edata));
 	}
@@ -422,7 +695,7 @@ arena_extent_ralloc_large_shrink(
     tsdn_t *tsdn, arena_t *arena, edata_t *edata, size_t oldusize) {
 	size_t usize = edata_usize_get(edata);
 
-	if (config_stats) {
+	if (arena_stats_enabled_get(arena)) {
 		arena_large_ralloc_stats_update(tsdn, arena, oldusize, usize);
 	}
 }
@@ -432,7 +705,7 @@ arena_extent_ralloc_large_expand(
     tsdn_t *tsdn, arena_t *arena, edata_t *edata, size_t oldusize) {
 	size_t usize = edata_usize_get(edata);
 
-	if (config_stats) {
+	if (arena_stats_enabled_get(arena)) {
 		arena_large_ralloc_stats_update(tsdn, arena, oldusize, usize);
 	}
 }
@@ -530,6 +803,8 @@ arena_decay(tsdn_t *tsdn, arena_t *arena, bool is_background_thread, bool all) {
 		 * like thread death, or manual purge calls).
 		 */
 		pa_shard_flush(tsdn, &arena->pa_shard);
+	} else {
+		pa_shard_lec_gc(tsdn, &arena->pa_shard);
 	}
 	if (arena_decay_dirty(tsdn, arena, is_background_thread, all)) {
 		return;
@@ -779,31 +1054,15 @@ arena_dalloc_promoted(
 	arena_dalloc_promoted_impl(tsdn, ptr, tcache, slow_path, edata);
 }
 
-void
-arena_reset(tsd_t *tsd, arena_t *arena) {
-	/*
-	 * Locking in this function is unintuitive.  The caller guarantees that
-	 * no concurrent operations are happening in this arena, but there are
-	 * still reasons that some locking is necessary:
-	 *
-	 * - Some of the functions in the transitive closure of calls assume
-	 *   appropriate locks are held, and in some cases these locks are
-	 *   temporarily dropped to avoid lock order reversal or deadlock due to
-	 *   reentry.
-	 * - mallctl("epoch", ...) may concurrently refresh stats.  While
-	 *   strictly speaking this is a "concurrent operation", disallowing
-	 *   stats refreshes would impose an inconvenient burden.
-	 */
-
-	/* Large allocations. */
-	malloc_mutex_lock(tsd_tsdn(tsd), &arena->large_mtx);
-
-	for (edata_t *edata = edata_list_active_first(&arena->large);
-	    edata != NULL; edata = edata_list_active_first(&arena->large)) {
+static void
+arena_large_reset(tsd_t *tsd, arena_t *arena, arena_large_shard_t *shard) {
+	malloc_mutex_lock(tsd_tsdn(tsd), &shard->mtx);
+	for (edata_t *edata = edata_list_active_first(&shard->list);
+	    edata != NULL; edata = edata_list_active_first(&shard->list)) {
 		void  *ptr = edata_base_get(edata);
 		size_t usize;
 
-		malloc_mutex_unlock(tsd_tsdn(tsd), &arena->large_mtx);
+		malloc_mutex_unlock(tsd_tsdn(tsd), &shard->mtx);
 		emap_alloc_ctx_t alloc_ctx;
 		emap_alloc_ctx_lookup(
 		    tsd_tsdn(tsd), &arena_emap_global, ptr, &alloc_ctx);
@@ -823,9 +1082,37 @@ arena_reset(tsd_t *tsd, arena_t *arena) {
 		} else {
 			large_dalloc(tsd_tsdn(tsd), edata);
 		}
-		malloc_mutex_lock(tsd_tsdn(tsd), &arena->large_mtx);
+		malloc_mutex_lock(tsd_tsdn(tsd), &shard->mtx);
+	}
+	malloc_mutex_unlock(tsd_tsdn(tsd), &shard->mtx);
+}
+
+void
+arena_reset(tsd_t *tsd, arena_t *arena) {
+	/*
+	 * Locking in this function is unintuitive.  The caller guarantees that
+	 * no concurrent operations are happening in this arena, but there are
+	 * still reasons that some locking is necessary:
+	 *
+	 * - Some of the functions in the transitive closure of calls assume
+	 *   appropriate locks are held, and in some cases these locks are
+	 *   temporarily dropped to avoid lock order reversal or deadlock due to
+	 *   reentry.
+	 * - mallctl("epoch", ...) may concurrently refresh stats.  While
+	 *   strictly speaking this is a "concurrent operation", disallowing
+	 *   stats refreshes would impose an inconvenient burden.
+	 */
+
+	/*
+	 * Pooled tcaches of exited threads may still cache regions of this
+	 * arena, and nobody else can flush those.
+	 */
+	tcache_pool_flush(tsd);
+
+	/* Large allocations. */
+	for (unsigned i = 0; i < ARENA_LARGE_NSHARDS; i++) {
+		arena_large_reset(tsd, arena, &arena->large[i]);
 	}
-	malloc_mutex_unlock(tsd_tsdn(tsd), &arena->large_mtx);
 
 	/* Bins. */
 	for (unsigned i = 0; i < SC_NBINS; i++) {
@@ -1147,10 +1434,12 @@ label_refill:
 	} /* while (filled < nfill_min) loop. */
 
 	if (config_stats && !alloc_and_retry) {
-		bin->stats.nmalloc += filled;
-		bin->stats.nrequests += merge_stats.nrequests;
+		if (arena_stats_enabled_get(arena)) {
+			bin->stats.nmalloc += filled;
+			bin->stats.nrequests += merge_stats.nrequests;
+			bin->stats.nfills++;
+		}
 		bin->stats.curregs += filled;
-		bin->stats.nfills++;
 	}
 
 	malloc_mutex_unlock(tsdn, &bin->lock);
@@ -1242,8 +1531,10 @@ arena_fill_small_fresh(tsdn_t *tsdn, arena_t *arena, szind_t binind,
 	if (config_stats) {
 		bin->stats.nslabs += nslab;
 		bin->stats.curslabs += nslab;
-		bin->stats.nmalloc += filled;
-		bin->stats.nrequests += filled;
+		if (arena_stats_enabled_get(arena)) {
+			bin->stats.nmalloc += filled;
+			bin->stats.nrequests += filled;
+		}
 		bin->stats.curregs += filled;
 	}
 	malloc_mutex_unlock(tsdn, &bin->lock);
@@ -1302,8 +1593,10 @@ arena_malloc_small(tsdn_t *tsdn, arena_t *arena, szind_t binind, bool zero) {
 		}
 	}
 	if (config_stats) {
-		bin->stats.nmalloc++;
-		bin->stats.nrequests++;
+		if (arena_stats_enabled_get(arena)) {
+			bin->stats.nmalloc++;
+			bin->stats.nrequests++;
+		}
 		bin->stats.curregs++;
 	}
 	malloc_mutex_unlock(tsdn, &bin->lock);
@@ -1651,25 +1944,12 @@ arena_ptr_array_flush_impl_large(tsdn_t *tsdn, szind_t binind,
     cache_bin_ptr_array_t *arr, emap_batch_lookup_result_t *item_edata,
     cache_bin_sz_t nflush, arena_t *stats_arena,
     cache_bin_stats_t **merge_stats) {
-	/*
-	 * We're about to grab a bunch of locks.  If one of them happens to be
-	 * the one guarding the arena-level stats counters we flush our
-	 * thread-local ones to, we do so under one critical section.
-	 */
 	while (nflush > 0) {
-		/* Lock the arena, or bin, associated with the first object. */
+		/* Handle the arena associated with the first object. */
 		edata_t *edata = item_edata[0].edata;
 		unsigned cur_arena_ind = edata_arena_ind_get(edata);
 		arena_t *cur_arena = arena_get(tsdn, cur_arena_ind, false);
 
-		if (!arena_is_auto(cur_arena)) {
-			malloc_mutex_lock(tsdn, &cur_arena->large_mtx);
-		}
-
-		/*
-		 * If we acquired the right lock and have some stats to flush,
-		 * flush them.
-		 */
 		if (config_stats && stats_arena == cur_arena
 		    && *merge_stats != NULL) {
 			arena_stats_large_flush_nrequests_add(tsdn,
@@ -1679,8 +1959,8 @@ arena_ptr_array_flush_impl_large(tsdn_t *tsdn, szind_t binind,
 		}
 
 		/*
-		 * Large allocations need special prep done.  Afterwards, we can
-		 * drop the large lock.
+		 * Large allocations need special prep done.  For manual arenas
+		 * this takes the lock of each extent's large shard in turn.
 		 */
 		for (unsigned i = 0; i < nflush; i++) {
 			void *ptr = arr->ptr[i];
@@ -1688,12 +1968,9 @@ arena_ptr_array_flush_impl_large(tsdn_t *tsdn, szind_t binind,
 			assert(ptr != NULL && edata != NULL);
 
 			if (edata_arena_ind_get(edata) == cur_arena_ind) {
-				large_dalloc_prep_locked(tsdn, edata);
+				large_dalloc_prep(tsdn, edata);
 			}
 		}
-		if (!arena_is_auto(cur_arena)) {
-			malloc_mutex_unlock(tsdn, &cur_arena->large_mtx);
-		}
 
 		/* Deallocate whatever we can. */
 		unsigned ndeferred = 0;
@@ -1795,9 +2072,14 @@ arena_ptr_array_flush(tsd_t *tsd, szind_t binind, cache_bin_ptr_array_t *arr,
      * This separation ensures that each layer operates independently and
      * does not modify another layer's data directly.
      */
-	cache_bin_stats_t    *stats = &merge_stats;
+	/* Nothing to merge into when the arena doesn't keep stats. */
+	cache_bin_stats_t    *stats = arena_stats_enabled_get(stats_arena)
+	       ? &merge_stats
+	       : NULL;
 	unsigned              nflush_batch, nflushed = 0;
 	cache_bin_ptr_array_t ptrs_batch;
+	latency_timer_t       timer;
+	latency_timer_start(tsd_tsdn(tsd), &timer, latency_site_tcache_flush);
 	do {
 		nflush_batch = nflush - nflushed;
 		if (nflush_batch > CACHE_BIN_NFLUSH_BATCH_MAX) {
@@ -1812,8 +2094,11 @@ arena_ptr_array_flush(tsd_t *tsd, szind_t binind, cache_bin_ptr_array_t *arr,
 	} while (nflushed < nflush);
 	assert(nflush == nflushed);
 	assert((arr->ptr + nflush) == ((&ptrs_batch)->ptr + nflush_batch));
-	if (config_stats) {
-		assert(stats == NULL);
+	assert(stats == NULL);
+	if (stats_arena != NULL) {
+		latency_timer_stop(tsd_tsdn(tsd), &timer,
+		    &stats_arena->stats.latency,
+		    LOCKEDINT_MTX(stats_arena->stats.mtx));
 	}
 }
 
@@ -2072,6 +2357,9 @@ arena_new(tsdn_t *tsdn, unsigned ind, const arena_config_t *config) {
 			goto label_error;
 		}
 
+		atomic_store_b(&arena->stats_enabled, opt_arena_stats_enabled,
+		    ATOMIC_RELAXED);
+		atomic_store_zu(&arena->resident_scan_next_ms, 0, ATOMIC_RELAXED);
 		ql_new(&arena->tcache_ql);
 		ql_new(&arena->cache_bin_array_descriptor_ql);
 		if (malloc_mutex_init(&arena->tcache_ql_mtx, "tcache_ql",
@@ -2083,17 +2371,20 @@ arena_new(tsdn_t *tsdn, unsigned ind, const arena_config_t *config) {
 	atomic_store_u(
 	    &arena->dss_prec, (unsigned)extent_dss_prec_get(), ATOMIC_RELAXED);
 
-	edata_list_active_init(&arena->large);
-	if (malloc_mutex_init(&arena->large_mtx, "arena_large",
-	        WITNESS_RANK_ARENA_LARGE, malloc_mutex_rank_exclusive)) {
-		goto label_error;
+	for (unsigned i = 0; i < ARENA_LARGE_NSHARDS; i++) {
+		edata_list_active_init(&arena->large[i].list);
+		if (malloc_mutex_init(&arena->large[i].mtx, "arena_large",
+		        WITNESS_RANK_ARENA_LARGE, malloc_mutex_rank_exclusive)) {
+			goto label_error;
+		}
 	}
 
 	nstime_t cur_time;
 	nstime_init_update(&cur_time);
 	if (pa_shard_init(tsdn, &arena->pa_shard, &arena_pa_central_global,
 	        &arena_emap_global, base, ind, &arena->stats.pa_shard_stats,
-	        LOCKEDINT_MTX(arena->stats.mtx), &cur_time, oversize_threshold,
+	        &arena->stats.latency, LOCKEDINT_MTX(arena->stats.mtx),
+	        &cur_time, oversize_threshold,
 	        arena_dirty_decay_ms_default_get(),
 	        arena_muzzy_decay_ms_default_get())) {
 		goto label_error;
@@ -2137,6 +2428,12 @@ arena_new(tsdn_t *tsdn, unsigned ind, const arena_config_t *config) {
 		}
 	}
 
+	if (opt_lec_max_bytes != 0
+	    && pa_shard_enable_lec(tsdn, &arena->pa_shard, opt_lec_max_bytes,
+	        opt_lec_max_alloc)) {
+		goto label_error;
+	}
+
 	/* We don't support reentrancy for arena 0 bootstrapping. */
 	if (ind != 0) {
 		/*
@@ -2310,7 +2607,9 @@ arena_prefork6(tsdn_t *tsdn, arena_t *arena) {
 
 void
 arena_prefork7(tsdn_t *tsdn, arena_t *arena) {
-	malloc_mutex_prefork(tsdn, &arena->large_mtx);
+	for (unsigned i = 0; i < ARENA_LARGE_NSHARDS; i++) {
+		malloc_mutex_prefork(tsdn, &arena->large[i].mtx);
+	}
 }
 
 void
@@ -2328,7 +2627,9 @@ arena_postfork_parent(tsdn_t *tsdn, arena_t *arena) {
 		    bin_postfork_parent(tsdn, &arena->all_bins[i]);)
 	}
 
-	malloc_mutex_postfork_parent(tsdn, &arena->large_mtx);
+	for (unsigned i = 0; i < ARENA_LARGE_NSHARDS; i++) {
+		malloc_mutex_postfork_parent(tsdn, &arena->large[i].mtx);
+	}
 	base_postfork_parent(tsdn, arena->base);
 	pa_shard_postfork_parent(tsdn, &arena->pa_shard);
 	if (config_stats) {
@@ -2347,6 +2648,14 @@ arena_postfork_child(tsdn_t *tsdn, arena_t *arena) {
 		arena_nthreads_inc(arena, true);
 	}
 	if (config_stats) {
+		/*
+		 * The other threads are gone, but their extents aren't; keep
+		 * their counts.
+		 */
+		tcache_slow_t *iter;
+		ql_foreach (iter, &arena->tcache_ql, link) {
+			arena_large_stats_tcache_flush(tsdn, arena, iter);
+		}
 		ql_new(&arena->tcache_ql);
 		ql_new(&arena->cache_bin_array_descriptor_ql);
 		tcache_slow_t *tcache_slow = tcache_slow_get(tsdn_tsd(tsdn));
@@ -2367,7 +2676,9 @@ arena_postfork_child(tsdn_t *tsdn, arena_t *arena) {
 		    bin_postfork_child(tsdn, &arena->all_bins[i]);)
 	}
 
-	malloc_mutex_postfork_child(tsdn, &arena->large_mtx);
+	for (unsigned i = 0; i < ARENA_LARGE_NSHARDS; i++) {
+		malloc_mutex_postfork_child(tsdn, &arena->large[i].mtx);
+	}
 	base_postfork_child(tsdn, arena->base);
 	pa_shard_postfork_child(tsdn, &arena->pa_shard);
 	if (config_stats) {
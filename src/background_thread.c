@@ -2,6 +2,7 @@
 #include "jemalloc/internal/jemalloc_internal_includes.h"
 
 #include "jemalloc/internal/assert.h"
+#include "jemalloc/internal/prof_log.h"
 
 JEMALLOC_DIAGNOSTIC_DISABLE_SPURIOUS
 
@@ -161,6 +162,26 @@ set_current_thread_affinity(int cpu) {
 /* Minimal sleep interval 100 ms. */
 #	define BACKGROUND_THREAD_MIN_INTERVAL_NS (BILLION / 10)
 
+static bool
+background_thread_cond_init(background_thread_info_t *info) {
+#	ifdef JEMALLOC_FUTEX_MUTEX
+	atomic_store_u32(&info->cond, 0, ATOMIC_RELAXED);
+	return false;
+#	else
+	return pthread_cond_init(&info->cond, NULL) != 0;
+#	endif
+}
+
+static void
+background_thread_cond_signal(background_thread_info_t *info) {
+#	ifdef JEMALLOC_FUTEX_MUTEX
+	atomic_fetch_add_u32(&info->cond, 1, ATOMIC_RELEASE);
+	malloc_futex_wake(&info->cond, 1);
+#	else
+	pthread_cond_signal(&info->cond);
+#	endif
+}
+
 static int
 background_thread_cond_wait(
     background_thread_info_t *info, struct timespec *ts) {
@@ -171,11 +192,26 @@ background_thread_cond_wait(
 	 * going through our wrapper.  Update the locked state explicitly.
 	 */
 	atomic_store_b(&info->mtx.locked, false, ATOMIC_RELAXED);
+#	ifdef JEMALLOC_FUTEX_MUTEX
+	/*
+	 * Signals bump the sequence number, so that one sent after we read it
+	 * makes the futex wait return right away.  Like pthread_cond_wait, we
+	 * may wake up spuriously.
+	 */
+	uint32_t seq = atomic_load_u32(&info->cond, ATOMIC_ACQUIRE);
+	malloc_futex_unlock(&info->mtx.lock);
+	ret = malloc_futex_wait(&info->cond, seq, ts);
+	if (ret != ETIMEDOUT) {
+		ret = 0;
+	}
+	malloc_futex_lock(&info->mtx.lock);
+#	else
 	if (ts == NULL) {
 		ret = pthread_cond_wait(&info->cond, &info->mtx.lock);
 	} else {
 		ret = pthread_cond_timedwait(&info->cond, &info->mtx.lock, ts);
 	}
+#	endif
 	atomic_store_b(&info->mtx.locked, true, ATOMIC_RELAXED);
 
 	return ret;
@@ -269,6 +305,7 @@ background_work_sleep_once(
 		if (!slept_indefinitely) {
 			arena_do_deferred_work(tsdn, arena);
 		}
+		tcache_idle_reclaim(tsdn_tsd(tsdn), arena);
 		if (ns_until_deferred <= BACKGROUND_THREAD_MIN_INTERVAL_NS) {
 			/* Min interval will be used. */
 			continue;
@@ -280,6 +317,20 @@ background_work_sleep_once(
 		}
 	}
 
+	/* Come back in time to check for idle tcaches. */
+	uint64_t ns_tcache_reclaim = tcache_idle_reclaim_interval_ns();
+	if (ns_tcache_reclaim < ns_until_deferred) {
+		ns_until_deferred = ns_tcache_reclaim;
+	}
+
+	/* And, on thread 0, for deferred heap profile dumps. */
+	if (config_prof && opt_prof && ind == 0) {
+		uint64_t ns_prof_dump = prof_bg_dump_ns_until();
+		if (ns_prof_dump < ns_until_deferred) {
+			ns_until_deferred = ns_prof_dump;
+		}
+	}
+
 	uint64_t sleep_ns;
 	if (ns_until_deferred == BACKGROUND_THREAD_DEFERRED_MAX) {
 		sleep_ns = BACKGROUND_THREAD_INDEFINITE_SLEEP;
@@ -310,7 +361,7 @@ background_threads_disable_single(tsd_t *tsd, background_thread_info_t *info) {
 	if (info->state == background_thread_started) {
 		has_thread = true;
 		info->state = background_thread_stopped;
-		pthread_cond_signal(&info->cond);
+		background_thread_cond_signal(info);
 	} else {
 		has_thread = false;
 	}
@@ -422,6 +473,38 @@ check_background_thread_creation(tsd_t *tsd,
 	return ret;
 }
 
+/*
+ * Runs the heap profile dumps deferred to thread 0, if any are due, and writes
+ * out the binary profiling log.  These can't hold info->mtx (which ranks after
+ * the profiling locks), and the state may change while it is dropped, so
+ * returns true when the caller has to check again.
+ */
+static bool
+background_thread0_prof_dump(tsd_t *tsd) {
+	if (!config_prof || !opt_prof) {
+		return false;
+	}
+	/*
+	 * Triggers that fail to wake us up from here on are picked up when
+	 * computing how long to sleep.
+	 */
+	prof_bg_thread0_wakeup_clear();
+	bool dump = prof_bg_dump_ns_until() == 0;
+	bool log_flush = prof_log_flush_pending();
+	if (!dump && !log_flush) {
+		return false;
+	}
+	malloc_mutex_unlock(tsd_tsdn(tsd), &background_thread_info[0].mtx);
+	if (dump) {
+		prof_bg_dump(tsd);
+	}
+	if (log_flush) {
+		prof_log_flush(tsd_tsdn(tsd));
+	}
+	malloc_mutex_lock(tsd_tsdn(tsd), &background_thread_info[0].mtx);
+	return true;
+}
+
 static void
 background_thread0_work(tsd_t *tsd) {
 	/*
@@ -451,6 +534,9 @@ background_thread0_work(tsd_t *tsd) {
 		        created_threads)) {
 			continue;
 		}
+		if (background_thread0_prof_dump(tsd)) {
+			continue;
+		}
 		background_work_sleep_once(
 		    tsd_tsdn(tsd), &background_thread_info[0], 0);
 	}
@@ -561,7 +647,7 @@ background_thread_create_locked(tsd_t *tsd, unsigned arena_ind) {
 		background_thread_info_t *t0 = &background_thread_info[0];
 		malloc_mutex_lock(tsd_tsdn(tsd), &t0->mtx);
 		assert(t0->state == background_thread_started);
-		pthread_cond_signal(&t0->cond);
+		background_thread_cond_signal(t0);
 		malloc_mutex_unlock(tsd_tsdn(tsd), &t0->mtx);
 
 		return false;
@@ -693,7 +779,7 @@ background_thread_wakeup_early(
 	    && nstime_ns(remaining_sleep) < BACKGROUND_THREAD_MIN_INTERVAL_NS) {
 		return;
 	}
-	pthread_cond_signal(&info->cond);
+	background_thread_cond_signal(info);
 }
 
 void
@@ -737,8 +823,8 @@ background_thread_postfork_child(tsdn_t *tsdn) {
 		background_thread_info_t *info = &background_thread_info[i];
 		malloc_mutex_lock(tsdn, &info->mtx);
 		info->state = background_thread_stopped;
-		int ret = pthread_cond_init(&info->cond, NULL);
-		assert(ret == 0);
+		bool err = background_thread_cond_init(info);
+		assert(!err);
 		background_thread_info_init(tsdn, info);
 		malloc_mutex_unlock(tsdn, &info->mtx);
 	}
@@ -855,7 +941,7 @@ background_thread_boot1(tsdn_t *tsdn, base_t *base) {
 		        malloc_mutex_address_ordered)) {
 			return true;
 		}
-		if (pthread_cond_init(&info->cond, NULL)) {
+		if (background_thread_cond_init(info)) {
 			return true;
 		}
 		malloc_mutex_lock(tsdn, &info->mtx);
@@ -1,17 +1,21 @@
 #include "jemalloc/internal/jemalloc_preamble.h"
 #include "jemalloc/internal/jemalloc_internal_includes.h"
 
+#include "jemalloc/internal/alloc_tag.h"
 #include "jemalloc/internal/assert.h"
 #include "jemalloc/internal/ctl.h"
 #include "jemalloc/internal/extent_dss.h"
 #include "jemalloc/internal/extent_mmap.h"
+#include "jemalloc/internal/hash.h"
 #include "jemalloc/internal/inspect.h"
 #include "jemalloc/internal/mutex.h"
 #include "jemalloc/internal/nstime.h"
 #include "jemalloc/internal/peak_event.h"
+#include "jemalloc/internal/prof_contention.h"
 #include "jemalloc/internal/prof_data.h"
 #include "jemalloc/internal/prof_log.h"
 #include "jemalloc/internal/prof_recent.h"
+#include "jemalloc/internal/prof_snapshot.h"
 #include "jemalloc/internal/prof_stats.h"
 #include "jemalloc/internal/prof_sys.h"
 #include "jemalloc/internal/safety_check.h"
@@ -30,6 +34,35 @@ static bool           ctl_initialized;
 static ctl_stats_t   *ctl_stats;
 static ctl_arenas_t  *ctl_arenas;
 
+/*
+ * The thread running experimental.batch_read, which holds ctl_mtx across all
+ * the reads of the batch; see ctl_mtx_lock() and ctl_batch_readable().
+ */
+static atomic_p_t ctl_batch_owner;
+
+/*
+ * Cache of complete name -> MIB translations, to spare repeated by-name
+ * lookups the string comparisons along the path through the tree.  Slots are
+ * filled at most once and never freed, so readers need no locking.  Names of
+ * indexed nodes are cached as well; since the validity of an index can change
+ * (e.g. stats.arenas.<i> of a destroyed arena), cached MIBs are still
+ * validated through ctl_lookupbymib().
+ */
+#define CTL_NAME_CACHE_LG_SIZE 10
+#define CTL_NAME_CACHE_SIZE (ZU(1) << CTL_NAME_CACHE_LG_SIZE)
+/* Number of slots probed, starting from the hashed one. */
+#define CTL_NAME_CACHE_NPROBES 4
+/* Longer names are never cached. */
+#define CTL_NAME_CACHE_NAME_MAX 64
+
+typedef struct ctl_name_cache_elm_s ctl_name_cache_elm_t;
+struct ctl_name_cache_elm_s {
+	size_t miblen;
+	size_t mib[CTL_MAX_DEPTH];
+	char   name[CTL_NAME_CACHE_NAME_MAX];
+};
+static atomic_p_t ctl_name_cache[CTL_NAME_CACHE_SIZE];
+
 /******************************************************************************/
 /* Helpers for named and indexed nodes. */
 
@@ -50,6 +83,33 @@ ctl_indexed_node(const ctl_node_t *node) {
 	return (!node->named ? (const ctl_indexed_node_t *)node : NULL);
 }
 
+/*
+ * Wrappers for locking ctl_mtx, which is already held (for the whole batch) by
+ * a thread running experimental.batch_read.  Only the read handlers the batch
+ * may call (see ctl_batch_readable()) use them; everything else takes ctl_mtx
+ * directly.
+ */
+static bool
+ctl_mtx_batch_owned(tsdn_t *tsdn) {
+	return !tsdn_null(tsdn)
+	    && atomic_load_p(&ctl_batch_owner, ATOMIC_RELAXED)
+	    == (void *)tsdn_tsd(tsdn);
+}
+
+static void
+ctl_mtx_lock(tsdn_t *tsdn) {
+	if (!ctl_mtx_batch_owned(tsdn)) {
+		malloc_mutex_lock(tsdn, &ctl_mtx);
+	}
+}
+
+static void
+ctl_mtx_unlock(tsdn_t *tsdn) {
+	if (!ctl_mtx_batch_owned(tsdn)) {
+		malloc_mutex_unlock(tsdn, &ctl_mtx);
+	}
+}
+
 /******************************************************************************/
 /* Function prototypes for non-inline static functions. */
 
@@ -67,6 +127,7 @@ CTL_PROTO(background_thread)
 CTL_PROTO(max_background_threads)
 CTL_PROTO(thread_tcache_enabled)
 CTL_PROTO(thread_tcache_max)
+CTL_PROTO(thread_tcache_bytes_budget)
 CTL_PROTO(thread_tcache_flush)
 CTL_PROTO(thread_tcache_ncached_max_write)
 CTL_PROTO(thread_tcache_ncached_max_read_sizeclass)
@@ -80,6 +141,7 @@ CTL_PROTO(thread_allocatedp)
 CTL_PROTO(thread_deallocated)
 CTL_PROTO(thread_deallocatedp)
 CTL_PROTO(thread_idle)
+CTL_PROTO(thread_tag)
 CTL_PROTO(config_cache_oblivious)
 CTL_PROTO(config_debug)
 CTL_PROTO(config_fill)
@@ -123,6 +185,8 @@ CTL_PROTO(opt_dss)
 CTL_PROTO(opt_narenas)
 CTL_PROTO(opt_percpu_arena)
 CTL_PROTO(opt_oversize_threshold)
+CTL_PROTO(opt_lec_max_bytes)
+CTL_PROTO(opt_lec_max_alloc)
 CTL_PROTO(opt_background_thread)
 CTL_PROTO(opt_mutex_max_spin)
 CTL_PROTO(opt_max_background_threads)
@@ -132,6 +196,8 @@ CTL_PROTO(opt_stats_print)
 CTL_PROTO(opt_stats_print_opts)
 CTL_PROTO(opt_stats_interval)
 CTL_PROTO(opt_stats_interval_opts)
+CTL_PROTO(opt_stats_latency_sample)
+CTL_PROTO(opt_arena_stats_enabled)
 CTL_PROTO(opt_junk)
 CTL_PROTO(opt_zero)
 CTL_PROTO(opt_utrace)
@@ -146,6 +212,10 @@ CTL_PROTO(opt_tcache_nslots_large)
 CTL_PROTO(opt_lg_tcache_nslots_mul)
 CTL_PROTO(opt_tcache_gc_incr_bytes)
 CTL_PROTO(opt_tcache_gc_delay_bytes)
+CTL_PROTO(opt_tcache_bytes_budget)
+CTL_PROTO(opt_tcache_idle_reclaim_ms)
+CTL_PROTO(opt_tcache_pool_max)
+CTL_PROTO(opt_tcache_pool_keep_cached)
 CTL_PROTO(opt_lg_tcache_flush_small_div)
 CTL_PROTO(opt_lg_tcache_flush_large_div)
 CTL_PROTO(opt_thp)
@@ -156,6 +226,7 @@ CTL_PROTO(opt_prof_active)
 CTL_PROTO(opt_prof_thread_active_init)
 CTL_PROTO(opt_prof_bt_max)
 CTL_PROTO(opt_lg_prof_sample)
+CTL_PROTO(opt_prof_overhead_ppm)
 CTL_PROTO(opt_experimental_lg_prof_threshold)
 CTL_PROTO(opt_lg_prof_interval)
 CTL_PROTO(opt_prof_gdump)
@@ -163,9 +234,15 @@ CTL_PROTO(opt_prof_final)
 CTL_PROTO(opt_prof_leak)
 CTL_PROTO(opt_prof_leak_error)
 CTL_PROTO(opt_prof_accum)
+CTL_PROTO(opt_prof_lifetime)
 CTL_PROTO(opt_prof_pid_namespace)
 CTL_PROTO(opt_prof_recent_alloc_max)
 CTL_PROTO(opt_prof_stats)
+CTL_PROTO(opt_prof_callsite)
+CTL_PROTO(opt_prof_pprof)
+CTL_PROTO(opt_prof_bg_dump_ms)
+CTL_PROTO(opt_prof_contention)
+CTL_PROTO(opt_lg_prof_contention_sample)
 CTL_PROTO(opt_prof_sys_thread_name)
 CTL_PROTO(opt_prof_time_res)
 CTL_PROTO(opt_lg_san_uaf_align)
@@ -191,6 +268,9 @@ CTL_PROTO(arena_i_muzzy_decay_ms)
 CTL_PROTO(arena_i_extent_hooks)
 CTL_PROTO(arena_i_retain_grow_limit)
 CTL_PROTO(arena_i_name)
+CTL_PROTO(arena_i_stats_refresh)
+CTL_PROTO(arena_i_stats_enabled)
+CTL_PROTO(arena_i_resident_scan)
 INDEX_PROTO(arena_i)
 CTL_PROTO(arenas_bin_i_size)
 CTL_PROTO(arenas_bin_i_nregs)
@@ -199,6 +279,8 @@ CTL_PROTO(arenas_bin_i_nshards)
 INDEX_PROTO(arenas_bin_i)
 CTL_PROTO(arenas_lextent_i_size)
 INDEX_PROTO(arenas_lextent_i)
+CTL_PROTO(arenas_latency_bucket_i_lower_ns)
+INDEX_PROTO(arenas_latency_bucket_i)
 CTL_PROTO(arenas_narenas)
 CTL_PROTO(arenas_dirty_decay_ms)
 CTL_PROTO(arenas_muzzy_decay_ms)
@@ -209,6 +291,7 @@ CTL_PROTO(arenas_tcache_max)
 CTL_PROTO(arenas_nbins)
 CTL_PROTO(arenas_nhbins)
 CTL_PROTO(arenas_nlextents)
+CTL_PROTO(arenas_nlatency_buckets)
 CTL_PROTO(arenas_create)
 CTL_PROTO(arenas_lookup)
 CTL_PROTO(prof_thread_active_init)
@@ -219,8 +302,13 @@ CTL_PROTO(prof_prefix)
 CTL_PROTO(prof_reset)
 CTL_PROTO(prof_interval)
 CTL_PROTO(lg_prof_sample)
+CTL_PROTO(prof_lg_sample_effective)
 CTL_PROTO(prof_log_start)
 CTL_PROTO(prof_log_stop)
+CTL_PROTO(prof_contention_dump)
+CTL_PROTO(prof_contention_reset)
+CTL_PROTO(prof_snapshot)
+CTL_PROTO(prof_diff)
 CTL_PROTO(prof_stats_bins_i_live)
 CTL_PROTO(prof_stats_bins_i_accum)
 INDEX_PROTO(prof_stats_bins_i)
@@ -336,7 +424,24 @@ CTL_PROTO(stats_arenas_i_metadata_thp)
 CTL_PROTO(stats_arenas_i_tcache_bytes)
 CTL_PROTO(stats_arenas_i_tcache_stashed_bytes)
 CTL_PROTO(stats_arenas_i_resident)
+CTL_PROTO(stats_arenas_i_resident_scan_active_manual)
+CTL_PROTO(stats_arenas_i_resident_scan_dirty)
+CTL_PROTO(stats_arenas_i_resident_scan_muzzy)
+CTL_PROTO(stats_arenas_i_resident_scan_retained)
+CTL_PROTO(stats_arenas_i_resident_scan_hpa_nonfull)
+CTL_PROTO(stats_arenas_i_resident_scan_hpa_nonfull_huge)
 CTL_PROTO(stats_arenas_i_abandoned_vm)
+CTL_PROTO(stats_arenas_i_lec_bytes)
+CTL_PROTO(stats_arenas_i_lec_hits)
+CTL_PROTO(stats_arenas_i_lec_misses)
+CTL_PROTO(stats_arenas_i_lec_evictions)
+CTL_PROTO(stats_arenas_i_latency_site_count)
+CTL_PROTO(stats_arenas_i_latency_site_total_ns)
+CTL_PROTO(stats_arenas_i_latency_site_p50_ns)
+CTL_PROTO(stats_arenas_i_latency_site_p99_ns)
+CTL_PROTO(stats_arenas_i_latency_site_p999_ns)
+CTL_PROTO(stats_arenas_i_latency_site_buckets_j)
+INDEX_PROTO(stats_arenas_i_latency_site_buckets_j)
 CTL_PROTO(stats_arenas_i_hpa_sec_bytes)
 CTL_PROTO(stats_arenas_i_hpa_sec_hits)
 CTL_PROTO(stats_arenas_i_hpa_sec_misses)
@@ -357,6 +462,14 @@ CTL_PROTO(stats_resident)
 CTL_PROTO(stats_mapped)
 CTL_PROTO(stats_retained)
 CTL_PROTO(stats_zero_reallocs)
+CTL_PROTO(stats_tags_i_allocated)
+CTL_PROTO(stats_tags_i_deallocated)
+CTL_PROTO(stats_tags_i_live)
+INDEX_PROTO(stats_tags_i)
+CTL_PROTO(stats_prof_callsites_i_addr)
+CTL_PROTO(stats_prof_callsites_i_count)
+CTL_PROTO(stats_prof_callsites_i_bytes)
+INDEX_PROTO(stats_prof_callsites_i)
 CTL_PROTO(approximate_stats_active)
 CTL_PROTO(experimental_hooks_install)
 CTL_PROTO(experimental_hooks_remove)
@@ -375,6 +488,7 @@ INDEX_PROTO(experimental_arenas_i)
 CTL_PROTO(experimental_prof_recent_alloc_max)
 CTL_PROTO(experimental_prof_recent_alloc_dump)
 CTL_PROTO(experimental_batch_alloc)
+CTL_PROTO(experimental_batch_read)
 CTL_PROTO(experimental_arenas_create_ext)
 
 #define MUTEX_STATS_CTL_PROTO_GEN(n)                                           \
@@ -400,6 +514,11 @@ MUTEX_PROF_ARENA_MUTEXES
 MUTEX_STATS_CTL_PROTO_GEN(arenas_i_bins_j_mutex)
 #undef MUTEX_STATS_CTL_PROTO_GEN
 
+CTL_PROTO(stats_mutexes_wait_hist_j)
+INDEX_PROTO(stats_mutexes_wait_hist_j)
+CTL_PROTO(stats_arenas_i_mutexes_wait_hist_j)
+INDEX_PROTO(stats_arenas_i_mutexes_wait_hist_j)
+
 CTL_PROTO(stats_mutexes_reset)
 
 /******************************************************************************/
@@ -424,6 +543,7 @@ static const ctl_named_node_t thread_tcache_ncached_max_node[] = {
 static const ctl_named_node_t thread_tcache_node[] = {
     {NAME("enabled"), CTL(thread_tcache_enabled)},
     {NAME("max"), CTL(thread_tcache_max)},
+    {NAME("bytes_budget"), CTL(thread_tcache_bytes_budget)},
     {NAME("flush"), CTL(thread_tcache_flush)},
     {NAME("ncached_max"), CHILD(named, thread_tcache_ncached_max)}};
 
@@ -445,7 +565,8 @@ static const ctl_named_node_t thread_node[] = {
     {NAME("tcache"), CHILD(named, thread_tcache)},
     {NAME("peak"), CHILD(named, thread_peak)},
     {NAME("prof"), CHILD(named, thread_prof)},
-    {NAME("idle"), CTL(thread_idle)}};
+    {NAME("idle"), CTL(thread_idle)},
+    {NAME("tag"), CTL(thread_tag)}};
 
 static const ctl_named_node_t config_node[] = {
     {NAME("cache_oblivious"), CTL(config_cache_oblivious)},
@@ -497,6 +618,8 @@ static const ctl_named_node_t opt_node[] = {{NAME("abort"), CTL(opt_abort)},
     {NAME("narenas"), CTL(opt_narenas)},
     {NAME("percpu_arena"), CTL(opt_percpu_arena)},
     {NAME("oversize_threshold"), CTL(opt_oversize_threshold)},
+    {NAME("lec_max_bytes"), CTL(opt_lec_max_bytes)},
+    {NAME("lec_max_alloc"), CTL(opt_lec_max_alloc)},
     {NAME("mutex_max_spin"), CTL(opt_mutex_max_spin)},
     {NAME("background_thread"), CTL(opt_background_thread)},
     {NAME("max_background_threads"), CTL(opt_max_background_threads)},
@@ -506,6 +629,8 @@ static const ctl_named_node_t opt_node[] = {{NAME("abort"), CTL(opt_abort)},
     {NAME("stats_print_opts"), CTL(opt_stats_print_opts)},
     {NAME("stats_interval"), CTL(opt_stats_interval)},
     {NAME("stats_interval_opts"), CTL(opt_stats_interval_opts)},
+    {NAME("stats_latency_sample"), CTL(opt_stats_latency_sample)},
+    {NAME("arena_stats_enabled"), CTL(opt_arena_stats_enabled)},
     {NAME("junk"), CTL(opt_junk)}, {NAME("zero"), CTL(opt_zero)},
     {NAME("utrace"), CTL(opt_utrace)}, {NAME("xmalloc"), CTL(opt_xmalloc)},
     {NAME("experimental_infallible_new"), CTL(opt_experimental_infallible_new)},
@@ -518,6 +643,10 @@ static const ctl_named_node_t opt_node[] = {{NAME("abort"), CTL(opt_abort)},
     {NAME("lg_tcache_nslots_mul"), CTL(opt_lg_tcache_nslots_mul)},
     {NAME("tcache_gc_incr_bytes"), CTL(opt_tcache_gc_incr_bytes)},
     {NAME("tcache_gc_delay_bytes"), CTL(opt_tcache_gc_delay_bytes)},
+    {NAME("tcache_bytes_budget"), CTL(opt_tcache_bytes_budget)},
+    {NAME("tcache_idle_reclaim_ms"), CTL(opt_tcache_idle_reclaim_ms)},
+    {NAME("tcache_pool_max"), CTL(opt_tcache_pool_max)},
+    {NAME("tcache_pool_keep_cached"), CTL(opt_tcache_pool_keep_cached)},
     {NAME("lg_tcache_flush_small_div"), CTL(opt_lg_tcache_flush_small_div)},
     {NAME("lg_tcache_flush_large_div"), CTL(opt_lg_tcache_flush_large_div)},
     {NAME("thp"), CTL(opt_thp)},
@@ -527,6 +656,7 @@ static const ctl_named_node_t opt_node[] = {{NAME("abort"), CTL(opt_abort)},
     {NAME("prof_thread_active_init"), CTL(opt_prof_thread_active_init)},
     {NAME("prof_bt_max"), CTL(opt_prof_bt_max)},
     {NAME("lg_prof_sample"), CTL(opt_lg_prof_sample)},
+    {NAME("prof_overhead_ppm"), CTL(opt_prof_overhead_ppm)},
     {NAME("experimental_lg_prof_threshold"),
         CTL(opt_experimental_lg_prof_threshold)},
     {NAME("lg_prof_interval"), CTL(opt_lg_prof_interval)},
@@ -535,9 +665,15 @@ static const ctl_named_node_t opt_node[] = {{NAME("abort"), CTL(opt_abort)},
     {NAME("prof_leak"), CTL(opt_prof_leak)},
     {NAME("prof_leak_error"), CTL(opt_prof_leak_error)},
     {NAME("prof_accum"), CTL(opt_prof_accum)},
+    {NAME("prof_lifetime"), CTL(opt_prof_lifetime)},
     {NAME("prof_pid_namespace"), CTL(opt_prof_pid_namespace)},
     {NAME("prof_recent_alloc_max"), CTL(opt_prof_recent_alloc_max)},
     {NAME("prof_stats"), CTL(opt_prof_stats)},
+    {NAME("prof_callsite"), CTL(opt_prof_callsite)},
+    {NAME("prof_pprof"), CTL(opt_prof_pprof)},
+    {NAME("prof_bg_dump_ms"), CTL(opt_prof_bg_dump_ms)},
+    {NAME("prof_contention"), CTL(opt_prof_contention)},
+    {NAME("lg_prof_contention_sample"), CTL(opt_lg_prof_contention_sample)},
     {NAME("prof_sys_thread_name"), CTL(opt_prof_sys_thread_name)},
     {NAME("prof_time_resolution"), CTL(opt_prof_time_res)},
     {NAME("lg_san_uaf_align"), CTL(opt_lg_san_uaf_align)},
@@ -565,7 +701,10 @@ static const ctl_named_node_t arena_i_node[] = {
     {NAME("muzzy_decay_ms"), CTL(arena_i_muzzy_decay_ms)},
     {NAME("extent_hooks"), CTL(arena_i_extent_hooks)},
     {NAME("retain_grow_limit"), CTL(arena_i_retain_grow_limit)},
-    {NAME("name"), CTL(arena_i_name)}};
+    {NAME("name"), CTL(arena_i_name)},
+    {NAME("stats_refresh"), CTL(arena_i_stats_refresh)},
+    {NAME("stats_enabled"), CTL(arena_i_stats_enabled)},
+    {NAME("resident_scan"), CTL(arena_i_resident_scan)}};
 static const ctl_named_node_t super_arena_i_node[] = {
     {NAME(""), CHILD(named, arena_i)}};
 
@@ -589,6 +728,14 @@ static const ctl_named_node_t super_arenas_lextent_i_node[] = {
 static const ctl_indexed_node_t arenas_lextent_node[] = {
     {INDEX(arenas_lextent_i)}};
 
+static const ctl_named_node_t arenas_latency_bucket_i_node[] = {
+    {NAME("lower_ns"), CTL(arenas_latency_bucket_i_lower_ns)}};
+static const ctl_named_node_t super_arenas_latency_bucket_i_node[] = {
+    {NAME(""), CHILD(named, arenas_latency_bucket_i)}};
+
+static const ctl_indexed_node_t arenas_latency_bucket_node[] = {
+    {INDEX(arenas_latency_bucket_i)}};
+
 static const ctl_named_node_t arenas_node[] = {
     {NAME("narenas"), CTL(arenas_narenas)},
     {NAME("dirty_decay_ms"), CTL(arenas_dirty_decay_ms)},
@@ -600,6 +747,8 @@ static const ctl_named_node_t arenas_node[] = {
     {NAME("bin"), CHILD(indexed, arenas_bin)},
     {NAME("nlextents"), CTL(arenas_nlextents)},
     {NAME("lextent"), CHILD(indexed, arenas_lextent)},
+    {NAME("nlatency_buckets"), CTL(arenas_nlatency_buckets)},
+    {NAME("latency_bucket"), CHILD(indexed, arenas_latency_bucket)},
     {NAME("create"), CTL(arenas_create)}, {NAME("lookup"), CTL(arenas_lookup)}};
 
 static const ctl_named_node_t prof_stats_bins_i_node[] = {
@@ -633,8 +782,12 @@ static const ctl_named_node_t prof_node[] = {
     {NAME("gdump"), CTL(prof_gdump)}, {NAME("prefix"), CTL(prof_prefix)},
     {NAME("reset"), CTL(prof_reset)}, {NAME("interval"), CTL(prof_interval)},
     {NAME("lg_sample"), CTL(lg_prof_sample)},
+    {NAME("lg_sample_effective"), CTL(prof_lg_sample_effective)},
     {NAME("log_start"), CTL(prof_log_start)},
     {NAME("log_stop"), CTL(prof_log_stop)},
+    {NAME("contention_dump"), CTL(prof_contention_dump)},
+    {NAME("contention_reset"), CTL(prof_contention_reset)},
+    {NAME("snapshot"), CTL(prof_snapshot)}, {NAME("diff"), CTL(prof_diff)},
     {NAME("stats"), CHILD(named, prof_stats)}};
 
 static const ctl_named_node_t stats_arenas_i_small_node[] = {
@@ -653,18 +806,32 @@ static const ctl_named_node_t stats_arenas_i_large_node[] = {
     {NAME("nfills"), CTL(stats_arenas_i_large_nfills)},
     {NAME("nflushes"), CTL(stats_arenas_i_large_nflushes)}};
 
-#define MUTEX_PROF_DATA_NODE(prefix)                                                                          \
-	static const ctl_named_node_t stats_##prefix##_node[] = {                                             \
-	    {NAME("num_ops"), CTL(stats_##prefix##_num_ops)},                                                 \
-	    {NAME("num_wait"), CTL(stats_##prefix##_num_wait)},                                               \
-	    {NAME("num_spin_acq"), CTL(stats_##prefix##_num_spin_acq)},                                       \
-	    {NAME("num_owner_switch"),                                                                        \
-	        CTL(stats_##prefix##_num_owner_switch)},                                                      \
-	    {NAME("total_wait_time"), CTL(stats_##prefix##_total_wait_time)},                                 \
-	    {NAME("max_wait_time"), CTL(stats_##prefix##_max_wait_time)},                                     \
-	    {NAME("max_num_thds"),                                                                            \
-	        CTL(stats_##prefix##_max_num_thds)} /* Note that # of current waiting thread not provided. */ \
-	};
+#define MUTEX_PROF_DATA_NODE_COMMON(prefix)                                    \
+	{NAME("num_ops"), CTL(stats_##prefix##_num_ops)},                      \
+	    {NAME("num_wait"), CTL(stats_##prefix##_num_wait)},                \
+	    {NAME("num_spin_acq"), CTL(stats_##prefix##_num_spin_acq)},        \
+	    {NAME("num_owner_switch"),                                         \
+	        CTL(stats_##prefix##_num_owner_switch)},                       \
+	    {NAME("total_wait_time"),                                          \
+	        CTL(stats_##prefix##_total_wait_time)},                        \
+	    {NAME("max_wait_time"), CTL(stats_##prefix##_max_wait_time)},      \
+	{                                                                      \
+		NAME("max_num_thds"), CTL(stats_##prefix##_max_num_thds)       \
+	} /* Note that # of current waiting thread not provided. */
+
+#define MUTEX_PROF_DATA_NODE(prefix)                                           \
+	static const ctl_named_node_t stats_##prefix##_node[] = {              \
+	    MUTEX_PROF_DATA_NODE_COMMON(prefix)};
+
+/*
+ * Also exposes the wait time histogram, through an indexed node shared by all
+ * the mutexes of a kind.  Bin mutexes don't get one: it would be past
+ * CTL_MAX_DEPTH.
+ */
+#define MUTEX_PROF_DATA_HIST_NODE(prefix, hist)                                \
+	static const ctl_named_node_t stats_##prefix##_node[] = {              \
+	    MUTEX_PROF_DATA_NODE_COMMON(prefix),                               \
+	    {NAME("wait_hist"), CHILD(indexed, stats_##hist)}};
 
 MUTEX_PROF_DATA_NODE(arenas_i_bins_j_mutex)
 
@@ -712,7 +879,15 @@ static const ctl_named_node_t super_stats_arenas_i_extents_j_node[] = {
 static const ctl_indexed_node_t stats_arenas_i_extents_node[] = {
     {INDEX(stats_arenas_i_extents_j)}};
 
-#define OP(mtx) MUTEX_PROF_DATA_NODE(arenas_i_mutexes_##mtx)
+static const ctl_named_node_t stats_arenas_i_mutexes_wait_hist_j_node[] = {
+    {NAME(""), CTL(stats_arenas_i_mutexes_wait_hist_j)}};
+
+static const ctl_indexed_node_t stats_arenas_i_mutexes_wait_hist_node[] = {
+    {INDEX(stats_arenas_i_mutexes_wait_hist_j)}};
+
+#define OP(mtx)                                                                \
+	MUTEX_PROF_DATA_HIST_NODE(                                             \
+	    arenas_i_mutexes_##mtx, arenas_i_mutexes_wait_hist)
 MUTEX_PROF_ARENA_MUTEXES
 #undef OP
 
@@ -722,6 +897,31 @@ static const ctl_named_node_t stats_arenas_i_mutexes_node[] = {
 #undef OP
 };
 
+/*
+ * The bucket counts are leaves right under the index; another level would
+ * exceed CTL_MAX_DEPTH.
+ */
+static const ctl_named_node_t stats_arenas_i_latency_site_buckets_j_node[] = {
+    {NAME(""), CTL(stats_arenas_i_latency_site_buckets_j)}};
+
+static const ctl_indexed_node_t stats_arenas_i_latency_site_buckets_node[] = {
+    {INDEX(stats_arenas_i_latency_site_buckets_j)}};
+
+/* Shared by all sites; the handlers find the site in mib[4]. */
+static const ctl_named_node_t stats_arenas_i_latency_site_node[] = {
+    {NAME("count"), CTL(stats_arenas_i_latency_site_count)},
+    {NAME("total_ns"), CTL(stats_arenas_i_latency_site_total_ns)},
+    {NAME("p50_ns"), CTL(stats_arenas_i_latency_site_p50_ns)},
+    {NAME("p99_ns"), CTL(stats_arenas_i_latency_site_p99_ns)},
+    {NAME("p999_ns"), CTL(stats_arenas_i_latency_site_p999_ns)},
+    {NAME("buckets"), CHILD(indexed, stats_arenas_i_latency_site_buckets)}};
+
+static const ctl_named_node_t stats_arenas_i_latency_node[] = {
+#define OP(site) {NAME(#site), CHILD(named, stats_arenas_i_latency_site)},
+    LATENCY_SITES
+#undef OP
+};
+
 static const ctl_named_node_t stats_arenas_i_hpa_shard_slabs_node[] = {
     {NAME("npageslabs_nonhuge"),
         CTL(stats_arenas_i_hpa_shard_slabs_npageslabs_nonhuge)},
@@ -801,6 +1001,15 @@ static const ctl_named_node_t stats_arenas_i_hpa_shard_node[] = {
     {NAME("nonfull_slabs"),
         CHILD(indexed, stats_arenas_i_hpa_shard_nonfull_slabs)}};
 
+static const ctl_named_node_t stats_arenas_i_resident_scan_node[] = {
+    {NAME("active_manual"), CTL(stats_arenas_i_resident_scan_active_manual)},
+    {NAME("dirty"), CTL(stats_arenas_i_resident_scan_dirty)},
+    {NAME("muzzy"), CTL(stats_arenas_i_resident_scan_muzzy)},
+    {NAME("retained"), CTL(stats_arenas_i_resident_scan_retained)},
+    {NAME("hpa_nonfull"), CTL(stats_arenas_i_resident_scan_hpa_nonfull)},
+    {NAME("hpa_nonfull_huge"),
+        CTL(stats_arenas_i_resident_scan_hpa_nonfull_huge)}};
+
 static const ctl_named_node_t stats_arenas_i_node[] = {
     {NAME("nthreads"), CTL(stats_arenas_i_nthreads)},
     {NAME("uptime"), CTL(stats_arenas_i_uptime)},
@@ -827,7 +1036,12 @@ static const ctl_named_node_t stats_arenas_i_node[] = {
     {NAME("tcache_bytes"), CTL(stats_arenas_i_tcache_bytes)},
     {NAME("tcache_stashed_bytes"), CTL(stats_arenas_i_tcache_stashed_bytes)},
     {NAME("resident"), CTL(stats_arenas_i_resident)},
+    {NAME("resident_scan"), CHILD(named, stats_arenas_i_resident_scan)},
     {NAME("abandoned_vm"), CTL(stats_arenas_i_abandoned_vm)},
+    {NAME("lec_bytes"), CTL(stats_arenas_i_lec_bytes)},
+    {NAME("lec_hits"), CTL(stats_arenas_i_lec_hits)},
+    {NAME("lec_misses"), CTL(stats_arenas_i_lec_misses)},
+    {NAME("lec_evictions"), CTL(stats_arenas_i_lec_evictions)},
     {NAME("hpa_sec_bytes"), CTL(stats_arenas_i_hpa_sec_bytes)},
     {NAME("hpa_sec_hits"), CTL(stats_arenas_i_hpa_sec_hits)},
     {NAME("hpa_sec_misses"), CTL(stats_arenas_i_hpa_sec_misses)},
@@ -841,6 +1055,7 @@ static const ctl_named_node_t stats_arenas_i_node[] = {
     {NAME("lextents"), CHILD(indexed, stats_arenas_i_lextents)},
     {NAME("extents"), CHILD(indexed, stats_arenas_i_extents)},
     {NAME("mutexes"), CHILD(named, stats_arenas_i_mutexes)},
+    {NAME("latency"), CHILD(named, stats_arenas_i_latency)},
     {NAME("hpa_shard"), CHILD(named, stats_arenas_i_hpa_shard)}};
 static const ctl_named_node_t super_stats_arenas_i_node[] = {
     {NAME(""), CHILD(named, stats_arenas_i)}};
@@ -852,7 +1067,13 @@ static const ctl_named_node_t stats_background_thread_node[] = {
     {NAME("num_runs"), CTL(stats_background_thread_num_runs)},
     {NAME("run_interval"), CTL(stats_background_thread_run_interval)}};
 
-#define OP(mtx) MUTEX_PROF_DATA_NODE(mutexes_##mtx)
+static const ctl_named_node_t stats_mutexes_wait_hist_j_node[] = {
+    {NAME(""), CTL(stats_mutexes_wait_hist_j)}};
+
+static const ctl_indexed_node_t stats_mutexes_wait_hist_node[] = {
+    {INDEX(stats_mutexes_wait_hist_j)}};
+
+#define OP(mtx) MUTEX_PROF_DATA_HIST_NODE(mutexes_##mtx, mutexes_wait_hist)
 MUTEX_PROF_GLOBAL_MUTEXES
 #undef OP
 
@@ -862,6 +1083,27 @@ static const ctl_named_node_t stats_mutexes_node[] = {
 #undef OP
     {NAME("reset"), CTL(stats_mutexes_reset)}};
 #undef MUTEX_PROF_DATA_NODE
+#undef MUTEX_PROF_DATA_HIST_NODE
+#undef MUTEX_PROF_DATA_NODE_COMMON
+
+static const ctl_named_node_t stats_tags_i_node[] = {
+    {NAME("allocated"), CTL(stats_tags_i_allocated)},
+    {NAME("deallocated"), CTL(stats_tags_i_deallocated)},
+    {NAME("live"), CTL(stats_tags_i_live)}};
+static const ctl_named_node_t super_stats_tags_i_node[] = {
+    {NAME(""), CHILD(named, stats_tags_i)}};
+
+static const ctl_indexed_node_t stats_tags_node[] = {{INDEX(stats_tags_i)}};
+
+static const ctl_named_node_t stats_prof_callsites_i_node[] = {
+    {NAME("addr"), CTL(stats_prof_callsites_i_addr)},
+    {NAME("count"), CTL(stats_prof_callsites_i_count)},
+    {NAME("bytes"), CTL(stats_prof_callsites_i_bytes)}};
+static const ctl_named_node_t super_stats_prof_callsites_i_node[] = {
+    {NAME(""), CHILD(named, stats_prof_callsites_i)}};
+
+static const ctl_indexed_node_t stats_prof_callsites_node[] = {
+    {INDEX(stats_prof_callsites_i)}};
 
 static const ctl_named_node_t approximate_stats_node[] = {
     {NAME("active"), CTL(approximate_stats_active)},
@@ -881,6 +1123,8 @@ static const ctl_named_node_t stats_node[] = {
     {NAME("mutexes"), CHILD(named, stats_mutexes)},
     {NAME("arenas"), CHILD(indexed, stats_arenas)},
     {NAME("zero_reallocs"), CTL(stats_zero_reallocs)},
+    {NAME("tags"), CHILD(indexed, stats_tags)},
+    {NAME("prof_callsites"), CHILD(indexed, stats_prof_callsites)},
 };
 
 static const ctl_named_node_t experimental_hooks_node[] = {
@@ -922,6 +1166,7 @@ static const ctl_named_node_t experimental_node[] = {
     {NAME("arenas_create_ext"), CTL(experimental_arenas_create_ext)},
     {NAME("prof_recent"), CHILD(named, experimental_prof_recent)},
     {NAME("batch_alloc"), CTL(experimental_batch_alloc)},
+    {NAME("batch_read"), CTL(experimental_batch_read)},
     {NAME("thread"), CHILD(named, experimental_thread)}};
 
 static const ctl_named_node_t root_node[] = {{NAME("version"), CTL(version)},
@@ -1050,8 +1295,71 @@ arenas_i(size_t i) {
 	return ret;
 }
 
+/*
+ * Clears the stats about to be refreshed; see ARENA_STATS_MERGE_* for the
+ * groups selected by what.  The groups not refreshed keep their values.
+ */
 static void
-ctl_arena_clear(ctl_arena_t *ctl_arena) {
+ctl_arena_stats_clear(ctl_arena_stats_t *astats, unsigned what) {
+	if (what == ARENA_STATS_MERGE_ALL) {
+		memset(astats, 0, sizeof(*astats));
+		return;
+	}
+
+	/* Basic counters, always refreshed. */
+	arena_stats_t *basic = &astats->astats;
+	basic->base = 0;
+	basic->metadata_edata = 0;
+	basic->metadata_rtree = 0;
+	basic->resident = 0;
+	basic->metadata_thp = 0;
+	basic->mapped = 0;
+	atomic_store_zu(&basic->internal, 0, ATOMIC_RELAXED);
+	for (unsigned i = 0; i < arena_resident_scan_nkinds; i++) {
+		atomic_store_zu(&basic->resident_scan[i], 0, ATOMIC_RELAXED);
+	}
+	lec_stats_t lec_stats = basic->pa_shard_stats.lec_stats;
+	memset(&basic->pa_shard_stats, 0, sizeof(basic->pa_shard_stats));
+
+	if ((what & ARENA_STATS_MERGE_BINS) != 0) {
+		astats->allocated_small = 0;
+		astats->nmalloc_small = 0;
+		astats->ndalloc_small = 0;
+		astats->nrequests_small = 0;
+		astats->nfills_small = 0;
+		astats->nflushes_small = 0;
+		memset(astats->bstats, 0, sizeof(astats->bstats));
+	}
+	if ((what & ARENA_STATS_MERGE_LARGE) != 0) {
+		basic->allocated_large = 0;
+		basic->nmalloc_large = 0;
+		basic->ndalloc_large = 0;
+		basic->nfills_large = 0;
+		basic->nflushes_large = 0;
+		basic->nrequests_large = 0;
+		memset(astats->lstats, 0, sizeof(astats->lstats));
+	}
+	if ((what & ARENA_STATS_MERGE_EXTENTS) != 0) {
+		memset(astats->estats, 0, sizeof(astats->estats));
+		memset(&astats->hpastats, 0, sizeof(astats->hpastats));
+	} else {
+		basic->pa_shard_stats.lec_stats = lec_stats;
+	}
+	if ((what & ARENA_STATS_MERGE_TCACHE) != 0) {
+		basic->tcache_bytes = 0;
+		basic->tcache_stashed_bytes = 0;
+	}
+	if ((what & ARENA_STATS_MERGE_MUTEXES) != 0) {
+		memset(basic->mutex_prof_data, 0,
+		    sizeof(basic->mutex_prof_data));
+	}
+	if ((what & ARENA_STATS_MERGE_LATENCY) != 0) {
+		memset(&basic->latency, 0, sizeof(basic->latency));
+	}
+}
+
+static void
+ctl_arena_clear(ctl_arena_t *ctl_arena, unsigned what) {
 	ctl_arena->nthreads = 0;
 	ctl_arena->dss = dss_prec_names[dss_prec_limit];
 	ctl_arena->dirty_decay_ms = -1;
@@ -1060,23 +1368,32 @@ ctl_arena_clear(ctl_arena_t *ctl_arena) {
 	ctl_arena->pdirty = 0;
 	ctl_arena->pmuzzy = 0;
 	if (config_stats) {
-		memset(ctl_arena->astats, 0, sizeof(*(ctl_arena->astats)));
+		ctl_arena_stats_clear(ctl_arena->astats, what);
 	}
 }
 
 static void
-ctl_arena_stats_amerge(tsdn_t *tsdn, ctl_arena_t *ctl_arena, arena_t *arena) {
+ctl_arena_stats_amerge(
+    tsdn_t *tsdn, ctl_arena_t *ctl_arena, arena_t *arena, unsigned what) {
 	unsigned i;
 
 	if (config_stats) {
+		if (!arena_stats_enabled_get(arena)) {
+			/* Only the page level stats are still meaningful. */
+			what &= ~(ARENA_STATS_MERGE_BINS
+			    | ARENA_STATS_MERGE_LARGE);
+		}
 		arena_stats_merge(tsdn, arena, &ctl_arena->nthreads,
 		    &ctl_arena->dss, &ctl_arena->dirty_decay_ms,
 		    &ctl_arena->muzzy_decay_ms, &ctl_arena->pactive,
 		    &ctl_arena->pdirty, &ctl_arena->pmuzzy,
 		    &ctl_arena->astats->astats, ctl_arena->astats->bstats,
 		    ctl_arena->astats->lstats, ctl_arena->astats->estats,
-		    &ctl_arena->astats->hpastats);
+		    &ctl_arena->astats->hpastats, what);
 
+		if ((what & ARENA_STATS_MERGE_BINS) == 0) {
+			return;
+		}
 		for (i = 0; i < SC_NBINS; i++) {
 			bin_stats_t *bstats =
 			    &ctl_arena->astats->bstats[i].stats_data;
@@ -1168,6 +1485,12 @@ ctl_arena_stats_sdmerge(
 			    astats->astats.metadata_thp;
 			ctl_accum_atomic_zu(&sdstats->astats.internal,
 			    &astats->astats.internal);
+			for (unsigned i = 0; i < arena_resident_scan_nkinds;
+			     i++) {
+				ctl_accum_atomic_zu(
+				    &sdstats->astats.resident_scan[i],
+				    &astats->astats.resident_scan[i]);
+			}
 		} else {
 			assert(atomic_load_zu(
 			           &astats->astats.internal, ATOMIC_RELAXED)
@@ -1267,18 +1590,29 @@ ctl_arena_stats_sdmerge(
 
 		/* Merge HPA stats. */
 		hpa_shard_stats_accum(&sdstats->hpastats, &astats->hpastats);
+
+		/* Merge large extent cache stats. */
+		lec_stats_accum(&sdstats->astats.pa_shard_stats.lec_stats,
+		    &astats->astats.pa_shard_stats.lec_stats);
+
+		/* Merge slow path latency histograms. */
+		latency_stats_accum(
+		    &sdstats->astats.latency, &astats->astats.latency);
 	}
 }
 
+/* ctl_sdarena may be NULL, to only refresh the stats of arena i. */
 static void
 ctl_arena_refresh(tsdn_t *tsdn, arena_t *arena, ctl_arena_t *ctl_sdarena,
-    unsigned i, bool destroyed) {
+    unsigned i, bool destroyed, unsigned what) {
 	ctl_arena_t *ctl_arena = arenas_i(i);
 
-	ctl_arena_clear(ctl_arena);
-	ctl_arena_stats_amerge(tsdn, ctl_arena, arena);
-	/* Merge into sum stats as well. */
-	ctl_arena_stats_sdmerge(ctl_sdarena, ctl_arena, destroyed);
+	ctl_arena_clear(ctl_arena, what);
+	ctl_arena_stats_amerge(tsdn, ctl_arena, arena, what);
+	if (ctl_sdarena != NULL) {
+		/* Merge into sum stats as well. */
+		ctl_arena_stats_sdmerge(ctl_sdarena, ctl_arena, destroyed);
+	}
 }
 
 static unsigned
@@ -1324,8 +1658,12 @@ ctl_background_thread_stats_read(tsdn_t *tsdn) {
 	    &stats->max_counter_per_bg_thd);
 }
 
+/*
+ * Refreshes the stats groups selected by what for all arenas, and recomputes
+ * the summary and global stats from the result.
+ */
 static void
-ctl_refresh(tsdn_t *tsdn) {
+ctl_refresh(tsdn_t *tsdn, unsigned what) {
 	malloc_mutex_assert_owner(tsdn, &ctl_mtx);
 	/*
 	 * We are guaranteed that `ctl_arenas->narenas` will not change
@@ -1343,7 +1681,7 @@ ctl_refresh(tsdn_t *tsdn) {
 	 * Clear sum stats, since they will be merged into by
 	 * ctl_arena_refresh().
 	 */
-	ctl_arena_clear(ctl_sarena);
+	ctl_arena_clear(ctl_sarena, ARENA_STATS_MERGE_ALL);
 
 	for (unsigned i = 0; i < narenas; i++) {
 		tarenas[i] = arena_get(tsdn, i, false);
@@ -1356,7 +1694,7 @@ ctl_refresh(tsdn_t *tsdn) {
 		ctl_arena->initialized = initialized;
 		if (initialized) {
 			ctl_arena_refresh(
-			    tsdn, tarenas[i], ctl_sarena, i, false);
+			    tsdn, tarenas[i], ctl_sarena, i, false, what);
 		}
 	}
 
@@ -1380,14 +1718,38 @@ ctl_refresh(tsdn_t *tsdn) {
 
 		ctl_background_thread_stats_read(tsdn);
 
+		/* Let the caller see its own recent activity. */
+		if (!tsdn_null(tsdn)) {
+			alloc_tag_flush(tsdn_tsd(tsdn));
+		}
+		for (unsigned i = 0; i < ALLOC_TAG_NTAGS; i++) {
+			alloc_tag_read(i, &ctl_stats->tag_allocated[i],
+			    &ctl_stats->tag_deallocated[i]);
+		}
+		if (config_prof && opt_prof) {
+			if (!tsdn_null(tsdn)) {
+				prof_callsite_flush(tsdn_tsd(tsdn));
+			}
+			prof_callsite_top(tsdn, ctl_stats->prof_callsites,
+			    PROF_CALLSITE_NTOP);
+		}
+
 #define READ_GLOBAL_MUTEX_PROF_DATA(i, mtx)                                    \
 	malloc_mutex_lock(tsdn, &mtx);                                         \
 	malloc_mutex_prof_read(tsdn, &ctl_stats->mutex_prof_data[i], &mtx);    \
 	malloc_mutex_unlock(tsdn, &mtx);
 
 		if (config_prof && opt_prof) {
-			READ_GLOBAL_MUTEX_PROF_DATA(
-			    global_prof_mutex_prof, bt2gctx_mtx);
+			/* The bt2gctx shards are reported as one mutex. */
+			mutex_prof_data_t *bt2gctx_data =
+			    &ctl_stats->mutex_prof_data[global_prof_mutex_prof];
+			memset(bt2gctx_data, 0, sizeof(mutex_prof_data_t));
+			for (unsigned i = 0; i < PROF_BT2GCTX_NSHARDS; i++) {
+				malloc_mutex_lock(tsdn, &bt2gctx_locks[i]);
+				malloc_mutex_prof_accum(
+				    tsdn, bt2gctx_data, &bt2gctx_locks[i]);
+				malloc_mutex_unlock(tsdn, &bt2gctx_locks[i]);
+			}
 			READ_GLOBAL_MUTEX_PROF_DATA(
 			    global_prof_mutex_prof_thds_data, tdatas_mtx);
 			READ_GLOBAL_MUTEX_PROF_DATA(
@@ -1470,7 +1832,7 @@ ctl_init(tsd_t *tsd) {
 			ret = true;
 			goto label_return;
 		}
-		ctl_arena_clear(ctl_darena);
+		ctl_arena_clear(ctl_darena, ARENA_STATS_MERGE_ALL);
 		/*
 		 * Don't toggle ctl_darena to initialized until an arena is
 		 * actually destroyed, so that arena.<i>.initialized can be used
@@ -1486,7 +1848,7 @@ ctl_init(tsd_t *tsd) {
 		}
 
 		ql_new(&ctl_arenas->destroyed);
-		ctl_refresh(tsdn);
+		ctl_refresh(tsdn, ARENA_STATS_MERGE_ALL);
 
 		ctl_initialized = true;
 	}
@@ -1588,6 +1950,110 @@ label_return:
 	return ret;
 }
 
+static int ctl_lookupbymib(tsdn_t *tsdn, const ctl_named_node_t **ending_nodep,
+    const size_t *mib, size_t miblen);
+
+/*
+ * Returns true if name is not cached, or if its MIB is longer than *depthp.
+ */
+static bool
+ctl_name_cache_get(const char *name, size_t len, size_t *mibp, size_t *depthp) {
+	uint32_t h = hash_x86_32(name, (int)len, 0);
+	for (unsigned i = 0; i < CTL_NAME_CACHE_NPROBES; i++) {
+		ctl_name_cache_elm_t *elm = (ctl_name_cache_elm_t *)atomic_load_p(
+		    &ctl_name_cache[(h + i) & (CTL_NAME_CACHE_SIZE - 1)],
+		    ATOMIC_ACQUIRE);
+		if (elm == NULL) {
+			return true;
+		}
+		if (strcmp(elm->name, name) == 0) {
+			if (elm->miblen > *depthp) {
+				return true;
+			}
+			memcpy(mibp, elm->mib, elm->miblen * sizeof(size_t));
+			*depthp = elm->miblen;
+			return false;
+		}
+	}
+	return true;
+}
+
+static void
+ctl_name_cache_put(tsdn_t *tsdn, const char *name, size_t len,
+    const size_t *mib, size_t miblen) {
+	assert(len < CTL_NAME_CACHE_NAME_MAX);
+	assert(miblen <= CTL_MAX_DEPTH);
+
+	uint32_t              h = hash_x86_32(name, (int)len, 0);
+	ctl_name_cache_elm_t *elm = NULL;
+	for (unsigned i = 0; i < CTL_NAME_CACHE_NPROBES; i++) {
+		atomic_p_t *slot =
+		    &ctl_name_cache[(h + i) & (CTL_NAME_CACHE_SIZE - 1)];
+		ctl_name_cache_elm_t *cur = (ctl_name_cache_elm_t *)
+		    atomic_load_p(slot, ATOMIC_ACQUIRE);
+		if (cur != NULL) {
+			if (strcmp(cur->name, name) == 0) {
+				/* Raced with another thread. */
+				return;
+			}
+			continue;
+		}
+		if (elm == NULL) {
+			/*
+			 * Since this only happens for an empty slot, at most
+			 * one element per slot can ever be lost to a failed
+			 * CAS below.
+			 */
+			elm = (ctl_name_cache_elm_t *)base_alloc(tsdn,
+			    b0get(), sizeof(ctl_name_cache_elm_t), CACHELINE);
+			if (elm == NULL) {
+				return;
+			}
+			elm->miblen = miblen;
+			memcpy(elm->mib, mib, miblen * sizeof(size_t));
+			memcpy(elm->name, name, len + 1);
+		}
+		void *expected = NULL;
+		if (atomic_compare_exchange_strong_p(slot, &expected,
+		        (void *)elm, ATOMIC_RELEASE, ATOMIC_RELAXED)) {
+			return;
+		}
+	}
+}
+
+/* ctl_lookup() from the root node, through the name cache. */
+static int
+ctl_lookup_cached(tsdn_t *tsdn, const char *name,
+    const ctl_named_node_t **ending_nodep, size_t *mibp, size_t *depthp) {
+	int                     ret;
+	const ctl_named_node_t *node;
+
+	size_t len = strlen(name);
+	if (len >= CTL_NAME_CACHE_NAME_MAX) {
+		return ctl_lookup(
+		    tsdn, super_root_node, name, ending_nodep, mibp, depthp);
+	}
+
+	size_t depth = *depthp;
+	if (!ctl_name_cache_get(name, len, mibp, &depth)) {
+		ret = ctl_lookupbymib(tsdn, &node, mibp, depth);
+		if (ret == 0) {
+			*depthp = depth;
+		}
+	} else {
+		ret = ctl_lookup(tsdn, super_root_node, name, &node, mibp,
+		    depthp);
+		/* Only complete names are cached. */
+		if (ret == 0 && node != NULL && node->ctl != NULL) {
+			ctl_name_cache_put(tsdn, name, len, mibp, *depthp);
+		}
+	}
+	if (ret == 0 && ending_nodep != NULL) {
+		*ending_nodep = node;
+	}
+	return ret;
+}
+
 int
 ctl_byname(tsd_t *tsd, const char *name, void *oldp, size_t *oldlenp,
     void *newp, size_t newlen) {
@@ -1602,8 +2068,7 @@ ctl_byname(tsd_t *tsd, const char *name, void *oldp, size_t *oldlenp,
 	}
 
 	depth = CTL_MAX_DEPTH;
-	ret = ctl_lookup(
-	    tsd_tsdn(tsd), super_root_node, name, &node, mib, &depth);
+	ret = ctl_lookup_cached(tsd_tsdn(tsd), name, &node, mib, &depth);
 	if (ret != 0) {
 		goto label_return;
 	}
@@ -1628,8 +2093,7 @@ ctl_nametomib(tsd_t *tsd, const char *name, size_t *mibp, size_t *miblenp) {
 		goto label_return;
 	}
 
-	ret = ctl_lookup(
-	    tsd_tsdn(tsd), super_root_node, name, NULL, mibp, miblenp);
+	ret = ctl_lookup_cached(tsd_tsdn(tsd), name, NULL, mibp, miblenp);
 label_return:
 	return (ret);
 }
@@ -1915,14 +2379,14 @@ ctl_mtx_assert_held(tsdn_t *tsdn) {
 		if (!(c)) {                                                    \
 			return ENOENT;                                         \
 		}                                                              \
-		malloc_mutex_lock(tsd_tsdn(tsd), &ctl_mtx);                    \
+		ctl_mtx_lock(tsd_tsdn(tsd));                                   \
 		READONLY();                                                    \
 		oldval = (v);                                                  \
 		READ(oldval, t);                                               \
                                                                                \
 		ret = 0;                                                       \
 	label_return:                                                          \
-		malloc_mutex_unlock(tsd_tsdn(tsd), &ctl_mtx);                  \
+		ctl_mtx_unlock(tsd_tsdn(tsd));                                 \
 		return ret;                                                    \
 	}
 
@@ -1932,14 +2396,14 @@ ctl_mtx_assert_held(tsdn_t *tsdn) {
 		int ret;                                                       \
 		t   oldval;                                                    \
                                                                                \
-		malloc_mutex_lock(tsd_tsdn(tsd), &ctl_mtx);                    \
+		ctl_mtx_lock(tsd_tsdn(tsd));                                   \
 		READONLY();                                                    \
 		oldval = (v);                                                  \
 		READ(oldval, t);                                               \
                                                                                \
 		ret = 0;                                                       \
 	label_return:                                                          \
-		malloc_mutex_unlock(tsd_tsdn(tsd), &ctl_mtx);                  \
+		ctl_mtx_unlock(tsd_tsdn(tsd));                                 \
 		return ret;                                                    \
 	}
 
@@ -2008,7 +2472,7 @@ epoch_ctl(tsd_t *tsd, const size_t *mib, size_t miblen, void *oldp,
 	malloc_mutex_lock(tsd_tsdn(tsd), &ctl_mtx);
 	WRITE(newval, uint64_t);
 	if (newp != NULL) {
-		ctl_refresh(tsd_tsdn(tsd));
+		ctl_refresh(tsd_tsdn(tsd), ARENA_STATS_MERGE_ALL);
 	}
 	READ(ctl_arenas->epoch, uint64_t);
 
@@ -2195,6 +2659,8 @@ CTL_RO_NL_GEN(
     opt_percpu_arena, percpu_arena_mode_names[opt_percpu_arena], const char *)
 CTL_RO_NL_GEN(opt_mutex_max_spin, opt_mutex_max_spin, int64_t)
 CTL_RO_NL_GEN(opt_oversize_threshold, opt_oversize_threshold, size_t)
+CTL_RO_NL_GEN(opt_lec_max_bytes, opt_lec_max_bytes, size_t)
+CTL_RO_NL_GEN(opt_lec_max_alloc, opt_lec_max_alloc, size_t)
 CTL_RO_NL_GEN(opt_background_thread, opt_background_thread, bool)
 CTL_RO_NL_GEN(opt_max_background_threads, opt_max_background_threads, size_t)
 CTL_RO_NL_GEN(opt_dirty_decay_ms, opt_dirty_decay_ms, ssize_t)
@@ -2203,6 +2669,10 @@ CTL_RO_NL_GEN(opt_stats_print, opt_stats_print, bool)
 CTL_RO_NL_GEN(opt_stats_print_opts, opt_stats_print_opts, const char *)
 CTL_RO_NL_GEN(opt_stats_interval, opt_stats_interval, int64_t)
 CTL_RO_NL_GEN(opt_stats_interval_opts, opt_stats_interval_opts, const char *)
+CTL_RO_NL_CGEN(config_stats, opt_stats_latency_sample,
+    opt_stats_latency_sample, int64_t)
+CTL_RO_NL_CGEN(config_stats, opt_arena_stats_enabled, opt_arena_stats_enabled,
+    bool)
 CTL_RO_NL_CGEN(config_fill, opt_junk, opt_junk, const char *)
 CTL_RO_NL_CGEN(config_fill, opt_zero, opt_zero, bool)
 CTL_RO_NL_CGEN(config_utrace, opt_utrace, opt_utrace, bool)
@@ -2220,6 +2690,12 @@ CTL_RO_NL_GEN(opt_tcache_nslots_large, opt_tcache_nslots_large, unsigned)
 CTL_RO_NL_GEN(opt_lg_tcache_nslots_mul, opt_lg_tcache_nslots_mul, ssize_t)
 CTL_RO_NL_GEN(opt_tcache_gc_incr_bytes, opt_tcache_gc_incr_bytes, size_t)
 CTL_RO_NL_GEN(opt_tcache_gc_delay_bytes, opt_tcache_gc_delay_bytes, size_t)
+CTL_RO_NL_GEN(opt_tcache_bytes_budget, opt_tcache_bytes_budget, size_t)
+CTL_RO_NL_CGEN(config_stats, opt_tcache_idle_reclaim_ms,
+    opt_tcache_idle_reclaim_ms, ssize_t)
+CTL_RO_NL_GEN(opt_tcache_pool_max, opt_tcache_pool_max, unsigned)
+CTL_RO_NL_GEN(
+    opt_tcache_pool_keep_cached, opt_tcache_pool_keep_cached, bool)
 CTL_RO_NL_GEN(
     opt_lg_tcache_flush_small_div, opt_lg_tcache_flush_small_div, unsigned)
 CTL_RO_NL_GEN(
@@ -2236,9 +2712,12 @@ CTL_RO_NL_CGEN(
     config_prof, opt_prof_thread_active_init, opt_prof_thread_active_init, bool)
 CTL_RO_NL_CGEN(config_prof, opt_prof_bt_max, opt_prof_bt_max, unsigned)
 CTL_RO_NL_CGEN(config_prof, opt_lg_prof_sample, opt_lg_prof_sample, size_t)
+CTL_RO_NL_CGEN(
+    config_prof, opt_prof_overhead_ppm, opt_prof_overhead_ppm, unsigned)
 CTL_RO_NL_CGEN(config_prof, opt_experimental_lg_prof_threshold,
     opt_experimental_lg_prof_threshold, size_t)
 CTL_RO_NL_CGEN(config_prof, opt_prof_accum, opt_prof_accum, bool)
+CTL_RO_NL_CGEN(config_prof, opt_prof_lifetime, opt_prof_lifetime, bool)
 CTL_RO_NL_CGEN(
     config_prof, opt_prof_pid_namespace, opt_prof_pid_namespace, bool)
 CTL_RO_NL_CGEN(config_prof, opt_lg_prof_interval, opt_lg_prof_interval, ssize_t)
@@ -2249,6 +2728,12 @@ CTL_RO_NL_CGEN(config_prof, opt_prof_leak_error, opt_prof_leak_error, bool)
 CTL_RO_NL_CGEN(
     config_prof, opt_prof_recent_alloc_max, opt_prof_recent_alloc_max, ssize_t)
 CTL_RO_NL_CGEN(config_prof, opt_prof_stats, opt_prof_stats, bool)
+CTL_RO_NL_CGEN(config_prof, opt_prof_callsite, opt_prof_callsite, bool)
+CTL_RO_NL_CGEN(config_prof, opt_prof_pprof, opt_prof_pprof, bool)
+CTL_RO_NL_CGEN(config_prof, opt_prof_bg_dump_ms, opt_prof_bg_dump_ms, ssize_t)
+CTL_RO_NL_CGEN(config_prof, opt_prof_contention, opt_prof_contention, bool)
+CTL_RO_NL_CGEN(config_prof, opt_lg_prof_contention_sample,
+    opt_lg_prof_contention_sample, size_t)
 CTL_RO_NL_CGEN(
     config_prof, opt_prof_sys_thread_name, opt_prof_sys_thread_name, bool)
 CTL_RO_NL_CGEN(config_prof, opt_prof_time_res,
@@ -2459,6 +2944,35 @@ label_return:
 	return ret;
 }
 
+static int
+thread_tcache_bytes_budget_ctl(tsd_t *tsd, const size_t *mib, size_t miblen,
+    void *oldp, size_t *oldlenp, void *newp, size_t newlen) {
+	int    ret;
+	size_t oldval;
+
+	/* pointer to tcache_t always exists even with tcache disabled. */
+	tcache_t *tcache = tsd_tcachep_get(tsd);
+	assert(tcache != NULL);
+	oldval = tcache->tcache_slow->bytes_budget;
+	READ(oldval, size_t);
+
+	if (newp != NULL) {
+		if (newlen != sizeof(size_t)) {
+			ret = EINVAL;
+			goto label_return;
+		}
+		size_t new_bytes_budget = oldval;
+		WRITE(new_bytes_budget, size_t);
+		if (new_bytes_budget != oldval) {
+			thread_tcache_bytes_budget_set(tsd, new_bytes_budget);
+		}
+	}
+
+	ret = 0;
+label_return:
+	return ret;
+}
+
 static int
 thread_tcache_flush_ctl(tsd_t *tsd, const size_t *mib, size_t miblen,
     void *oldp, size_t *oldlenp, void *newp, size_t newlen) {
@@ -2571,6 +3085,34 @@ label_return:
 	return ret;
 }
 
+static int
+thread_tag_ctl(tsd_t *tsd, const size_t *mib, size_t miblen, void *oldp,
+    size_t *oldlenp, void *newp, size_t newlen) {
+	int      ret;
+	unsigned oldval;
+
+	if (!config_stats) {
+		return ENOENT;
+	}
+
+	oldval = alloc_tag_get(tsd);
+	if (newp != NULL) {
+		if (newlen != sizeof(unsigned)) {
+			ret = EINVAL;
+			goto label_return;
+		}
+		if (alloc_tag_set(tsd, *(unsigned *)newp)) {
+			ret = EINVAL;
+			goto label_return;
+		}
+	}
+	READ(oldval, unsigned);
+
+	ret = 0;
+label_return:
+	return ret;
+}
+
 static int
 thread_idle_ctl(tsd_t *tsd, const size_t *mib, size_t miblen, void *oldp,
     size_t *oldlenp, void *newp, size_t newlen) {
@@ -2854,7 +3396,8 @@ arena_i_destroy_ctl(tsd_t *tsd, const size_t *mib, size_t miblen, void *oldp,
 	arena_decay(tsd_tsdn(tsd), arena, false, true);
 	ctl_darena = arenas_i(MALLCTL_ARENAS_DESTROYED);
 	ctl_darena->initialized = true;
-	ctl_arena_refresh(tsd_tsdn(tsd), arena, ctl_darena, arena_ind, true);
+	ctl_arena_refresh(tsd_tsdn(tsd), arena, ctl_darena, arena_ind, true,
+	    ARENA_STATS_MERGE_ALL);
 	/* Destroy arena. */
 	arena_destroy(tsd, arena);
 	ctl_arena = arenas_i(arena_ind);
@@ -2871,6 +3414,115 @@ label_return:
 	return ret;
 }
 
+static int
+arena_i_stats_refresh_ctl(tsd_t *tsd, const size_t *mib, size_t miblen,
+    void *oldp, size_t *oldlenp, void *newp, size_t newlen) {
+	int      ret;
+	unsigned arena_ind;
+	unsigned what = MALLCTL_STATS_REFRESH_ALL;
+
+	malloc_mutex_lock(tsd_tsdn(tsd), &ctl_mtx);
+	WRITEONLY();
+	WRITE(what, unsigned);
+	if ((what & ~MALLCTL_STATS_REFRESH_ALL) != 0) {
+		ret = EINVAL;
+		goto label_return;
+	}
+	MIB_UNSIGNED(arena_ind, 1);
+	if (arena_ind == MALLCTL_ARENAS_ALL) {
+		ctl_refresh(tsd_tsdn(tsd), what);
+	} else {
+		arena_t *arena = (arena_ind < ctl_arenas->narenas)
+		    ? arena_get(tsd_tsdn(tsd), arena_ind, false)
+		    : NULL;
+		if (arena == NULL) {
+			ret = EFAULT;
+			goto label_return;
+		}
+		/*
+		 * Only the stats of this arena change; the summary keeps
+		 * reflecting the last full refresh.
+		 */
+		arenas_i(arena_ind)->initialized = true;
+		ctl_arena_refresh(
+		    tsd_tsdn(tsd), arena, NULL, arena_ind, false, what);
+	}
+
+	ret = 0;
+label_return:
+	malloc_mutex_unlock(tsd_tsdn(tsd), &ctl_mtx);
+	return ret;
+}
+
+static int
+arena_i_stats_enabled_ctl(tsd_t *tsd, const size_t *mib, size_t miblen,
+    void *oldp, size_t *oldlenp, void *newp, size_t newlen) {
+	int      ret;
+	unsigned arena_ind;
+	arena_t *arena;
+
+	if (!config_stats) {
+		return ENOENT;
+	}
+
+	malloc_mutex_lock(tsd_tsdn(tsd), &ctl_mtx);
+	MIB_UNSIGNED(arena_ind, 1);
+	if (arena_ind >= narenas_total_get()
+	    || (arena = arena_get(tsd_tsdn(tsd), arena_ind, false)) == NULL) {
+		ret = EFAULT;
+		goto label_return;
+	}
+	bool oldval = arena_stats_enabled_get(arena);
+	if (newp != NULL) {
+		bool newval;
+		WRITE(newval, bool);
+		if (arena_stats_enabled_set(arena, newval)) {
+			/* Once turned off, stats can't be turned back on. */
+			ret = EINVAL;
+			goto label_return;
+		}
+	}
+	READ(oldval, bool);
+
+	ret = 0;
+label_return:
+	malloc_mutex_unlock(tsd_tsdn(tsd), &ctl_mtx);
+	return ret;
+}
+
+static int
+arena_i_resident_scan_ctl(tsd_t *tsd, const size_t *mib, size_t miblen,
+    void *oldp, size_t *oldlenp, void *newp, size_t newlen) {
+	int      ret;
+	unsigned arena_ind;
+	arena_t *arena;
+
+	if (!config_stats) {
+		return ENOENT;
+	}
+
+	NEITHER_READ_NOR_WRITE();
+	MIB_UNSIGNED(arena_ind, 1);
+	malloc_mutex_lock(tsd_tsdn(tsd), &ctl_mtx);
+	if (arena_ind >= narenas_total_get()
+	    || (arena = arena_get(tsd_tsdn(tsd), arena_ind, false)) == NULL) {
+		malloc_mutex_unlock(tsd_tsdn(tsd), &ctl_mtx);
+		ret = EFAULT;
+		goto label_return;
+	}
+	/* Scans are slow; don't hold up other mallctl calls. */
+	malloc_mutex_unlock(tsd_tsdn(tsd), &ctl_mtx);
+
+	if (arena_resident_scan(tsd_tsdn(tsd), arena)) {
+		ret = EAGAIN;
+		goto label_return;
+	}
+
+	ret = 0;
+label_return:
+	return ret;
+}
+
 static int
 arena_i_dss_ctl(tsd_t *tsd, const size_t *mib, size_t miblen, void *oldp,
     size_t *oldlenp, void *newp, size_t newlen) {
@@ -3197,14 +3849,14 @@ arenas_narenas_ctl(tsd_t *tsd, const size_t *mib, size_t miblen, void *oldp,
 	int      ret;
 	unsigned narenas;
 
-	malloc_mutex_lock(tsd_tsdn(tsd), &ctl_mtx);
+	ctl_mtx_lock(tsd_tsdn(tsd));
 	READONLY();
 	narenas = ctl_arenas->narenas;
 	READ(narenas, unsigned);
 
 	ret = 0;
 label_return:
-	malloc_mutex_unlock(tsd_tsdn(tsd), &ctl_mtx);
+	ctl_mtx_unlock(tsd_tsdn(tsd));
 	return ret;
 }
 
@@ -3280,6 +3932,18 @@ arenas_lextent_i_index(
 	return super_arenas_lextent_i_node;
 }
 
+CTL_RO_NL_GEN(arenas_nlatency_buckets, LATENCY_NBUCKETS, unsigned)
+CTL_RO_NL_GEN(arenas_latency_bucket_i_lower_ns,
+    latency_bucket_lower_ns((unsigned)mib[2]), uint64_t)
+static const ctl_named_node_t *
+arenas_latency_bucket_i_index(
+    tsdn_t *tsdn, const size_t *mib, size_t miblen, size_t i) {
+	if (i >= LATENCY_NBUCKETS) {
+		return NULL;
+	}
+	return super_arenas_latency_bucket_i_node;
+}
+
 static int
 arenas_create_ctl(tsd_t *tsd, const size_t *mib, size_t miblen, void *oldp,
     size_t *oldlenp, void *newp, size_t newlen) {
@@ -3528,8 +4192,113 @@ label_return:
 	return ret;
 }
 
+static int
+prof_contention_dump_ctl(tsd_t *tsd, const size_t *mib, size_t miblen,
+    void *oldp, size_t *oldlenp, void *newp, size_t newlen) {
+	int         ret;
+	const char *filename = NULL;
+
+	if (!config_prof || !opt_prof || !opt_prof_contention) {
+		return ENOENT;
+	}
+
+	WRITEONLY();
+	WRITE(filename, const char *);
+
+	if (prof_contention_dump(tsd, filename)) {
+		ret = EFAULT;
+		goto label_return;
+	}
+
+	ret = 0;
+label_return:
+	return ret;
+}
+
+static int
+prof_contention_reset_ctl(tsd_t *tsd, const size_t *mib, size_t miblen,
+    void *oldp, size_t *oldlenp, void *newp, size_t newlen) {
+	int ret;
+
+	if (!config_prof || !opt_prof || !opt_prof_contention) {
+		return ENOENT;
+	}
+
+	NEITHER_READ_NOR_WRITE();
+	prof_contention_reset();
+
+	ret = 0;
+label_return:
+	return ret;
+}
+
+static int
+prof_snapshot_ctl(tsd_t *tsd, const size_t *mib, size_t miblen, void *oldp,
+    size_t *oldlenp, void *newp, size_t newlen) {
+	int         ret;
+	const char *name = NULL;
+
+	if (!config_prof || !opt_prof) {
+		return ENOENT;
+	}
+
+	WRITEONLY();
+	WRITE(name, const char *);
+	if (name == NULL || strlen(name) >= PROF_SNAPSHOT_NAME_MAX) {
+		ret = EINVAL;
+		goto label_return;
+	}
+
+	if (prof_snapshot_take(tsd, name)) {
+		ret = EFAULT;
+		goto label_return;
+	}
+
+	ret = 0;
+label_return:
+	return ret;
+}
+
+typedef struct prof_diff_packet_s prof_diff_packet_t;
+struct prof_diff_packet_s {
+	const char *name;
+	size_t      threshold;
+	write_cb_t *write_cb;
+	void       *cbopaque;
+};
+
+static int
+prof_diff_ctl(tsd_t *tsd, const size_t *mib, size_t miblen, void *oldp,
+    size_t *oldlenp, void *newp, size_t newlen) {
+	int ret;
+
+	if (!config_prof || !opt_prof) {
+		return ENOENT;
+	}
+
+	WRITEONLY();
+	prof_diff_packet_t packet;
+	ASSURED_WRITE(packet, prof_diff_packet_t);
+	if (packet.name == NULL) {
+		ret = EINVAL;
+		goto label_return;
+	}
+
+	if (prof_snapshot_diff(tsd, packet.name, packet.threshold,
+	        packet.write_cb, packet.cbopaque)) {
+		ret = EINVAL;
+		goto label_return;
+	}
+
+	ret = 0;
+label_return:
+	return ret;
+}
+
 CTL_RO_NL_CGEN(config_prof, prof_interval, prof_interval, uint64_t)
 CTL_RO_NL_CGEN(config_prof, lg_prof_sample, lg_prof_sample, size_t)
+CTL_RO_NL_CGEN(config_prof, prof_lg_sample_effective,
+    prof_lg_sample_effective(), size_t)
 
 static int
 prof_log_start_ctl(tsd_t *tsd, const size_t *mib, size_t miblen, void *oldp,
@@ -3867,11 +4636,68 @@ CTL_RO_CGEN(config_stats, stats_arenas_i_tcache_stashed_bytes,
     arenas_i(mib[2])->astats->astats.tcache_stashed_bytes, size_t)
 CTL_RO_CGEN(config_stats, stats_arenas_i_resident,
     arenas_i(mib[2])->astats->astats.resident, size_t)
+
+#define RO_RESIDENT_SCAN_CTL_GEN(kind)                                         \
+	CTL_RO_CGEN(config_stats, stats_arenas_i_resident_scan_##kind,         \
+	    atomic_load_zu(&arenas_i(mib[2])->astats->astats.resident_scan     \
+	                        [arena_resident_scan_##kind],                  \
+	        ATOMIC_RELAXED),                                               \
+	    size_t)
+RO_RESIDENT_SCAN_CTL_GEN(active_manual)
+RO_RESIDENT_SCAN_CTL_GEN(dirty)
+RO_RESIDENT_SCAN_CTL_GEN(muzzy)
+RO_RESIDENT_SCAN_CTL_GEN(retained)
+RO_RESIDENT_SCAN_CTL_GEN(hpa_nonfull)
+RO_RESIDENT_SCAN_CTL_GEN(hpa_nonfull_huge)
+#undef RO_RESIDENT_SCAN_CTL_GEN
 CTL_RO_CGEN(config_stats, stats_arenas_i_abandoned_vm,
     atomic_load_zu(
         &arenas_i(mib[2])->astats->astats.pa_shard_stats.pac_stats.abandoned_vm,
         ATOMIC_RELAXED),
     size_t)
+CTL_RO_CGEN(config_stats, stats_arenas_i_lec_bytes,
+    arenas_i(mib[2])->astats->astats.pa_shard_stats.lec_stats.bytes, size_t)
+CTL_RO_CGEN(config_stats, stats_arenas_i_lec_hits,
+    arenas_i(mib[2])->astats->astats.pa_shard_stats.lec_stats.nhits, uint64_t)
+CTL_RO_CGEN(config_stats, stats_arenas_i_lec_misses,
+    arenas_i(mib[2])->astats->astats.pa_shard_stats.lec_stats.nmisses,
+    uint64_t)
+CTL_RO_CGEN(config_stats, stats_arenas_i_lec_evictions,
+    arenas_i(mib[2])->astats->astats.pa_shard_stats.lec_stats.nevictions,
+    uint64_t)
+
+#define STATS_ARENAS_I_LATENCY_SITE(mib)                                      \
+	(&arenas_i((mib)[2])->astats->astats.latency.hists[(mib)[4]])
+CTL_RO_CGEN(config_stats, stats_arenas_i_latency_site_count,
+    locked_read_u64_unsynchronized(&STATS_ARENAS_I_LATENCY_SITE(mib)->count),
+    uint64_t)
+CTL_RO_CGEN(config_stats, stats_arenas_i_latency_site_total_ns,
+    locked_read_u64_unsynchronized(
+        &STATS_ARENAS_I_LATENCY_SITE(mib)->total_ns),
+    uint64_t)
+CTL_RO_CGEN(config_stats, stats_arenas_i_latency_site_p50_ns,
+    latency_hist_quantile_ns(STATS_ARENAS_I_LATENCY_SITE(mib), 500000),
+    uint64_t)
+CTL_RO_CGEN(config_stats, stats_arenas_i_latency_site_p99_ns,
+    latency_hist_quantile_ns(STATS_ARENAS_I_LATENCY_SITE(mib), 990000),
+    uint64_t)
+CTL_RO_CGEN(config_stats, stats_arenas_i_latency_site_p999_ns,
+    latency_hist_quantile_ns(STATS_ARENAS_I_LATENCY_SITE(mib), 999000),
+    uint64_t)
+CTL_RO_CGEN(config_stats, stats_arenas_i_latency_site_buckets_j,
+    locked_read_u64_unsynchronized(
+        &STATS_ARENAS_I_LATENCY_SITE(mib)->buckets[mib[6]]),
+    uint64_t)
+#undef STATS_ARENAS_I_LATENCY_SITE
+
+static const ctl_named_node_t *
+stats_arenas_i_latency_site_buckets_j_index(
+    tsdn_t *tsdn, const size_t *mib, size_t miblen, size_t j) {
+	if (j >= LATENCY_NBUCKETS) {
+		return NULL;
+	}
+	return stats_arenas_i_latency_site_buckets_j_node;
+}
 
 CTL_RO_CGEN(config_stats, stats_arenas_i_hpa_sec_bytes,
     arenas_i(mib[2])->astats->hpastats.secstats.bytes, size_t)
@@ -3951,6 +4777,66 @@ RO_MUTEX_CTL_GEN(
     arenas_i_bins_j_mutex, arenas_i(mib[2])->astats->bstats[mib[4]].mutex_data)
 #undef RO_MUTEX_CTL_GEN
 
+/* The mutex is mib[2] (global) or mib[4] (per arena), the bucket the last. */
+CTL_RO_CGEN(config_stats, stats_mutexes_wait_hist_j,
+    ctl_stats->mutex_prof_data[mib[2]].wait_hist[mib[4]], uint64_t)
+CTL_RO_CGEN(config_stats, stats_arenas_i_mutexes_wait_hist_j,
+    arenas_i(mib[2])->astats->astats.mutex_prof_data[mib[4]].wait_hist[mib[6]],
+    uint64_t)
+
+static const ctl_named_node_t *
+stats_mutexes_wait_hist_j_index(
+    tsdn_t *tsdn, const size_t *mib, size_t miblen, size_t j) {
+	if (j >= MUTEX_PROF_WAIT_NBUCKETS) {
+		return NULL;
+	}
+	return stats_mutexes_wait_hist_j_node;
+}
+
+static const ctl_named_node_t *
+stats_arenas_i_mutexes_wait_hist_j_index(
+    tsdn_t *tsdn, const size_t *mib, size_t miblen, size_t j) {
+	if (j >= MUTEX_PROF_WAIT_NBUCKETS) {
+		return NULL;
+	}
+	return stats_arenas_i_mutexes_wait_hist_j_node;
+}
+
+CTL_RO_CGEN(config_stats, stats_tags_i_allocated,
+    ctl_stats->tag_allocated[mib[2]], uint64_t)
+CTL_RO_CGEN(config_stats, stats_tags_i_deallocated,
+    ctl_stats->tag_deallocated[mib[2]], uint64_t)
+/* Negative if the tag freed more than it allocated; see alloc_tag.h. */
+CTL_RO_CGEN(config_stats, stats_tags_i_live,
+    (int64_t)(ctl_stats->tag_allocated[mib[2]]
+        - ctl_stats->tag_deallocated[mib[2]]),
+    int64_t)
+
+static const ctl_named_node_t *
+stats_tags_i_index(tsdn_t *tsdn, const size_t *mib, size_t miblen, size_t i) {
+	if (!config_stats || i >= ALLOC_TAG_NTAGS) {
+		return NULL;
+	}
+	return super_stats_tags_i_node;
+}
+
+CTL_RO_CGEN(config_stats && config_prof, stats_prof_callsites_i_addr,
+    (void *)ctl_stats->prof_callsites[mib[2]].addr, void *)
+CTL_RO_CGEN(config_stats && config_prof, stats_prof_callsites_i_count,
+    ctl_stats->prof_callsites[mib[2]].objs_shifted >> SC_LG_TINY_MIN,
+    uint64_t)
+CTL_RO_CGEN(config_stats && config_prof, stats_prof_callsites_i_bytes,
+    ctl_stats->prof_callsites[mib[2]].bytes, uint64_t)
+
+static const ctl_named_node_t *
+stats_prof_callsites_i_index(
+    tsdn_t *tsdn, const size_t *mib, size_t miblen, size_t i) {
+	if (!(config_stats && config_prof) || i >= PROF_CALLSITE_NTOP) {
+		return NULL;
+	}
+	return super_stats_prof_callsites_i_node;
+}
+
 /* Resets all mutex stats, including global, arena and bin mutexes. */
 static int
 stats_mutexes_reset_ctl(tsd_t *tsd, const size_t *mib, size_t miblen,
@@ -3972,7 +4858,9 @@ stats_mutexes_reset_ctl(tsd_t *tsd, const size_t *mib, size_t miblen,
 		MUTEX_PROF_RESET(background_thread_lock);
 	}
 	if (config_prof && opt_prof) {
-		MUTEX_PROF_RESET(bt2gctx_mtx);
+		for (unsigned i = 0; i < PROF_BT2GCTX_NSHARDS; i++) {
+			MUTEX_PROF_RESET(bt2gctx_locks[i]);
+		}
 		MUTEX_PROF_RESET(tdatas_mtx);
 		MUTEX_PROF_RESET(prof_dump_mtx);
 		MUTEX_PROF_RESET(prof_recent_alloc_mtx);
@@ -3988,7 +4876,9 @@ stats_mutexes_reset_ctl(tsd_t *tsd, const size_t *mib, size_t miblen,
 		if (!arena) {
 			continue;
 		}
-		MUTEX_PROF_RESET(arena->large_mtx);
+		for (unsigned j = 0; j < ARENA_LARGE_NSHARDS; j++) {
+			MUTEX_PROF_RESET(arena->large[j].mtx);
+		}
 		MUTEX_PROF_RESET(arena->pa_shard.edata_cache.mtx);
 		MUTEX_PROF_RESET(arena->pa_shard.pac.ecache_dirty.mtx);
 		MUTEX_PROF_RESET(arena->pa_shard.pac.ecache_muzzy.mtx);
@@ -4228,7 +5118,7 @@ static const ctl_named_node_t *
 stats_arenas_i_index(tsdn_t *tsdn, const size_t *mib, size_t miblen, size_t i) {
 	const ctl_named_node_t *ret;
 
-	malloc_mutex_lock(tsdn, &ctl_mtx);
+	ctl_mtx_lock(tsdn);
 	if (ctl_arenas_i_verify(i)) {
 		ret = NULL;
 		goto label_return;
@@ -4236,7 +5126,7 @@ stats_arenas_i_index(tsdn_t *tsdn, const size_t *mib, size_t miblen, size_t i) {
 
 	ret = super_stats_arenas_i_node;
 label_return:
-	malloc_mutex_unlock(tsdn, &ctl_mtx);
+	ctl_mtx_unlock(tsdn);
 	return ret;
 }
 
@@ -4678,6 +5568,119 @@ label_return:
 	return ret;
 }
 
+/*
+ * Subtrees experimental.batch_read may read from.  Checked on the MIB before
+ * the lookup, since the index functions of other subtrees take ctl_mtx.
+ */
+static const char *const ctl_batch_subtrees[] = {
+    "version", "config", "opt", "arenas", "stats"};
+
+static bool
+ctl_batch_readable_mib(const size_t *mib, size_t miblen) {
+	if (miblen == 0 || mib[0] >= sizeof(root_node) / sizeof(root_node[0])) {
+		return false;
+	}
+	for (size_t i = 0; i < sizeof(ctl_batch_subtrees)
+	         / sizeof(ctl_batch_subtrees[0]);
+	     i++) {
+		if (strcmp(root_node[mib[0]].name, ctl_batch_subtrees[i]) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Whether node, within ctl_batch_subtrees, is a pure read. */
+static bool
+ctl_batch_readable(const ctl_named_node_t *node) {
+	return node->ctl != arenas_create_ctl && node->ctl != arenas_lookup_ctl
+	    && node->ctl != stats_mutexes_reset_ctl;
+}
+
+typedef struct batch_read_elm_s batch_read_elm_t;
+struct batch_read_elm_s {
+	/* Input. */
+	const size_t *mib;
+	size_t        miblen;
+	void         *oldp;
+	/* Input: size of the oldp buffer; output: size of the value read. */
+	size_t oldlen;
+	/* Output: what mallctlbymib() would have returned. */
+	int ret;
+};
+
+/*
+ * Reads a batch of MIBs, as if by one mallctlbymib() call each, but holding
+ * ctl_mtx across the whole batch, so that the values come from a single stats
+ * snapshot and the lock is only acquired once.  newp / newlen pass an array of
+ * batch_read_elm_t.  If oldp is non-NULL, it must point to a uint64_t: the
+ * stats are then refreshed first, as with the epoch mallctl, and the new epoch
+ * is returned.  The batch itself only fails (with EINVAL) if the arguments are
+ * malformed; per read errors are reported in the ret field of the elements.
+ *
+ * Only reads of the ctl_batch_subtrees are supported; other elements, those
+ * that would act rather than read, and those without an oldp, fail with
+ * EINVAL.
+ */
+static int
+experimental_batch_read_ctl(tsd_t *tsd, const size_t *mib, size_t miblen,
+    void *oldp, size_t *oldlenp, void *newp, size_t newlen) {
+	int ret;
+
+	size_t nelms = newlen / sizeof(batch_read_elm_t);
+	if (newp == NULL || nelms == 0
+	    || newlen != nelms * sizeof(batch_read_elm_t)) {
+		ret = EINVAL;
+		goto label_return;
+	}
+	if (oldp != NULL || oldlenp != NULL) {
+		VERIFY_READ(uint64_t);
+	}
+	if (ctl_mtx_batch_owned(tsd_tsdn(tsd))) {
+		/* Nested batch. */
+		ret = EINVAL;
+		goto label_return;
+	}
+
+	batch_read_elm_t *elms = (batch_read_elm_t *)newp;
+	malloc_mutex_lock(tsd_tsdn(tsd), &ctl_mtx);
+	atomic_store_p(&ctl_batch_owner, tsd, ATOMIC_RELAXED);
+	if (oldp != NULL) {
+		ctl_refresh(tsd_tsdn(tsd), ARENA_STATS_MERGE_ALL);
+		*(uint64_t *)oldp = ctl_arenas->epoch;
+	}
+	for (size_t i = 0; i < nelms; i++) {
+		batch_read_elm_t       *elm = &elms[i];
+		const ctl_named_node_t *node;
+
+		if (elm->oldp == NULL
+		    || !ctl_batch_readable_mib(elm->mib, elm->miblen)) {
+			elm->ret = EINVAL;
+			continue;
+		}
+		elm->ret = ctl_lookupbymib(
+		    tsd_tsdn(tsd), &node, elm->mib, elm->miblen);
+		if (elm->ret != 0) {
+			continue;
+		}
+		if (node == NULL || node->ctl == NULL) {
+			/* Partial MIB. */
+			elm->ret = ENOENT;
+		} else if (!ctl_batch_readable(node)) {
+			elm->ret = EINVAL;
+		} else {
+			elm->ret = node->ctl(tsd, elm->mib, elm->miblen,
+			    elm->oldp, &elm->oldlen, NULL, 0);
+		}
+	}
+	atomic_store_p(&ctl_batch_owner, NULL, ATOMIC_RELAXED);
+	malloc_mutex_unlock(tsd_tsdn(tsd), &ctl_mtx);
+
+	ret = 0;
+label_return:
+	return ret;
+}
+
 static int
 prof_stats_bins_i_live_ctl(tsd_t *tsd, const size_t *mib, size_t miblen,
     void *oldp, size_t *oldlenp, void *newp, size_t newlen) {
@@ -19,6 +19,33 @@ ecache_init(tsdn_t *tsdn, ecache_t *ecache, extent_state_t state, unsigned ind,
 	return false;
 }
 
+static size_t
+ecache_eset_resident_ranges(
+    eset_t *eset, pages_range_t *ranges, size_t nranges, size_t n) {
+	for (edata_t *edata = edata_list_inactive_first(&eset->lru);
+	     edata != NULL; edata = edata_list_inactive_next(&eset->lru, edata)) {
+		if (n < nranges) {
+			ranges[n].addr = edata_base_get(edata);
+			ranges[n].size = edata_size_get(edata);
+			ranges[n].huge = false;
+		}
+		n++;
+	}
+	return n;
+}
+
+size_t
+ecache_resident_ranges(
+    tsdn_t *tsdn, ecache_t *ecache, pages_range_t *ranges, size_t nranges) {
+	malloc_mutex_lock(tsdn, &ecache->mtx);
+	size_t n = ecache_eset_resident_ranges(
+	    &ecache->eset, ranges, nranges, 0);
+	n = ecache_eset_resident_ranges(
+	    &ecache->guarded_eset, ranges, nranges, n);
+	malloc_mutex_unlock(tsdn, &ecache->mtx);
+	return n;
+}
+
 void
 ecache_prefork(tsdn_t *tsdn, ecache_t *ecache) {
 	malloc_mutex_prefork(tsdn, &ecache->mtx);
@@ -734,8 +734,12 @@ extent_grow_retained(tsdn_t *tsdn, pac_t *pac, ehooks_t *ehooks, size_t size,
 	bool zeroed = false;
 	bool committed = false;
 
+	latency_timer_t timer;
+	latency_timer_start(tsdn, &timer, latency_site_pages_map);
 	void *ptr = ehooks_alloc(
 	    tsdn, ehooks, NULL, alloc_size, PAGE, &zeroed, &committed);
+	latency_timer_stop(tsdn, &timer, pac->latency,
+	    LOCKEDINT_MTX(*pac->stats_mtx));
 
 	if (ptr == NULL) {
 		edata_cache_put(tsdn, pac->edata_cache, edata);
@@ -1108,9 +1112,13 @@ extent_alloc_wrapper(tsdn_t *tsdn, pac_t *pac, ehooks_t *ehooks, void *new_addr,
 	if (edata == NULL) {
 		return NULL;
 	}
-	size_t palignment = ALIGNMENT_CEILING(alignment, PAGE);
-	void  *addr = ehooks_alloc(
-            tsdn, ehooks, new_addr, size, palignment, &zero, commit);
+	size_t          palignment = ALIGNMENT_CEILING(alignment, PAGE);
+	latency_timer_t timer;
+	latency_timer_start(tsdn, &timer, latency_site_pages_map);
+	void *addr = ehooks_alloc(
+	    tsdn, ehooks, new_addr, size, palignment, &zero, commit);
+	latency_timer_stop(tsdn, &timer, pac->latency,
+	    LOCKEDINT_MTX(*pac->stats_mtx));
 	if (addr == NULL) {
 		edata_cache_put(tsdn, pac->edata_cache, edata);
 		return NULL;
@@ -170,6 +170,15 @@ hpa_shard_stats_merge(
 	sec_stats_merge(tsdn, &shard->sec, &dst->secstats);
 }
 
+size_t
+hpa_shard_resident_ranges(
+    tsdn_t *tsdn, hpa_shard_t *shard, pages_range_t *ranges, size_t nranges) {
+	malloc_mutex_lock(tsdn, &shard->mtx);
+	size_t n = psset_resident_ranges(&shard->psset, ranges, nranges);
+	malloc_mutex_unlock(tsdn, &shard->mtx);
+	return n;
+}
+
 static bool
 hpa_is_hugify_eager(hpa_shard_t *shard) {
 	return shard->opts.hugify_style == hpa_hugify_style_eager;
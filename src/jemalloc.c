@@ -1448,6 +1448,13 @@ malloc_conf_init_helper(sc_data_t *sc_data, unsigned bin_shard_sizes[SC_NBINS],
 				    v, vlen, opt_stats_interval_opts);
 				CONF_CONTINUE;
 			}
+			if (config_stats) {
+				CONF_HANDLE_INT64_T(opt_stats_latency_sample,
+				    "stats_latency_sample", -1, INT64_MAX,
+				    CONF_CHECK_MIN, CONF_DONT_CHECK_MAX, false)
+				CONF_HANDLE_BOOL(opt_arena_stats_enabled,
+				    "arena_stats_enabled")
+			}
 			if (config_fill) {
 				if (CONF_MATCH("junk")) {
 					if (CONF_MATCH_VALUE("true")) {
@@ -1531,6 +1538,24 @@ malloc_conf_init_helper(sc_data_t *sc_data, unsigned bin_shard_sizes[SC_NBINS],
 			    "tcache_gc_delay_bytes", 0, SIZE_T_MAX,
 			    CONF_DONT_CHECK_MIN, CONF_DONT_CHECK_MAX,
 			    /* clip */ false)
+			/* Reclamation walks the tcache lists kept for stats. */
+			if (config_stats) {
+				CONF_HANDLE_SSIZE_T(opt_tcache_idle_reclaim_ms,
+				    "tcache_idle_reclaim_ms", -1,
+				    NSTIME_SEC_MAX * KQU(1000) < QU(SSIZE_MAX)
+				        ? NSTIME_SEC_MAX * KQU(1000)
+				        : SSIZE_MAX);
+			}
+			CONF_HANDLE_SIZE_T(opt_tcache_bytes_budget,
+			    "tcache_bytes_budget", 0, SIZE_T_MAX,
+			    CONF_DONT_CHECK_MIN, CONF_DONT_CHECK_MAX,
+			    /* clip */ false)
+			CONF_HANDLE_UNSIGNED(opt_tcache_pool_max,
+			    "tcache_pool_max", 0, TCACHE_POOL_MAX_LIMIT,
+			    CONF_DONT_CHECK_MIN, CONF_CHECK_MAX,
+			    /* clip */ true)
+			CONF_HANDLE_BOOL(opt_tcache_pool_keep_cached,
+			    "tcache_pool_keep_cached")
 			CONF_HANDLE_UNSIGNED(opt_lg_tcache_flush_small_div,
 			    "lg_tcache_flush_small_div", 1, 16, CONF_CHECK_MIN,
 			    CONF_CHECK_MAX, /* clip */ true)
@@ -1557,6 +1582,11 @@ malloc_conf_init_helper(sc_data_t *sc_data, unsigned bin_shard_sizes[SC_NBINS],
 			CONF_HANDLE_SIZE_T(opt_oversize_threshold,
 			    "oversize_threshold", 0, SC_LARGE_MAXCLASS,
 			    CONF_DONT_CHECK_MIN, CONF_CHECK_MAX, false)
+			CONF_HANDLE_SIZE_T(opt_lec_max_bytes, "lec_max_bytes", 0,
+			    0, CONF_DONT_CHECK_MIN, CONF_DONT_CHECK_MAX, false)
+			CONF_HANDLE_SIZE_T(opt_lec_max_alloc, "lec_max_alloc",
+			    PAGE, SC_LARGE_MAXCLASS, CONF_CHECK_MIN,
+			    CONF_CHECK_MAX, true)
 			CONF_HANDLE_SIZE_T(opt_lg_extent_max_active_fit,
 			    "lg_extent_max_active_fit", 0,
 			    (sizeof(size_t) << 3), CONF_DONT_CHECK_MIN,
@@ -1747,12 +1777,17 @@ malloc_conf_init_helper(sc_data_t *sc_data, unsigned bin_shard_sizes[SC_NBINS],
 				    "lg_prof_sample", 0,
 				    (sizeof(uint64_t) << 3) - 1,
 				    CONF_DONT_CHECK_MIN, CONF_CHECK_MAX, true)
+				CONF_HANDLE_UNSIGNED(opt_prof_overhead_ppm,
+				    "prof_overhead_ppm", 0, 1000000,
+				    CONF_DONT_CHECK_MIN, CONF_CHECK_MAX, true)
 				CONF_HANDLE_SIZE_T(
 				    opt_experimental_lg_prof_threshold,
 				    "experimental_lg_prof_threshold", 0,
 				    (sizeof(uint64_t) << 3) - 1,
 				    CONF_DONT_CHECK_MIN, CONF_CHECK_MAX, true)
 				CONF_HANDLE_BOOL(opt_prof_accum, "prof_accum")
+				CONF_HANDLE_BOOL(
+				    opt_prof_lifetime, "prof_lifetime")
 				CONF_HANDLE_UNSIGNED(opt_prof_bt_max,
 				    "prof_bt_max", 1, PROF_BT_MAX_LIMIT,
 				    CONF_CHECK_MIN, CONF_CHECK_MAX,
@@ -1761,16 +1796,32 @@ malloc_conf_init_helper(sc_data_t *sc_data, unsigned bin_shard_sizes[SC_NBINS],
 				    "lg_prof_interval", -1,
 				    (sizeof(uint64_t) << 3) - 1)
 				CONF_HANDLE_BOOL(opt_prof_gdump, "prof_gdump")
+				CONF_HANDLE_SSIZE_T(opt_prof_bg_dump_ms,
+				    "prof_bg_dump_ms", -1,
+				    NSTIME_SEC_MAX * KQU(1000) < QU(SSIZE_MAX)
+				        ? NSTIME_SEC_MAX * KQU(1000)
+				        : SSIZE_MAX)
 				CONF_HANDLE_BOOL(opt_prof_final, "prof_final")
 				CONF_HANDLE_BOOL(opt_prof_leak, "prof_leak")
 				CONF_HANDLE_BOOL(
 				    opt_prof_leak_error, "prof_leak_error")
 				CONF_HANDLE_BOOL(opt_prof_log, "prof_log")
+				CONF_HANDLE_BOOL(
+				    opt_prof_log_binary, "prof_log_binary")
 				CONF_HANDLE_BOOL(opt_prof_pid_namespace,
 				    "prof_pid_namespace")
 				CONF_HANDLE_SSIZE_T(opt_prof_recent_alloc_max,
 				    "prof_recent_alloc_max", -1, SSIZE_MAX)
 				CONF_HANDLE_BOOL(opt_prof_stats, "prof_stats")
+				CONF_HANDLE_BOOL(
+				    opt_prof_callsite, "prof_callsite")
+				CONF_HANDLE_BOOL(opt_prof_pprof, "prof_pprof")
+				CONF_HANDLE_BOOL(
+				    opt_prof_contention, "prof_contention")
+				CONF_HANDLE_SIZE_T(opt_lg_prof_contention_sample,
+				    "lg_prof_contention_sample", 0,
+				    (sizeof(uint64_t) << 3) - 1,
+				    CONF_DONT_CHECK_MIN, CONF_CHECK_MAX, true)
 				CONF_HANDLE_BOOL(opt_prof_sys_thread_name,
 				    "prof_sys_thread_name")
 				if (CONF_MATCH("prof_time_resolution")) {
@@ -1931,6 +1982,13 @@ malloc_conf_init_check_deps(void) {
 		    "prof_final.\n");
 		return true;
 	}
+	if (opt_prof_overhead_ppm != 0 && !opt_prof_unbias) {
+		/* Raw counts taken at varying rates can't be unbiased. */
+		malloc_printf(
+		    "<jemalloc>: prof_overhead_ppm is set w/o "
+		    "prof_unbias.\n");
+		return true;
+	}
 	/* To emphasize in the stats output that opt is disabled when !debug. */
 	if (!config_debug) {
 		opt_debug_double_free_max_scan = 0;
@@ -2503,6 +2561,8 @@ struct dynamic_opts_s {
 	bool     zero;
 	unsigned tcache_ind;
 	unsigned arena_ind;
+	/* Return address of the public entry point, for opt_prof_callsite. */
+	const void *callsite;
 };
 
 JEMALLOC_ALWAYS_INLINE void
@@ -2515,6 +2575,7 @@ dynamic_opts_init(dynamic_opts_t *dynamic_opts) {
 	dynamic_opts->zero = false;
 	dynamic_opts->tcache_ind = TCACHE_IND_AUTOMATIC;
 	dynamic_opts->arena_ind = ARENA_IND_AUTOMATIC;
+	dynamic_opts->callsite = NULL;
 }
 
 /*
@@ -2747,7 +2808,7 @@ imalloc_body(static_opts_t *sopts, dynamic_opts_t *dopts, tsd_t *tsd) {
 		bool prof_active = prof_active_get_unlocked();
 		bool sample_event = te_prof_sample_event_lookahead(tsd, usize);
 		prof_tctx_t *tctx = prof_alloc_prep(
-		    tsd, prof_active, sample_event);
+		    tsd, prof_active, sample_event, usize, dopts->callsite);
 
 		emap_alloc_ctx_t alloc_ctx;
 		if (likely(tctx == PROF_TCTX_SENTINEL)) {
@@ -2879,19 +2940,22 @@ imalloc(static_opts_t *sopts, dynamic_opts_t *dopts) {
 	/* We always need the tsd.  Let's grab it right away. */
 	tsd_t *tsd = tsd_fetch();
 	assert(tsd);
+	bool reclaim_busy = tcache_idle_reclaim_busy_begin(tsd);
+	int  err;
 	if (likely(tsd_fast(tsd))) {
 		/* Fast and common path. */
 		tsd_assert_fast(tsd);
 		sopts->slow = false;
-		return imalloc_body(sopts, dopts, tsd);
+		err = imalloc_body(sopts, dopts, tsd);
+	} else if (!tsd_get_allocates()
+	    && !imalloc_init_check(sopts, dopts)) {
+		err = ENOMEM;
 	} else {
-		if (!tsd_get_allocates() && !imalloc_init_check(sopts, dopts)) {
-			return ENOMEM;
-		}
-
 		sopts->slow = true;
-		return imalloc_body(sopts, dopts, tsd);
+		err = imalloc_body(sopts, dopts, tsd);
 	}
+	tcache_idle_reclaim_busy_end(tsd, reclaim_busy);
+	return err;
 }
 
 JEMALLOC_NOINLINE
@@ -2904,7 +2968,8 @@ malloc_default(size_t size) {
 	/*
 	 * This variant has logging hook on exit but not on entry.  It's callled
 	 * only by je_malloc, below, which emits the entry one for us (and, if
-	 * it calls us, does so only via tail call).
+	 * it calls us, does so only via tail call).  The latter also makes our
+	 * return address the one of je_malloc.
 	 */
 
 	static_opts_init(&sopts);
@@ -2917,6 +2982,7 @@ malloc_default(size_t size) {
 	dopts.result = &ret;
 	dopts.num_items = 1;
 	dopts.item_size = size;
+	dopts.callsite = util_return_address();
 
 	imalloc(&sopts, &dopts);
 	/*
@@ -2973,6 +3039,7 @@ JEMALLOC_ATTR(nonnull(1))
 	dopts.num_items = 1;
 	dopts.item_size = size;
 	dopts.alignment = alignment;
+	dopts.callsite = util_return_address();
 
 	ret = imalloc(&sopts, &dopts);
 	if (sopts.slow) {
@@ -3016,6 +3083,7 @@ JEMALLOC_ATTR(malloc) JEMALLOC_ALLOC_SIZE(2)
 	dopts.num_items = 1;
 	dopts.item_size = size;
 	dopts.alignment = alignment;
+	dopts.callsite = util_return_address();
 
 	imalloc(&sopts, &dopts);
 	if (sopts.slow) {
@@ -3051,6 +3119,7 @@ JEMALLOC_ATTR(malloc) JEMALLOC_ALLOC_SIZE2(1, 2)
 	dopts.num_items = num;
 	dopts.item_size = size;
 	dopts.zero = true;
+	dopts.callsite = util_return_address();
 
 	imalloc(&sopts, &dopts);
 	if (sopts.slow) {
@@ -3085,6 +3154,9 @@ ifree(tsd_t *tsd, void *ptr, tcache_t *tcache, bool slow_path) {
 	if (config_prof && opt_prof) {
 		prof_free(tsd, ptr, usize, &alloc_ctx);
 	}
+	if (config_stats && !alloc_ctx.slab) {
+		alloc_tag_dalloc(tsd, alloc_tag_large_get(tsd, ptr), usize);
+	}
 
 	if (likely(!slow_path)) {
 		idalloctm(tsd_tsdn(tsd), ptr, tcache, &alloc_ctx, false, false);
@@ -3162,6 +3234,9 @@ isfree(tsd_t *tsd, void *ptr, size_t usize, tcache_t *tcache, bool slow_path) {
 	if (config_prof && opt_prof) {
 		prof_free(tsd, ptr, usize, &alloc_ctx);
 	}
+	if (config_stats && !alloc_ctx.slab) {
+		alloc_tag_dalloc(tsd, alloc_tag_large_get(tsd, ptr), usize);
+	}
 	if (likely(!slow_path)) {
 		isdalloct(tsd_tsdn(tsd), ptr, usize, tcache, &alloc_ctx, false);
 	} else {
@@ -3188,6 +3263,7 @@ free_default(void *ptr) {
 		 */
 		tsd_t *tsd = tsd_fetch_min();
 		check_entry_exit_locking(tsd_tsdn(tsd));
+		bool reclaim_busy = tcache_idle_reclaim_busy_begin(tsd);
 
 		if (likely(tsd_fast(tsd))) {
 			tcache_t *tcache = tcache_get_from_ind(tsd,
@@ -3203,6 +3279,7 @@ free_default(void *ptr) {
 			ifree(tsd, ptr, tcache, /* slow */ true);
 		}
 
+		tcache_idle_reclaim_busy_end(tsd, reclaim_busy);
 		check_entry_exit_locking(tsd_tsdn(tsd));
 	}
 }
@@ -3264,6 +3341,7 @@ JEMALLOC_ATTR(malloc) je_memalign(size_t alignment, size_t size) {
 	dopts.num_items = 1;
 	dopts.item_size = size;
 	dopts.alignment = alignment;
+	dopts.callsite = util_return_address();
 
 	imalloc(&sopts, &dopts);
 	if (sopts.slow) {
@@ -3302,6 +3380,7 @@ JEMALLOC_ATTR(malloc) je_valloc(size_t size) {
 	dopts.num_items = 1;
 	dopts.item_size = size;
 	dopts.alignment = PAGE;
+	dopts.callsite = util_return_address();
 
 	imalloc(&sopts, &dopts);
 	if (sopts.slow) {
@@ -3343,6 +3422,7 @@ JEMALLOC_ATTR(malloc) je_pvalloc(size_t size) {
 	 */
 	dopts.item_size = PAGE_CEILING(size);
 	dopts.alignment = PAGE;
+	dopts.callsite = util_return_address();
 
 	imalloc(&sopts, &dopts);
 	if (sopts.slow) {
@@ -3492,6 +3572,7 @@ JEMALLOC_EXPORT JEMALLOC_ALLOCATOR JEMALLOC_RESTRICT_RETURN smallocx_return_t
 	dopts.result = &ret.ptr;
 	dopts.num_items = 1;
 	dopts.item_size = size;
+	dopts.callsite = util_return_address();
 	if (unlikely(flags != 0)) {
 		dopts.alignment = MALLOCX_ALIGN_GET(flags);
 		dopts.zero = MALLOCX_ZERO_GET(flags);
@@ -3530,6 +3611,7 @@ JEMALLOC_ATTR(malloc) JEMALLOC_ALLOC_SIZE(1)
 	dopts.result = &ret;
 	dopts.num_items = 1;
 	dopts.item_size = size;
+	dopts.callsite = util_return_address();
 	if (unlikely(flags != 0)) {
 		dopts.alignment = MALLOCX_ALIGN_GET(flags);
 		dopts.zero = MALLOCX_ZERO_GET(flags);
@@ -3586,12 +3668,14 @@ irallocx_prof_sample(tsdn_t *tsdn, void *old_ptr, size_t old_usize,
 JEMALLOC_ALWAYS_INLINE void *
 irallocx_prof(tsd_t *tsd, void *old_ptr, size_t old_usize, size_t size,
     size_t alignment, size_t usize, bool zero, tcache_t *tcache, arena_t *arena,
-    emap_alloc_ctx_t *alloc_ctx, hook_ralloc_args_t *hook_args) {
+    emap_alloc_ctx_t *alloc_ctx, hook_ralloc_args_t *hook_args,
+    const void *callsite) {
 	prof_info_t old_prof_info;
 	prof_info_get_and_reset_recent(tsd, old_ptr, alloc_ctx, &old_prof_info);
 	bool         prof_active = prof_active_get_unlocked();
 	bool         sample_event = te_prof_sample_event_lookahead(tsd, usize);
-	prof_tctx_t *tctx = prof_alloc_prep(tsd, prof_active, sample_event);
+	prof_tctx_t *tctx = prof_alloc_prep(
+	    tsd, prof_active, sample_event, usize, callsite);
 	void        *p;
 	if (unlikely(tctx != PROF_TCTX_SENTINEL)) {
 		p = irallocx_prof_sample(tsd_tsdn(tsd), old_ptr, old_usize,
@@ -3612,7 +3696,8 @@ irallocx_prof(tsd_t *tsd, void *old_ptr, size_t old_usize, size_t size,
 }
 
 static void *
-do_rallocx(void *ptr, size_t size, int flags, bool is_realloc) {
+do_rallocx(void *ptr, size_t size, int flags, bool is_realloc,
+    const void *callsite) {
 	void    *p;
 	tsd_t   *tsd;
 	size_t   usize;
@@ -3625,6 +3710,7 @@ do_rallocx(void *ptr, size_t size, int flags, bool is_realloc) {
 	assert(malloc_initialized() || IS_INITIALIZER);
 	tsd = tsd_fetch();
 	check_entry_exit_locking(tsd_tsdn(tsd));
+	bool reclaim_busy = tcache_idle_reclaim_busy_begin(tsd);
 
 	bool zero = zero_get(MALLOCX_ZERO_GET(flags), /* slow */ true);
 
@@ -3646,12 +3732,16 @@ do_rallocx(void *ptr, size_t size, int flags, bool is_realloc) {
 	if (aligned_usize_get(size, alignment, &usize, NULL, false)) {
 		goto label_oom;
 	}
+	/* Read before an in place resize charges the extent anew. */
+	unsigned old_tag = (config_stats && !alloc_ctx.slab)
+	    ? alloc_tag_large_get(tsd, ptr)
+	    : 0;
 
 	hook_ralloc_args_t hook_args = {
 	    is_realloc, {(uintptr_t)ptr, size, flags, 0}};
 	if (config_prof && opt_prof) {
 		p = irallocx_prof(tsd, ptr, old_usize, size, alignment, usize,
-		    zero, tcache, arena, &alloc_ctx, &hook_args);
+		    zero, tcache, arena, &alloc_ctx, &hook_args, callsite);
 		if (unlikely(p == NULL)) {
 			goto label_oom;
 		}
@@ -3664,10 +3754,14 @@ do_rallocx(void *ptr, size_t size, int flags, bool is_realloc) {
 		assert(usize == isalloc(tsd_tsdn(tsd), p));
 	}
 	assert(alignment == 0 || ((uintptr_t)p & (alignment - 1)) == ZU(0));
+	if (config_stats && !alloc_ctx.slab) {
+		alloc_tag_dalloc(tsd, old_tag, old_usize);
+	}
 	thread_alloc_event(tsd, usize);
 	thread_dalloc_event(tsd, old_usize);
 
 	UTRACE(ptr, size, p);
+	tcache_idle_reclaim_busy_end(tsd, reclaim_busy);
 	check_entry_exit_locking(tsd_tsdn(tsd));
 
 	if (config_fill && unlikely(opt_junk_alloc) && usize > old_usize
@@ -3687,6 +3781,7 @@ label_oom:
 		abort();
 	}
 	UTRACE(ptr, size, 0);
+	tcache_idle_reclaim_busy_end(tsd, reclaim_busy);
 	check_entry_exit_locking(tsd_tsdn(tsd));
 
 	return NULL;
@@ -3697,13 +3792,14 @@ JEMALLOC_ALLOCATOR JEMALLOC_RESTRICT_RETURN void JEMALLOC_NOTHROW *
 JEMALLOC_ALLOC_SIZE(2) je_rallocx(void *ptr, size_t size, int flags) {
 	LOG("core.rallocx.entry", "ptr: %p, size: %zu, flags: %d", ptr, size,
 	    flags);
-	void *ret = do_rallocx(ptr, size, flags, false);
+	void *ret = do_rallocx(
+	    ptr, size, flags, false, util_return_address());
 	LOG("core.rallocx.exit", "result: %p", ret);
 	return ret;
 }
 
 static void *
-do_realloc_nonnull_zero(void *ptr) {
+do_realloc_nonnull_zero(void *ptr, const void *callsite) {
 	if (config_stats) {
 		atomic_fetch_add_zu(&zero_realloc_count, 1, ATOMIC_RELAXED);
 	}
@@ -3714,11 +3810,12 @@ do_realloc_nonnull_zero(void *ptr) {
 		 * reduce the harm, and turn off the tcache while allocating, so
 		 * that we'll get a true first fit.
 		 */
-		return do_rallocx(ptr, 1, MALLOCX_TCACHE_NONE, true);
+		return do_rallocx(ptr, 1, MALLOCX_TCACHE_NONE, true, callsite);
 	} else if (opt_zero_realloc_action == zero_realloc_action_free) {
 		UTRACE(ptr, 0, 0);
 		tsd_t *tsd = tsd_fetch();
 		check_entry_exit_locking(tsd_tsdn(tsd));
+		bool reclaim_busy = tcache_idle_reclaim_busy_begin(tsd);
 
 		tcache_t *tcache = tcache_get_from_ind(tsd,
 		    TCACHE_IND_AUTOMATIC, /* slow */ true,
@@ -3727,6 +3824,7 @@ do_realloc_nonnull_zero(void *ptr) {
 		hook_invoke_dalloc(hook_dalloc_realloc, ptr, args);
 		ifree(tsd, ptr, tcache, true);
 
+		tcache_idle_reclaim_busy_end(tsd, reclaim_busy);
 		check_entry_exit_locking(tsd_tsdn(tsd));
 		return NULL;
 	} else {
@@ -3748,11 +3846,12 @@ JEMALLOC_ALLOC_SIZE(2) je_realloc(void *ptr, size_t size) {
 	LOG("core.realloc.entry", "ptr: %p, size: %zu\n", ptr, size);
 
 	if (likely(ptr != NULL && size != 0)) {
-		void *ret = do_rallocx(ptr, size, 0, true);
+		void *ret = do_rallocx(
+		    ptr, size, 0, true, util_return_address());
 		LOG("core.realloc.exit", "result: %p", ret);
 		return ret;
 	} else if (ptr != NULL && size == 0) {
-		void *ret = do_realloc_nonnull_zero(ptr);
+		void *ret = do_realloc_nonnull_zero(ptr, util_return_address());
 		LOG("core.realloc.exit", "result: %p", ret);
 		return ret;
 	} else {
@@ -3773,6 +3872,7 @@ JEMALLOC_ALLOC_SIZE(2) je_realloc(void *ptr, size_t size) {
 		dopts.result = &ret;
 		dopts.num_items = 1;
 		dopts.item_size = size;
+		dopts.callsite = util_return_address();
 
 		imalloc(&sopts, &dopts);
 		if (sopts.slow) {
@@ -3812,7 +3912,8 @@ ixallocx_prof_sample(tsdn_t *tsdn, void *ptr, size_t old_usize, size_t size,
 
 JEMALLOC_ALWAYS_INLINE size_t
 ixallocx_prof(tsd_t *tsd, void *ptr, size_t old_usize, size_t size,
-    size_t extra, size_t alignment, bool zero, emap_alloc_ctx_t *alloc_ctx) {
+    size_t extra, size_t alignment, bool zero, emap_alloc_ctx_t *alloc_ctx,
+    const void *callsite) {
 	/*
 	 * old_prof_info is only used for asserting that the profiling info
 	 * isn't changed by the ixalloc() call.
@@ -3823,8 +3924,9 @@ ixallocx_prof(tsd_t *tsd, void *ptr, size_t old_usize, size_t size,
 	/*
 	 * usize isn't knowable before ixalloc() returns when extra is non-zero.
 	 * Therefore, compute its maximum possible value and use that in
-	 * prof_alloc_prep() to decide whether to capture a backtrace.
-	 * prof_realloc() will use the actual usize to decide whether to sample.
+	 * prof_alloc_prep() to decide whether to capture a backtrace (or, with
+	 * opt_prof_callsite, what to charge the callsite with).  prof_realloc()
+	 * will use the actual usize to decide whether to sample.
 	 */
 	size_t usize_max;
 	if (aligned_usize_get(
@@ -3838,7 +3940,8 @@ ixallocx_prof(tsd_t *tsd, void *ptr, size_t old_usize, size_t size,
 	}
 	bool prof_active = prof_active_get_unlocked();
 	bool sample_event = te_prof_sample_event_lookahead(tsd, usize_max);
-	prof_tctx_t *tctx = prof_alloc_prep(tsd, prof_active, sample_event);
+	prof_tctx_t *tctx = prof_alloc_prep(
+	    tsd, prof_active, sample_event, usize_max, callsite);
 
 	size_t usize;
 	if (unlikely(tctx != PROF_TCTX_SENTINEL)) {
@@ -3914,6 +4017,9 @@ je_xallocx(void *ptr, size_t size, size_t extra, int flags) {
 	assert(alloc_ctx.szind != SC_NSIZES);
 	old_usize = emap_alloc_ctx_usize_get(&alloc_ctx);
 	assert(old_usize == isalloc(tsd_tsdn(tsd), ptr));
+	unsigned old_tag = (config_stats && !alloc_ctx.slab)
+	    ? edata_alloc_tag_get(old_edata)
+	    : 0;
 	/*
 	 * The API explicitly absolves itself of protecting against (size +
 	 * extra) numerical overflow, but we may need to clamp extra to avoid
@@ -3933,7 +4039,7 @@ je_xallocx(void *ptr, size_t size, size_t extra, int flags) {
 
 	if (config_prof && opt_prof) {
 		usize = ixallocx_prof(tsd, ptr, old_usize, size, extra,
-		    alignment, zero, &alloc_ctx);
+		    alignment, zero, &alloc_ctx, util_return_address());
 	} else {
 		usize = ixallocx_helper(tsd_tsdn(tsd), ptr, old_usize, size,
 		    extra, alignment, zero);
@@ -3949,6 +4055,9 @@ je_xallocx(void *ptr, size_t size, size_t extra, int flags) {
 	if (unlikely(usize == old_usize)) {
 		goto label_not_resized;
 	}
+	if (config_stats && !alloc_ctx.slab) {
+		alloc_tag_dalloc(tsd, old_tag, old_usize);
+	}
 	thread_alloc_event(tsd, usize);
 	thread_dalloc_event(tsd, old_usize);
 
@@ -4008,6 +4117,7 @@ je_dallocx(void *ptr, int flags) {
 	tsd_t *tsd = tsd_fetch_min();
 	bool   fast = tsd_fast(tsd);
 	check_entry_exit_locking(tsd_tsdn(tsd));
+	bool reclaim_busy = tcache_idle_reclaim_busy_begin(tsd);
 
 	unsigned  tcache_ind = mallocx_tcache_get(flags);
 	tcache_t *tcache = tcache_get_from_ind(tsd, tcache_ind, !fast,
@@ -4022,6 +4132,7 @@ je_dallocx(void *ptr, int flags) {
 		hook_invoke_dalloc(hook_dalloc_dallocx, ptr, args_raw);
 		ifree(tsd, ptr, tcache, true);
 	}
+	tcache_idle_reclaim_busy_end(tsd, reclaim_busy);
 	check_entry_exit_locking(tsd_tsdn(tsd));
 
 	LOG("core.dallocx.exit", "");
@@ -4046,6 +4157,7 @@ sdallocx_default(void *ptr, size_t size, int flags) {
 	bool   fast = tsd_fast(tsd);
 	size_t usize = inallocx(tsd_tsdn(tsd), size, flags);
 	check_entry_exit_locking(tsd_tsdn(tsd));
+	bool reclaim_busy = tcache_idle_reclaim_busy_begin(tsd);
 
 	unsigned  tcache_ind = mallocx_tcache_get(flags);
 	tcache_t *tcache = tcache_get_from_ind(tsd, tcache_ind, !fast,
@@ -4060,6 +4172,7 @@ sdallocx_default(void *ptr, size_t size, int flags) {
 		hook_invoke_dalloc(hook_dalloc_sdallocx, ptr, args_raw);
 		isfree(tsd, ptr, usize, tcache, true);
 	}
+	tcache_idle_reclaim_busy_end(tsd, reclaim_busy);
 	check_entry_exit_locking(tsd_tsdn(tsd));
 }
 
@@ -4114,7 +4227,9 @@ je_mallctl(
 
 	tsd = tsd_fetch();
 	check_entry_exit_locking(tsd_tsdn(tsd));
+	bool reclaim_busy = tcache_idle_reclaim_busy_begin(tsd);
 	ret = ctl_byname(tsd, name, oldp, oldlenp, newp, newlen);
+	tcache_idle_reclaim_busy_end(tsd, reclaim_busy);
 	check_entry_exit_locking(tsd_tsdn(tsd));
 
 	LOG("core.mallctl.exit", "result: %d", ret);
@@ -4156,7 +4271,9 @@ je_mallctlbymib(const size_t *mib, size_t miblen, void *oldp, size_t *oldlenp,
 
 	tsd = tsd_fetch();
 	check_entry_exit_locking(tsd_tsdn(tsd));
+	bool reclaim_busy = tcache_idle_reclaim_busy_begin(tsd);
 	ret = ctl_bymib(tsd, mib, miblen, oldp, oldlenp, newp, newlen);
+	tcache_idle_reclaim_busy_end(tsd, reclaim_busy);
 	check_entry_exit_locking(tsd_tsdn(tsd));
 	LOG("core.mallctlbymib.exit", "result: %d", ret);
 	return ret;
@@ -4253,6 +4370,7 @@ batch_alloc(void **ptrs, size_t num, size_t size, int flags) {
 
 	tsd_t *tsd = tsd_fetch();
 	check_entry_exit_locking(tsd_tsdn(tsd));
+	bool reclaim_busy = tcache_idle_reclaim_busy_begin(tsd);
 
 	size_t filled = 0;
 
@@ -4407,6 +4525,7 @@ batch_alloc(void **ptrs, size_t num, size_t size, int flags) {
 	}
 
 label_done:
+	tcache_idle_reclaim_busy_end(tsd, reclaim_busy);
 	check_entry_exit_locking(tsd_tsdn(tsd));
 	LOG("core.batch_alloc.exit", "result: %zu", filled);
 	return filled;
@@ -4468,7 +4587,7 @@ _malloc_prefork(void)
 	witness_prefork(tsd_witness_tsdp_get(tsd));
 	/* Acquire all mutexes in a safe order. */
 	ctl_prefork(tsd_tsdn(tsd));
-	tcache_prefork(tsd_tsdn(tsd));
+	tcache_prefork0(tsd_tsdn(tsd));
 	malloc_mutex_prefork(tsd_tsdn(tsd), &arenas_lock);
 	if (have_background_thread) {
 		background_thread_prefork0(tsd_tsdn(tsd));
@@ -4477,6 +4596,7 @@ _malloc_prefork(void)
 	if (have_background_thread) {
 		background_thread_prefork1(tsd_tsdn(tsd));
 	}
+	tcache_prefork1(tsd_tsdn(tsd));
 	/* Break arena prefork into stages to preserve lock order. */
 	for (i = 0; i < 9; i++) {
 		for (j = 0; j < narenas; j++) {
@@ -1,6 +1,7 @@
 #include "jemalloc/internal/jemalloc_preamble.h"
 #include "jemalloc/internal/jemalloc_internal_includes.h"
 
+#include "jemalloc/internal/alloc_tag.h"
 #include "jemalloc/internal/assert.h"
 #include "jemalloc/internal/emap.h"
 #include "jemalloc/internal/extent_mmap.h"
@@ -17,6 +18,15 @@ large_malloc(tsdn_t *tsdn, arena_t *arena, size_t usize, bool zero) {
 	return large_palloc(tsdn, arena, usize, CACHELINE, zero);
 }
 
+/* Records the tag that the allocation gets charged to; see alloc_tag.h. */
+static void
+large_alloc_tag_stamp(tsdn_t *tsdn, edata_t *edata) {
+	if (config_stats) {
+		edata_alloc_tag_set(edata,
+		    tsdn_null(tsdn) ? 0 : alloc_tag_get(tsdn_tsd(tsdn)));
+	}
+}
+
 void *
 large_palloc(
     tsdn_t *tsdn, arena_t *arena, size_t usize, size_t alignment, bool zero) {
@@ -34,20 +44,27 @@ large_palloc(
 	if (likely(!tsdn_null(tsdn))) {
 		arena = arena_choose_maybe_huge(tsdn_tsd(tsdn), arena, usize);
 	}
-	if (unlikely(arena == NULL)
-	    || (edata = arena_extent_alloc_large(
-	            tsdn, arena, usize, alignment, zero))
-	        == NULL) {
+	if (unlikely(arena == NULL)) {
+		return NULL;
+	}
+	latency_timer_t timer;
+	latency_timer_start(tsdn, &timer, latency_site_large_alloc);
+	edata = arena_extent_alloc_large(tsdn, arena, usize, alignment, zero);
+	if (edata == NULL) {
 		return NULL;
 	}
+	large_alloc_tag_stamp(tsdn, edata);
 
 	/* See comments in arena_bin_slabs_full_insert(). */
 	if (!arena_is_auto(arena)) {
 		/* Insert edata into large. */
-		malloc_mutex_lock(tsdn, &arena->large_mtx);
-		edata_list_active_append(&arena->large, edata);
-		malloc_mutex_unlock(tsdn, &arena->large_mtx);
+		arena_large_shard_t *shard = arena_large_shard_get(arena, edata);
+		malloc_mutex_lock(tsdn, &shard->mtx);
+		edata_list_active_append(&shard->list, edata);
+		malloc_mutex_unlock(tsdn, &shard->mtx);
 	}
+	latency_timer_stop(tsdn, &timer, &arena->stats.latency,
+	    LOCKEDINT_MTX(arena->stats.mtx));
 
 	arena_decay_tick(tsdn, arena);
 	return edata_addr_get(edata);
@@ -128,8 +145,8 @@ large_ralloc_no_move_expand(
 	return false;
 }
 
-bool
-large_ralloc_no_move(tsdn_t *tsdn, edata_t *edata, size_t usize_min,
+static bool
+large_ralloc_no_move_impl(tsdn_t *tsdn, edata_t *edata, size_t usize_min,
     size_t usize_max, bool zero) {
 	size_t oldusize = edata_usize_get(edata);
 
@@ -173,6 +190,17 @@ large_ralloc_no_move(tsdn_t *tsdn, edata_t *edata, size_t usize_min,
 	return true;
 }
 
+bool
+large_ralloc_no_move(tsdn_t *tsdn, edata_t *edata, size_t usize_min,
+    size_t usize_max, bool zero) {
+	if (large_ralloc_no_move_impl(tsdn, edata, usize_min, usize_max, zero)) {
+		return true;
+	}
+	/* Resizing debits the old size from the old tag, see do_rallocx(). */
+	large_alloc_tag_stamp(tsdn, edata);
+	return false;
+}
+
 static void *
 large_ralloc_move_helper(
     tsdn_t *tsdn, arena_t *arena, size_t usize, size_t alignment, bool zero) {
@@ -226,25 +254,14 @@ large_ralloc(tsdn_t *tsdn, arena_t *arena, void *ptr, size_t usize,
 	return ret;
 }
 
-/*
- * locked indicates whether the arena's large_mtx is currently held.
- */
 static void
-large_dalloc_prep_impl(
-    tsdn_t *tsdn, arena_t *arena, edata_t *edata, bool locked) {
-	if (!locked) {
-		/* See comments in arena_bin_slabs_full_insert(). */
-		if (!arena_is_auto(arena)) {
-			malloc_mutex_lock(tsdn, &arena->large_mtx);
-			edata_list_active_remove(&arena->large, edata);
-			malloc_mutex_unlock(tsdn, &arena->large_mtx);
-		}
-	} else {
-		/* Only hold the large_mtx if necessary. */
-		if (!arena_is_auto(arena)) {
-			malloc_mutex_assert_owner(tsdn, &arena->large_mtx);
-			edata_list_active_remove(&arena->large, edata);
-		}
+large_dalloc_prep_impl(tsdn_t *tsdn, arena_t *arena, edata_t *edata) {
+	/* See comments in arena_bin_slabs_full_insert(). */
+	if (!arena_is_auto(arena)) {
+		arena_large_shard_t *shard = arena_large_shard_get(arena, edata);
+		malloc_mutex_lock(tsdn, &shard->mtx);
+		edata_list_active_remove(&shard->list, edata);
+		malloc_mutex_unlock(tsdn, &shard->mtx);
 	}
 	arena_extent_dalloc_large_prep(tsdn, arena, edata);
 }
@@ -259,8 +276,8 @@ large_dalloc_finish_impl(tsdn_t *tsdn, arena_t *arena, edata_t *edata) {
 }
 
 void
-large_dalloc_prep_locked(tsdn_t *tsdn, edata_t *edata) {
-	large_dalloc_prep_impl(tsdn, arena_get_from_edata(edata), edata, true);
+large_dalloc_prep(tsdn_t *tsdn, edata_t *edata) {
+	large_dalloc_prep_impl(tsdn, arena_get_from_edata(edata), edata);
 }
 
 void
@@ -271,7 +288,7 @@ large_dalloc_finish(tsdn_t *tsdn, edata_t *edata) {
 void
 large_dalloc(tsdn_t *tsdn, edata_t *edata) {
 	arena_t *arena = arena_get_from_edata(edata);
-	large_dalloc_prep_impl(tsdn, arena, edata, false);
+	large_dalloc_prep_impl(tsdn, arena, edata);
 	large_dalloc_finish_impl(tsdn, arena, edata);
 	arena_decay_tick(tsdn, arena);
 }
@@ -293,6 +310,7 @@ large_prof_info_get(
 		nstime_copy(
 		    &prof_info->alloc_time, edata_prof_alloc_time_get(edata));
 		prof_info->alloc_size = edata_prof_alloc_size_get(edata);
+		prof_info->sample_step = edata_prof_sample_step_get(edata);
 		if (reset_recent) {
 			/*
 			 * Reset the pointer on the recent allocation record,
@@ -314,11 +332,13 @@ large_prof_tctx_reset(edata_t *edata) {
 }
 
 void
-large_prof_info_set(edata_t *edata, prof_tctx_t *tctx, size_t size) {
+large_prof_info_set(
+    edata_t *edata, prof_tctx_t *tctx, size_t size, unsigned sample_step) {
 	nstime_t t;
 	nstime_prof_init_update(&t);
 	edata_prof_alloc_time_set(edata, &t);
 	edata_prof_alloc_size_set(edata, size);
+	edata_prof_sample_step_set(edata, sample_step);
 	edata_prof_recent_alloc_init(edata);
 	large_prof_tctx_set(edata, tctx);
 }
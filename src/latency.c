@@ -0,0 +1,144 @@
+#include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/jemalloc_internal_includes.h"
+
+#include "jemalloc/internal/latency.h"
+
+#include "jemalloc/internal/thread_event.h"
+
+int64_t opt_stats_latency_sample = LATENCY_SAMPLE_DEFAULT;
+
+const char *const latency_site_names[latency_nsites] = {
+#define OP(site) #site,
+    LATENCY_SITES
+#undef OP
+};
+
+void
+latency_record(tsdn_t *tsdn, latency_stats_t *stats, malloc_mutex_t *stats_mtx,
+    latency_site_t site, uint64_t ns) {
+	assert(site < latency_nsites);
+	latency_hist_t *hist = &stats->hists[site];
+	LOCKEDINT_MTX_LOCK(tsdn, *stats_mtx);
+	locked_inc_u64(tsdn, stats_mtx, &hist->count, 1);
+	locked_inc_u64(tsdn, stats_mtx, &hist->total_ns, ns);
+	locked_inc_u64(
+	    tsdn, stats_mtx, &hist->buckets[latency_bucket_ind(ns)], 1);
+	LOCKEDINT_MTX_UNLOCK(tsdn, *stats_mtx);
+}
+
+void
+latency_stats_merge(tsdn_t *tsdn, malloc_mutex_t *stats_mtx,
+    latency_stats_t *dst, latency_stats_t *src) {
+	for (unsigned i = 0; i < latency_nsites; i++) {
+		latency_hist_t *d = &dst->hists[i];
+		latency_hist_t *s = &src->hists[i];
+		uint64_t        count = locked_read_u64(tsdn, stats_mtx, &s->count);
+		if (count == 0) {
+			continue;
+		}
+		locked_inc_u64_unsynchronized(&d->count, count);
+		locked_inc_u64_unsynchronized(&d->total_ns,
+		    locked_read_u64(tsdn, stats_mtx, &s->total_ns));
+		for (unsigned j = 0; j < LATENCY_NBUCKETS; j++) {
+			locked_inc_u64_unsynchronized(&d->buckets[j],
+			    locked_read_u64(tsdn, stats_mtx, &s->buckets[j]));
+		}
+	}
+}
+
+void
+latency_stats_accum(latency_stats_t *dst, latency_stats_t *src) {
+	for (unsigned i = 0; i < latency_nsites; i++) {
+		latency_hist_t *d = &dst->hists[i];
+		latency_hist_t *s = &src->hists[i];
+		locked_inc_u64_unsynchronized(
+		    &d->count, locked_read_u64_unsynchronized(&s->count));
+		locked_inc_u64_unsynchronized(
+		    &d->total_ns, locked_read_u64_unsynchronized(&s->total_ns));
+		for (unsigned j = 0; j < LATENCY_NBUCKETS; j++) {
+			locked_inc_u64_unsynchronized(&d->buckets[j],
+			    locked_read_u64_unsynchronized(&s->buckets[j]));
+		}
+	}
+}
+
+uint64_t
+latency_hist_quantile_ns(latency_hist_t *hist, uint64_t ppm) {
+	assert(ppm <= 1000 * 1000);
+	uint64_t count = locked_read_u64_unsynchronized(&hist->count);
+	if (count == 0) {
+		return 0;
+	}
+	/* The rank (1-based) of the sample we're looking for. */
+	uint64_t rank = (count * ppm + 1000 * 1000 - 1) / (1000 * 1000);
+	if (rank == 0) {
+		rank = 1;
+	}
+	uint64_t seen = 0;
+	for (unsigned i = 0; i < LATENCY_NBUCKETS - 1; i++) {
+		seen += locked_read_u64_unsynchronized(&hist->buckets[i]);
+		if (seen >= rank) {
+			return latency_bucket_lower_ns(i + 1) - 1;
+		}
+	}
+	return latency_bucket_lower_ns(LATENCY_NBUCKETS - 1);
+}
+
+void
+latency_timer_start_hard(tsdn_t *tsdn, latency_timer_t *timer) {
+	if (tsdn_null(tsdn)) {
+		return;
+	}
+	latency_sites_t *armed = tsd_latency_sites_armedp_get_unsafe(
+	    tsdn_tsd(tsdn));
+	latency_sites_t bit = (latency_sites_t)(1U << timer->site);
+	if ((*armed & bit) == 0) {
+		return;
+	}
+	*armed &= ~bit;
+	timer->sampled = true;
+	nstime_precise_init_update(&timer->start);
+}
+
+void
+latency_timer_stop_hard(tsdn_t *tsdn, latency_timer_t *timer,
+    latency_stats_t *stats, malloc_mutex_t *stats_mtx) {
+	assert(timer->sampled);
+	nstime_t now;
+	nstime_copy(&now, &timer->start);
+	nstime_precise_update(&now);
+	latency_record(tsdn, stats, stats_mtx, timer->site,
+	    nstime_ns_between(&timer->start, &now));
+}
+
+static te_enabled_t
+latency_sample_enabled(void) {
+	return (config_stats && opt_stats_latency_sample >= 0) ? te_enabled_yes
+	                                                       : te_enabled_no;
+}
+
+static uint64_t
+latency_sample_new_event_wait(tsd_t *tsd) {
+	assert(opt_stats_latency_sample >= 0);
+	/* A zero sampling interval arms the sites on every allocation. */
+	return opt_stats_latency_sample == 0
+	    ? 1
+	    : (uint64_t)opt_stats_latency_sample;
+}
+
+static uint64_t
+latency_sample_postponed_event_wait(tsd_t *tsd) {
+	return TE_MIN_START_WAIT;
+}
+
+static void
+latency_sample_event_handler(tsd_t *tsd) {
+	*tsd_latency_sites_armedp_get(tsd) = LATENCY_SITES_ALL;
+}
+
+te_base_cb_t latency_sample_te_handler = {
+    .enabled = &latency_sample_enabled,
+    .new_event_wait = &latency_sample_new_event_wait,
+    .postponed_event_wait = &latency_sample_postponed_event_wait,
+    .event_handler = &latency_sample_event_handler,
+};
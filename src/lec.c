@@ -0,0 +1,305 @@
+#include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/jemalloc_internal_includes.h"
+
+#include "jemalloc/internal/lec.h"
+
+static bool
+lec_bin_init(lec_bin_t *bin) {
+	bin->bytes_cur = 0;
+	bin->bytes_low_water = 0;
+	edata_list_active_init(&bin->lru);
+	bin->nhits = 0;
+	bin->nmisses = 0;
+	bin->nevictions = 0;
+	return malloc_mutex_init(&bin->mtx, "lec_bin", WITNESS_RANK_LEC,
+	    malloc_mutex_rank_exclusive);
+}
+
+bool
+lec_init(tsdn_t *tsdn, lec_t *lec, base_t *base, size_t max_bytes,
+    size_t max_alloc) {
+	lec->max_bytes = max_bytes;
+	lec->max_alloc = PAGE_FLOOR(max_alloc);
+	lec->npsizes = 0;
+	lec->bins = NULL;
+	atomic_store_zu(&lec->bytes, 0, ATOMIC_RELAXED);
+	atomic_store_zu(&lec->seq, 0, ATOMIC_RELAXED);
+	if (max_bytes == 0) {
+		return false;
+	}
+	assert(lec->max_alloc >= PAGE);
+
+	if (malloc_mutex_init(&lec->gc_mtx, "lec_gc", WITNESS_RANK_LEC,
+	        malloc_mutex_rank_exclusive)) {
+		return true;
+	}
+	nstime_init_update(&lec->gc_next);
+
+	pszind_t npsizes = sz_psz2ind(lec->max_alloc) + 1;
+	lec_bin_t *bins = (lec_bin_t *)base_alloc(
+	    tsdn, base, sizeof(lec_bin_t) * npsizes, CACHELINE);
+	if (bins == NULL) {
+		return true;
+	}
+	for (pszind_t i = 0; i < npsizes; i++) {
+		if (lec_bin_init(&bins[i])) {
+			return true;
+		}
+	}
+	lec->bins = bins;
+	lec->npsizes = npsizes;
+
+	return false;
+}
+
+static lec_bin_t *
+lec_bin_get(lec_t *lec, size_t size) {
+	pszind_t pszind = sz_psz2ind(size);
+	assert(pszind < lec->npsizes);
+	return &lec->bins[pszind];
+}
+
+static void
+lec_bin_bytes_sub(lec_t *lec, lec_bin_t *bin, size_t size) {
+	assert(bin->bytes_cur >= size);
+	bin->bytes_cur -= size;
+	if (bin->bytes_cur < bin->bytes_low_water) {
+		bin->bytes_low_water = bin->bytes_cur;
+	}
+	atomic_fetch_sub_zu(&lec->bytes, size, ATOMIC_RELAXED);
+}
+
+edata_t *
+lec_alloc(tsdn_t *tsdn, lec_t *lec, size_t size) {
+	if (!lec_size_supported(lec, size)) {
+		return NULL;
+	}
+	assert((size & PAGE_MASK) == 0);
+	lec_bin_t *bin = lec_bin_get(lec, size);
+
+	malloc_mutex_lock(tsdn, &bin->mtx);
+	edata_t *edata = edata_list_active_first(&bin->lru);
+	for (unsigned i = 0; edata != NULL && i < LEC_SEARCH_MAX; i++) {
+		if (edata_size_get(edata) == size) {
+			break;
+		}
+		edata = edata_list_active_next(&bin->lru, edata);
+	}
+	if (edata != NULL && edata_size_get(edata) == size) {
+		edata_list_active_remove(&bin->lru, edata);
+		lec_bin_bytes_sub(lec, bin, size);
+		bin->nhits++;
+	} else {
+		edata = NULL;
+		bin->nmisses++;
+	}
+	malloc_mutex_unlock(tsdn, &bin->mtx);
+
+	return edata;
+}
+
+/* Moves the coldest extent of bin to to_evict. */
+static void
+lec_bin_evict_one(lec_t *lec, lec_bin_t *bin, edata_list_active_t *to_evict) {
+	edata_t *edata = edata_list_active_last(&bin->lru);
+	assert(edata != NULL);
+	edata_list_active_remove(&bin->lru, edata);
+	lec_bin_bytes_sub(lec, bin, edata_size_get(edata));
+	bin->nevictions++;
+	edata_list_active_append(to_evict, edata);
+}
+
+bool
+lec_dalloc(
+    tsdn_t *tsdn, lec_t *lec, edata_t *edata, edata_list_active_t *to_evict) {
+	size_t size = edata_size_get(edata);
+	assert(lec_size_supported(lec, size));
+	lec_bin_t *bin = lec_bin_get(lec, size);
+	/* Wraps around; see lec_seq_before(). */
+	edata_lec_seq_set(
+	    edata, atomic_fetch_add_zu(&lec->seq, 1, ATOMIC_RELAXED));
+
+	malloc_mutex_lock(tsdn, &bin->mtx);
+	/*
+	 * If lec_gc() is falling behind, make room in this bin, which is all
+	 * that can be done without looking at the others.
+	 */
+	while (atomic_load_zu(&lec->bytes, ATOMIC_RELAXED) + size
+	        > 2 * lec->max_bytes
+	    && !edata_list_active_empty(&bin->lru)) {
+		lec_bin_evict_one(lec, bin, to_evict);
+	}
+	size_t bytes;
+	if (atomic_load_zu(&lec->bytes, ATOMIC_RELAXED) + size
+	    > 2 * lec->max_bytes) {
+		bin->nevictions++;
+		edata_list_active_append(to_evict, edata);
+		bytes = atomic_load_zu(&lec->bytes, ATOMIC_RELAXED);
+	} else {
+		edata_list_active_prepend(&bin->lru, edata);
+		bin->bytes_cur += size;
+		bytes = atomic_fetch_add_zu(&lec->bytes, size, ATOMIC_RELAXED)
+		    + size;
+	}
+	malloc_mutex_unlock(tsdn, &bin->mtx);
+
+	return bytes > lec->max_bytes;
+}
+
+/* Whether the extent stamped with seq_a was cached before the seq_b one. */
+static bool
+lec_seq_before(size_t seq_a, size_t seq_b) {
+	return (ssize_t)(seq_a - seq_b) < 0;
+}
+
+/*
+ * Evicts the least recently freed extents, whatever their bin, until the cache
+ * fits in max_bytes.  Bins are only locked one at a time, so the coldest
+ * extent found may have been allocated by the time its bin is locked again;
+ * the bin's coldest extent is evicted instead then.
+ */
+static void
+lec_evict_excess(tsdn_t *tsdn, lec_t *lec, edata_list_active_t *to_evict) {
+	while (atomic_load_zu(&lec->bytes, ATOMIC_RELAXED) > lec->max_bytes) {
+		lec_bin_t *coldest = NULL;
+		size_t     coldest_seq = 0;
+		for (pszind_t i = 0; i < lec->npsizes; i++) {
+			lec_bin_t *bin = &lec->bins[i];
+			malloc_mutex_lock(tsdn, &bin->mtx);
+			edata_t *edata = edata_list_active_last(&bin->lru);
+			if (edata != NULL
+			    && (coldest == NULL
+			        || lec_seq_before(
+			            edata_lec_seq_get(edata), coldest_seq))) {
+				coldest = bin;
+				coldest_seq = edata_lec_seq_get(edata);
+			}
+			malloc_mutex_unlock(tsdn, &bin->mtx);
+		}
+		if (coldest == NULL) {
+			return;
+		}
+		malloc_mutex_lock(tsdn, &coldest->mtx);
+		if (!edata_list_active_empty(&coldest->lru)) {
+			lec_bin_evict_one(lec, coldest, to_evict);
+		}
+		malloc_mutex_unlock(tsdn, &coldest->mtx);
+	}
+}
+
+void
+lec_gc(tsdn_t *tsdn, lec_t *lec, uint64_t interval_ms,
+    edata_list_active_t *to_evict) {
+	if (!lec_is_used(lec) || atomic_load_zu(&lec->bytes, ATOMIC_RELAXED)
+	    == 0) {
+		return;
+	}
+	lec_evict_excess(tsdn, lec, to_evict);
+	if (malloc_mutex_trylock(tsdn, &lec->gc_mtx)) {
+		/* Somebody else is doing the pass. */
+		return;
+	}
+	nstime_t now;
+	nstime_init_update(&now);
+	if (nstime_compare(&now, &lec->gc_next) < 0) {
+		malloc_mutex_unlock(tsdn, &lec->gc_mtx);
+		return;
+	}
+	nstime_copy(&lec->gc_next, &now);
+	nstime_iadd(&lec->gc_next, interval_ms * 1000 * 1000);
+	malloc_mutex_unlock(tsdn, &lec->gc_mtx);
+
+	for (pszind_t i = 0; i < lec->npsizes; i++) {
+		lec_bin_t *bin = &lec->bins[i];
+		malloc_mutex_lock(tsdn, &bin->mtx);
+		/*
+		 * bytes_low_water bytes went unused for the whole interval;
+		 * evict (at least) that much from the cold end.
+		 */
+		size_t target = bin->bytes_cur - bin->bytes_low_water;
+		while (bin->bytes_cur > target) {
+			lec_bin_evict_one(lec, bin, to_evict);
+		}
+		bin->bytes_low_water = bin->bytes_cur;
+		malloc_mutex_unlock(tsdn, &bin->mtx);
+	}
+}
+
+void
+lec_flush(tsdn_t *tsdn, lec_t *lec, edata_list_active_t *to_evict) {
+	if (!lec_is_used(lec)) {
+		return;
+	}
+	for (pszind_t i = 0; i < lec->npsizes; i++) {
+		lec_bin_t *bin = &lec->bins[i];
+		malloc_mutex_lock(tsdn, &bin->mtx);
+		while (!edata_list_active_empty(&bin->lru)) {
+			lec_bin_evict_one(lec, bin, to_evict);
+		}
+		bin->bytes_low_water = 0;
+		malloc_mutex_unlock(tsdn, &bin->mtx);
+	}
+}
+
+void
+lec_stats_merge(tsdn_t *tsdn, lec_t *lec, lec_stats_t *stats) {
+	if (!lec_is_used(lec)) {
+		return;
+	}
+	for (pszind_t i = 0; i < lec->npsizes; i++) {
+		lec_bin_t *bin = &lec->bins[i];
+		malloc_mutex_lock(tsdn, &bin->mtx);
+		stats->bytes += bin->bytes_cur;
+		stats->nhits += bin->nhits;
+		stats->nmisses += bin->nmisses;
+		stats->nevictions += bin->nevictions;
+		malloc_mutex_unlock(tsdn, &bin->mtx);
+	}
+}
+
+void
+lec_mutex_stats_read(
+    tsdn_t *tsdn, lec_t *lec, mutex_prof_data_t *mutex_prof_data) {
+	if (!lec_is_used(lec)) {
+		return;
+	}
+	for (pszind_t i = 0; i < lec->npsizes; i++) {
+		lec_bin_t *bin = &lec->bins[i];
+		malloc_mutex_lock(tsdn, &bin->mtx);
+		malloc_mutex_prof_accum(tsdn, mutex_prof_data, &bin->mtx);
+		malloc_mutex_unlock(tsdn, &bin->mtx);
+	}
+}
+
+void
+lec_prefork2(tsdn_t *tsdn, lec_t *lec) {
+	if (!lec_is_used(lec)) {
+		return;
+	}
+	malloc_mutex_prefork(tsdn, &lec->gc_mtx);
+	for (pszind_t i = 0; i < lec->npsizes; i++) {
+		malloc_mutex_prefork(tsdn, &lec->bins[i].mtx);
+	}
+}
+
+void
+lec_postfork_parent(tsdn_t *tsdn, lec_t *lec) {
+	if (!lec_is_used(lec)) {
+		return;
+	}
+	for (pszind_t i = 0; i < lec->npsizes; i++) {
+		malloc_mutex_postfork_parent(tsdn, &lec->bins[i].mtx);
+	}
+	malloc_mutex_postfork_parent(tsdn, &lec->gc_mtx);
+}
+
+void
+lec_postfork_child(tsdn_t *tsdn, lec_t *lec) {
+	if (!lec_is_used(lec)) {
+		return;
+	}
+	for (pszind_t i = 0; i < lec->npsizes; i++) {
+		malloc_mutex_postfork_child(tsdn, &lec->bins[i].mtx);
+	}
+	malloc_mutex_postfork_child(tsdn, &lec->gc_mtx);
+}
@@ -3,6 +3,7 @@
 
 #include "jemalloc/internal/assert.h"
 #include "jemalloc/internal/malloc_io.h"
+#include "jemalloc/internal/prof_contention.h"
 #include "jemalloc/internal/spin.h"
 
 #if defined(_WIN32) && !defined(_CRT_SPINCOUNT)
@@ -48,12 +49,163 @@ JEMALLOC_EXPORT int _pthread_mutex_init_calloc_cb(
     pthread_mutex_t *mutex, void *(calloc_cb)(size_t, size_t));
 #endif
 
+#ifdef JEMALLOC_FUTEX_MUTEX
+int
+malloc_futex_wait(
+    atomic_u32_t *word, uint32_t expected, const struct timespec *abstime) {
+	long ret;
+	if (abstime == NULL) {
+		ret = syscall(SYS_futex, (uint32_t *)word, FUTEX_WAIT_PRIVATE,
+		    expected, NULL, NULL, 0);
+	} else {
+		ret = syscall(SYS_futex, (uint32_t *)word,
+		    FUTEX_WAIT_BITSET_PRIVATE | FUTEX_CLOCK_REALTIME, expected,
+		    abstime, NULL, FUTEX_BITSET_MATCH_ANY);
+	}
+	return ret == 0 ? 0 : errno;
+}
+
+void
+malloc_futex_wake(atomic_u32_t *word, int nwake) {
+	syscall(SYS_futex, (uint32_t *)word, FUTEX_WAKE_PRIVATE, nwake, NULL,
+	    NULL, 0);
+}
+
+/* Acquires the queue lock, and returns the state with it set. */
+static uint32_t
+malloc_futex_qlock(malloc_futex_t *futex) {
+	spin_t   spinner = SPIN_INITIALIZER;
+	uint32_t state = atomic_load_u32(&futex->state, ATOMIC_RELAXED);
+	while (true) {
+		if ((state & MALLOC_FUTEX_QLOCKED) == 0) {
+			if (atomic_compare_exchange_weak_u32(&futex->state,
+			        &state, state | MALLOC_FUTEX_QLOCKED,
+			        ATOMIC_ACQUIRE, ATOMIC_RELAXED)) {
+				return state | MALLOC_FUTEX_QLOCKED;
+			}
+		} else {
+			/* Held for a handful of instructions only. */
+			spin_adaptive(&spinner);
+			state = atomic_load_u32(&futex->state, ATOMIC_RELAXED);
+		}
+	}
+}
+
 void
-malloc_mutex_lock_slow(malloc_mutex_t *mutex) {
+malloc_futex_lock_slow(malloc_futex_t *futex) {
+	malloc_futex_waiter_t waiter;
+	waiter.requeued = false;
+	while (true) {
+		uint32_t state = malloc_futex_qlock(futex);
+		/*
+		 * With the queue lock held, the lock bit can still be set by
+		 * malloc_futex_trylock(), but not cleared.
+		 */
+		while ((state & MALLOC_FUTEX_LOCKED) == 0) {
+			if (atomic_compare_exchange_weak_u32(&futex->state,
+			        &state,
+			        (state | MALLOC_FUTEX_LOCKED)
+			            & ~MALLOC_FUTEX_QLOCKED,
+			        ATOMIC_ACQUIRE, ATOMIC_RELAXED)) {
+				return;
+			}
+		}
+
+		atomic_store_u32(
+		    &waiter.wake, MALLOC_FUTEX_WAKE_NONE, ATOMIC_RELAXED);
+		if (futex->head == NULL) {
+			waiter.next = NULL;
+			futex->head = &waiter;
+			futex->tail = &waiter;
+		} else if (waiter.requeued) {
+			/* Keep our place in line. */
+			waiter.next = futex->head;
+			futex->head = &waiter;
+		} else {
+			waiter.next = NULL;
+			futex->tail->next = &waiter;
+			futex->tail = &waiter;
+		}
+		/* Nobody else can modify the state as long as it's locked. */
+		atomic_store_u32(&futex->state,
+		    MALLOC_FUTEX_LOCKED | MALLOC_FUTEX_WAITERS, ATOMIC_RELEASE);
+
+		uint32_t wake;
+		while ((wake = atomic_load_u32(&waiter.wake, ATOMIC_ACQUIRE))
+		    == MALLOC_FUTEX_WAKE_NONE) {
+			malloc_futex_wait(
+			    &waiter.wake, MALLOC_FUTEX_WAKE_NONE, NULL);
+		}
+		if (wake == MALLOC_FUTEX_WAKE_HANDOFF) {
+			/* The lock bit was left set for us. */
+			assert(atomic_load_u32(&futex->state, ATOMIC_RELAXED)
+			    & MALLOC_FUTEX_LOCKED);
+			return;
+		}
+		if (!malloc_futex_trylock(futex)) {
+			return;
+		}
+		waiter.requeued = true;
+	}
+}
+
+void
+malloc_futex_unlock_slow(malloc_futex_t *futex) {
+	uint32_t state = malloc_futex_qlock(futex);
+	assert(state & MALLOC_FUTEX_LOCKED);
+	malloc_futex_waiter_t *waiter = futex->head;
+	if (waiter == NULL) {
+		/* Only raced with a locker busy with the queue lock. */
+		assert((state & MALLOC_FUTEX_WAITERS) == 0);
+		atomic_store_u32(&futex->state, 0, ATOMIC_RELEASE);
+		return;
+	}
+	futex->head = waiter->next;
+	if (futex->head == NULL) {
+		futex->tail = NULL;
+	}
+	uint32_t waiters = futex->head == NULL ? 0 : MALLOC_FUTEX_WAITERS;
+	uint32_t wake;
+	if (waiter->requeued) {
+		/* It lost once already; hand the lock over. */
+		atomic_store_u32(&futex->state, MALLOC_FUTEX_LOCKED | waiters,
+		    ATOMIC_RELEASE);
+		wake = MALLOC_FUTEX_WAKE_HANDOFF;
+	} else {
+		atomic_store_u32(&futex->state, waiters, ATOMIC_RELEASE);
+		wake = MALLOC_FUTEX_WAKE_RETRY;
+	}
+	atomic_store_u32(&waiter->wake, wake, ATOMIC_RELEASE);
+	/*
+	 * The waiter may have seen the store and returned (and its stack slot
+	 * been reused) by now; the worst this can do is a spurious wakeup of
+	 * some other futex waiter at that address, which all of them tolerate.
+	 */
+	malloc_futex_wake(&waiter->wake, 1);
+}
+#endif
+
+/*
+ * Whether spinning is pointless.  Queued threads mean that lock holders have
+ * recently been taking longer than a spin (e.g. because they got preempted),
+ * and those threads are ahead in line anyway.  User space has no cheap way of
+ * telling whether the lock holder is running; this is the proxy.
+ */
+static inline bool
+mutex_spin_futile(malloc_mutex_t *mutex) {
+#ifdef JEMALLOC_FUTEX_MUTEX
+	return malloc_futex_has_waiters(&mutex->lock);
+#else
+	return false;
+#endif
+}
+
+void
+malloc_mutex_lock_slow(tsdn_t *tsdn, malloc_mutex_t *mutex) {
 	mutex_prof_data_t *data = &mutex->prof_data;
 	nstime_t           before;
 
-	if (ncpus == 1) {
+	if (ncpus == 1 || mutex_spin_futile(mutex)) {
 		goto label_spin_done;
 	}
 
@@ -65,14 +217,22 @@ malloc_mutex_lock_slow(malloc_mutex_t *mutex) {
 			data->n_spin_acquired++;
 			return;
 		}
+		if (mutex_spin_futile(mutex)) {
+			break;
+		}
 	} while (cnt++ < opt_mutex_max_spin || opt_mutex_max_spin == -1);
 
-	if (!config_stats) {
+	if (!config_stats && !(config_prof && opt_prof_contention)) {
 		/* Only spin is useful when stats is off. */
 		malloc_mutex_lock_final(mutex);
 		return;
 	}
 label_spin_done:
+	;
+	/* Taken before the clock starts, to keep it out of the wait time. */
+	prof_contention_sample_t sample;
+	bool sampled = prof_contention_sample(tsdn, &sample);
+
 	nstime_init_update(&before);
 	/* Copy before to after to avoid clock skews. */
 	nstime_t after;
@@ -96,7 +256,11 @@ label_spin_done:
 	nstime_t delta;
 	nstime_copy(&delta, &after);
 	nstime_subtract(&delta, &before);
+	if (sampled) {
+		prof_contention_record(&sample, nstime_ns(&delta));
+	}
 
+	data->wait_hist[mutex_prof_wait_bucket(nstime_ns(&delta))]++;
 	data->n_wait_times++;
 	nstime_add(&data->tot_wait_time, &delta);
 	if (nstime_compare(&data->max_wait_time, &delta) < 0) {
@@ -152,6 +316,10 @@ malloc_mutex_init(malloc_mutex_t *mutex, const char *name, witness_rank_t rank,
 #	endif
 #elif (defined(JEMALLOC_OS_UNFAIR_LOCK))
 	mutex->lock = OS_UNFAIR_LOCK_INIT;
+#elif (defined(JEMALLOC_FUTEX_MUTEX))
+	atomic_store_u32(&mutex->lock.state, 0, ATOMIC_RELAXED);
+	mutex->lock.head = NULL;
+	mutex->lock.tail = NULL;
 #elif (defined(JEMALLOC_MUTEX_INIT_CB))
 	if (postpone_init) {
 		mutex->postponed_next = postponed_mutexes;
@@ -302,12 +302,44 @@ nstime_update_impl(nstime_t *time) {
 }
 nstime_update_t *JET_MUTABLE nstime_update = nstime_update_impl;
 
+/*
+ * The coarse clock nstime_get() prefers has a resolution in the milliseconds,
+ * which is useless for timing individual allocator operations.
+ */
+static void
+nstime_precise_update_impl(nstime_t *time) {
+	nstime_t old_time;
+
+	nstime_copy(&old_time, time);
+#if defined(JEMALLOC_HAVE_CLOCK_MONOTONIC) && !defined(_WIN32)
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	nstime_init2(time, ts.tv_sec, ts.tv_nsec);
+#else
+	nstime_get(time);
+#endif
+
+	/* Handle non-monotonic clocks. */
+	if (unlikely(nstime_compare(&old_time, time) > 0)) {
+		nstime_copy(time, &old_time);
+	}
+}
+nstime_update_t *JET_MUTABLE nstime_precise_update =
+    nstime_precise_update_impl;
+
 void
 nstime_init_update(nstime_t *time) {
 	nstime_init_zero(time);
 	nstime_update(time);
 }
 
+void
+nstime_precise_init_update(nstime_t *time) {
+	nstime_init_zero(time);
+	nstime_precise_update(time);
+}
+
 void
 nstime_prof_init_update(nstime_t *time) {
 	nstime_init_zero(time);
@@ -31,7 +31,7 @@ pa_central_init(pa_central_t *central, base_t *base, bool hpa,
 bool
 pa_shard_init(tsdn_t *tsdn, pa_shard_t *shard, pa_central_t *central,
     emap_t *emap, base_t *base, unsigned ind, pa_shard_stats_t *stats,
-    malloc_mutex_t *stats_mtx, nstime_t *cur_time,
+    latency_stats_t *latency, malloc_mutex_t *stats_mtx, nstime_t *cur_time,
     size_t pac_oversize_threshold, ssize_t dirty_decay_ms,
     ssize_t muzzy_decay_ms) {
 	/* This will change eventually, but for now it should hold. */
@@ -42,7 +42,12 @@ pa_shard_init(tsdn_t *tsdn, pa_shard_t *shard, pa_central_t *central,
 
 	if (pac_init(tsdn, &shard->pac, base, emap, &shard->edata_cache,
 	        cur_time, pac_oversize_threshold, dirty_decay_ms,
-	        muzzy_decay_ms, &stats->pac_stats, stats_mtx)) {
+	        muzzy_decay_ms, &stats->pac_stats, latency, stats_mtx)) {
+		return true;
+	}
+
+	if (lec_init(tsdn, &shard->lec, base, /* max_bytes */ 0,
+	        /* max_alloc */ 0)) {
 		return true;
 	}
 
@@ -56,6 +61,7 @@ pa_shard_init(tsdn_t *tsdn, pa_shard_t *shard, pa_central_t *central,
 	shard->stats_mtx = stats_mtx;
 	shard->stats = stats;
 	memset(shard->stats, 0, sizeof(*shard->stats));
+	shard->latency = latency;
 
 	shard->central = central;
 	shard->emap = emap;
@@ -78,6 +84,12 @@ pa_shard_enable_hpa(tsdn_t *tsdn, pa_shard_t *shard,
 	return false;
 }
 
+bool
+pa_shard_enable_lec(
+    tsdn_t *tsdn, pa_shard_t *shard, size_t max_bytes, size_t max_alloc) {
+	return lec_init(tsdn, &shard->lec, shard->base, max_bytes, max_alloc);
+}
+
 void
 pa_shard_disable_hpa(tsdn_t *tsdn, pa_shard_t *shard) {
 	atomic_store_b(&shard->use_hpa, false, ATOMIC_RELAXED);
@@ -92,8 +104,33 @@ pa_shard_reset(tsdn_t *tsdn, pa_shard_t *shard) {
 	pa_shard_flush(tsdn, shard);
 }
 
+static pai_t *
+pa_get_pai(pa_shard_t *shard, edata_t *edata) {
+	return (edata_pai_get(edata) == EXTENT_PAI_PAC ? &shard->pac.pai
+	                                               : &shard->hpa_shard.pai);
+}
+
+static void
+pa_shard_lec_evict(tsdn_t *tsdn, pa_shard_t *shard,
+    edata_list_active_t *to_evict, bool *deferred_work_generated) {
+	edata_t *edata;
+	while ((edata = edata_list_active_first(to_evict)) != NULL) {
+		edata_list_active_remove(to_evict, edata);
+		pai_dalloc(tsdn, pa_get_pai(shard, edata), edata,
+		    deferred_work_generated);
+	}
+}
+
 void
 pa_shard_flush(tsdn_t *tsdn, pa_shard_t *shard) {
+	if (lec_is_used(&shard->lec)) {
+		edata_list_active_t to_evict;
+		edata_list_active_init(&to_evict);
+		lec_flush(tsdn, &shard->lec, &to_evict);
+		bool deferred_work_generated = false;
+		pa_shard_lec_evict(
+		    tsdn, shard, &to_evict, &deferred_work_generated);
+	}
 	if (shard->ever_used_hpa) {
 		hpa_shard_flush(tsdn, &shard->hpa_shard);
 	}
@@ -112,12 +149,6 @@ pa_shard_destroy(tsdn_t *tsdn, pa_shard_t *shard) {
 	}
 }
 
-static pai_t *
-pa_get_pai(pa_shard_t *shard, edata_t *edata) {
-	return (edata_pai_get(edata) == EXTENT_PAI_PAC ? &shard->pac.pai
-	                                               : &shard->hpa_shard.pai);
-}
-
 edata_t *
 pa_alloc(tsdn_t *tsdn, pa_shard_t *shard, size_t size, size_t alignment,
     bool slab, szind_t szind, bool zero, bool guarded,
@@ -126,8 +157,17 @@ pa_alloc(tsdn_t *tsdn, pa_shard_t *shard, size_t size, size_t alignment,
 	    tsdn_witness_tsdp_get(tsdn), WITNESS_RANK_CORE, 0);
 	assert(!guarded || alignment <= PAGE);
 
+	latency_timer_t timer;
+	latency_timer_start(tsdn, &timer, latency_site_pa_alloc);
 	edata_t *edata = NULL;
-	if (!guarded && pa_shard_uses_hpa(shard)) {
+	/*
+	 * Cached extents are dirty and only page aligned, so they can't serve
+	 * zeroed or over-aligned requests.
+	 */
+	if (!slab && !guarded && !zero && alignment <= PAGE) {
+		edata = lec_alloc(tsdn, &shard->lec, size);
+	}
+	if (edata == NULL && !guarded && pa_shard_uses_hpa(shard)) {
 		edata = pai_alloc(tsdn, &shard->hpa_shard.pai, size, alignment,
 		    zero, /* guarded */ false, slab, deferred_work_generated);
 	}
@@ -150,6 +190,8 @@ pa_alloc(tsdn_t *tsdn, pa_shard_t *shard, size_t size, size_t alignment,
 		}
 		assert(edata_arena_ind_get(edata) == shard->ind);
 	}
+	latency_timer_stop(tsdn, &timer, shard->latency,
+	    LOCKEDINT_MTX(*shard->stats_mtx));
 	return edata;
 }
 
@@ -205,6 +247,8 @@ pa_shrink(tsdn_t *tsdn, pa_shard_t *shard, edata_t *edata, size_t old_size,
 void
 pa_dalloc(tsdn_t *tsdn, pa_shard_t *shard, edata_t *edata,
     bool *deferred_work_generated) {
+	latency_timer_t timer;
+	latency_timer_start(tsdn, &timer, latency_site_pa_dalloc);
 	emap_remap(tsdn, shard->emap, edata, SC_NSIZES, /* slab */ false);
 	if (edata_slab_get(edata)) {
 		emap_deregister_interior(tsdn, shard->emap, edata);
@@ -216,8 +260,24 @@ pa_dalloc(tsdn_t *tsdn, pa_shard_t *shard, edata_t *edata,
 	edata_addr_set(edata, edata_base_get(edata));
 	edata_szind_set(edata, SC_NSIZES);
 	pa_nactive_sub(shard, edata_size_get(edata) >> LG_PAGE);
-	pai_t *pai = pa_get_pai(shard, edata);
-	pai_dalloc(tsdn, pai, edata, deferred_work_generated);
+	if (!edata_slab_get(edata) && !edata_guarded_get(edata)
+	    && lec_size_supported(&shard->lec, edata_size_get(edata))
+	    && pac_decay_ms_get(&shard->pac, extent_state_dirty) != 0) {
+		edata_list_active_t to_evict;
+		edata_list_active_init(&to_evict);
+		edata_zeroed_set(edata, false);
+		if (lec_dalloc(tsdn, &shard->lec, edata, &to_evict)) {
+			/* Over lec_max_bytes; lec_gc() catches up. */
+			*deferred_work_generated = true;
+		}
+		pa_shard_lec_evict(
+		    tsdn, shard, &to_evict, deferred_work_generated);
+	} else {
+		pai_t *pai = pa_get_pai(shard, edata);
+		pai_dalloc(tsdn, pai, edata, deferred_work_generated);
+	}
+	latency_timer_stop(tsdn, &timer, shard->latency,
+	    LOCKEDINT_MTX(*shard->stats_mtx));
 }
 
 bool
@@ -231,6 +291,24 @@ pa_decay_ms_get(pa_shard_t *shard, extent_state_t state) {
 	return pac_decay_ms_get(&shard->pac, state);
 }
 
+void
+pa_shard_lec_gc(tsdn_t *tsdn, pa_shard_t *shard) {
+	if (!lec_is_used(&shard->lec)) {
+		return;
+	}
+	ssize_t decay_ms = pac_decay_ms_get(&shard->pac, extent_state_dirty);
+	if (decay_ms < 0) {
+		/* Dirty pages are never purged; neither are cached extents. */
+		return;
+	}
+	edata_list_active_t to_evict;
+	edata_list_active_init(&to_evict);
+	lec_gc(tsdn, &shard->lec, (uint64_t)decay_ms / LEC_GC_NINTERVALS,
+	    &to_evict);
+	bool deferred_work_generated = false;
+	pa_shard_lec_evict(tsdn, shard, &to_evict, &deferred_work_generated);
+}
+
 void
 pa_shard_set_deferral_allowed(
     tsdn_t *tsdn, pa_shard_t *shard, bool deferral_allowed) {
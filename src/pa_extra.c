@@ -16,6 +16,7 @@ pa_shard_prefork0(tsdn_t *tsdn, pa_shard_t *shard) {
 
 void
 pa_shard_prefork2(tsdn_t *tsdn, pa_shard_t *shard) {
+	lec_prefork2(tsdn, &shard->lec);
 	if (shard->ever_used_hpa) {
 		hpa_shard_prefork2(tsdn, &shard->hpa_shard);
 	}
@@ -56,6 +57,7 @@ pa_shard_postfork_parent(tsdn_t *tsdn, pa_shard_t *shard) {
 	if (shard->ever_used_hpa) {
 		hpa_shard_postfork_parent(tsdn, &shard->hpa_shard);
 	}
+	lec_postfork_parent(tsdn, &shard->lec);
 }
 
 void
@@ -70,6 +72,7 @@ pa_shard_postfork_child(tsdn_t *tsdn, pa_shard_t *shard) {
 	if (shard->ever_used_hpa) {
 		hpa_shard_postfork_child(tsdn, &shard->hpa_shard);
 	}
+	lec_postfork_child(tsdn, &shard->lec);
 }
 
 size_t
@@ -110,10 +113,19 @@ pa_shard_stats_merge(tsdn_t *tsdn, pa_shard_t *shard,
 	pa_shard_stats_out->edata_avail += atomic_load_zu(
 	    &shard->edata_cache.count, ATOMIC_RELAXED);
 
+	assert((estats_out == NULL) == (hpa_stats_out == NULL));
+	if (estats_out != NULL) {
+		lec_stats_t lec_stats = {0};
+		lec_stats_merge(tsdn, &shard->lec, &lec_stats);
+		lec_stats_accum(&pa_shard_stats_out->lec_stats, &lec_stats);
+	}
+
 	size_t resident_pgs = 0;
 	resident_pgs += pa_shard_nactive(shard);
 	resident_pgs += pa_shard_ndirty(shard);
-	*resident += (resident_pgs << LG_PAGE);
+	/* Cached large extents are neither active nor dirty, but resident. */
+	*resident += (resident_pgs << LG_PAGE)
+	    + atomic_load_zu(&shard->lec.bytes, ATOMIC_RELAXED);
 
 	/* Dirty decay stats */
 	locked_inc_u64_unsynchronized(
@@ -146,6 +158,10 @@ pa_shard_stats_merge(tsdn_t *tsdn, pa_shard_t *shard,
 	atomic_load_add_store_zu(&pa_shard_stats_out->pac_stats.abandoned_vm,
 	    atomic_load_zu(&shard->pac.stats->abandoned_vm, ATOMIC_RELAXED));
 
+	if (estats_out == NULL) {
+		return;
+	}
+
 	for (pszind_t i = 0; i < SC_NPSIZES; i++) {
 		size_t dirty, muzzy, retained, dirty_bytes, muzzy_bytes,
 		    retained_bytes;
@@ -170,6 +186,48 @@ pa_shard_stats_merge(tsdn_t *tsdn, pa_shard_t *shard,
 	}
 }
 
+typedef struct pa_resident_ranges_arg_s pa_resident_ranges_arg_t;
+struct pa_resident_ranges_arg_s {
+	tsdn_t     *tsdn;
+	pa_shard_t *shard;
+	/* NULL for the HPA shard. */
+	ecache_t *ecache;
+};
+
+static size_t
+pa_resident_ranges(void *varg, pages_range_t *ranges, size_t nranges) {
+	pa_resident_ranges_arg_t *arg = (pa_resident_ranges_arg_t *)varg;
+	if (arg->ecache == NULL) {
+		return hpa_shard_resident_ranges(
+		    arg->tsdn, &arg->shard->hpa_shard, ranges, nranges);
+	}
+	return ecache_resident_ranges(arg->tsdn, arg->ecache, ranges, nranges);
+}
+
+bool
+pa_shard_resident_scan(
+    tsdn_t *tsdn, pa_shard_t *shard, pa_resident_scan_t *scan) {
+	ecache_t *ecaches[] = {&shard->pac.ecache_dirty,
+	    &shard->pac.ecache_muzzy, &shard->pac.ecache_retained};
+	size_t   *resident[] = {&scan->dirty, &scan->muzzy, &scan->retained};
+	for (unsigned i = 0; i < sizeof(ecaches) / sizeof(ecaches[0]); i++) {
+		pa_resident_ranges_arg_t arg = {tsdn, shard, ecaches[i]};
+		size_t                   huge = 0;
+		if (pages_ranges_resident(
+		        pa_resident_ranges, &arg, resident[i], &huge)) {
+			return true;
+		}
+	}
+	if (shard->ever_used_hpa) {
+		pa_resident_ranges_arg_t arg = {tsdn, shard, NULL};
+		if (pages_ranges_resident(pa_resident_ranges, &arg,
+		        &scan->hpa_nonfull, &scan->hpa_nonfull_huge)) {
+			return true;
+		}
+	}
+	return false;
+}
+
 static void
 pa_shard_mtx_stats_read_single(tsdn_t *tsdn, mutex_prof_data_t *mutex_prof_data,
     malloc_mutex_t *mtx, int ind) {
@@ -203,4 +261,6 @@ pa_shard_mtx_stats_read(tsdn_t *tsdn, pa_shard_t *shard,
 		sec_mutex_stats_read(tsdn, &shard->hpa_shard.sec,
 		    &mutex_prof_data[arena_prof_mutex_hpa_sec]);
 	}
+	lec_mutex_stats_read(
+	    tsdn, &shard->lec, &mutex_prof_data[arena_prof_mutex_lec]);
 }
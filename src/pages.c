@@ -620,6 +620,77 @@ pages_dodump(void *addr, size_t size) {
 #endif
 }
 
+#define PAGES_RESIDENT_BATCH 256
+
+bool
+pages_resident(void *addr, size_t size, size_t *resident) {
+	assert(PAGE_ADDR2BASE(addr) == addr);
+	assert(PAGE_CEILING(size) == size);
+#ifdef JEMALLOC_HAVE_MINCORE
+	/* One byte per OS page; query in batches to bound stack usage. */
+	unsigned char vec[PAGES_RESIDENT_BATCH];
+	uintptr_t     cur = (uintptr_t)addr;
+	size_t        npages = size / os_page;
+	size_t        nresident = 0;
+	while (npages > 0) {
+		size_t n = npages < PAGES_RESIDENT_BATCH ? npages
+		                                         : PAGES_RESIDENT_BATCH;
+		if (mincore((void *)cur, n * os_page, (void *)vec) != 0) {
+			return true;
+		}
+		for (size_t i = 0; i < n; i++) {
+			nresident += vec[i] & 1;
+		}
+		cur += n * os_page;
+		npages -= n;
+	}
+	*resident = nresident * os_page;
+	return false;
+#else
+	return true;
+#endif
+}
+
+bool
+pages_ranges_resident(
+    pages_ranges_copy_t *copy, void *arg, size_t *resident, size_t *huge) {
+	pages_range_t *ranges = NULL;
+	size_t         size = 0;
+	size_t         nranges;
+	while ((nranges = copy(arg, ranges, size / sizeof(pages_range_t)))
+	    > size / sizeof(pages_range_t)) {
+		if (ranges != NULL) {
+			pages_unmap(ranges, size);
+		}
+		/* Leave room for the ranges added before the next copy. */
+		size = PAGE_CEILING(2 * nranges * sizeof(pages_range_t));
+		bool commit = true;
+		ranges = (pages_range_t *)pages_map(NULL, size, PAGE, &commit);
+		if (ranges == NULL) {
+			return true;
+		}
+	}
+
+	for (size_t i = 0; i < nranges; i++) {
+		size_t r;
+		/*
+		 * The range may have been unmapped since it was copied, e.g.
+		 * by custom extent hooks; it's no longer resident then.
+		 */
+		if (pages_resident(ranges[i].addr, ranges[i].size, &r)) {
+			continue;
+		}
+		*resident += r;
+		if (ranges[i].huge) {
+			*huge += r;
+		}
+	}
+	if (ranges != NULL) {
+		pages_unmap(ranges, size);
+	}
+	return false;
+}
+
 #ifdef JEMALLOC_HAVE_PROCESS_MADVISE
 #	include <sys/mman.h>
 #	include <sys/syscall.h>
@@ -4,6 +4,7 @@
 #include "jemalloc/internal/peak_event.h"
 
 #include "jemalloc/internal/activity_callback.h"
+#include "jemalloc/internal/alloc_tag.h"
 #include "jemalloc/internal/peak.h"
 #include "jemalloc/internal/thread_event_registry.h"
 
@@ -55,6 +56,7 @@ peak_event_postponed_event_wait(tsd_t *tsd) {
 static void
 peak_event_handler(tsd_t *tsd) {
 	peak_event_update(tsd);
+	alloc_tag_flush(tsd);
 	peak_event_activity_callback(tsd);
 }
 
@@ -5,6 +5,8 @@
 #include "jemalloc/internal/assert.h"
 #include "jemalloc/internal/mutex.h"
 #include "jemalloc/internal/counter.h"
+#include "jemalloc/internal/prof_callsite.h"
+#include "jemalloc/internal/prof_contention.h"
 #include "jemalloc/internal/prof_data.h"
 #include "jemalloc/internal/prof_log.h"
 #include "jemalloc/internal/prof_recent.h"
@@ -39,10 +41,29 @@ bool     opt_prof_pid_namespace = false;
 char     opt_prof_prefix[PROF_DUMP_FILENAME_LEN];
 bool     opt_prof_sys_thread_name = false;
 bool     opt_prof_unbias = true;
+ssize_t  opt_prof_bg_dump_ms = -1;
+bool     opt_prof_lifetime = false;
+unsigned opt_prof_overhead_ppm = 0;
 
 /* Accessed via prof_sample_event_handler(). */
 static counter_accum_t prof_idump_accumulated;
 
+/*
+ * Interval and growth triggered dumps left to background thread 0 under
+ * opt_prof_bg_dump_ms.  Triggering only sets the flag for its kind, so that
+ * however many triggers happen before the background thread gets to them end
+ * up as one dump.
+ */
+static atomic_b_t prof_bg_idump_pending;
+static atomic_b_t prof_bg_gdump_pending;
+/* When the last deferred dump started; only accessed by background thread 0. */
+static nstime_t prof_bg_dump_last = NSTIME_ZERO_INITIALIZER;
+/*
+ * Set when prof_bg_thread0_wakeup() couldn't get at background thread 0, which
+ * may then have checked for deferred work just before it was triggered.
+ */
+static atomic_b_t prof_bg_thread0_wakeup_missed;
+
 /*
  * Initialized as opt_prof_active, and accessed via
  * prof_active_[gs]et{_unlocked,}().
@@ -68,6 +89,31 @@ uint64_t prof_interval = 0;
 
 size_t lg_prof_sample;
 
+atomic_u_t prof_sample_step = ATOMIC_INIT(0);
+
+/*
+ * Under opt_prof_overhead_ppm, the time spent taking samples is added up over
+ * windows of at least this long, at the end of which the sampling rate is
+ * adjusted.
+ */
+#define PROF_SAMPLE_WINDOW_MS 1000
+
+/* The sample time wraps around much sooner without 64-bit atomics. */
+#ifdef JEMALLOC_ATOMIC_U64
+static atomic_u64_t prof_sample_spent_ns;
+#	define prof_sample_spent_add atomic_fetch_add_u64
+#	define prof_sample_spent_exchange atomic_exchange_u64
+#else
+static atomic_zu_t prof_sample_spent_ns;
+#	define prof_sample_spent_add atomic_fetch_add_zu
+#	define prof_sample_spent_exchange atomic_exchange_zu
+#endif
+/*
+ * Start of the current window, in milliseconds of the monotonic clock; only
+ * differences are used, so wrapping around is fine.
+ */
+static atomic_zu_t prof_sample_window_ms;
+
 static uint64_t       next_thr_uid;
 static malloc_mutex_t next_thr_uid_mtx;
 
@@ -123,7 +169,12 @@ prof_malloc_sample_object(
 
 	edata_t *edata = emap_edata_lookup(
 	    tsd_tsdn(tsd), &arena_emap_global, ptr);
-	prof_info_set(tsd, edata, tctx, size);
+	/*
+	 * The wait that led here may have been drawn at an earlier rate; the
+	 * resulting bias is limited to one sample per thread per rate change.
+	 */
+	unsigned sample_step = prof_sample_step_get();
+	prof_info_set(tsd, edata, tctx, size, sample_step);
 
 	szind_t szind = sz_size2index(usize);
 
@@ -138,8 +189,9 @@ prof_malloc_sample_object(
 	 * the prof_reset call is about to mark our tctx as expired before any
 	 * dumping of our corrupted output is attempted.
 	 */
-	size_t shifted_unbiased_cnt = prof_shifted_unbiased_cnt[szind];
-	size_t unbiased_bytes = prof_unbiased_sz[szind];
+	size_t shifted_unbiased_cnt =
+	    prof_shifted_unbiased_cnt[sample_step][szind];
+	size_t unbiased_bytes = prof_unbiased_sz[sample_step][szind];
 	tctx->cnts.curobjs++;
 	tctx->cnts.curobjs_shifted_unbiased += shifted_unbiased_cnt;
 	tctx->cnts.curbytes += usize;
@@ -172,6 +224,24 @@ prof_malloc_sample_object(
 	}
 }
 
+static unsigned
+prof_lifetime_ind(const nstime_t *alloc_time) {
+	nstime_t lifetime;
+	nstime_prof_init_update(&lifetime);
+	if (nstime_compare(&lifetime, alloc_time) <= 0) {
+		return 0;
+	}
+	nstime_subtract(&lifetime, alloc_time);
+	uint64_t ns = nstime_ns(&lifetime);
+	uint64_t bound = KQU(1000);
+	unsigned ind = 0;
+	while (ind < PROF_LIFETIME_NBUCKETS - 1 && ns >= bound) {
+		bound *= 10;
+		ind++;
+	}
+	return ind;
+}
+
 void
 prof_free_sampled_object(
     tsd_t *tsd, const void *ptr, size_t usize, prof_info_t *prof_info) {
@@ -183,6 +253,13 @@ prof_free_sampled_object(
 
 	szind_t szind = sz_size2index(usize);
 
+	if (opt_prof_lifetime) {
+		/* tctx, and so its gctx, stays alive at least until below. */
+		atomic_fetch_add_zu(&tctx->gctx->lifetimes[prof_lifetime_ind(
+		                        &prof_info->alloc_time)],
+		    1, ATOMIC_RELAXED);
+	}
+
 	/* Unsample hook. */
 	prof_sample_free_hook_t prof_sample_free_hook =
 	    prof_sample_free_hook_get();
@@ -203,19 +280,65 @@ prof_free_sampled_object(
 	 * yet.
 	 */
 	tctx->cnts.curobjs--;
-	tctx->cnts.curobjs_shifted_unbiased -= prof_shifted_unbiased_cnt[szind];
+	/* Take back what was added, even if the rate has changed since. */
+	tctx->cnts.curobjs_shifted_unbiased -=
+	    prof_shifted_unbiased_cnt[prof_info->sample_step][szind];
 	tctx->cnts.curbytes -= usize;
-	tctx->cnts.curbytes_unbiased -= prof_unbiased_sz[szind];
+	tctx->cnts.curbytes_unbiased -=
+	    prof_unbiased_sz[prof_info->sample_step][szind];
 
 	prof_try_log(tsd, usize, prof_info);
 
 	prof_tctx_try_destroy(tsd, tctx);
+	prof_log_flush_backlog(tsd_tsdn(tsd));
 
 	if (opt_prof_stats) {
 		prof_stats_dec(tsd, szind, prof_info->alloc_size);
 	}
 }
 
+/*
+ * Closes the sampling window if it has run its course, and moves the sampling
+ * rate toward opt_prof_overhead_ppm: one doubling of the sampling interval
+ * halves the number of samples, and so, roughly, the time they take.
+ */
+static void
+prof_sample_adapt(const nstime_t *now) {
+	size_t now_ms = (size_t)nstime_ms(now);
+	size_t window_ms = atomic_load_zu(
+	    &prof_sample_window_ms, ATOMIC_RELAXED);
+	size_t elapsed_ms = now_ms - window_ms;
+	if (elapsed_ms < PROF_SAMPLE_WINDOW_MS) {
+		return;
+	}
+	/* Whoever moves the window start on adjusts the rate. */
+	if (!atomic_compare_exchange_strong_zu(&prof_sample_window_ms,
+	        &window_ms, now_ms, ATOMIC_RELAXED, ATOMIC_RELAXED)) {
+		return;
+	}
+	uint64_t ppm = (uint64_t)prof_sample_spent_exchange(
+	                   &prof_sample_spent_ns, 0, ATOMIC_RELAXED)
+	    / elapsed_ms;
+
+	unsigned step = prof_sample_step_get();
+	unsigned step_max = PROF_SAMPLE_NSTEPS - 1;
+	if (lg_prof_sample + step_max > (sizeof(uint64_t) << 3) - 1) {
+		step_max = (unsigned)((sizeof(uint64_t) << 3) - 1
+		    - lg_prof_sample);
+	}
+	uint64_t budget = opt_prof_overhead_ppm;
+	if (ppm > budget) {
+		while (ppm > budget && step < step_max) {
+			ppm /= 2;
+			step++;
+		}
+	} else if (step > 0 && ppm * 2 <= budget - budget / 4) {
+		/* Back off one step at a time, and with some margin. */
+		step--;
+	}
+	atomic_store_u(&prof_sample_step, step, ATOMIC_RELAXED);
+}
+
 prof_tctx_t *
 prof_tctx_create(tsd_t *tsd) {
 	if (!tsd_nominal(tsd) || tsd_reentrancy_level_get(tsd) > 0) {
@@ -229,8 +352,26 @@ prof_tctx_create(tsd_t *tsd) {
 
 	prof_bt_t bt;
 	bt_init(&bt, tdata->vec);
+	if (opt_prof_overhead_ppm == 0) {
+		prof_backtrace(tsd, &bt);
+		return prof_lookup(tsd, &bt);
+	}
+
+	/*
+	 * The clock may well be coarser than a sample takes; the time measured
+	 * is still right on average, which is all the adjustment needs.
+	 */
+	nstime_t start, end;
+	nstime_init_update(&start);
 	prof_backtrace(tsd, &bt);
-	return prof_lookup(tsd, &bt);
+	prof_tctx_t *tctx = prof_lookup(tsd, &bt);
+	nstime_init_update(&end);
+	if (nstime_compare(&end, &start) > 0) {
+		prof_sample_spent_add(&prof_sample_spent_ns,
+		    nstime_ns_between(&start, &end), ATOMIC_RELAXED);
+	}
+	prof_sample_adapt(&end);
+	return tctx;
 }
 
 /*
@@ -249,7 +390,8 @@ prof_tctx_create(tsd_t *tsd) {
 uint64_t
 prof_sample_new_event_wait(tsd_t *tsd) {
 #ifdef JEMALLOC_PROF
-	if (lg_prof_sample == 0) {
+	size_t lg_sample = prof_lg_sample_effective();
+	if (lg_sample == 0) {
 		return TE_MIN_START_WAIT;
 	}
 
@@ -284,7 +426,7 @@ prof_sample_new_event_wait(tsd_t *tsd) {
 	      : (double)((long double)r * (1.0L / 9007199254740992.0L));
 	return (uint64_t)(log(u)
 	           / log(
-	               1.0 - (1.0 / (double)((uint64_t)1U << lg_prof_sample))))
+	               1.0 - (1.0 / (double)((uint64_t)1U << lg_sample))))
 	    + (uint64_t)1U;
 #else
 	not_reached();
@@ -354,6 +496,99 @@ prof_fdump(void) {
 	prof_fdump_impl(tsd);
 }
 
+/*
+ * Bounds how late deferred work can be when its trigger raced with background
+ * thread 0 going to sleep (triggers only try to wake it up, so as not to wait
+ * behind its other work).
+ */
+#define PROF_BG_DUMP_RECHECK_NS (KQU(1000) * KQU(1000) * KQU(1000))
+
+static bool
+prof_bg_dump_defer(tsdn_t *tsdn, atomic_b_t *pending) {
+	if (opt_prof_bg_dump_ms < 0 || !background_thread_enabled()) {
+		return false;
+	}
+	if (atomic_exchange_b(pending, true, ATOMIC_ACQ_REL)
+	    && !atomic_load_b(&prof_bg_thread0_wakeup_missed, ATOMIC_ACQUIRE)) {
+		/* Coalesced with a dump that is still pending. */
+		return true;
+	}
+	prof_bg_thread0_wakeup(tsdn);
+	return true;
+}
+
+void
+prof_bg_thread0_wakeup(tsdn_t *tsdn) {
+	cassert(config_prof);
+
+	background_thread_info_t *info = &background_thread_info[0];
+	if (malloc_mutex_trylock(tsdn, &info->mtx)) {
+		atomic_store_b(
+		    &prof_bg_thread0_wakeup_missed, true, ATOMIC_RELEASE);
+		return;
+	}
+	if (background_thread_is_started(info)) {
+		background_thread_wakeup_early(info, NULL);
+	}
+	malloc_mutex_unlock(tsdn, &info->mtx);
+}
+
+void
+prof_bg_thread0_wakeup_clear(void) {
+	cassert(config_prof);
+
+	/* An exchange, so that we see what the trigger published before. */
+	atomic_exchange_b(&prof_bg_thread0_wakeup_missed, false, ATOMIC_ACQ_REL);
+}
+
+static uint64_t
+prof_bg_dump_ns_until_impl(void) {
+	if (opt_prof_bg_dump_ms < 0) {
+		return BACKGROUND_THREAD_DEFERRED_MAX;
+	}
+	if (!atomic_load_b(&prof_bg_idump_pending, ATOMIC_ACQUIRE)
+	    && !atomic_load_b(&prof_bg_gdump_pending, ATOMIC_ACQUIRE)) {
+		return BACKGROUND_THREAD_DEFERRED_MAX;
+	}
+	uint64_t interval_ns = (uint64_t)opt_prof_bg_dump_ms * KQU(1000000);
+	nstime_t elapsed;
+	nstime_init_update(&elapsed);
+	if (nstime_compare(&elapsed, &prof_bg_dump_last) <= 0) {
+		return interval_ns;
+	}
+	nstime_subtract(&elapsed, &prof_bg_dump_last);
+	uint64_t elapsed_ns = nstime_ns(&elapsed);
+	return elapsed_ns >= interval_ns ? 0 : interval_ns - elapsed_ns;
+}
+
+uint64_t
+prof_bg_dump_ns_until(void) {
+	cassert(config_prof);
+
+	uint64_t ns = prof_bg_dump_ns_until_impl();
+	if (ns > PROF_BG_DUMP_RECHECK_NS
+	    && atomic_load_b(&prof_bg_thread0_wakeup_missed, ATOMIC_ACQUIRE)) {
+		/* A trigger (of a dump or a log flush) may have raced. */
+		return PROF_BG_DUMP_RECHECK_NS;
+	}
+	return ns;
+}
+
+void
+prof_bg_dump(tsd_t *tsd) {
+	cassert(config_prof);
+	/* Triggers check prof_booted before deferring anything. */
+	assert(prof_booted);
+
+	nstime_init_update(&prof_bg_dump_last);
+	if (atomic_exchange_b(&prof_bg_idump_pending, false, ATOMIC_ACQ_REL)) {
+		prof_idump_impl(tsd);
+	}
+	if (atomic_exchange_b(&prof_bg_gdump_pending, false, ATOMIC_ACQ_REL)) {
+		prof_gdump_impl(tsd);
+	}
+}
+
 static bool
 prof_idump_accum_init(void) {
 	cassert(config_prof);
@@ -384,6 +619,9 @@ prof_idump(tsdn_t *tsdn) {
 		tdata->enq_idump = true;
 		return;
 	}
+	if (prof_bg_dump_defer(tsdn, &prof_bg_idump_pending)) {
+		return;
+	}
 
 	prof_idump_impl(tsd);
 }
@@ -423,6 +661,9 @@ prof_gdump(tsdn_t *tsdn) {
 		tdata->enq_gdump = true;
 		return;
 	}
+	if (prof_bg_dump_defer(tsdn, &prof_bg_gdump_pending)) {
+		return;
+	}
 
 	prof_gdump_impl(tsd);
 }
@@ -689,10 +930,6 @@ prof_boot2(tsd_t *tsd, base_t *base) {
 	        malloc_mutex_rank_exclusive)) {
 		return true;
 	}
-	if (malloc_mutex_init(&bt2gctx_mtx, "prof_bt2gctx",
-	        WITNESS_RANK_PROF_BT2GCTX, malloc_mutex_rank_exclusive)) {
-		return true;
-	}
 	if (malloc_mutex_init(&tdatas_mtx, "prof_tdatas",
 	        WITNESS_RANK_PROF_TDATAS, malloc_mutex_rank_exclusive)) {
 		return true;
@@ -717,11 +954,17 @@ prof_boot2(tsd_t *tsd, base_t *base) {
 	if (opt_prof) {
 		lg_prof_sample = opt_lg_prof_sample;
 		prof_unbias_map_init();
+		if (opt_prof_overhead_ppm != 0) {
+			nstime_t now;
+			nstime_init_update(&now);
+			atomic_store_zu(&prof_sample_window_ms,
+			    (size_t)nstime_ms(&now), ATOMIC_RELAXED);
+		}
 		prof_active_state = opt_prof_active;
 		prof_gdump_val = opt_prof_gdump;
 		prof_thread_active_init = opt_prof_thread_active_init;
 
-		if (prof_data_init(tsd)) {
+		if (prof_data_init(tsd, base)) {
 			return true;
 		}
 
@@ -746,6 +989,14 @@ prof_boot2(tsd_t *tsd, base_t *base) {
 			return true;
 		}
 
+		if (prof_contention_init(tsd_tsdn(tsd), base)) {
+			return true;
+		}
+
+		if (prof_callsite_init(tsd_tsdn(tsd), base)) {
+			return true;
+		}
+
 		prof_base = base;
 
 		gctx_locks = (malloc_mutex_t *)base_alloc(tsd_tsdn(tsd), base,
@@ -788,16 +1039,20 @@ prof_prefork0(tsdn_t *tsdn) {
 		unsigned i;
 
 		malloc_mutex_prefork(tsdn, &prof_dump_mtx);
-		malloc_mutex_prefork(tsdn, &bt2gctx_mtx);
+		for (i = 0; i < PROF_BT2GCTX_NSHARDS; i++) {
+			malloc_mutex_prefork(tsdn, &bt2gctx_locks[i]);
+		}
 		malloc_mutex_prefork(tsdn, &tdatas_mtx);
 		for (i = 0; i < PROF_NTDATA_LOCKS; i++) {
 			malloc_mutex_prefork(tsdn, &tdata_locks[i]);
 		}
+		malloc_mutex_prefork(tsdn, &log_write_mtx);
 		malloc_mutex_prefork(tsdn, &log_mtx);
 		for (i = 0; i < PROF_NCTX_LOCKS; i++) {
 			malloc_mutex_prefork(tsdn, &gctx_locks[i]);
 		}
 		malloc_mutex_prefork(tsdn, &prof_recent_dump_mtx);
+		malloc_mutex_prefork(tsdn, &prof_recent_alloc_mtx);
 	}
 }
 
@@ -808,8 +1063,9 @@ prof_prefork1(tsdn_t *tsdn) {
 		malloc_mutex_prefork(tsdn, &prof_active_mtx);
 		malloc_mutex_prefork(tsdn, &prof_dump_filename_mtx);
 		malloc_mutex_prefork(tsdn, &prof_gdump_mtx);
-		malloc_mutex_prefork(tsdn, &prof_recent_alloc_mtx);
+		prof_recent_prefork(tsdn);
 		malloc_mutex_prefork(tsdn, &prof_stats_mtx);
+		malloc_mutex_prefork(tsdn, &prof_callsite_mtx);
 		malloc_mutex_prefork(tsdn, &next_thr_uid_mtx);
 		malloc_mutex_prefork(tsdn, &prof_thread_active_init_mtx);
 	}
@@ -823,22 +1079,27 @@ prof_postfork_parent(tsdn_t *tsdn) {
 		malloc_mutex_postfork_parent(
 		    tsdn, &prof_thread_active_init_mtx);
 		malloc_mutex_postfork_parent(tsdn, &next_thr_uid_mtx);
+		malloc_mutex_postfork_parent(tsdn, &prof_callsite_mtx);
 		malloc_mutex_postfork_parent(tsdn, &prof_stats_mtx);
-		malloc_mutex_postfork_parent(tsdn, &prof_recent_alloc_mtx);
+		prof_recent_postfork_parent(tsdn);
 		malloc_mutex_postfork_parent(tsdn, &prof_gdump_mtx);
 		malloc_mutex_postfork_parent(tsdn, &prof_dump_filename_mtx);
 		malloc_mutex_postfork_parent(tsdn, &prof_active_mtx);
 		counter_postfork_parent(tsdn, &prof_idump_accumulated);
+		malloc_mutex_postfork_parent(tsdn, &prof_recent_alloc_mtx);
 		malloc_mutex_postfork_parent(tsdn, &prof_recent_dump_mtx);
 		for (i = 0; i < PROF_NCTX_LOCKS; i++) {
 			malloc_mutex_postfork_parent(tsdn, &gctx_locks[i]);
 		}
 		malloc_mutex_postfork_parent(tsdn, &log_mtx);
+		malloc_mutex_postfork_parent(tsdn, &log_write_mtx);
 		for (i = 0; i < PROF_NTDATA_LOCKS; i++) {
 			malloc_mutex_postfork_parent(tsdn, &tdata_locks[i]);
 		}
 		malloc_mutex_postfork_parent(tsdn, &tdatas_mtx);
-		malloc_mutex_postfork_parent(tsdn, &bt2gctx_mtx);
+		for (i = 0; i < PROF_BT2GCTX_NSHARDS; i++) {
+			malloc_mutex_postfork_parent(tsdn, &bt2gctx_locks[i]);
+		}
 		malloc_mutex_postfork_parent(tsdn, &prof_dump_mtx);
 	}
 }
@@ -850,22 +1111,27 @@ prof_postfork_child(tsdn_t *tsdn) {
 
 		malloc_mutex_postfork_child(tsdn, &prof_thread_active_init_mtx);
 		malloc_mutex_postfork_child(tsdn, &next_thr_uid_mtx);
+		malloc_mutex_postfork_child(tsdn, &prof_callsite_mtx);
 		malloc_mutex_postfork_child(tsdn, &prof_stats_mtx);
-		malloc_mutex_postfork_child(tsdn, &prof_recent_alloc_mtx);
+		prof_recent_postfork_child(tsdn);
 		malloc_mutex_postfork_child(tsdn, &prof_gdump_mtx);
 		malloc_mutex_postfork_child(tsdn, &prof_dump_filename_mtx);
 		malloc_mutex_postfork_child(tsdn, &prof_active_mtx);
 		counter_postfork_child(tsdn, &prof_idump_accumulated);
+		malloc_mutex_postfork_child(tsdn, &prof_recent_alloc_mtx);
 		malloc_mutex_postfork_child(tsdn, &prof_recent_dump_mtx);
 		for (i = 0; i < PROF_NCTX_LOCKS; i++) {
 			malloc_mutex_postfork_child(tsdn, &gctx_locks[i]);
 		}
 		malloc_mutex_postfork_child(tsdn, &log_mtx);
+		malloc_mutex_postfork_child(tsdn, &log_write_mtx);
 		for (i = 0; i < PROF_NTDATA_LOCKS; i++) {
 			malloc_mutex_postfork_child(tsdn, &tdata_locks[i]);
 		}
 		malloc_mutex_postfork_child(tsdn, &tdatas_mtx);
-		malloc_mutex_postfork_child(tsdn, &bt2gctx_mtx);
+		for (i = 0; i < PROF_BT2GCTX_NSHARDS; i++) {
+			malloc_mutex_postfork_child(tsdn, &bt2gctx_locks[i]);
+		}
 		malloc_mutex_postfork_child(tsdn, &prof_dump_mtx);
 	}
 }
@@ -0,0 +1,162 @@
+#include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/jemalloc_internal_includes.h"
+
+#include "jemalloc/internal/assert.h"
+#include "jemalloc/internal/prof_callsite.h"
+#include "jemalloc/internal/prof_data.h"
+
+#define LG_PROF_CALLSITE_NSLOTS 10
+#define PROF_CALLSITE_NSLOTS (1U << LG_PROF_CALLSITE_NSLOTS)
+/* Number of global slots looked at before a sample goes to the overflow. */
+#define PROF_CALLSITE_NPROBES 32
+
+bool           opt_prof_callsite = false;
+malloc_mutex_t prof_callsite_mtx;
+
+/* NULL unless callsite profiling is on; protected by prof_callsite_mtx. */
+static prof_callsite_t *prof_callsites = NULL;
+static prof_callsite_t  prof_callsite_overflow;
+
+static unsigned
+prof_callsite_hash(const void *addr, unsigned lg_nslots) {
+	uint64_t h = (uint64_t)(uintptr_t)addr * KQU(0x9e3779b97f4a7c15);
+	return (unsigned)(h >> (64 - lg_nslots));
+}
+
+static void
+prof_callsite_add(prof_callsite_t *slot, const void *addr,
+    uint64_t objs_shifted, uint64_t bytes) {
+	slot->addr = addr;
+	slot->objs_shifted += objs_shifted;
+	slot->bytes += bytes;
+}
+
+bool
+prof_callsite_init(tsdn_t *tsdn, base_t *base) {
+	cassert(config_prof);
+	if (malloc_mutex_init(&prof_callsite_mtx, "prof_callsite",
+	        WITNESS_RANK_PROF_CALLSITE, malloc_mutex_rank_exclusive)) {
+		return true;
+	}
+	if (!opt_prof_callsite) {
+		return false;
+	}
+	/* base_alloc() returns zeroed memory, i.e. all slots are empty. */
+	prof_callsites = (prof_callsite_t *)base_alloc(tsdn, base,
+	    PROF_CALLSITE_NSLOTS * sizeof(prof_callsite_t), CACHELINE);
+	return prof_callsites == NULL;
+}
+
+static void
+prof_callsite_flush_tdata(tsdn_t *tsdn, prof_tdata_t *tdata) {
+	malloc_mutex_lock(tsdn, &prof_callsite_mtx);
+	for (unsigned i = 0; i < PROF_CALLSITE_TDATA_NSLOTS; i++) {
+		prof_callsite_t *local = &tdata->callsites[i];
+		if (local->objs_shifted == 0) {
+			continue;
+		}
+		prof_callsite_t *slot = &prof_callsite_overflow;
+		unsigned h = prof_callsite_hash(
+		    local->addr, LG_PROF_CALLSITE_NSLOTS);
+		for (unsigned j = 0; j < PROF_CALLSITE_NPROBES; j++) {
+			unsigned         ind = (h + j) & (PROF_CALLSITE_NSLOTS - 1);
+			prof_callsite_t *probe = &prof_callsites[ind];
+			if (probe->objs_shifted == 0
+			    || probe->addr == local->addr) {
+				slot = probe;
+				break;
+			}
+		}
+		prof_callsite_add(slot,
+		    slot == &prof_callsite_overflow ? NULL : local->addr,
+		    local->objs_shifted, local->bytes);
+	}
+	malloc_mutex_unlock(tsdn, &prof_callsite_mtx);
+
+	memset(tdata->callsites, 0,
+	    PROF_CALLSITE_TDATA_NSLOTS * sizeof(prof_callsite_t));
+	tdata->callsites_nsamples = 0;
+}
+
+void
+prof_callsite_record(tsd_t *tsd, const void *callsite, size_t usize) {
+	cassert(config_prof);
+	assert(opt_prof_callsite);
+
+	/* The caller made sure of this through prof_sample_should_skip(). */
+	prof_tdata_t *tdata = tsd_prof_tdata_get(tsd);
+	assert(tdata != NULL && tdata->callsites != NULL);
+
+	unsigned sample_step = prof_sample_step_get();
+	szind_t  szind = sz_size2index(usize);
+	uint64_t objs_shifted = prof_shifted_unbiased_cnt[sample_step][szind];
+	uint64_t bytes = prof_unbiased_sz[sample_step][szind];
+
+	unsigned h = prof_callsite_hash(
+	    callsite, LG_PROF_CALLSITE_TDATA_NSLOTS);
+	for (unsigned pass = 0; pass < 2; pass++) {
+		for (unsigned i = 0; i < PROF_CALLSITE_TDATA_NSLOTS; i++) {
+			prof_callsite_t *slot = &tdata->callsites[(h + i)
+			    & (PROF_CALLSITE_TDATA_NSLOTS - 1)];
+			if (slot->objs_shifted == 0 || slot->addr == callsite) {
+				prof_callsite_add(
+				    slot, callsite, objs_shifted, bytes);
+				if (++tdata->callsites_nsamples
+				    >= PROF_CALLSITE_FLUSH_NSAMPLES) {
+					prof_callsite_flush_tdata(
+					    tsd_tsdn(tsd), tdata);
+				}
+				return;
+			}
+		}
+		/* Full; make room and try again. */
+		prof_callsite_flush_tdata(tsd_tsdn(tsd), tdata);
+	}
+	not_reached();
+}
+
+void
+prof_callsite_flush(tsd_t *tsd) {
+	cassert(config_prof);
+	prof_tdata_t *tdata = tsd_prof_tdata_get(tsd);
+	if (tdata == NULL || tdata->callsites == NULL
+	    || tdata->callsites_nsamples == 0) {
+		return;
+	}
+	prof_callsite_flush_tdata(tsd_tsdn(tsd), tdata);
+}
+
+static void
+prof_callsite_top_insert(prof_callsite_t *top, unsigned ntop, unsigned *n,
+    const prof_callsite_t *c) {
+	if (c->objs_shifted == 0) {
+		return;
+	}
+	unsigned i = *n < ntop ? (*n)++ : ntop;
+	for (; i > 0 && top[i - 1].bytes < c->bytes; i--) {
+		if (i < ntop) {
+			top[i] = top[i - 1];
+		}
+	}
+	if (i < ntop) {
+		top[i] = *c;
+	}
+}
+
+unsigned
+prof_callsite_top(tsdn_t *tsdn, prof_callsite_t *top, unsigned ntop) {
+	cassert(config_prof);
+	memset(top, 0, ntop * sizeof(prof_callsite_t));
+	if (prof_callsites == NULL) {
+		return 0;
+	}
+
+	unsigned n = 0;
+	malloc_mutex_lock(tsdn, &prof_callsite_mtx);
+	for (unsigned i = 0; i < PROF_CALLSITE_NSLOTS; i++) {
+		prof_callsite_top_insert(top, ntop, &n, &prof_callsites[i]);
+	}
+	prof_callsite_top_insert(top, ntop, &n, &prof_callsite_overflow);
+	malloc_mutex_unlock(tsdn, &prof_callsite_mtx);
+	return n;
+}
@@ -0,0 +1,304 @@
+#include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/jemalloc_internal_includes.h"
+
+#include "jemalloc/internal/assert.h"
+#include "jemalloc/internal/hash.h"
+#include "jemalloc/internal/prof_contention.h"
+#include "jemalloc/internal/prof_sys.h"
+
+#define LG_PROF_CONTENTION_NSLOTS 10
+#define PROF_CONTENTION_NSLOTS (1U << LG_PROF_CONTENTION_NSLOTS)
+/* Number of slots looked at before a sample is discarded. */
+#define PROF_CONTENTION_NPROBES 64
+
+/* Slot states; a slot never goes back to empty once claimed. */
+#define PROF_CONTENTION_SLOT_EMPTY 0
+#define PROF_CONTENTION_SLOT_BUSY 1
+#define PROF_CONTENTION_SLOT_READY 2
+
+/*
+ * The counters wrap around much sooner on platforms without 64-bit atomics;
+ * that's the price of not taking locks while recording.
+ */
+#ifdef JEMALLOC_ATOMIC_U64
+typedef atomic_u64_t prof_contention_counter_t;
+#	define prof_contention_counter_load atomic_load_u64
+#	define prof_contention_counter_store atomic_store_u64
+#	define prof_contention_counter_add atomic_fetch_add_u64
+#else
+typedef atomic_zu_t prof_contention_counter_t;
+#	define prof_contention_counter_load atomic_load_zu
+#	define prof_contention_counter_store atomic_store_zu
+#	define prof_contention_counter_add atomic_fetch_add_zu
+#endif
+
+typedef struct prof_contention_slot_s prof_contention_slot_t;
+struct prof_contention_slot_s {
+	atomic_u32_t state;
+	/* Immutable once the slot is ready. */
+	unsigned len;
+	size_t   hash;
+	void    *vec[PROF_CONTENTION_BT_MAX];
+	/* Number of sampled waits, and the nanoseconds spent in them. */
+	prof_contention_counter_t count;
+	prof_contention_counter_t wait_ns;
+};
+
+bool   opt_prof_contention = false;
+size_t opt_lg_prof_contention_sample = LG_PROF_CONTENTION_SAMPLE_DEFAULT;
+
+/* NULL unless profiling is on; set during boot, before any thread exists. */
+static prof_contention_slot_t   *prof_contention_slots = NULL;
+static prof_contention_counter_t prof_contention_discarded;
+
+bool
+prof_contention_init(tsdn_t *tsdn, base_t *base) {
+	cassert(config_prof);
+	if (!opt_prof_contention) {
+		return false;
+	}
+	prof_contention_slots = (prof_contention_slot_t *)base_alloc(tsdn,
+	    base, PROF_CONTENTION_NSLOTS * sizeof(prof_contention_slot_t),
+	    CACHELINE);
+	if (prof_contention_slots == NULL) {
+		return true;
+	}
+	/* base_alloc() returns zeroed memory, i.e. all slots are empty. */
+	prof_contention_counter_store(
+	    &prof_contention_discarded, 0, ATOMIC_RELAXED);
+	return false;
+}
+
+#if defined(__linux__) && defined(JEMALLOC_HAVE_GETTID)
+/* Stack mapping of the current thread, looked up on its first sample. */
+static __thread uintptr_t prof_contention_stack_low = 0;
+static __thread uintptr_t prof_contention_stack_high = 0;
+static __thread bool      prof_contention_stack_unknown = false;
+#endif
+
+static bool
+prof_contention_stack_range(uintptr_t fp, uintptr_t *low, uintptr_t *high) {
+#if defined(__linux__) && defined(JEMALLOC_HAVE_GETTID)
+	if (prof_contention_stack_unknown) {
+		return false;
+	}
+	if (prof_contention_stack_low == prof_contention_stack_high) {
+		/* Plain syscalls on a stack buffer; no allocation, no locks. */
+		if (prof_thread_stack_range(fp, &prof_contention_stack_low,
+		        &prof_contention_stack_high)
+		    != 0) {
+			prof_contention_stack_unknown = true;
+			return false;
+		}
+	}
+	if (fp < prof_contention_stack_low
+	    || fp >= prof_contention_stack_high) {
+		/* Switched stacks (fibers etc.); don't chase frames there. */
+		prof_contention_stack_unknown = true;
+		return false;
+	}
+	*low = prof_contention_stack_low;
+	*high = prof_contention_stack_high;
+	return true;
+#else
+	return false;
+#endif
+}
+
+/*
+ * The sampling thread may hold allocator mutexes, and both the configured
+ * unwinder and prof.backtrace_hook may take the loader lock or allocate.  Hence
+ * contention backtraces only follow the frame pointer chain, reading nothing
+ * outside of the thread's own stack, and stop at the first frame pointer that
+ * doesn't move up the stack.  Code built without frame pointers (see
+ * --enable-prof-frameptr) cuts the chain short; the return address of this
+ * function is always there though.
+ */
+JEMALLOC_DIAGNOSTIC_PUSH
+JEMALLOC_DIAGNOSTIC_IGNORE_FRAME_ADDRESS
+JEMALLOC_NOINLINE
+static void
+prof_contention_backtrace(prof_contention_sample_t *sample) {
+	uintptr_t fp = (uintptr_t)__builtin_frame_address(0);
+	uintptr_t low, high;
+
+	sample->vec[0] = __builtin_return_address(0);
+	sample->len = 1;
+	if (!prof_contention_stack_range(fp, &low, &high)) {
+		return;
+	}
+	while (sample->len < PROF_CONTENTION_BT_MAX) {
+		uintptr_t next = ((uintptr_t *)fp)[0];
+		if (next <= fp || next > high - 2 * sizeof(void *)
+		    || (next & (sizeof(void *) - 1)) != 0) {
+			break;
+		}
+		void *ip = ((void **)next)[1];
+		if (ip == NULL) {
+			break;
+		}
+		sample->vec[sample->len++] = ip;
+		fp = next;
+	}
+}
+JEMALLOC_DIAGNOSTIC_POP
+
+bool
+prof_contention_sample_hard(tsdn_t *tsdn, prof_contention_sample_t *sample) {
+	cassert(config_prof);
+	if (prof_contention_slots == NULL || tsdn_null(tsdn)) {
+		return false;
+	}
+	tsd_t *tsd = tsdn_tsd(tsdn);
+	/*
+	 * Waits from within the allocator's own reentrant calls (e.g. profile
+	 * dumps) would be sampled recursively.
+	 */
+	if (tsd_state_get(tsd) > tsd_state_nominal_max
+	    || tsd_reentrancy_level_get(tsd) > 0) {
+		return false;
+	}
+	if (opt_lg_prof_contention_sample != 0
+	    && prng_lg_range_u64(tsd_prng_statep_get(tsd),
+	           (unsigned)opt_lg_prof_contention_sample)
+	        != 0) {
+		return false;
+	}
+
+	prof_contention_backtrace(sample);
+	return sample->len != 0;
+}
+
+static bool
+prof_contention_slot_matches(prof_contention_slot_t *slot, size_t hash,
+    prof_contention_sample_t *sample) {
+	return slot->hash == hash && slot->len == sample->len
+	    && memcmp(slot->vec, sample->vec, sample->len * sizeof(void *))
+	    == 0;
+}
+
+void
+prof_contention_record(prof_contention_sample_t *sample, uint64_t wait_ns) {
+	cassert(config_prof);
+	assert(prof_contention_slots != NULL);
+	assert(sample->len > 0 && sample->len <= PROF_CONTENTION_BT_MAX);
+
+	size_t r_hash[2];
+	hash(sample->vec, sample->len * sizeof(void *), 0x6b8b4567U, r_hash);
+	size_t h = r_hash[0];
+	for (unsigned i = 0; i < PROF_CONTENTION_NPROBES; i++) {
+		prof_contention_slot_t *slot = &prof_contention_slots[(h + i)
+		    & (PROF_CONTENTION_NSLOTS - 1)];
+		uint32_t state = atomic_load_u32(&slot->state, ATOMIC_ACQUIRE);
+		if (state == PROF_CONTENTION_SLOT_EMPTY) {
+			if (atomic_compare_exchange_strong_u32(&slot->state,
+			        &state, PROF_CONTENTION_SLOT_BUSY,
+			        ATOMIC_ACQUIRE, ATOMIC_ACQUIRE)) {
+				slot->len = sample->len;
+				slot->hash = h;
+				memcpy(slot->vec, sample->vec,
+				    sample->len * sizeof(void *));
+				prof_contention_counter_add(
+				    &slot->count, 1, ATOMIC_RELAXED);
+				prof_contention_counter_add(
+				    &slot->wait_ns, wait_ns, ATOMIC_RELAXED);
+				atomic_store_u32(&slot->state,
+				    PROF_CONTENTION_SLOT_READY, ATOMIC_RELEASE);
+				return;
+			}
+		}
+		/*
+		 * A busy slot may be getting the very same backtrace; rather
+		 * than wait for it, move on, and let the dump list the
+		 * backtrace twice if need be (jeprof sums up duplicates).
+		 */
+		if (state == PROF_CONTENTION_SLOT_READY
+		    && prof_contention_slot_matches(slot, h, sample)) {
+			prof_contention_counter_add(
+			    &slot->count, 1, ATOMIC_RELAXED);
+			prof_contention_counter_add(
+			    &slot->wait_ns, wait_ns, ATOMIC_RELAXED);
+			return;
+		}
+	}
+	prof_contention_counter_add(&prof_contention_discarded, 1, ATOMIC_RELAXED);
+}
+
+void
+prof_contention_reset(void) {
+	cassert(config_prof);
+	if (prof_contention_slots == NULL) {
+		return;
+	}
+	/* Backtraces stay; the dump skips the ones without samples. */
+	for (unsigned i = 0; i < PROF_CONTENTION_NSLOTS; i++) {
+		prof_contention_slot_t *slot = &prof_contention_slots[i];
+		prof_contention_counter_store(&slot->count, 0, ATOMIC_RELAXED);
+		prof_contention_counter_store(&slot->wait_ns, 0, ATOMIC_RELAXED);
+	}
+	prof_contention_counter_store(
+	    &prof_contention_discarded, 0, ATOMIC_RELAXED);
+}
+
+JEMALLOC_FORMAT_PRINTF(3, 4)
+static void
+prof_contention_printf(
+    write_cb_t *write_cb, void *cbopaque, const char *format, ...) {
+	va_list ap;
+	char    buf[PROF_PRINTF_BUFSIZE];
+
+	va_start(ap, format);
+	malloc_vsnprintf(buf, sizeof(buf), format, ap);
+	va_end(ap);
+	write_cb(cbopaque, buf);
+}
+
+void
+prof_contention_write(write_cb_t *write_cb, void *cbopaque) {
+	cassert(config_prof);
+	assert(prof_contention_slots != NULL);
+
+	/* Waits are reported in ns, hence the 1GHz "clock". */
+	write_cb(cbopaque, "--- contention\n");
+	write_cb(cbopaque, "cycles/second = 1000000000\n");
+	prof_contention_printf(write_cb, cbopaque,
+	    "sampling period = %" FMTu64 "\n",
+	    (uint64_t)1 << opt_lg_prof_contention_sample);
+	prof_contention_printf(write_cb, cbopaque,
+	    "discarded samples = %" FMTu64 "\n",
+	    (uint64_t)prof_contention_counter_load(
+	        &prof_contention_discarded, ATOMIC_RELAXED));
+	for (unsigned i = 0; i < PROF_CONTENTION_NSLOTS; i++) {
+		prof_contention_slot_t *slot = &prof_contention_slots[i];
+		if (atomic_load_u32(&slot->state, ATOMIC_ACQUIRE)
+		    != PROF_CONTENTION_SLOT_READY) {
+			continue;
+		}
+		uint64_t count = prof_contention_counter_load(
+		    &slot->count, ATOMIC_RELAXED);
+		if (count == 0) {
+			continue;
+		}
+		prof_contention_printf(write_cb, cbopaque,
+		    "%" FMTu64 " %" FMTu64 " @",
+		    (uint64_t)prof_contention_counter_load(
+		        &slot->wait_ns, ATOMIC_RELAXED),
+		    count);
+		for (unsigned j = 0; j < slot->len; j++) {
+			prof_contention_printf(write_cb, cbopaque,
+			    " %#" FMTxPTR, (uintptr_t)slot->vec[j]);
+		}
+		write_cb(cbopaque, "\n");
+	}
+}
+
+bool
+prof_contention_dump(tsd_t *tsd, const char *filename) {
+	cassert(config_prof);
+	assert(tsd_reentrancy_level_get(tsd) == 0);
+
+	if (prof_contention_slots == NULL) {
+		return true;
+	}
+	return prof_contention_dump_impl(tsd, filename);
+}
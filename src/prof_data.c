@@ -25,10 +25,16 @@
 
 /******************************************************************************/
 
-malloc_mutex_t bt2gctx_mtx;
 malloc_mutex_t tdatas_mtx;
 malloc_mutex_t prof_dump_mtx;
 
+/*
+ * Locks for the bt2gctx shards; bt2gctx_locks[i] protects bt2gctx[i].  Dumps
+ * snapshot the shards one at a time, so no more than one is held at once
+ * (outside of fork, which takes them all, in order).
+ */
+malloc_mutex_t *bt2gctx_locks;
+
 /*
  * Table of mutexes that are shared among gctx's.  These are leaf locks, so
  * there is no problem with using them for more than one gctx at the same time.
@@ -49,9 +55,12 @@ malloc_mutex_t *tdata_locks;
 
 /*
  * Global hash of (prof_bt_t *)-->(prof_gctx_t *).  This is the master data
- * structure that knows about all backtraces currently captured.
+ * structure that knows about all backtraces currently captured.  It is split
+ * into PROF_BT2GCTX_NSHARDS independently locked tables by backtrace hash, so
+ * that looking up (or inserting) a backtrace only contends with threads
+ * sampling backtraces that hash to the same shard.
  */
-static ckh_t bt2gctx;
+static ckh_t *bt2gctx;
 
 /*
  * Tree of all extant prof_tdata_t structures, regardless of state,
@@ -59,8 +68,10 @@ static ckh_t bt2gctx;
  */
 static prof_tdata_tree_t tdatas;
 
-size_t prof_unbiased_sz[PROF_SC_NSIZES];
-size_t prof_shifted_unbiased_cnt[PROF_SC_NSIZES];
+size_t prof_unbiased_sz[PROF_SAMPLE_NSTEPS][PROF_SC_NSIZES];
+size_t prof_shifted_unbiased_cnt[PROF_SAMPLE_NSTEPS][PROF_SC_NSIZES];
+
+size_t prof_dump_lg_sample;
 
 /******************************************************************************/
 /* Red-black trees. */
@@ -139,32 +150,68 @@ prof_tdata_mutex_choose(uint64_t thr_uid) {
 	return &tdata_locks[thr_uid % PROF_NTDATA_LOCKS];
 }
 
+static unsigned
+prof_bt2gctx_shard(prof_bt_t *bt) {
+	size_t r_hash[2];
+	prof_bt_hash((void *)bt, r_hash);
+	/*
+	 * ckh indexes its buckets with the low bits of the hash; use the high
+	 * ones, so that each shard still gets well spread out keys.
+	 */
+	return (unsigned)(r_hash[0]
+	    >> (sizeof(size_t) * 8 - LG_PROF_BT2GCTX_NSHARDS));
+}
+
 bool
-prof_data_init(tsd_t *tsd) {
+prof_data_init(tsd_t *tsd, base_t *base) {
 	tdata_tree_new(&tdatas);
-	return ckh_new(
-	    tsd, &bt2gctx, PROF_CKH_MINITEMS, prof_bt_hash, prof_bt_keycomp);
+
+	bt2gctx_locks = (malloc_mutex_t *)base_alloc(tsd_tsdn(tsd), base,
+	    PROF_BT2GCTX_NSHARDS * sizeof(malloc_mutex_t), CACHELINE);
+	bt2gctx = (ckh_t *)base_alloc(tsd_tsdn(tsd), base,
+	    PROF_BT2GCTX_NSHARDS * sizeof(ckh_t), CACHELINE);
+	if (bt2gctx_locks == NULL || bt2gctx == NULL) {
+		return true;
+	}
+	for (unsigned i = 0; i < PROF_BT2GCTX_NSHARDS; i++) {
+		if (malloc_mutex_init(&bt2gctx_locks[i], "prof_bt2gctx",
+		        WITNESS_RANK_PROF_BT2GCTX,
+		        malloc_mutex_address_ordered)) {
+			return true;
+		}
+		if (ckh_new(tsd, &bt2gctx[i], PROF_CKH_MINITEMS, prof_bt_hash,
+		        prof_bt_keycomp)) {
+			return true;
+		}
+	}
+	return false;
 }
 
+/*
+ * Locks bt2gctx shard ind.  While a thread is inside, it defers the dumps it
+ * triggers until prof_leave().
+ */
 static void
-prof_enter(tsd_t *tsd, prof_tdata_t *tdata) {
+prof_enter(tsd_t *tsd, prof_tdata_t *tdata, unsigned ind) {
 	cassert(config_prof);
 	assert(tdata == prof_tdata_get(tsd, false));
+	assert(ind < PROF_BT2GCTX_NSHARDS);
 
 	if (tdata != NULL) {
 		assert(!tdata->enq);
 		tdata->enq = true;
 	}
 
-	malloc_mutex_lock(tsd_tsdn(tsd), &bt2gctx_mtx);
+	malloc_mutex_lock(tsd_tsdn(tsd), &bt2gctx_locks[ind]);
 }
 
 static void
-prof_leave(tsd_t *tsd, prof_tdata_t *tdata) {
+prof_leave(tsd_t *tsd, prof_tdata_t *tdata, unsigned ind) {
 	cassert(config_prof);
 	assert(tdata == prof_tdata_get(tsd, false));
+	assert(ind < PROF_BT2GCTX_NSHARDS);
 
-	malloc_mutex_unlock(tsd_tsdn(tsd), &bt2gctx_mtx);
+	malloc_mutex_unlock(tsd_tsdn(tsd), &bt2gctx_locks[ind]);
 
 	if (tdata != NULL) {
 		bool idump, gdump;
@@ -203,6 +250,10 @@ prof_gctx_create(tsdn_t *tsdn, prof_bt_t *bt) {
 	 * prof_tctx_destroy()/prof_gctx_try_destroy().
 	 */
 	gctx->nlimbo = 1;
+	gctx->dumping = false;
+	for (unsigned i = 0; i < PROF_LIFETIME_NBUCKETS; i++) {
+		atomic_store_zu(&gctx->lifetimes[i], 0, ATOMIC_RELAXED);
+	}
 	tctx_tree_new(&gctx->tctxs);
 	/* Duplicate bt. */
 	memcpy(gctx->vec, bt->vec, bt->len * sizeof(void *));
@@ -222,15 +273,16 @@ prof_gctx_try_destroy(tsd_t *tsd, prof_tdata_t *tdata_self, prof_gctx_t *gctx) {
 	 * avoid a race between the main body of prof_tctx_destroy() and entry
 	 * into this function.
 	 */
-	prof_enter(tsd, tdata_self);
+	unsigned ind = prof_bt2gctx_shard(&gctx->bt);
+	prof_enter(tsd, tdata_self, ind);
 	malloc_mutex_lock(tsd_tsdn(tsd), gctx->lock);
 	assert(gctx->nlimbo != 0);
 	if (tctx_tree_empty(&gctx->tctxs) && gctx->nlimbo == 1) {
 		/* Remove gctx from bt2gctx. */
-		if (ckh_remove(tsd, &bt2gctx, &gctx->bt, NULL, NULL)) {
+		if (ckh_remove(tsd, &bt2gctx[ind], &gctx->bt, NULL, NULL)) {
 			not_reached();
 		}
-		prof_leave(tsd, tdata_self);
+		prof_leave(tsd, tdata_self, ind);
 		/* Destroy gctx. */
 		malloc_mutex_unlock(tsd_tsdn(tsd), gctx->lock);
 		idalloctm(tsd_tsdn(tsd), gctx, NULL, NULL, true, true);
@@ -241,13 +293,14 @@ prof_gctx_try_destroy(tsd_t *tsd, prof_tdata_t *tdata_self, prof_gctx_t *gctx) {
 		 */
 		gctx->nlimbo--;
 		malloc_mutex_unlock(tsd_tsdn(tsd), gctx->lock);
-		prof_leave(tsd, tdata_self);
+		prof_leave(tsd, tdata_self, ind);
 	}
 }
 
 static bool
 prof_gctx_should_destroy(prof_gctx_t *gctx) {
-	if (opt_prof_accum) {
+	/* The lifetime histogram outlives the objects it counts. */
+	if (opt_prof_accum || opt_prof_lifetime) {
 		return false;
 	}
 	if (!tctx_tree_empty(&gctx->tctxs)) {
@@ -270,23 +323,24 @@ prof_lookup_global(tsd_t *tsd, prof_bt_t *bt, prof_tdata_t *tdata,
 		prof_bt_t *p;
 		void      *v;
 	} btkey;
-	bool new_gctx;
+	bool     new_gctx;
+	unsigned ind = prof_bt2gctx_shard(bt);
 
-	prof_enter(tsd, tdata);
-	if (ckh_search(&bt2gctx, bt, &btkey.v, &gctx.v)) {
+	prof_enter(tsd, tdata, ind);
+	if (ckh_search(&bt2gctx[ind], bt, &btkey.v, &gctx.v)) {
 		/* bt has never been seen before.  Insert it. */
-		prof_leave(tsd, tdata);
+		prof_leave(tsd, tdata, ind);
 		tgctx.p = prof_gctx_create(tsd_tsdn(tsd), bt);
 		if (tgctx.v == NULL) {
 			return true;
 		}
-		prof_enter(tsd, tdata);
-		if (ckh_search(&bt2gctx, bt, &btkey.v, &gctx.v)) {
+		prof_enter(tsd, tdata, ind);
+		if (ckh_search(&bt2gctx[ind], bt, &btkey.v, &gctx.v)) {
 			gctx.p = tgctx.p;
 			btkey.p = &gctx.p->bt;
-			if (ckh_insert(tsd, &bt2gctx, btkey.v, gctx.v)) {
+			if (ckh_insert(tsd, &bt2gctx[ind], btkey.v, gctx.v)) {
 				/* OOM. */
-				prof_leave(tsd, tdata);
+				prof_leave(tsd, tdata, ind);
 				idalloctm(tsd_tsdn(tsd), gctx.v, NULL, NULL,
 				    true, true);
 				return true;
@@ -316,7 +370,7 @@ prof_lookup_global(tsd_t *tsd, prof_bt_t *bt, prof_tdata_t *tdata,
 			    tsd_tsdn(tsd), tgctx.v, NULL, NULL, true, true);
 		}
 	}
-	prof_leave(tsd, tdata);
+	prof_leave(tsd, tdata, ind);
 
 	*p_btkey = btkey.v;
 	*p_gctx = gctx.p;
@@ -436,9 +490,12 @@ prof_bt_count(void) {
 		return 0;
 	}
 
-	malloc_mutex_lock(tsd_tsdn(tsd), &bt2gctx_mtx);
-	bt_count = ckh_count(&bt2gctx);
-	malloc_mutex_unlock(tsd_tsdn(tsd), &bt2gctx_mtx);
+	bt_count = 0;
+	for (unsigned i = 0; i < PROF_BT2GCTX_NSHARDS; i++) {
+		malloc_mutex_lock(tsd_tsdn(tsd), &bt2gctx_locks[i]);
+		bt_count += ckh_count(&bt2gctx[i]);
+		malloc_mutex_unlock(tsd_tsdn(tsd), &bt2gctx_locks[i]);
+	}
 
 	return bt_count;
 }
@@ -505,10 +562,9 @@ prof_double_uint64_cast(double d) {
 }
 #endif
 
-void
-prof_unbias_map_init(void) {
-	/* See the comment in prof_sample_new_event_wait */
 #ifdef JEMALLOC_PROF
+static void
+prof_unbias_map_init_step(unsigned step) {
 	for (szind_t i = 0; i < SC_NSIZES; i++) {
 		/*
 		 * With large size classes disabled, the unbiased calculation
@@ -517,7 +573,7 @@ prof_unbias_map_init(void) {
 		 * using the old way.
 		 */
 		double sz = (double)sz_index2size_unsafe(i);
-		double rate = (double)(ZU(1) << lg_prof_sample);
+		double rate = (double)((uint64_t)1 << (lg_prof_sample + step));
 		double div_val = 1.0 - exp(-sz / rate);
 		double unbiased_sz = sz / div_val;
 		/*
@@ -535,10 +591,24 @@ prof_unbias_map_init(void) {
 		 */
 		double cnt_shift = (double)(ZU(1) << SC_LG_TINY_MIN);
 		double shifted_unbiased_cnt = cnt_shift / div_val;
-		prof_unbiased_sz[i] = (size_t)round(unbiased_sz);
-		prof_shifted_unbiased_cnt[i] = (size_t)round(
+		prof_unbiased_sz[step][i] = (size_t)round(unbiased_sz);
+		prof_shifted_unbiased_cnt[step][i] = (size_t)round(
 		    shifted_unbiased_cnt);
 	}
+}
+#endif
+
+void
+prof_unbias_map_init(void) {
+	/* See the comment in prof_sample_new_event_wait */
+#ifdef JEMALLOC_PROF
+	/* Only step 0 is ever used with a fixed rate. */
+	unsigned nsteps = opt_prof_overhead_ppm != 0 ? PROF_SAMPLE_NSTEPS : 1;
+	for (unsigned step = 0; step < nsteps
+	     && lg_prof_sample + step < (sizeof(uint64_t) << 3);
+	     step++) {
+		prof_unbias_map_init_step(step);
+	}
 #else
 	unreachable();
 #endif
@@ -602,7 +672,7 @@ prof_do_unbias(uint64_t c_out_shifted_i, uint64_t s_out_i, uint64_t *r_c_in,
 	double c_out = (double)c_out_shifted_i
 	    / (double)(ZU(1) << SC_LG_TINY_MIN);
 	double s_out = (double)s_out_i;
-	double R = (double)(ZU(1) << lg_prof_sample);
+	double R = (double)((uint64_t)1 << prof_dump_lg_sample);
 
 	double x = s_out / c_out;
 	double y = s_out * (1.0 - exp(-x / R));
@@ -617,6 +687,23 @@ prof_do_unbias(uint64_t c_out_shifted_i, uint64_t s_out_i, uint64_t *r_c_in,
 #endif
 }
 
+/* The counts as they should be reported, i.e. unbiased if need be. */
+static void
+prof_dump_cnts_get(const prof_cnt_t *cnts, uint64_t *curobjs,
+    uint64_t *curbytes, uint64_t *accumobjs, uint64_t *accumbytes) {
+	if (opt_prof_unbias) {
+		prof_do_unbias(cnts->curobjs_shifted_unbiased,
+		    cnts->curbytes_unbiased, curobjs, curbytes);
+		prof_do_unbias(cnts->accumobjs_shifted_unbiased,
+		    cnts->accumbytes_unbiased, accumobjs, accumbytes);
+	} else {
+		*curobjs = cnts->curobjs;
+		*curbytes = cnts->curbytes;
+		*accumobjs = cnts->accumobjs;
+		*accumbytes = cnts->accumbytes;
+	}
+}
+
 static void
 prof_dump_print_cnts(
     write_cb_t *prof_dump_write, void *cbopaque, const prof_cnt_t *cnts) {
@@ -624,17 +711,7 @@ prof_dump_print_cnts(
 	uint64_t curbytes;
 	uint64_t accumobjs;
 	uint64_t accumbytes;
-	if (opt_prof_unbias) {
-		prof_do_unbias(cnts->curobjs_shifted_unbiased,
-		    cnts->curbytes_unbiased, &curobjs, &curbytes);
-		prof_do_unbias(cnts->accumobjs_shifted_unbiased,
-		    cnts->accumbytes_unbiased, &accumobjs, &accumbytes);
-	} else {
-		curobjs = cnts->curobjs;
-		curbytes = cnts->curbytes;
-		accumobjs = cnts->accumobjs;
-		accumbytes = cnts->accumbytes;
-	}
+	prof_dump_cnts_get(cnts, &curobjs, &curbytes, &accumobjs, &accumbytes);
 	prof_dump_printf(prof_dump_write, cbopaque,
 	    "%" FMTu64 ": %" FMTu64 " [%" FMTu64 ": %" FMTu64 "]", curobjs,
 	    curbytes, accumobjs, accumbytes);
@@ -651,6 +728,11 @@ prof_tctx_merge_tdata(tsdn_t *tsdn, prof_tctx_t *tctx, prof_tdata_t *tdata) {
 		malloc_mutex_unlock(tsdn, tctx->gctx->lock);
 		return;
 	case prof_tctx_state_nominal:
+		if (!tctx->gctx->dumping) {
+			/* gctx is newer than the dump's snapshot of bt2gctx. */
+			malloc_mutex_unlock(tsdn, tctx->gctx->lock);
+			return;
+		}
 		tctx->state = prof_tctx_state_dumping;
 		malloc_mutex_unlock(tsdn, tctx->gctx->lock);
 
@@ -698,11 +780,17 @@ prof_tctx_merge_gctx(tsdn_t *tsdn, prof_tctx_t *tctx, prof_gctx_t *gctx) {
 	}
 }
 
+typedef struct prof_tctx_merge_iter_arg_s prof_tctx_merge_iter_arg_t;
+struct prof_tctx_merge_iter_arg_s {
+	tsdn_t       *tsdn;
+	prof_tctx_t **tail;
+};
+
 static prof_tctx_t *
-prof_tctx_merge_iter(prof_tctx_tree_t *tctxs, prof_tctx_t *tctx, void *arg) {
-	tsdn_t *tsdn = (tsdn_t *)arg;
+prof_tctx_merge_iter(prof_tctx_tree_t *tctxs, prof_tctx_t *tctx, void *opaque) {
+	prof_tctx_merge_iter_arg_t *arg = (prof_tctx_merge_iter_arg_t *)opaque;
 
-	malloc_mutex_assert_owner(tsdn, tctx->gctx->lock);
+	malloc_mutex_assert_owner(arg->tsdn, tctx->gctx->lock);
 
 	switch (tctx->state) {
 	case prof_tctx_state_nominal:
@@ -710,7 +798,14 @@ prof_tctx_merge_iter(prof_tctx_tree_t *tctxs, prof_tctx_t *tctx, void *arg) {
 		break;
 	case prof_tctx_state_dumping:
 	case prof_tctx_state_purgatory:
-		prof_tctx_merge_gctx(tsdn, tctx, tctx->gctx);
+		prof_tctx_merge_gctx(arg->tsdn, tctx, tctx->gctx);
+		/*
+		 * Neither state changes back before prof_gctx_finish(), so tctx
+		 * stays valid, and its dump_cnts stay put, until then.
+		 */
+		tctx->dump_next = NULL;
+		*arg->tail = tctx;
+		arg->tail = &tctx->dump_next;
 		break;
 	case prof_tctx_state_initializing:
 	default:
@@ -727,55 +822,13 @@ struct prof_dump_iter_arg_s {
 	void       *cbopaque;
 };
 
-static prof_tctx_t *
-prof_tctx_dump_iter(prof_tctx_tree_t *tctxs, prof_tctx_t *tctx, void *opaque) {
-	prof_dump_iter_arg_t *arg = (prof_dump_iter_arg_t *)opaque;
-	malloc_mutex_assert_owner(arg->tsdn, tctx->gctx->lock);
-
-	switch (tctx->state) {
-	case prof_tctx_state_initializing:
-	case prof_tctx_state_nominal:
-		/* Not captured by this dump. */
-		break;
-	case prof_tctx_state_dumping:
-	case prof_tctx_state_purgatory:
-		prof_dump_printf(arg->prof_dump_write, arg->cbopaque,
-		    "  t%" FMTu64 ": ", tctx->thr_uid);
-		prof_dump_print_cnts(
-		    arg->prof_dump_write, arg->cbopaque, &tctx->dump_cnts);
-		arg->prof_dump_write(arg->cbopaque, "\n");
-		break;
-	default:
-		not_reached();
-	}
-	return NULL;
-}
-
-static prof_tctx_t *
-prof_tctx_finish_iter(prof_tctx_tree_t *tctxs, prof_tctx_t *tctx, void *arg) {
-	tsdn_t      *tsdn = (tsdn_t *)arg;
-	prof_tctx_t *ret;
-
-	malloc_mutex_assert_owner(tsdn, tctx->gctx->lock);
-
-	switch (tctx->state) {
-	case prof_tctx_state_nominal:
-		/* New since dumping started; ignore. */
-		break;
-	case prof_tctx_state_dumping:
-		tctx->state = prof_tctx_state_nominal;
-		break;
-	case prof_tctx_state_purgatory:
-		ret = tctx;
-		goto label_return;
-	case prof_tctx_state_initializing:
-	default:
-		not_reached();
-	}
-
-	ret = NULL;
-label_return:
-	return ret;
+static void
+prof_tctx_dump(prof_dump_iter_arg_t *arg, const prof_tctx_t *tctx) {
+	prof_dump_printf(arg->prof_dump_write, arg->cbopaque,
+	    "  t%" FMTu64 ": ", tctx->thr_uid);
+	prof_dump_print_cnts(
+	    arg->prof_dump_write, arg->cbopaque, &tctx->dump_cnts);
+	arg->prof_dump_write(arg->cbopaque, "\n");
 }
 
 static void
@@ -790,9 +843,12 @@ prof_dump_gctx_prep(tsdn_t *tsdn, prof_gctx_t *gctx, prof_gctx_tree_t *gctxs) {
 	 * prof_dump()'s second pass.
 	 */
 	gctx->nlimbo++;
+	assert(!gctx->dumping);
+	gctx->dumping = true;
 	gctx_tree_insert(gctxs, gctx);
 
 	memset(&gctx->cnt_summed, 0, sizeof(prof_cnt_t));
+	gctx->dump_tctxs = NULL;
 
 	malloc_mutex_unlock(tsdn, gctx->lock);
 }
@@ -808,12 +864,20 @@ prof_gctx_merge_iter(prof_gctx_tree_t *gctxs, prof_gctx_t *gctx, void *opaque) {
 	prof_gctx_merge_iter_arg_t *arg = (prof_gctx_merge_iter_arg_t *)opaque;
 
 	malloc_mutex_lock(arg->tsdn, gctx->lock);
-	tctx_tree_iter(
-	    &gctx->tctxs, NULL, prof_tctx_merge_iter, (void *)arg->tsdn);
+	prof_tctx_merge_iter_arg_t prof_tctx_merge_iter_arg = {
+	    arg->tsdn, &gctx->dump_tctxs};
+	tctx_tree_iter(&gctx->tctxs, NULL, prof_tctx_merge_iter,
+	    &prof_tctx_merge_iter_arg);
 	if (gctx->cnt_summed.curobjs != 0) {
 		(*arg->leak_ngctx)++;
 	}
 	malloc_mutex_unlock(arg->tsdn, gctx->lock);
+	if (opt_prof_lifetime) {
+		for (unsigned i = 0; i < PROF_LIFETIME_NBUCKETS; i++) {
+			gctx->dump_lifetimes[i] = atomic_load_zu(
+			    &gctx->lifetimes[i], ATOMIC_RELAXED);
+		}
+	}
 
 	return NULL;
 }
@@ -832,26 +896,28 @@ prof_gctx_finish(tsd_t *tsd, prof_gctx_tree_t *gctxs) {
 	while ((gctx = gctx_tree_first(gctxs)) != NULL) {
 		gctx_tree_remove(gctxs, gctx);
 		malloc_mutex_lock(tsd_tsdn(tsd), gctx->lock);
-		{
-			prof_tctx_t *next;
-
-			next = NULL;
-			do {
-				prof_tctx_t *to_destroy = tctx_tree_iter(
-				    &gctx->tctxs, next, prof_tctx_finish_iter,
-				    (void *)tsd_tsdn(tsd));
-				if (to_destroy != NULL) {
-					next = tctx_tree_next(
-					    &gctx->tctxs, to_destroy);
-					tctx_tree_remove(
-					    &gctx->tctxs, to_destroy);
-					idalloctm(tsd_tsdn(tsd), to_destroy,
-					    NULL, NULL, true, true);
-				} else {
-					next = NULL;
-				}
-			} while (next != NULL);
+		/* Only the tctx's captured by the dump have a state to undo. */
+		prof_tctx_t *tctx = gctx->dump_tctxs;
+		while (tctx != NULL) {
+			prof_tctx_t *next = tctx->dump_next;
+			switch (tctx->state) {
+			case prof_tctx_state_dumping:
+				tctx->state = prof_tctx_state_nominal;
+				break;
+			case prof_tctx_state_purgatory:
+				tctx_tree_remove(&gctx->tctxs, tctx);
+				idalloctm(tsd_tsdn(tsd), tctx, NULL, NULL, true,
+				    true);
+				break;
+			case prof_tctx_state_initializing:
+			case prof_tctx_state_nominal:
+			default:
+				not_reached();
+			}
+			tctx = next;
 		}
+		gctx->dump_tctxs = NULL;
+		gctx->dumping = false;
 		gctx->nlimbo--;
 		if (prof_gctx_should_destroy(gctx)) {
 			gctx->nlimbo++;
@@ -936,7 +1002,8 @@ prof_tdata_dump_iter(
 static void
 prof_dump_header(prof_dump_iter_arg_t *arg, const prof_cnt_t *cnt_all) {
 	prof_dump_printf(arg->prof_dump_write, arg->cbopaque,
-	    "heap_v2/%" FMTu64 "\n  t*: ", ((uint64_t)1U << lg_prof_sample));
+	    "heap_v2/%" FMTu64 "\n  t*: ",
+	    ((uint64_t)1U << prof_dump_lg_sample));
 	prof_dump_print_cnts(arg->prof_dump_write, arg->cbopaque, cnt_all);
 	arg->prof_dump_write(arg->cbopaque, "\n");
 
@@ -945,15 +1012,36 @@ prof_dump_header(prof_dump_iter_arg_t *arg, const prof_cnt_t *cnt_all) {
 	malloc_mutex_unlock(arg->tsdn, &tdatas_mtx);
 }
 
+static bool
+prof_dump_gctx_empty(const prof_gctx_t *gctx) {
+	return (!opt_prof_accum && gctx->cnt_summed.curobjs == 0)
+	    || (opt_prof_accum && gctx->cnt_summed.accumobjs == 0);
+}
+
+static bool
+prof_dump_gctx_lifetimes_empty(const prof_gctx_t *gctx) {
+	if (!opt_prof_lifetime) {
+		return true;
+	}
+	for (unsigned i = 0; i < PROF_LIFETIME_NBUCKETS; i++) {
+		if (gctx->dump_lifetimes[i] != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
 static void
 prof_dump_gctx(prof_dump_iter_arg_t *arg, prof_gctx_t *gctx,
     const prof_bt_t *bt, prof_gctx_tree_t *gctxs) {
 	cassert(config_prof);
-	malloc_mutex_assert_owner(arg->tsdn, gctx->lock);
 
-	/* Avoid dumping such gctx's that have no useful data. */
-	if ((!opt_prof_accum && gctx->cnt_summed.curobjs == 0)
-	    || (opt_prof_accum && gctx->cnt_summed.accumobjs == 0)) {
+	/*
+	 * Avoid dumping such gctx's that have no useful data.  A gctx all of
+	 * whose sampled objects are gone may still have lifetimes to report.
+	 */
+	bool empty = prof_dump_gctx_empty(gctx);
+	if (empty && prof_dump_gctx_lifetimes_empty(gctx)) {
 		assert(gctx->cnt_summed.curobjs == 0);
 		assert(gctx->cnt_summed.curbytes == 0);
 		/*
@@ -980,7 +1068,23 @@ prof_dump_gctx(prof_dump_iter_arg_t *arg, prof_gctx_t *gctx,
 	    arg->prof_dump_write, arg->cbopaque, &gctx->cnt_summed);
 	arg->prof_dump_write(arg->cbopaque, "\n");
 
-	tctx_tree_iter(&gctx->tctxs, NULL, prof_tctx_dump_iter, arg);
+	if (opt_prof_lifetime) {
+		/* jeprof skips lines it doesn't know. */
+		arg->prof_dump_write(arg->cbopaque, "  lifetimes:");
+		for (unsigned i = 0; i < PROF_LIFETIME_NBUCKETS; i++) {
+			prof_dump_printf(arg->prof_dump_write, arg->cbopaque,
+			    " %zu", gctx->dump_lifetimes[i]);
+		}
+		arg->prof_dump_write(arg->cbopaque, "\n");
+	}
+
+	if (empty) {
+		return;
+	}
+	for (const prof_tctx_t *tctx = gctx->dump_tctxs; tctx != NULL;
+	     tctx = tctx->dump_next) {
+		prof_tctx_dump(arg, tctx);
+	}
 }
 
 /*
@@ -997,7 +1101,8 @@ prof_leakcheck(const prof_cnt_t *cnt_all, size_t leak_ngctx) {
 	 * reports the sums of the scaled values.
 	 */
 	if (cnt_all->curbytes != 0) {
-		double sample_period = (double)((uint64_t)1 << lg_prof_sample);
+		double sample_period = (double)((uint64_t)1
+		    << prof_dump_lg_sample);
 		double ratio = (((double)cnt_all->curbytes)
 		                   / (double)cnt_all->curobjs)
 		    / sample_period;
@@ -1032,9 +1137,7 @@ prof_leakcheck(const prof_cnt_t *cnt_all, size_t leak_ngctx) {
 static prof_gctx_t *
 prof_gctx_dump_iter(prof_gctx_tree_t *gctxs, prof_gctx_t *gctx, void *opaque) {
 	prof_dump_iter_arg_t *arg = (prof_dump_iter_arg_t *)opaque;
-	malloc_mutex_lock(arg->tsdn, gctx->lock);
 	prof_dump_gctx(arg, gctx, &gctx->bt, gctxs);
-	malloc_mutex_unlock(arg->tsdn, gctx->lock);
 	return NULL;
 }
 
@@ -1047,15 +1150,21 @@ prof_dump_prep(tsd_t *tsd, prof_tdata_t *tdata, prof_cnt_t *cnt_all,
 		void        *v;
 	} gctx;
 
-	prof_enter(tsd, tdata);
-
 	/*
 	 * Put gctx's in limbo and clear their counters in preparation for
-	 * summing.
+	 * summing.  This only pins the gctx's, so each shard is held just long
+	 * enough to walk it; once a gctx is pinned, everything else about it
+	 * is done under its own lock.  The dump doesn't include gctx's created
+	 * in shards that were already walked.
 	 */
 	gctx_tree_new(gctxs);
-	for (tabind = 0; !ckh_iter(&bt2gctx, &tabind, NULL, &gctx.v);) {
-		prof_dump_gctx_prep(tsd_tsdn(tsd), gctx.p, gctxs);
+	for (unsigned i = 0; i < PROF_BT2GCTX_NSHARDS; i++) {
+		prof_enter(tsd, tdata, i);
+		for (tabind = 0;
+		     !ckh_iter(&bt2gctx[i], &tabind, NULL, &gctx.v);) {
+			prof_dump_gctx_prep(tsd_tsdn(tsd), gctx.p, gctxs);
+		}
+		prof_leave(tsd, tdata, i);
 	}
 
 	/*
@@ -1076,8 +1185,6 @@ prof_dump_prep(tsd_t *tsd, prof_tdata_t *tdata, prof_cnt_t *cnt_all,
 	    tsd_tsdn(tsd), leak_ngctx};
 	gctx_tree_iter(
 	    gctxs, NULL, prof_gctx_merge_iter, &prof_gctx_merge_iter_arg);
-
-	prof_leave(tsd, tdata);
 }
 
 void
@@ -1098,6 +1205,85 @@ prof_dump_impl(tsd_t *tsd, write_cb_t *prof_dump_write, void *cbopaque,
 	}
 }
 
+typedef struct prof_pprof_iter_arg_s prof_pprof_iter_arg_t;
+struct prof_pprof_iter_arg_s {
+	tsd_t        *tsd;
+	prof_pprof_t *pprof;
+};
+
+static prof_gctx_t *
+prof_gctx_pprof_iter(prof_gctx_tree_t *gctxs, prof_gctx_t *gctx, void *opaque) {
+	prof_pprof_iter_arg_t *arg = (prof_pprof_iter_arg_t *)opaque;
+
+	if (!prof_dump_gctx_empty(gctx)) {
+		uint64_t curobjs, curbytes, accumobjs, accumbytes;
+		prof_dump_cnts_get(&gctx->cnt_summed, &curobjs, &curbytes,
+		    &accumobjs, &accumbytes);
+		uint64_t values[4];
+		unsigned nvalues = 0;
+		if (opt_prof_accum) {
+			values[nvalues++] = accumobjs;
+			values[nvalues++] = accumbytes;
+		}
+		values[nvalues++] = curobjs;
+		values[nvalues++] = curbytes;
+		assert(nvalues == arg->pprof->nvalues);
+		prof_pprof_sample(arg->tsd, arg->pprof, &gctx->bt, values);
+	}
+	return NULL;
+}
+
+void
+prof_dump_pprof_impl(
+    tsd_t *tsd, prof_pprof_t *pprof, prof_tdata_t *tdata, bool leakcheck) {
+	malloc_mutex_assert_owner(tsd_tsdn(tsd), &prof_dump_mtx);
+	prof_cnt_t       cnt_all;
+	size_t           leak_ngctx;
+	prof_gctx_tree_t gctxs;
+	prof_dump_prep(tsd, tdata, &cnt_all, &leak_ngctx, &gctxs);
+	prof_pprof_iter_arg_t prof_pprof_iter_arg = {tsd, pprof};
+	gctx_tree_iter(&gctxs, NULL, prof_gctx_pprof_iter, &prof_pprof_iter_arg);
+	prof_gctx_finish(tsd, &gctxs);
+	if (leakcheck) {
+		prof_leakcheck(&cnt_all, leak_ngctx);
+	}
+}
+
+typedef struct prof_gctx_cnts_iter_arg_s prof_gctx_cnts_iter_arg_t;
+struct prof_gctx_cnts_iter_arg_s {
+	tsd_t               *tsd;
+	prof_gctx_cnts_cb_t *cb;
+	void                *opaque;
+};
+
+static prof_gctx_t *
+prof_gctx_cnts_iter_gctx(
+    prof_gctx_tree_t *gctxs, prof_gctx_t *gctx, void *opaque) {
+	prof_gctx_cnts_iter_arg_t *arg = (prof_gctx_cnts_iter_arg_t *)opaque;
+
+	if (gctx->cnt_summed.curobjs != 0) {
+		uint64_t curobjs, curbytes, accumobjs, accumbytes;
+		prof_dump_cnts_get(&gctx->cnt_summed, &curobjs, &curbytes,
+		    &accumobjs, &accumbytes);
+		arg->cb(arg->tsd, arg->opaque, &gctx->bt, curobjs, curbytes);
+	}
+	return NULL;
+}
+
+void
+prof_gctx_cnts_iter(tsd_t *tsd, prof_tdata_t *tdata, prof_gctx_cnts_cb_t *cb,
+    void *opaque) {
+	malloc_mutex_assert_owner(tsd_tsdn(tsd), &prof_dump_mtx);
+	prof_cnt_t       cnt_all;
+	size_t           leak_ngctx;
+	prof_gctx_tree_t gctxs;
+	prof_dump_prep(tsd, tdata, &cnt_all, &leak_ngctx, &gctxs);
+	prof_gctx_cnts_iter_arg_t prof_gctx_cnts_iter_arg = {tsd, cb, opaque};
+	gctx_tree_iter(&gctxs, NULL, prof_gctx_cnts_iter_gctx,
+	    &prof_gctx_cnts_iter_arg);
+	prof_gctx_finish(tsd, &gctxs);
+}
+
 /* Used in unit tests. */
 void
 prof_cnt_all(prof_cnt_t *cnt_all) {
@@ -1108,8 +1294,10 @@ prof_cnt_all(prof_cnt_t *cnt_all) {
 	} else {
 		size_t           leak_ngctx;
 		prof_gctx_tree_t gctxs;
+		malloc_mutex_lock(tsd_tsdn(tsd), &prof_dump_mtx);
 		prof_dump_prep(tsd, tdata, cnt_all, &leak_ngctx, &gctxs);
 		prof_gctx_finish(tsd, &gctxs);
+		malloc_mutex_unlock(tsd_tsdn(tsd), &prof_dump_mtx);
 	}
 }
 
@@ -1146,7 +1334,11 @@ prof_tdata_init_impl(tsd_t *tsd, uint64_t thr_uid, uint64_t thr_discrim,
 
 	/* Initialize an empty cache for this thread. */
 	size_t tdata_sz = ALIGNMENT_CEILING(sizeof(prof_tdata_t), QUANTUM);
-	size_t total_sz = tdata_sz + sizeof(void *) * opt_prof_bt_max;
+	size_t callsites_sz = opt_prof_callsite
+	    ? PROF_CALLSITE_TDATA_NSLOTS * sizeof(prof_callsite_t)
+	    : 0;
+	size_t total_sz = tdata_sz + callsites_sz
+	    + sizeof(void *) * opt_prof_bt_max;
 	tdata = (prof_tdata_t *)iallocztm(tsd_tsdn(tsd), total_sz,
 	    sz_size2index(total_sz), false, NULL, true,
 	    arena_get(TSDN_NULL, 0, true), true);
@@ -1154,7 +1346,15 @@ prof_tdata_init_impl(tsd_t *tsd, uint64_t thr_uid, uint64_t thr_discrim,
 		return NULL;
 	}
 
-	tdata->vec = (void **)((byte_t *)tdata + tdata_sz);
+	if (opt_prof_callsite) {
+		tdata->callsites = (prof_callsite_t *)((byte_t *)tdata
+		    + tdata_sz);
+		memset(tdata->callsites, 0, callsites_sz);
+	} else {
+		tdata->callsites = NULL;
+	}
+	tdata->callsites_nsamples = 0;
+	tdata->vec = (void **)((byte_t *)tdata + tdata_sz + callsites_sz);
 	tdata->lock = prof_tdata_mutex_choose(thr_uid);
 	tdata->thr_uid = thr_uid;
 	tdata->thr_discrim = thr_discrim;
@@ -1231,6 +1431,8 @@ void
 prof_tdata_detach(tsd_t *tsd, prof_tdata_t *tdata) {
 	bool destroy_tdata;
 
+	/* Whatever happens to tdata, its callsite counts shouldn't be lost. */
+	prof_callsite_flush(tsd);
 	malloc_mutex_lock(tsd_tsdn(tsd), tdata->lock);
 	if (tdata->attached) {
 		destroy_tdata = prof_tdata_should_destroy(
@@ -1286,6 +1488,8 @@ prof_reset(tsd_t *tsd, size_t lg_sample) {
 	malloc_mutex_lock(tsd_tsdn(tsd), &tdatas_mtx);
 
 	lg_prof_sample = lg_sample;
+	/* The counts are all gone; the adjustment can start over. */
+	atomic_store_u(&prof_sample_step, 0, ATOMIC_RELAXED);
 	prof_unbias_map_init();
 
 	next = NULL;
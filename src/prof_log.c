@@ -13,6 +13,7 @@
 #include "jemalloc/internal/prof_sys.h"
 
 bool                              opt_prof_log = false;
+bool                              opt_prof_log_binary = false;
 typedef enum prof_logging_state_e prof_logging_state_t;
 enum prof_logging_state_e {
 	prof_logging_state_stopped,
@@ -103,9 +104,58 @@ static prof_thr_node_t   *log_thr_last = NULL;
 static prof_alloc_node_t *log_alloc_first = NULL;
 static prof_alloc_node_t *log_alloc_last = NULL;
 
-/* Protects the prof_logging_state and any log_{...} variable. */
+/*
+ * Protects the prof_logging_state and any log_{...} variable, except as noted
+ * below.
+ */
 malloc_mutex_t log_mtx;
 
+/*
+ * Binary log state.  Records are appended to log_buf_cur under log_mtx.  When
+ * it fills up, it is queued, and a spare (or new) buffer takes its place.  The
+ * queued buffers are written out with log_mtx released, under log_write_mtx:
+ * by background thread 0 if background threads are enabled, or else by the
+ * thread that filled them, once it is done logging (see
+ * prof_log_flush_backlog()).  Nobody waits for write(2) while appending.
+ */
+#ifdef JEMALLOC_DEBUG
+/* Small enough for the tests to switch buffers often. */
+#	define PROF_LOG_BINARY_BUFSIZE 4096
+#else
+#	define PROF_LOG_BINARY_BUFSIZE 65536
+#endif
+#define PROF_LOG_VARINT_MAX 10
+/*
+ * Number of queued buffers past which the threads filling them write them out
+ * themselves, rather than wait for background thread 0 to catch up.
+ */
+#define PROF_LOG_BINARY_NQUEUED_MAX 4
+/* Number of written out buffers kept for reuse. */
+#define PROF_LOG_BINARY_NSPARE_MAX 2
+
+typedef struct prof_log_buf_s prof_log_buf_t;
+struct prof_log_buf_s {
+	prof_log_buf_t *next;
+	size_t          len;
+	uint8_t         data[PROF_LOG_BINARY_BUFSIZE];
+};
+
+/* Whether the log being taken is a binary one. */
+static bool            log_binary = false;
+static int             log_fd = -1;
+/* NULL if a buffer couldn't be allocated; the rest of the log is dropped. */
+static prof_log_buf_t *log_buf_cur;
+/* Full buffers, oldest first. */
+static prof_log_buf_t *log_buf_queue_first;
+static prof_log_buf_t *log_buf_queue_last;
+static atomic_u_t      log_buf_nqueued = ATOMIC_INIT(0);
+static prof_log_buf_t *log_buf_spare;
+static unsigned        log_buf_nspare;
+static bool            log_buf_oom;
+/* Protected by log_write_mtx, which ranks before log_mtx. */
+static bool log_write_failed;
+malloc_mutex_t log_write_mtx;
+
 /******************************************************************************/
 /*
  * Function prototypes for static functions that are referenced prior to
@@ -118,6 +168,11 @@ static bool prof_thr_node_keycomp(const void *k1, const void *k2);
 static void prof_bt_node_hash(const void *key, size_t r_hash[2]);
 static bool prof_bt_node_keycomp(const void *k1, const void *k2);
 
+/* Appending records to the binary log. */
+static void prof_log_binary_thread(
+    tsdn_t *tsdn, uint64_t thr_uid, const char *name);
+static void prof_log_binary_trace(tsdn_t *tsdn, prof_bt_t *bt);
+
 /******************************************************************************/
 
 static size_t
@@ -157,6 +212,9 @@ prof_log_bt_index(tsd_t *tsd, prof_bt_t *bt) {
 
 		log_bt_index++;
 		ckh_insert(tsd, &log_bt_node_set, (void *)new_node, NULL);
+		if (log_binary) {
+			prof_log_binary_trace(tsd_tsdn(tsd), bt);
+		}
 		return new_node->index;
 	} else {
 		return node->index;
@@ -194,12 +252,231 @@ prof_log_thr_index(tsd_t *tsd, uint64_t thr_uid, const char *name) {
 
 		log_thr_index++;
 		ckh_insert(tsd, &log_thr_node_set, (void *)new_node, NULL);
+		if (log_binary) {
+			prof_log_binary_thread(tsd_tsdn(tsd), thr_uid, name);
+		}
 		return new_node->index;
 	} else {
 		return node->index;
 	}
 }
 
+static uint8_t *
+prof_log_put_varint(uint8_t *p, uint64_t v) {
+	while (v >= 0x80) {
+		*p++ = (uint8_t)(v | 0x80);
+		v >>= 7;
+	}
+	*p++ = (uint8_t)v;
+	return p;
+}
+
+static uint8_t *
+prof_log_put_str(uint8_t *p, const char *str) {
+	size_t len = strlen(str);
+	p = prof_log_put_varint(p, len);
+	memcpy(p, str, len);
+	return p + len;
+}
+
+static void
+prof_log_binary_write(const uint8_t *buf, size_t len) {
+	if (len > 0 && log_fd != -1 && !log_write_failed
+	    && prof_dump_write_file(log_fd, buf, len) == -1) {
+		log_write_failed = true;
+	}
+}
+
+static prof_log_buf_t *
+prof_log_binary_buf_alloc(tsdn_t *tsdn) {
+	prof_log_buf_t *buf = (prof_log_buf_t *)iallocztm(tsdn,
+	    sizeof(prof_log_buf_t), sz_size2index(sizeof(prof_log_buf_t)), false,
+	    NULL, true, arena_get(TSDN_NULL, 0, true), true);
+	if (buf != NULL) {
+		buf->next = NULL;
+		buf->len = 0;
+	}
+	return buf;
+}
+
+static void
+prof_log_binary_buf_free_list(tsdn_t *tsdn, prof_log_buf_t *buf) {
+	while (buf != NULL) {
+		prof_log_buf_t *next = buf->next;
+		idalloctm(tsdn, buf, NULL, NULL, true, true);
+		buf = next;
+	}
+}
+
+/*
+ * Writes out the queued buffers, in order.  The queue is taken over under
+ * log_write_mtx, so that concurrent writers don't reorder buffers, and the
+ * writes happen with log_mtx released.
+ */
+static void
+prof_log_binary_write_queued(tsdn_t *tsdn) {
+	malloc_mutex_assert_owner(tsdn, &log_write_mtx);
+	malloc_mutex_assert_not_owner(tsdn, &log_mtx);
+
+	malloc_mutex_lock(tsdn, &log_mtx);
+	prof_log_buf_t *first = log_buf_queue_first;
+	log_buf_queue_first = NULL;
+	log_buf_queue_last = NULL;
+	atomic_store_u(&log_buf_nqueued, 0, ATOMIC_RELEASE);
+	malloc_mutex_unlock(tsdn, &log_mtx);
+	if (first == NULL) {
+		return;
+	}
+
+	for (prof_log_buf_t *buf = first; buf != NULL; buf = buf->next) {
+		prof_log_binary_write(buf->data, buf->len);
+		buf->len = 0;
+	}
+
+	/* Keep a few buffers around for the next ones to fill up. */
+	malloc_mutex_lock(tsdn, &log_mtx);
+	while (first != NULL && log_buf_nspare < PROF_LOG_BINARY_NSPARE_MAX) {
+		prof_log_buf_t *buf = first;
+		first = buf->next;
+		buf->next = log_buf_spare;
+		log_buf_spare = buf;
+		log_buf_nspare++;
+	}
+	malloc_mutex_unlock(tsdn, &log_mtx);
+	prof_log_binary_buf_free_list(tsdn, first);
+}
+
+/*
+ * Returns where to encode a record of at most size bytes, queueing the current
+ * buffer if it doesn't have room, or NULL if no buffer is available.  The
+ * record is done with prof_log_binary_commit.
+ */
+static uint8_t *
+prof_log_binary_reserve(tsdn_t *tsdn, size_t size) {
+	malloc_mutex_assert_owner(tsdn, &log_mtx);
+	assert(size <= PROF_LOG_BINARY_BUFSIZE);
+
+	if (log_buf_cur == NULL) {
+		return NULL;
+	}
+	if (log_buf_cur->len + size > PROF_LOG_BINARY_BUFSIZE) {
+		prof_log_buf_t *buf = log_buf_spare;
+		if (buf != NULL) {
+			log_buf_spare = buf->next;
+			log_buf_nspare--;
+			buf->next = NULL;
+		} else {
+			buf = prof_log_binary_buf_alloc(tsdn);
+		}
+		if (buf == NULL) {
+			/* Any further record might refer to this one. */
+			log_buf_oom = true;
+		}
+
+		if (log_buf_queue_last == NULL) {
+			log_buf_queue_first = log_buf_cur;
+		} else {
+			log_buf_queue_last->next = log_buf_cur;
+		}
+		log_buf_queue_last = log_buf_cur;
+		atomic_fetch_add_u(&log_buf_nqueued, 1, ATOMIC_RELEASE);
+		log_buf_cur = buf;
+		if (background_thread_enabled()) {
+			prof_bg_thread0_wakeup(tsdn);
+		}
+		if (buf == NULL) {
+			return NULL;
+		}
+	}
+	return &log_buf_cur->data[log_buf_cur->len];
+}
+
+static void
+prof_log_binary_commit(uint8_t *end) {
+	log_buf_cur->len = end - log_buf_cur->data;
+	assert(log_buf_cur->len <= PROF_LOG_BINARY_BUFSIZE);
+}
+
+static void
+prof_log_binary_thread(tsdn_t *tsdn, uint64_t thr_uid, const char *name) {
+	uint8_t *p = prof_log_binary_reserve(
+	    tsdn, 1 + 2 * PROF_LOG_VARINT_MAX + strlen(name));
+	if (p == NULL) {
+		return;
+	}
+	*p++ = prof_log_record_thread;
+	p = prof_log_put_varint(p, thr_uid);
+	p = prof_log_put_str(p, name);
+	prof_log_binary_commit(p);
+}
+
+static void
+prof_log_binary_trace(tsdn_t *tsdn, prof_bt_t *bt) {
+	/* Drop the outermost frames of a trace too long for the buffer. */
+	size_t len = bt->len;
+	size_t len_max = PROF_LOG_BINARY_BUFSIZE / PROF_LOG_VARINT_MAX - 2;
+	if (len > len_max) {
+		len = len_max;
+	}
+	uint8_t *p = prof_log_binary_reserve(
+	    tsdn, 1 + (1 + len) * PROF_LOG_VARINT_MAX);
+	if (p == NULL) {
+		return;
+	}
+	*p++ = prof_log_record_trace;
+	p = prof_log_put_varint(p, len);
+	for (size_t i = 0; i < len; i++) {
+		p = prof_log_put_varint(p, (uintptr_t)bt->vec[i]);
+	}
+	prof_log_binary_commit(p);
+}
+
+static void
+prof_log_binary_alloc(tsdn_t *tsdn, const prof_alloc_node_t *node) {
+	uint8_t *p = prof_log_binary_reserve(tsdn, 1 + 7 * PROF_LOG_VARINT_MAX);
+	if (p == NULL) {
+		return;
+	}
+	*p++ = prof_log_record_alloc;
+	p = prof_log_put_varint(p, node->alloc_thr_ind);
+	p = prof_log_put_varint(p, node->free_thr_ind);
+	p = prof_log_put_varint(p, node->alloc_bt_ind);
+	p = prof_log_put_varint(p, node->free_bt_ind);
+	p = prof_log_put_varint(p, node->alloc_time_ns);
+	p = prof_log_put_varint(p, node->free_time_ns);
+	p = prof_log_put_varint(p, node->usize);
+	prof_log_binary_commit(p);
+}
+
+bool
+prof_log_flush_pending(void) {
+	cassert(config_prof);
+	return atomic_load_u(&log_buf_nqueued, ATOMIC_ACQUIRE) != 0;
+}
+
+void
+prof_log_flush(tsdn_t *tsdn) {
+	cassert(config_prof);
+	malloc_mutex_lock(tsdn, &log_write_mtx);
+	prof_log_binary_write_queued(tsdn);
+	malloc_mutex_unlock(tsdn, &log_write_mtx);
+}
+
+void
+prof_log_flush_backlog(tsdn_t *tsdn) {
+	cassert(config_prof);
+	unsigned nqueued = atomic_load_u(&log_buf_nqueued, ATOMIC_ACQUIRE);
+	if (nqueued == 0) {
+		return;
+	}
+	/* Background thread 0 was woken up when the buffers got queued. */
+	if (background_thread_enabled()
+	    && nqueued <= PROF_LOG_BINARY_NQUEUED_MAX) {
+		return;
+	}
+	prof_log_flush(tsdn);
+}
+
 JEMALLOC_COLD
 void
 prof_try_log(tsd_t *tsd, size_t usize, prof_info_t *prof_info) {
@@ -238,10 +515,17 @@ prof_try_log(tsd_t *tsd, size_t usize, prof_info_t *prof_info) {
 	nstime_t free_time;
 	nstime_prof_init_update(&free_time);
 
-	size_t             sz = sizeof(prof_alloc_node_t);
-	prof_alloc_node_t *new_node = (prof_alloc_node_t *)iallocztm(
-	    tsd_tsdn(tsd), sz, sz_size2index(sz), false, NULL, true,
-	    arena_get(TSDN_NULL, 0, true), true);
+	/* The binary log needs no more than the node on the stack. */
+	prof_alloc_node_t  binary_node;
+	prof_alloc_node_t *new_node;
+	if (log_binary) {
+		new_node = &binary_node;
+	} else {
+		size_t sz = sizeof(prof_alloc_node_t);
+		new_node = (prof_alloc_node_t *)iallocztm(tsd_tsdn(tsd), sz,
+		    sz_size2index(sz), false, NULL, true,
+		    arena_get(TSDN_NULL, 0, true), true);
+	}
 
 	const char *prod_thr_name = tctx->tdata->thread_name;
 	const char *cons_thr_name = prof_thread_name_get(tsd);
@@ -266,7 +550,9 @@ prof_try_log(tsd_t *tsd, size_t usize, prof_info_t *prof_info) {
 	new_node->free_time_ns = nstime_ns(&free_time);
 	new_node->usize = usize;
 
-	if (log_alloc_first == NULL) {
+	if (log_binary) {
+		prof_log_binary_alloc(tsd_tsdn(tsd), new_node);
+	} else if (log_alloc_first == NULL) {
 		log_alloc_first = new_node;
 		log_alloc_last = new_node;
 	} else {
@@ -417,6 +703,61 @@ prof_log_stop_final(void) {
 	prof_log_stop(tsd_tsdn(tsd));
 }
 
+static void
+prof_log_creat_error(void) {
+	malloc_printf(
+	    "<jemalloc>: creat() for log file \"%s\" "
+	    " failed with %d\n",
+	    log_filename, errno);
+	if (opt_abort) {
+		abort();
+	}
+}
+
+static void
+prof_log_binary_bufs_free(tsdn_t *tsdn) {
+	prof_log_binary_buf_free_list(tsdn, log_buf_cur);
+	log_buf_cur = NULL;
+	prof_log_binary_buf_free_list(tsdn, log_buf_spare);
+	log_buf_spare = NULL;
+	log_buf_nspare = 0;
+}
+
+/* Opens the file, and starts it with the header and the info record. */
+static bool
+prof_log_binary_start(tsdn_t *tsdn) {
+	malloc_mutex_assert_owner(tsdn, &log_mtx);
+
+	assert(log_buf_queue_first == NULL);
+	log_buf_cur = prof_log_binary_buf_alloc(tsdn);
+	if (log_buf_cur == NULL) {
+		return true;
+	}
+	if (prof_log_dummy) {
+		log_fd = -1;
+	} else {
+		log_fd = prof_dump_open_file(log_filename, 0644);
+		if (log_fd == -1) {
+			prof_log_binary_bufs_free(tsdn);
+			prof_log_creat_error();
+			return true;
+		}
+	}
+	log_buf_oom = false;
+	log_write_failed = false;
+
+	uint8_t *p = log_buf_cur->data;
+	memcpy(p, PROF_LOG_BINARY_MAGIC, PROF_LOG_BINARY_MAGIC_LEN);
+	p += PROF_LOG_BINARY_MAGIC_LEN;
+	*p++ = prof_log_record_info;
+	p = prof_log_put_str(p, JEMALLOC_VERSION);
+	p = prof_log_put_varint(p, prof_lg_sample_effective());
+	p = prof_log_put_str(p, prof_time_res_mode_names[opt_prof_time_res]);
+	p = prof_log_put_varint(p, (uint64_t)prof_getpid());
+	prof_log_binary_commit(p);
+	return false;
+}
+
 JEMALLOC_COLD
 bool
 prof_log_start(tsdn_t *tsdn, const char *filename) {
@@ -449,18 +790,22 @@ prof_log_start(tsdn_t *tsdn, const char *filename) {
 		ret = true;
 	} else if (filename == NULL) {
 		/* Make default name. */
-		prof_get_default_filename(tsdn, log_filename, log_seq);
+		prof_get_default_filename(tsdn, log_filename, log_seq,
+		    opt_prof_log_binary ? "bin" : "json");
 		log_seq++;
-		prof_logging_state = prof_logging_state_started;
 	} else if (strlen(filename) >= PROF_DUMP_FILENAME_LEN) {
 		ret = true;
 	} else {
 		strcpy(log_filename, filename);
-		prof_logging_state = prof_logging_state_started;
 	}
 
+	if (!ret) {
+		log_binary = opt_prof_log_binary;
+		ret = log_binary && prof_log_binary_start(tsdn);
+	}
 	if (!ret) {
 		nstime_prof_init_update(&log_start_timestamp);
+		prof_logging_state = prof_logging_state_started;
 	}
 label_done:
 	malloc_mutex_unlock(tsdn, &log_mtx);
@@ -593,8 +938,9 @@ prof_log_emit_metadata(emitter_t *emitter) {
 	char *vers = JEMALLOC_VERSION;
 	emitter_json_kv(emitter, "version", emitter_type_string, &vers);
 
+	int lg_sample_rate = (int)prof_lg_sample_effective();
 	emitter_json_kv(
-	    emitter, "lg_sample_rate", emitter_type_int, &lg_prof_sample);
+	    emitter, "lg_sample_rate", emitter_type_int, &lg_sample_rate);
 
 	const char *res_type = prof_time_res_mode_names[opt_prof_time_res];
 	emitter_json_kv(
@@ -606,6 +952,70 @@ prof_log_emit_metadata(emitter_t *emitter) {
 	emitter_json_object_end(emitter);
 }
 
+/* Resets the global state once the nodes are freed, and stops logging. */
+static void
+prof_log_reset(tsd_t *tsd) {
+	if (log_tables_initialized) {
+		ckh_delete(tsd, &log_bt_node_set);
+		ckh_delete(tsd, &log_thr_node_set);
+	}
+	log_tables_initialized = false;
+	log_bt_index = 0;
+	log_thr_index = 0;
+	log_bt_first = NULL;
+	log_bt_last = NULL;
+	log_thr_first = NULL;
+	log_thr_last = NULL;
+	log_alloc_first = NULL;
+	log_alloc_last = NULL;
+
+	malloc_mutex_lock(tsd_tsdn(tsd), &log_mtx);
+	prof_logging_state = prof_logging_state_stopped;
+	malloc_mutex_unlock(tsd_tsdn(tsd), &log_mtx);
+}
+
+/* Writes out the rest of the binary log, and closes it. */
+static bool
+prof_log_binary_stop(tsd_t *tsd) {
+	tsdn_t *tsdn = tsd_tsdn(tsd);
+	nstime_t now;
+	nstime_prof_init_update(&now);
+	uint8_t end[1 + PROF_LOG_VARINT_MAX];
+	uint8_t *p = end;
+	*p++ = prof_log_record_end;
+	p = prof_log_put_varint(
+	    p, nstime_ns(&now) - nstime_ns(&log_start_timestamp));
+
+	/* Nothing gets appended anymore; writes may still be queued. */
+	malloc_mutex_lock(tsdn, &log_write_mtx);
+	prof_log_binary_write_queued(tsdn);
+	bool err = log_write_failed || log_buf_oom;
+	if (!log_buf_oom) {
+		prof_log_binary_write(log_buf_cur->data, log_buf_cur->len);
+		prof_log_binary_write(end, p - end);
+	}
+	malloc_mutex_unlock(tsdn, &log_write_mtx);
+
+	prof_log_binary_bufs_free(tsdn);
+	prof_thr_node_t *thr_node = log_thr_first;
+	while (thr_node != NULL) {
+		prof_thr_node_t *next = thr_node->next;
+		idalloctm(tsdn, thr_node, NULL, NULL, true, true);
+		thr_node = next;
+	}
+	prof_bt_node_t *bt_node = log_bt_first;
+	while (bt_node != NULL) {
+		prof_bt_node_t *next = bt_node->next;
+		idalloctm(tsdn, bt_node, NULL, NULL, true, true);
+		bt_node = next;
+	}
+	if (log_fd != -1) {
+		err |= close(log_fd) != 0;
+		log_fd = -1;
+	}
+	return err;
+}
+
 #define PROF_LOG_STOP_BUFSIZE PROF_DUMP_BUFSIZE
 JEMALLOC_COLD
 bool
@@ -631,6 +1041,12 @@ prof_log_stop(tsdn_t *tsdn) {
 	prof_logging_state = prof_logging_state_dumping;
 	malloc_mutex_unlock(tsdn, &log_mtx);
 
+	if (log_binary) {
+		bool err = prof_log_binary_stop(tsd);
+		prof_log_reset(tsd);
+		return err;
+	}
+
 	emitter_t emitter;
 
 	/* Create a file. */
@@ -643,13 +1059,7 @@ prof_log_stop(tsdn_t *tsdn) {
 	}
 
 	if (fd == -1) {
-		malloc_printf(
-		    "<jemalloc>: creat() for log file \"%s\" "
-		    " failed with %d\n",
-		    log_filename, errno);
-		if (opt_abort) {
-			abort();
-		}
+		prof_log_creat_error();
 		return true;
 	}
 
@@ -670,25 +1080,7 @@ prof_log_stop(tsdn_t *tsdn) {
 	emitter_end(&emitter);
 
 	buf_writer_terminate(tsdn, &buf_writer);
-
-	/* Reset global state. */
-	if (log_tables_initialized) {
-		ckh_delete(tsd, &log_bt_node_set);
-		ckh_delete(tsd, &log_thr_node_set);
-	}
-	log_tables_initialized = false;
-	log_bt_index = 0;
-	log_thr_index = 0;
-	log_bt_first = NULL;
-	log_bt_last = NULL;
-	log_thr_first = NULL;
-	log_thr_last = NULL;
-	log_alloc_first = NULL;
-	log_alloc_last = NULL;
-
-	malloc_mutex_lock(tsdn, &log_mtx);
-	prof_logging_state = prof_logging_state_stopped;
-	malloc_mutex_unlock(tsdn, &log_mtx);
+	prof_log_reset(tsd);
 
 	if (prof_log_dummy) {
 		return false;
@@ -705,6 +1097,10 @@ prof_log_init(tsd_t *tsd) {
 	        malloc_mutex_rank_exclusive)) {
 		return true;
 	}
+	if (malloc_mutex_init(&log_write_mtx, "prof_log_write",
+	        WITNESS_RANK_PROF_LOG_WRITE, malloc_mutex_rank_exclusive)) {
+		return true;
+	}
 
 	if (opt_prof_log) {
 		prof_log_start(tsd_tsdn(tsd), NULL);
@@ -0,0 +1,467 @@
+#include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/jemalloc_internal_includes.h"
+
+#include "jemalloc/internal/assert.h"
+#include "jemalloc/internal/ckh.h"
+#include "jemalloc/internal/malloc_io.h"
+#include "jemalloc/internal/prof_pprof.h"
+
+bool opt_prof_pprof = false;
+
+/* Wire types. */
+#define PROF_PPROF_VARINT 0
+#define PROF_PPROF_LEN 2
+
+/* Field numbers of the Profile message. */
+#define PROF_PPROF_PROFILE_SAMPLE_TYPE 1
+#define PROF_PPROF_PROFILE_SAMPLE 2
+#define PROF_PPROF_PROFILE_MAPPING 3
+#define PROF_PPROF_PROFILE_LOCATION 4
+#define PROF_PPROF_PROFILE_STRING_TABLE 6
+#define PROF_PPROF_PROFILE_PERIOD_TYPE 11
+#define PROF_PPROF_PROFILE_PERIOD 12
+#define PROF_PPROF_PROFILE_DEFAULT_SAMPLE_TYPE 14
+
+/* ValueType. */
+#define PROF_PPROF_VALUE_TYPE_TYPE 1
+#define PROF_PPROF_VALUE_TYPE_UNIT 2
+
+/* Sample. */
+#define PROF_PPROF_SAMPLE_LOCATION_ID 1
+#define PROF_PPROF_SAMPLE_VALUE 2
+
+/* Mapping. */
+#define PROF_PPROF_MAPPING_ID 1
+#define PROF_PPROF_MAPPING_MEMORY_START 2
+#define PROF_PPROF_MAPPING_MEMORY_LIMIT 3
+#define PROF_PPROF_MAPPING_FILE_OFFSET 4
+#define PROF_PPROF_MAPPING_FILENAME 5
+
+/* Location. */
+#define PROF_PPROF_LOCATION_ID 1
+#define PROF_PPROF_LOCATION_MAPPING_ID 2
+#define PROF_PPROF_LOCATION_ADDRESS 3
+
+/*
+ * The strings every profile starts with; the mapping file names follow.  The
+ * string table must start with "".
+ */
+enum prof_pprof_str_e {
+	prof_pprof_str_empty,
+	prof_pprof_str_alloc_objects,
+	prof_pprof_str_alloc_space,
+	prof_pprof_str_inuse_objects,
+	prof_pprof_str_inuse_space,
+	prof_pprof_str_space,
+	prof_pprof_str_count,
+	prof_pprof_str_bytes,
+	prof_pprof_nstrs
+};
+static const char *prof_pprof_strs[prof_pprof_nstrs] = {"", "alloc_objects",
+    "alloc_space", "inuse_objects", "inuse_space", "space", "count", "bytes"};
+
+/* Enough for a line of the memory map, file name included. */
+#define PROF_PPROF_MAPS_LINE_MAX (PATH_MAX + 128)
+
+typedef struct prof_pprof_range_s prof_pprof_range_t;
+struct prof_pprof_range_s {
+	uintptr_t start;
+	uintptr_t limit;
+};
+
+static void
+prof_pprof_flush(prof_pprof_t *pprof) {
+	if (pprof->buf_end > 0) {
+		pprof->write_cb(pprof->cbopaque, pprof->buf, pprof->buf_end);
+		pprof->buf_end = 0;
+	}
+}
+
+static void
+prof_pprof_write(prof_pprof_t *pprof, const void *s, size_t len) {
+	const unsigned char *src = (const unsigned char *)s;
+	while (len > 0) {
+		if (pprof->buf_end == pprof->buf_size) {
+			prof_pprof_flush(pprof);
+		}
+		size_t n = pprof->buf_size - pprof->buf_end;
+		if (n > len) {
+			n = len;
+		}
+		memcpy(&pprof->buf[pprof->buf_end], src, n);
+		pprof->buf_end += n;
+		src += n;
+		len -= n;
+	}
+}
+
+static size_t
+prof_pprof_varint_size(uint64_t v) {
+	size_t size = 1;
+	while (v >= 0x80) {
+		v >>= 7;
+		size++;
+	}
+	return size;
+}
+
+static void
+prof_pprof_varint(prof_pprof_t *pprof, uint64_t v) {
+	unsigned char buf[10];
+	size_t        len = 0;
+	while (v >= 0x80) {
+		buf[len++] = (unsigned char)(v | 0x80);
+		v >>= 7;
+	}
+	buf[len++] = (unsigned char)v;
+	prof_pprof_write(pprof, buf, len);
+}
+
+/* All field numbers are below 16, so keys take one byte. */
+static void
+prof_pprof_key(prof_pprof_t *pprof, unsigned field, unsigned wire_type) {
+	assert(field < 16);
+	prof_pprof_varint(pprof, (field << 3) | wire_type);
+}
+
+static size_t
+prof_pprof_uint_field_size(uint64_t v) {
+	return 1 + prof_pprof_varint_size(v);
+}
+
+static void
+prof_pprof_uint_field(prof_pprof_t *pprof, unsigned field, uint64_t v) {
+	prof_pprof_key(pprof, field, PROF_PPROF_VARINT);
+	prof_pprof_varint(pprof, v);
+}
+
+static void
+prof_pprof_len_field(prof_pprof_t *pprof, unsigned field, size_t len) {
+	prof_pprof_key(pprof, field, PROF_PPROF_LEN);
+	prof_pprof_varint(pprof, len);
+}
+
+static void
+prof_pprof_string(prof_pprof_t *pprof, const char *s, size_t len) {
+	prof_pprof_len_field(pprof, PROF_PPROF_PROFILE_STRING_TABLE, len);
+	prof_pprof_write(pprof, s, len);
+}
+
+static void
+prof_pprof_value_type(
+    prof_pprof_t *pprof, unsigned field, uint64_t type, uint64_t unit) {
+	prof_pprof_len_field(pprof, field,
+	    prof_pprof_uint_field_size(type) + prof_pprof_uint_field_size(unit));
+	prof_pprof_uint_field(pprof, PROF_PPROF_VALUE_TYPE_TYPE, type);
+	prof_pprof_uint_field(pprof, PROF_PPROF_VALUE_TYPE_UNIT, unit);
+}
+
+bool
+prof_pprof_init(tsd_t *tsd, prof_pprof_t *pprof,
+    prof_pprof_write_cb_t *write_cb, void *cbopaque, char *buf,
+    size_t buf_size, uint64_t period) {
+	cassert(config_prof);
+	assert(buf_size > 0);
+
+	pprof->write_cb = write_cb;
+	pprof->cbopaque = cbopaque;
+	pprof->buf = (unsigned char *)buf;
+	pprof->buf_size = buf_size;
+	pprof->buf_end = 0;
+	pprof->nvalues = opt_prof_accum ? 4 : 2;
+	if (ckh_new(tsd, &pprof->locations, PROF_CKH_MINITEMS,
+	        ckh_pointer_hash, ckh_pointer_keycomp)) {
+		return true;
+	}
+	pprof->nlocations = 0;
+	pprof->oom = false;
+
+	for (unsigned i = 0; i < prof_pprof_nstrs; i++) {
+		prof_pprof_string(
+		    pprof, prof_pprof_strs[i], strlen(prof_pprof_strs[i]));
+	}
+	if (opt_prof_accum) {
+		prof_pprof_value_type(pprof, PROF_PPROF_PROFILE_SAMPLE_TYPE,
+		    prof_pprof_str_alloc_objects, prof_pprof_str_count);
+		prof_pprof_value_type(pprof, PROF_PPROF_PROFILE_SAMPLE_TYPE,
+		    prof_pprof_str_alloc_space, prof_pprof_str_bytes);
+	}
+	prof_pprof_value_type(pprof, PROF_PPROF_PROFILE_SAMPLE_TYPE,
+	    prof_pprof_str_inuse_objects, prof_pprof_str_count);
+	prof_pprof_value_type(pprof, PROF_PPROF_PROFILE_SAMPLE_TYPE,
+	    prof_pprof_str_inuse_space, prof_pprof_str_bytes);
+	prof_pprof_value_type(pprof, PROF_PPROF_PROFILE_PERIOD_TYPE,
+	    prof_pprof_str_space, prof_pprof_str_bytes);
+	prof_pprof_uint_field(pprof, PROF_PPROF_PROFILE_PERIOD, period);
+	prof_pprof_uint_field(pprof, PROF_PPROF_PROFILE_DEFAULT_SAMPLE_TYPE,
+	    prof_pprof_str_inuse_space);
+	return false;
+}
+
+/*
+ * All frames but the first hold return addresses; like jeprof, point them into
+ * the call instruction instead, so that they symbolize to the calling line.
+ */
+static uintptr_t
+prof_pprof_frame_addr(const prof_bt_t *bt, unsigned i) {
+	uintptr_t addr = (uintptr_t)bt->vec[i];
+	return (i == 0 || addr == 0) ? addr : addr - 1;
+}
+
+static uint64_t
+prof_pprof_location_id(prof_pprof_t *pprof, uintptr_t addr) {
+	void *data;
+	if (ckh_search(&pprof->locations, (void *)addr, NULL, &data)) {
+		return 0;
+	}
+	return (uint64_t)(uintptr_t)data;
+}
+
+void
+prof_pprof_sample(tsd_t *tsd, prof_pprof_t *pprof, const prof_bt_t *bt,
+    const uint64_t *values) {
+	cassert(config_prof);
+
+	/*
+	 * Assign location ids first; the sample can only be written once its
+	 * length is known.
+	 */
+	size_t locs_len = 0;
+	for (unsigned i = 0; i < bt->len; i++) {
+		uintptr_t addr = prof_pprof_frame_addr(bt, i);
+		/* ckh can't hold NULL keys; such a frame says nothing anyway. */
+		if (addr == 0) {
+			continue;
+		}
+		uint64_t id = prof_pprof_location_id(pprof, addr);
+		if (id == 0) {
+			id = pprof->nlocations + 1;
+			if (ckh_insert(tsd, &pprof->locations, (void *)addr,
+			        (void *)(uintptr_t)id)) {
+				pprof->oom = true;
+				return;
+			}
+			pprof->nlocations = id;
+		}
+		locs_len += prof_pprof_varint_size(id);
+	}
+	size_t vals_len = 0;
+	for (unsigned i = 0; i < pprof->nvalues; i++) {
+		vals_len += prof_pprof_varint_size(values[i]);
+	}
+
+	prof_pprof_len_field(pprof, PROF_PPROF_PROFILE_SAMPLE,
+	    1 + prof_pprof_varint_size(locs_len) + locs_len + 1
+	        + prof_pprof_varint_size(vals_len) + vals_len);
+	prof_pprof_len_field(pprof, PROF_PPROF_SAMPLE_LOCATION_ID, locs_len);
+	for (unsigned i = 0; i < bt->len; i++) {
+		uintptr_t addr = prof_pprof_frame_addr(bt, i);
+		if (addr == 0) {
+			continue;
+		}
+		prof_pprof_varint(pprof, prof_pprof_location_id(pprof, addr));
+	}
+	prof_pprof_len_field(pprof, PROF_PPROF_SAMPLE_VALUE, vals_len);
+	for (unsigned i = 0; i < pprof->nvalues; i++) {
+		prof_pprof_varint(pprof, values[i]);
+	}
+}
+
+/*
+ * Parses a line of the Linux memory map, i.e.
+ *
+ *   <start>-<limit> <perms> <offset> <dev> <inode> [<file name>]
+ *
+ * and returns true unless it describes an executable mapping.
+ */
+static bool
+prof_pprof_maps_parse(char *line, uintptr_t *start, uintptr_t *limit,
+    uint64_t *offset, const char **filename) {
+	char *p = line;
+	char *end;
+
+	*start = (uintptr_t)malloc_strtoumax(p, &end, 16);
+	if (end == p || *end != '-') {
+		return true;
+	}
+	p = end + 1;
+	*limit = (uintptr_t)malloc_strtoumax(p, &end, 16);
+	if (end == p || *end != ' ' || *limit <= *start) {
+		return true;
+	}
+	p = end + 1;
+	if (strlen(p) < 5 || p[2] != 'x' || p[4] != ' ') {
+		return true;
+	}
+	p += 5;
+	*offset = (uint64_t)malloc_strtoumax(p, &end, 16);
+	if (end == p || *end != ' ') {
+		return true;
+	}
+	/* Skip the device and the inode. */
+	p = end + 1;
+	for (unsigned i = 0; i < 2; i++) {
+		p = strchr(p, ' ');
+		if (p == NULL) {
+			*filename = "";
+			return false;
+		}
+		while (*p == ' ') {
+			p++;
+		}
+	}
+	*filename = p;
+	return false;
+}
+
+static prof_pprof_range_t *
+prof_pprof_ranges_grow(
+    tsdn_t *tsdn, prof_pprof_range_t *ranges, size_t nranges, size_t *cap) {
+	size_t new_cap = (*cap == 0) ? 64 : *cap * 2;
+	size_t size = new_cap * sizeof(prof_pprof_range_t);
+	prof_pprof_range_t *new_ranges = (prof_pprof_range_t *)iallocztm(tsdn,
+	    size, sz_size2index(size), false, NULL, true,
+	    arena_get(TSDN_NULL, 0, true), true);
+	if (new_ranges == NULL) {
+		return NULL;
+	}
+	if (ranges != NULL) {
+		memcpy(new_ranges, ranges, nranges * sizeof(prof_pprof_range_t));
+		idalloctm(tsdn, ranges, NULL, NULL, true, true);
+	}
+	*cap = new_cap;
+	return new_ranges;
+}
+
+static void
+prof_pprof_mapping(prof_pprof_t *pprof, uint64_t id, uintptr_t start,
+    uintptr_t limit, uint64_t offset, const char *filename) {
+	size_t filename_len = strlen(filename);
+	prof_pprof_string(pprof, filename, filename_len);
+	uint64_t filename_ind = prof_pprof_nstrs + id - 1;
+
+	prof_pprof_len_field(pprof, PROF_PPROF_PROFILE_MAPPING,
+	    prof_pprof_uint_field_size(id) + prof_pprof_uint_field_size(start)
+	        + prof_pprof_uint_field_size(limit)
+	        + prof_pprof_uint_field_size(offset)
+	        + prof_pprof_uint_field_size(filename_ind));
+	prof_pprof_uint_field(pprof, PROF_PPROF_MAPPING_ID, id);
+	prof_pprof_uint_field(pprof, PROF_PPROF_MAPPING_MEMORY_START, start);
+	prof_pprof_uint_field(pprof, PROF_PPROF_MAPPING_MEMORY_LIMIT, limit);
+	prof_pprof_uint_field(pprof, PROF_PPROF_MAPPING_FILE_OFFSET, offset);
+	prof_pprof_uint_field(pprof, PROF_PPROF_MAPPING_FILENAME, filename_ind);
+}
+
+/*
+ * Writes a mapping for each executable entry of the memory map, and returns
+ * their address ranges (which the memory map lists in ascending order) in
+ * *r_ranges.  Mapping ids are indices into the ranges, plus one.
+ */
+static size_t
+prof_pprof_mappings(tsd_t *tsd, prof_pprof_t *pprof, int maps_fd,
+    prof_pprof_range_t **r_ranges) {
+	prof_pprof_range_t *ranges = NULL;
+	size_t              nranges = 0;
+	size_t              cap = 0;
+	char                line[PROF_PPROF_MAPS_LINE_MAX];
+	size_t              line_len = 0;
+	char                buf[512];
+	ssize_t             nread;
+
+	while ((nread = malloc_read_fd(maps_fd, buf, sizeof(buf))) > 0) {
+		for (ssize_t i = 0; i < nread; i++) {
+			if (buf[i] != '\n') {
+				/* Overlong lines are cut short. */
+				if (line_len < sizeof(line) - 1) {
+					line[line_len++] = buf[i];
+				}
+				continue;
+			}
+			line[line_len] = '\0';
+			line_len = 0;
+
+			uintptr_t   start, limit;
+			uint64_t    offset;
+			const char *filename;
+			if (prof_pprof_maps_parse(
+			        line, &start, &limit, &offset, &filename)) {
+				continue;
+			}
+			if (nranges == cap) {
+				prof_pprof_range_t *grown =
+				    prof_pprof_ranges_grow(tsd_tsdn(tsd),
+				        ranges, nranges, &cap);
+				if (grown == NULL) {
+					pprof->oom = true;
+					*r_ranges = ranges;
+					return nranges;
+				}
+				ranges = grown;
+			}
+			ranges[nranges].start = start;
+			ranges[nranges].limit = limit;
+			nranges++;
+			prof_pprof_mapping(
+			    pprof, nranges, start, limit, offset, filename);
+		}
+	}
+	*r_ranges = ranges;
+	return nranges;
+}
+
+static uint64_t
+prof_pprof_mapping_id(
+    const prof_pprof_range_t *ranges, size_t nranges, uintptr_t addr) {
+	size_t lo = 0;
+	size_t hi = nranges;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (addr < ranges[mid].start) {
+			hi = mid;
+		} else if (addr >= ranges[mid].limit) {
+			lo = mid + 1;
+		} else {
+			return mid + 1;
+		}
+	}
+	return 0;
+}
+
+bool
+prof_pprof_finish(tsd_t *tsd, prof_pprof_t *pprof, int maps_fd) {
+	cassert(config_prof);
+
+	prof_pprof_range_t *ranges = NULL;
+	size_t              nranges = 0;
+	if (maps_fd != -1) {
+		nranges = prof_pprof_mappings(tsd, pprof, maps_fd, &ranges);
+	}
+
+	size_t tabind;
+	void  *key, *data;
+	for (tabind = 0; !ckh_iter(&pprof->locations, &tabind, &key, &data);) {
+		uintptr_t addr = (uintptr_t)key;
+		uint64_t  id = (uint64_t)(uintptr_t)data;
+		uint64_t  mapping_id = prof_pprof_mapping_id(
+		    ranges, nranges, addr);
+		size_t    len = prof_pprof_uint_field_size(id)
+		    + prof_pprof_uint_field_size(addr);
+		if (mapping_id != 0) {
+			len += prof_pprof_uint_field_size(mapping_id);
+		}
+		prof_pprof_len_field(pprof, PROF_PPROF_PROFILE_LOCATION, len);
+		prof_pprof_uint_field(pprof, PROF_PPROF_LOCATION_ID, id);
+		if (mapping_id != 0) {
+			prof_pprof_uint_field(
+			    pprof, PROF_PPROF_LOCATION_MAPPING_ID, mapping_id);
+		}
+		prof_pprof_uint_field(pprof, PROF_PPROF_LOCATION_ADDRESS, addr);
+	}
+	prof_pprof_flush(pprof);
+
+	if (ranges != NULL) {
+		idalloctm(tsd_tsdn(tsd), ranges, NULL, NULL, true, true);
+	}
+	ckh_delete(tsd, &pprof->locations);
+	return pprof->oom;
+}
@@ -6,12 +6,48 @@
 #include "jemalloc/internal/emitter.h"
 #include "jemalloc/internal/prof_data.h"
 #include "jemalloc/internal/prof_recent.h"
+#include "jemalloc/internal/prof_sys.h"
+#include "jemalloc/internal/spin.h"
 
-ssize_t            opt_prof_recent_alloc_max = PROF_RECENT_ALLOC_MAX_DEFAULT;
-malloc_mutex_t     prof_recent_alloc_mtx; /* Protects the fields below */
+/*
+ * The records live in a ring of slots indexed by allocation order, so that
+ * neither recording an allocation nor its release takes a global lock: a
+ * sampled allocation claims the next seq with an atomic increment and takes
+ * over the slot the seq maps to, evicting the record that was there, while a
+ * release goes straight to its record through the edata.  Every slot has its
+ * own spin lock, held only for the few stores needed to fill, evict or update
+ * the record, never while acquiring anything else.
+ *
+ * The records shown are the ones whose seq is within prof_recent_alloc_max of
+ * the next seq; the ones that fall out of this window are evicted by the
+ * allocation that pushed them out, or by the ctl lowering the max.
+ *
+ * The ring has a power of 2 number of slots, at least prof_recent_alloc_max
+ * (doubling as needed in unlimited mode), and only ever grows.  A bigger ring
+ * gets the records of the old one before it is published, during which
+ * sampled allocations needing a slot wait.  Old rings are never freed, as a
+ * release may still be about to look for its record there; being base
+ * allocated and doubling in size, they cost no more than the current ring.
+ */
+#define PROF_RECENT_NSLOTS_MIN 64
+
+typedef struct prof_recent_ring_s prof_recent_ring_t;
+struct prof_recent_ring_s {
+	prof_recent_t *slots;
+	/* Power of 2. */
+	size_t nslots;
+	/* Set once the records are being moved to a bigger ring. */
+	atomic_b_t retired;
+};
+
+ssize_t opt_prof_recent_alloc_max = PROF_RECENT_ALLOC_MAX_DEFAULT;
+/* Protects ring growth, and serializes the max updates. */
+malloc_mutex_t     prof_recent_alloc_mtx;
 static atomic_zd_t prof_recent_alloc_max;
-static ssize_t     prof_recent_alloc_count = 0;
-prof_recent_list_t prof_recent_alloc_list;
+/* The seq of the next record; seqs start at 1. */
+static atomic_zu_t prof_recent_seq_next;
+/* NULL until the first record. */
+static atomic_p_t prof_recent_ring;
 
 malloc_mutex_t prof_recent_dump_mtx; /* Protects dumping. */
 
@@ -22,36 +58,44 @@ prof_recent_alloc_max_init(void) {
 }
 
 static inline ssize_t
-prof_recent_alloc_max_get_no_lock(void) {
+prof_recent_alloc_max_get(void) {
 	return atomic_load_zd(&prof_recent_alloc_max, ATOMIC_RELAXED);
 }
 
-static inline ssize_t
-prof_recent_alloc_max_get(tsd_t *tsd) {
-	malloc_mutex_assert_owner(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	return prof_recent_alloc_max_get_no_lock();
+static inline prof_recent_ring_t *
+prof_recent_ring_get(void) {
+	return (prof_recent_ring_t *)atomic_load_p(
+	    &prof_recent_ring, ATOMIC_ACQUIRE);
 }
 
-static inline ssize_t
-prof_recent_alloc_max_update(tsd_t *tsd, ssize_t max) {
-	malloc_mutex_assert_owner(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	ssize_t old_max = prof_recent_alloc_max_get(tsd);
-	atomic_store_zd(&prof_recent_alloc_max, max, ATOMIC_RELAXED);
-	return old_max;
+static inline prof_recent_t *
+prof_recent_ring_slot(prof_recent_ring_t *ring, size_t seq) {
+	return &ring->slots[seq & (ring->nslots - 1)];
 }
 
-static prof_recent_t *
-prof_recent_allocate_node(tsdn_t *tsdn) {
-	return (prof_recent_t *)iallocztm(tsdn, sizeof(prof_recent_t),
-	    sz_size2index(sizeof(prof_recent_t)), false, NULL, true,
-	    arena_get(tsdn, 0, false), true);
+/* The oldest seq that can still be shown, given the next seq. */
+static size_t
+prof_recent_window_start(
+    const prof_recent_ring_t *ring, ssize_t max, size_t seq_next) {
+	size_t n = ring->nslots;
+	if (max != -1 && (size_t)max < n) {
+		n = (size_t)max;
+	}
+	return seq_next > n ? seq_next - n : 1;
 }
 
 static void
-prof_recent_free_node(tsdn_t *tsdn, prof_recent_t *node) {
-	assert(node != NULL);
-	assert(isalloc(tsdn, node) == sz_s2u(sizeof(prof_recent_t)));
-	idalloctm(tsdn, node, NULL, NULL, true, true);
+prof_recent_slot_lock(prof_recent_t *slot) {
+	spin_t spin = SPIN_INITIALIZER;
+	while (atomic_exchange_b(&slot->locked, true, ATOMIC_ACQUIRE)) {
+		spin_adaptive(&spin);
+	}
+}
+
+static void
+prof_recent_slot_unlock(prof_recent_t *slot) {
+	assert(atomic_load_b(&slot->locked, ATOMIC_RELAXED));
+	atomic_store_b(&slot->locked, false, ATOMIC_RELEASE);
 }
 
 static inline void
@@ -68,23 +112,16 @@ prof_recent_alloc_prepare(tsd_t *tsd, prof_tctx_t *tctx) {
 	malloc_mutex_assert_owner(tsd_tsdn(tsd), tctx->tdata->lock);
 	malloc_mutex_assert_not_owner(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
 
-	/*
-	 * Check whether last-N mode is turned on without trying to acquire the
-	 * lock, so as to optimize for the following two scenarios:
-	 * (1) Last-N mode is switched off;
-	 * (2) Dumping, during which last-N mode is temporarily turned off so
-	 *     as not to block sampled allocations.
-	 */
-	if (prof_recent_alloc_max_get_no_lock() == 0) {
+	/* Don't hold the tctx at all when last-N mode is switched off. */
+	if (prof_recent_alloc_max_get() == 0) {
 		return false;
 	}
 
 	/*
 	 * Increment recent_count to hold the tctx so that it won't be gone
 	 * even after tctx->tdata->lock is released.  This acts as a
-	 * "placeholder"; the real recording of the allocation requires a lock
-	 * on prof_recent_alloc_mtx and is done in prof_recent_alloc (when
-	 * tctx->tdata->lock has been released).
+	 * "placeholder"; the real recording of the allocation is done in
+	 * prof_recent_alloc (when tctx->tdata->lock has been released).
 	 */
 	increment_recent_count(tsd, tctx);
 	return true;
@@ -111,18 +148,6 @@ prof_recent_alloc_edata_get_no_lock_test(const prof_recent_t *n) {
 	return prof_recent_alloc_edata_get_no_lock(n);
 }
 
-static inline edata_t *
-prof_recent_alloc_edata_get(tsd_t *tsd, const prof_recent_t *n) {
-	malloc_mutex_assert_owner(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	return prof_recent_alloc_edata_get_no_lock(n);
-}
-
-static void
-prof_recent_alloc_edata_set(tsd_t *tsd, prof_recent_t *n, edata_t *edata) {
-	malloc_mutex_assert_owner(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	atomic_store_p(&n->alloc_edata, edata, ATOMIC_RELEASE);
-}
-
 void
 edata_prof_recent_alloc_init(edata_t *edata) {
 	cassert(config_prof);
@@ -141,47 +166,52 @@ edata_prof_recent_alloc_get_no_lock_test(const edata_t *edata) {
 	return edata_prof_recent_alloc_get_no_lock(edata);
 }
 
-static inline prof_recent_t *
-edata_prof_recent_alloc_get(tsd_t *tsd, const edata_t *edata) {
-	malloc_mutex_assert_owner(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	prof_recent_t *recent_alloc = edata_prof_recent_alloc_get_no_lock(
-	    edata);
-	assert(recent_alloc == NULL
-	    || prof_recent_alloc_edata_get(tsd, recent_alloc) == edata);
-	return recent_alloc;
+/* Links the record in slot, which must be locked, and its edata. */
+static void
+prof_recent_slot_edata_set(prof_recent_t *slot, edata_t *edata) {
+	assert(edata_prof_recent_alloc_get_no_lock(edata) == NULL);
+	atomic_store_p(&slot->alloc_edata, edata, ATOMIC_RELEASE);
+	edata_prof_recent_alloc_set_dont_call_directly(edata, slot);
 }
 
-static prof_recent_t *
-edata_prof_recent_alloc_update_internal(
-    tsd_t *tsd, edata_t *edata, prof_recent_t *recent_alloc) {
-	malloc_mutex_assert_owner(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	prof_recent_t *old_recent_alloc = edata_prof_recent_alloc_get(
-	    tsd, edata);
-	edata_prof_recent_alloc_set_dont_call_directly(edata, recent_alloc);
-	return old_recent_alloc;
+/* Marks the allocation recorded in slot, which must be locked, as released. */
+static void
+prof_recent_slot_edata_reset(prof_recent_t *slot) {
+	edata_t *edata = prof_recent_alloc_edata_get_no_lock(slot);
+	assert(edata != NULL);
+	assert(edata_prof_recent_alloc_get_no_lock(edata) == slot);
+	edata_prof_recent_alloc_set_dont_call_directly(edata, NULL);
+	atomic_store_p(&slot->alloc_edata, NULL, ATOMIC_RELEASE);
 }
 
+/*
+ * Empties slot, which must be locked, handing back the tctxs the record held;
+ * they are to be released by prof_recent_tctx_release() once the slot is
+ * unlocked.
+ */
 static void
-edata_prof_recent_alloc_set(
-    tsd_t *tsd, edata_t *edata, prof_recent_t *recent_alloc) {
-	malloc_mutex_assert_owner(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	assert(recent_alloc != NULL);
-	prof_recent_t *old_recent_alloc =
-	    edata_prof_recent_alloc_update_internal(tsd, edata, recent_alloc);
-	assert(old_recent_alloc == NULL);
-	prof_recent_alloc_edata_set(tsd, recent_alloc, edata);
+prof_recent_slot_evict(prof_recent_t *slot, prof_tctx_t **alloc_tctx,
+    prof_tctx_t **dalloc_tctx) {
+	assert(slot->seq != 0);
+	if (prof_recent_alloc_edata_get_no_lock(slot) != NULL) {
+		prof_recent_slot_edata_reset(slot);
+	}
+	*alloc_tctx = slot->alloc_tctx;
+	*dalloc_tctx = slot->dalloc_tctx;
+	slot->alloc_tctx = NULL;
+	slot->dalloc_tctx = NULL;
+	slot->seq = 0;
 }
 
 static void
-edata_prof_recent_alloc_reset(
-    tsd_t *tsd, edata_t *edata, prof_recent_t *recent_alloc) {
-	malloc_mutex_assert_owner(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	assert(recent_alloc != NULL);
-	prof_recent_t *old_recent_alloc =
-	    edata_prof_recent_alloc_update_internal(tsd, edata, NULL);
-	assert(old_recent_alloc == recent_alloc);
-	assert(edata == prof_recent_alloc_edata_get(tsd, recent_alloc));
-	prof_recent_alloc_edata_set(tsd, recent_alloc, NULL);
+prof_recent_tctx_release(
+    tsd_t *tsd, prof_tctx_t *alloc_tctx, prof_tctx_t *dalloc_tctx) {
+	if (alloc_tctx != NULL) {
+		decrement_recent_count(tsd, alloc_tctx);
+	}
+	if (dalloc_tctx != NULL) {
+		decrement_recent_count(tsd, dalloc_tctx);
+	}
 }
 
 /*
@@ -195,10 +225,7 @@ edata_prof_recent_alloc_reset(
 void
 prof_recent_alloc_reset(tsd_t *tsd, edata_t *edata) {
 	cassert(config_prof);
-	/*
-	 * Check whether the recent allocation record still exists without
-	 * trying to acquire the lock.
-	 */
+	/* Check whether the recent allocation record still exists. */
 	if (edata_prof_recent_alloc_get_no_lock(edata) == NULL) {
 		return;
 	}
@@ -207,7 +234,7 @@ prof_recent_alloc_reset(tsd_t *tsd, edata_t *edata) {
 	/*
 	 * In case dalloc_tctx is NULL, e.g. due to OOM, we will not record the
 	 * deallocation time / tctx, which is handled later, after we check
-	 * again when holding the lock.
+	 * again when holding the slot lock.
 	 */
 
 	if (dalloc_tctx != NULL) {
@@ -217,62 +244,153 @@ prof_recent_alloc_reset(tsd_t *tsd, edata_t *edata) {
 		malloc_mutex_unlock(tsd_tsdn(tsd), dalloc_tctx->tdata->lock);
 	}
 
-	malloc_mutex_lock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	/* Check again after acquiring the lock.  */
-	prof_recent_t *recent = edata_prof_recent_alloc_get(tsd, edata);
-	if (recent != NULL) {
-		assert(nstime_equals_zero(&recent->dalloc_time));
-		assert(recent->dalloc_tctx == NULL);
-		if (dalloc_tctx != NULL) {
-			nstime_prof_update(&recent->dalloc_time);
-			recent->dalloc_tctx = dalloc_tctx;
-			dalloc_tctx = NULL;
+	/*
+	 * The record may be evicted, or moved to a bigger ring, until its slot
+	 * is locked; in the latter case the edata points to the new slot by the
+	 * time the old one is unlocked.
+	 */
+	prof_recent_t *slot;
+	while ((slot = edata_prof_recent_alloc_get_no_lock(edata)) != NULL) {
+		prof_recent_slot_lock(slot);
+		if (prof_recent_alloc_edata_get_no_lock(slot) == edata) {
+			assert(nstime_equals_zero(&slot->dalloc_time));
+			assert(slot->dalloc_tctx == NULL);
+			if (dalloc_tctx != NULL) {
+				nstime_prof_update(&slot->dalloc_time);
+				slot->dalloc_tctx = dalloc_tctx;
+				dalloc_tctx = NULL;
+			}
+			prof_recent_slot_edata_reset(slot);
+			prof_recent_slot_unlock(slot);
+			break;
 		}
-		edata_prof_recent_alloc_reset(tsd, edata, recent);
+		prof_recent_slot_unlock(slot);
 	}
-	malloc_mutex_unlock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
 
 	if (dalloc_tctx != NULL) {
-		/* We lost the rase - the allocation record was just gone. */
+		/* We lost the race - the allocation record was just gone. */
 		decrement_recent_count(tsd, dalloc_tctx);
 	}
 }
 
-static void
-prof_recent_alloc_evict_edata(tsd_t *tsd, prof_recent_t *recent_alloc) {
-	malloc_mutex_assert_owner(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	edata_t *edata = prof_recent_alloc_edata_get(tsd, recent_alloc);
-	if (edata != NULL) {
-		edata_prof_recent_alloc_reset(tsd, edata, recent_alloc);
+/*
+ * Replaces ring (NULL before the first record) with one that has room for max
+ * records, or twice as many slots in unlimited mode, unless another thread
+ * already did.  Returns true on OOM.
+ */
+static bool
+prof_recent_ring_grow(tsd_t *tsd, prof_recent_ring_t *ring, ssize_t max) {
+	malloc_mutex_lock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
+	if (prof_recent_ring_get() != ring) {
+		malloc_mutex_unlock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
+		return false;
 	}
-}
 
-static bool
-prof_recent_alloc_is_empty(tsd_t *tsd) {
-	malloc_mutex_assert_owner(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	if (ql_empty(&prof_recent_alloc_list)) {
-		assert(prof_recent_alloc_count == 0);
+	size_t nslots = ring == NULL ? PROF_RECENT_NSLOTS_MIN
+	                             : ring->nslots * 2;
+	if (max != -1 && (size_t)max > nslots) {
+		nslots = pow2_ceil_zu((size_t)max);
+	}
+	/* base_alloc() returns zeroed memory, i.e. empty unlocked slots. */
+	prof_recent_ring_t *new_ring = (prof_recent_ring_t *)base_alloc(
+	    tsd_tsdn(tsd), prof_base,
+	    sizeof(prof_recent_ring_t) + nslots * sizeof(prof_recent_t),
+	    CACHELINE);
+	if (new_ring == NULL) {
+		malloc_mutex_unlock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
 		return true;
-	} else {
-		assert(prof_recent_alloc_count > 0);
-		return false;
 	}
+	new_ring->slots = (prof_recent_t *)(new_ring + 1);
+	new_ring->nslots = nslots;
+
+	if (ring != NULL) {
+		atomic_store_b(&ring->retired, true, ATOMIC_RELAXED);
+		for (size_t i = 0; i < ring->nslots; i++) {
+			prof_recent_t *slot = &ring->slots[i];
+			prof_recent_slot_lock(slot);
+			if (slot->seq == 0) {
+				prof_recent_slot_unlock(slot);
+				continue;
+			}
+			/*
+			 * Records in different slots of the old ring end up in
+			 * different slots of the new one.
+			 */
+			prof_recent_t *new_slot = prof_recent_ring_slot(
+			    new_ring, slot->seq);
+			prof_recent_slot_lock(new_slot);
+			assert(new_slot->seq == 0);
+			new_slot->seq = slot->seq;
+			nstime_copy(&new_slot->alloc_time, &slot->alloc_time);
+			nstime_copy(&new_slot->dalloc_time, &slot->dalloc_time);
+			new_slot->size = slot->size;
+			new_slot->usize = slot->usize;
+			new_slot->alloc_tctx = slot->alloc_tctx;
+			new_slot->dalloc_tctx = slot->dalloc_tctx;
+			/*
+			 * Repoint the edata without ever clearing it, or its
+			 * release could miss the record.
+			 */
+			edata_t *edata = prof_recent_alloc_edata_get_no_lock(
+			    slot);
+			if (edata != NULL) {
+				atomic_store_p(&new_slot->alloc_edata, edata,
+				    ATOMIC_RELEASE);
+				edata_prof_recent_alloc_set_dont_call_directly(
+				    edata, new_slot);
+				atomic_store_p(
+				    &slot->alloc_edata, NULL, ATOMIC_RELEASE);
+			}
+			prof_recent_slot_unlock(new_slot);
+			slot->alloc_tctx = NULL;
+			slot->dalloc_tctx = NULL;
+			slot->seq = 0;
+			prof_recent_slot_unlock(slot);
+		}
+	}
+	atomic_store_p(&prof_recent_ring, new_ring, ATOMIC_RELEASE);
+	malloc_mutex_unlock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
+	return false;
+}
+
+/*
+ * Returns the ring that took over the records of the retired ring, once it's
+ * published.
+ */
+static prof_recent_ring_t *
+prof_recent_ring_successor(tsd_t *tsd, prof_recent_ring_t *ring) {
+	assert(atomic_load_b(&ring->retired, ATOMIC_RELAXED));
+	/* The ring is retired and replaced under prof_recent_alloc_mtx. */
+	malloc_mutex_lock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
+	malloc_mutex_unlock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
+	prof_recent_ring_t *successor = prof_recent_ring_get();
+	assert(successor != ring);
+	return successor;
 }
 
+/* Evicts the record seq, unless it's already gone. */
 static void
-prof_recent_alloc_assert_count(tsd_t *tsd) {
-	malloc_mutex_assert_owner(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	if (!config_debug) {
-		return;
-	}
-	ssize_t        count = 0;
-	prof_recent_t *n;
-	ql_foreach (n, &prof_recent_alloc_list, link) {
-		++count;
+prof_recent_evict_seq(tsd_t *tsd, size_t seq) {
+	prof_recent_ring_t *ring = prof_recent_ring_get();
+	prof_tctx_t        *alloc_tctx = NULL;
+	prof_tctx_t        *dalloc_tctx = NULL;
+	while (true) {
+		prof_recent_t *slot = prof_recent_ring_slot(ring, seq);
+		prof_recent_slot_lock(slot);
+		if (slot->seq == seq) {
+			prof_recent_slot_evict(slot, &alloc_tctx, &dalloc_tctx);
+			prof_recent_slot_unlock(slot);
+			break;
+		}
+		bool retired = atomic_load_b(&ring->retired, ATOMIC_RELAXED);
+		prof_recent_slot_unlock(slot);
+		if (!retired) {
+			break;
+		}
+		/* The record may have moved to a bigger ring. */
+		ring = prof_recent_ring_successor(tsd, ring);
 	}
-	assert(count == prof_recent_alloc_count);
-	assert(prof_recent_alloc_max_get(tsd) == -1
-	    || count <= prof_recent_alloc_max_get(tsd));
+	prof_recent_tctx_release(tsd, alloc_tctx, dalloc_tctx);
 }
 
 void
@@ -280,126 +398,83 @@ prof_recent_alloc(tsd_t *tsd, edata_t *edata, size_t size, size_t usize) {
 	cassert(config_prof);
 	assert(edata != NULL);
 	prof_tctx_t *tctx = edata_prof_tctx_get(edata);
-
 	malloc_mutex_assert_not_owner(tsd_tsdn(tsd), tctx->tdata->lock);
-	malloc_mutex_lock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	prof_recent_alloc_assert_count(tsd);
 
-	/*
-	 * Reserve a new prof_recent_t node if needed.  If needed, we release
-	 * the prof_recent_alloc_mtx lock and allocate.  Then, rather than
-	 * immediately checking for OOM, we regain the lock and try to make use
-	 * of the reserve node if needed.  There are six scenarios:
-	 *
-	 *          \ now | no need | need but OOMed | need and allocated
-	 *     later \    |         |                |
-	 *    ------------------------------------------------------------
-	 *     no need    |   (1)   |      (2)       |         (3)
-	 *    ------------------------------------------------------------
-	 *     need       |   (4)   |      (5)       |         (6)
-	 *
-	 * First, "(4)" never happens, because we don't release the lock in the
-	 * middle if there's no need for a new node; in such cases "(1)" always
-	 * takes place, which is trivial.
-	 *
-	 * Out of the remaining four scenarios, "(6)" is the common case and is
-	 * trivial.  "(5)" is also trivial, in which case we'll rollback the
-	 * effect of prof_recent_alloc_prepare() as expected.
-	 *
-	 * "(2)" / "(3)" occurs when the need for a new node is gone after we
-	 * regain the lock.  If the new node is successfully allocated, i.e. in
-	 * the case of "(3)", we'll release it in the end; otherwise, i.e. in
-	 * the case of "(2)", we do nothing - we're lucky that the OOM ends up
-	 * doing no harm at all.
-	 *
-	 * Therefore, the only performance cost of the "release lock" ->
-	 * "allocate" -> "regain lock" design is the "(3)" case, but it happens
-	 * very rarely, so the cost is relatively small compared to the gain of
-	 * not having to have the lock order of prof_recent_alloc_mtx above all
-	 * the allocation locks.
-	 */
-	prof_recent_t *reserve = NULL;
-	if (prof_recent_alloc_max_get(tsd) == -1
-	    || prof_recent_alloc_count < prof_recent_alloc_max_get(tsd)) {
-		assert(prof_recent_alloc_max_get(tsd) != 0);
-		malloc_mutex_unlock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-		reserve = prof_recent_allocate_node(tsd_tsdn(tsd));
-		malloc_mutex_lock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-		prof_recent_alloc_assert_count(tsd);
-	}
-
-	if (prof_recent_alloc_max_get(tsd) == 0) {
-		assert(prof_recent_alloc_is_empty(tsd));
-		goto label_rollback;
-	}
-
-	prof_tctx_t *old_alloc_tctx, *old_dalloc_tctx;
-	if (prof_recent_alloc_count == prof_recent_alloc_max_get(tsd)) {
-		/* If upper limit is reached, rotate the head. */
-		assert(prof_recent_alloc_max_get(tsd) != -1);
-		assert(!prof_recent_alloc_is_empty(tsd));
-		prof_recent_t *head = ql_first(&prof_recent_alloc_list);
-		old_alloc_tctx = head->alloc_tctx;
-		assert(old_alloc_tctx != NULL);
-		old_dalloc_tctx = head->dalloc_tctx;
-		prof_recent_alloc_evict_edata(tsd, head);
-		ql_rotate(&prof_recent_alloc_list, link);
-	} else {
-		/* Otherwise make use of the new node. */
-		assert(prof_recent_alloc_max_get(tsd) == -1
-		    || prof_recent_alloc_count
-		        < prof_recent_alloc_max_get(tsd));
-		if (reserve == NULL) {
+	size_t seq = atomic_fetch_add_zu(
+	    &prof_recent_seq_next, 1, ATOMIC_RELAXED);
+	ssize_t             max;
+	prof_recent_ring_t *ring;
+	prof_recent_t      *slot;
+	while (true) {
+		max = prof_recent_alloc_max_get();
+		if (max == 0) {
 			goto label_rollback;
 		}
-		ql_elm_new(reserve, link);
-		ql_tail_insert(&prof_recent_alloc_list, reserve, link);
-		reserve = NULL;
-		old_alloc_tctx = NULL;
-		old_dalloc_tctx = NULL;
-		++prof_recent_alloc_count;
-	}
-
-	/* Fill content into the tail node. */
-	prof_recent_t *tail = ql_last(&prof_recent_alloc_list, link);
-	assert(tail != NULL);
-	tail->size = size;
-	tail->usize = usize;
-	nstime_copy(&tail->alloc_time, edata_prof_alloc_time_get(edata));
-	tail->alloc_tctx = tctx;
-	nstime_init_zero(&tail->dalloc_time);
-	tail->dalloc_tctx = NULL;
-	edata_prof_recent_alloc_set(tsd, edata, tail);
-
-	assert(!prof_recent_alloc_is_empty(tsd));
-	prof_recent_alloc_assert_count(tsd);
-	malloc_mutex_unlock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
+		ring = prof_recent_ring_get();
+		if (ring == NULL) {
+			if (prof_recent_ring_grow(tsd, NULL, max)) {
+				goto label_rollback;
+			}
+			continue;
+		}
+		slot = prof_recent_ring_slot(ring, seq);
+		prof_recent_slot_lock(slot);
+		if (atomic_load_b(&ring->retired, ATOMIC_RELAXED)) {
+			/* Wait until the bigger ring is published. */
+			prof_recent_slot_unlock(slot);
+			spin_t spin = SPIN_INITIALIZER;
+			while (prof_recent_ring_get() == ring) {
+				spin_adaptive(&spin);
+			}
+			continue;
+		}
+		if (slot->seq == 0
+		    || (max != -1 && slot->seq + (size_t)max <= seq)) {
+			/* Empty, or holding a record out of the window. */
+			break;
+		}
+		size_t slot_seq = slot->seq;
+		prof_recent_slot_unlock(slot);
+		if (slot_seq > seq) {
+			/*
+			 * Lapped by newer records while getting here; ours is
+			 * already too old to keep.
+			 */
+			goto label_rollback;
+		}
+		if (prof_recent_ring_grow(tsd, ring, max)) {
+			goto label_rollback;
+		}
+	}
 
-	if (reserve != NULL) {
-		prof_recent_free_node(tsd_tsdn(tsd), reserve);
+	prof_tctx_t *old_alloc_tctx = NULL;
+	prof_tctx_t *old_dalloc_tctx = NULL;
+	if (slot->seq != 0) {
+		prof_recent_slot_evict(slot, &old_alloc_tctx, &old_dalloc_tctx);
 	}
+	slot->seq = seq;
+	slot->size = size;
+	slot->usize = usize;
+	nstime_copy(&slot->alloc_time, edata_prof_alloc_time_get(edata));
+	slot->alloc_tctx = tctx;
+	nstime_init_zero(&slot->dalloc_time);
+	slot->dalloc_tctx = NULL;
+	prof_recent_slot_edata_set(slot, edata);
+	prof_recent_slot_unlock(slot);
 
 	/*
-	 * Asynchronously handle the tctx of the old node, so that there's no
-	 * simultaneous holdings of prof_recent_alloc_mtx and tdata->lock.
-	 * In the worst case this may delay the tctx release but it's better
-	 * than holding prof_recent_alloc_mtx for longer.
+	 * Handle the tctxs of the old record once the slot is unlocked, so
+	 * that the slot lock is never held while acquiring tdata->lock.
 	 */
-	if (old_alloc_tctx != NULL) {
-		decrement_recent_count(tsd, old_alloc_tctx);
-	}
-	if (old_dalloc_tctx != NULL) {
-		decrement_recent_count(tsd, old_dalloc_tctx);
+	prof_recent_tctx_release(tsd, old_alloc_tctx, old_dalloc_tctx);
+	/* With fewer than max slots, keep at most max records. */
+	if (max != -1 && seq > (size_t)max) {
+		prof_recent_evict_seq(tsd, seq - max);
 	}
 	return;
 
 label_rollback:
-	assert(edata_prof_recent_alloc_get(tsd, edata) == NULL);
-	prof_recent_alloc_assert_count(tsd);
-	malloc_mutex_unlock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	if (reserve != NULL) {
-		prof_recent_free_node(tsd_tsdn(tsd), reserve);
-	}
+	assert(edata_prof_recent_alloc_get_no_lock(edata) == NULL);
 	decrement_recent_count(tsd, tctx);
 }
 
@@ -407,54 +482,37 @@ ssize_t
 prof_recent_alloc_max_ctl_read(void) {
 	cassert(config_prof);
 	/* Don't bother to acquire the lock. */
-	return prof_recent_alloc_max_get_no_lock();
+	return prof_recent_alloc_max_get();
 }
 
+/* Evicts the records that fell out of the window, e.g. as max was lowered. */
 static void
-prof_recent_alloc_restore_locked(tsd_t *tsd, prof_recent_list_t *to_delete) {
-	malloc_mutex_assert_owner(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	ssize_t max = prof_recent_alloc_max_get(tsd);
-	if (max == -1 || prof_recent_alloc_count <= max) {
-		/* Easy case - no need to alter the list. */
-		ql_new(to_delete);
-		prof_recent_alloc_assert_count(tsd);
-		return;
-	}
-
-	prof_recent_t *node;
-	ql_foreach (node, &prof_recent_alloc_list, link) {
-		if (prof_recent_alloc_count == max) {
-			break;
-		}
-		prof_recent_alloc_evict_edata(tsd, node);
-		--prof_recent_alloc_count;
-	}
-	assert(prof_recent_alloc_count == max);
-
-	ql_move(to_delete, &prof_recent_alloc_list);
-	if (max == 0) {
-		assert(node == NULL);
-	} else {
-		assert(node != NULL);
-		ql_split(to_delete, node, &prof_recent_alloc_list, link);
-	}
-	assert(!ql_empty(to_delete));
-	prof_recent_alloc_assert_count(tsd);
-}
-
-static void
-prof_recent_alloc_async_cleanup(tsd_t *tsd, prof_recent_list_t *to_delete) {
-	malloc_mutex_assert_not_owner(tsd_tsdn(tsd), &prof_recent_dump_mtx);
+prof_recent_alloc_trim(tsd_t *tsd) {
 	malloc_mutex_assert_not_owner(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	while (!ql_empty(to_delete)) {
-		prof_recent_t *node = ql_first(to_delete);
-		ql_remove(to_delete, node, link);
-		decrement_recent_count(tsd, node->alloc_tctx);
-		if (node->dalloc_tctx != NULL) {
-			decrement_recent_count(tsd, node->dalloc_tctx);
+	prof_recent_ring_t *ring;
+	do {
+		ring = prof_recent_ring_get();
+		ssize_t max = prof_recent_alloc_max_get();
+		if (ring == NULL || max == -1) {
+			return;
 		}
-		prof_recent_free_node(tsd_tsdn(tsd), node);
-	}
+		size_t seq_next = atomic_load_zu(
+		    &prof_recent_seq_next, ATOMIC_RELAXED);
+		for (size_t i = 0; i < ring->nslots; i++) {
+			prof_recent_t *slot = &ring->slots[i];
+			prof_tctx_t   *alloc_tctx = NULL;
+			prof_tctx_t   *dalloc_tctx = NULL;
+			prof_recent_slot_lock(slot);
+			if (slot->seq != 0
+			    && slot->seq + (size_t)max < seq_next) {
+				prof_recent_slot_evict(
+				    slot, &alloc_tctx, &dalloc_tctx);
+			}
+			prof_recent_slot_unlock(slot);
+			prof_recent_tctx_release(tsd, alloc_tctx, dalloc_tctx);
+		}
+		/* Records moved to a bigger ring meanwhile may have escaped. */
+	} while (prof_recent_ring_get() != ring);
 }
 
 ssize_t
@@ -462,69 +520,183 @@ prof_recent_alloc_max_ctl_write(tsd_t *tsd, ssize_t max) {
 	cassert(config_prof);
 	assert(max >= -1);
 	malloc_mutex_lock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	prof_recent_alloc_assert_count(tsd);
-	const ssize_t      old_max = prof_recent_alloc_max_update(tsd, max);
-	prof_recent_list_t to_delete;
-	prof_recent_alloc_restore_locked(tsd, &to_delete);
+	const ssize_t old_max = prof_recent_alloc_max_get();
+	atomic_store_zd(&prof_recent_alloc_max, max, ATOMIC_RELAXED);
 	malloc_mutex_unlock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	prof_recent_alloc_async_cleanup(tsd, &to_delete);
+	prof_recent_alloc_trim(tsd);
 	return old_max;
 }
 
+size_t
+prof_recent_alloc_records_test(prof_recent_t **records, size_t nrecords_max) {
+	cassert(config_prof);
+	prof_recent_ring_t *ring = prof_recent_ring_get();
+	if (ring == NULL) {
+		return 0;
+	}
+	size_t seq_next = atomic_load_zu(&prof_recent_seq_next, ATOMIC_RELAXED);
+	size_t n = 0;
+	for (size_t seq = prof_recent_window_start(
+	         ring, prof_recent_alloc_max_get(), seq_next);
+	    seq < seq_next && n < nrecords_max; seq++) {
+		prof_recent_t *slot = prof_recent_ring_slot(ring, seq);
+		if (slot->seq == seq) {
+			records[n++] = slot;
+		}
+	}
+	return n;
+}
+
+/*
+ * What the dump needs of a record, copied while holding the slot lock: once
+ * it's released, the record may be evicted and its tctxs destroyed.
+ */
+typedef struct prof_recent_dump_tctx_s prof_recent_dump_tctx_t;
+struct prof_recent_dump_tctx_s {
+	uint64_t thr_uid;
+	char     thread_name[PROF_THREAD_NAME_MAX_LEN];
+	/* Room for opt_prof_bt_max frames. */
+	void   **bt_vec;
+	unsigned bt_len;
+	size_t   lifetimes[PROF_LIFETIME_NBUCKETS];
+};
+
+typedef struct prof_recent_dump_record_s prof_recent_dump_record_t;
+struct prof_recent_dump_record_s {
+	size_t                  size;
+	size_t                  usize;
+	bool                    released;
+	bool                    has_dalloc;
+	nstime_t                alloc_time;
+	nstime_t                dalloc_time;
+	prof_recent_dump_tctx_t alloc;
+	prof_recent_dump_tctx_t dalloc;
+};
+
+static void
+prof_recent_dump_tctx_copy(prof_recent_dump_tctx_t *dst, prof_tctx_t *tctx) {
+	dst->thr_uid = tctx->thr_uid;
+	prof_tdata_t *tdata = tctx->tdata;
+	assert(tdata != NULL);
+	memcpy(dst->thread_name, tdata->thread_name, PROF_THREAD_NAME_MAX_LEN);
+	dst->thread_name[PROF_THREAD_NAME_MAX_LEN - 1] = '\0';
+	prof_bt_t *bt = &tctx->gctx->bt;
+	assert(bt->len <= opt_prof_bt_max);
+	memcpy(dst->bt_vec, bt->vec, bt->len * sizeof(void *));
+	dst->bt_len = bt->len;
+	for (unsigned i = 0; i < PROF_LIFETIME_NBUCKETS; i++) {
+		dst->lifetimes[i] = atomic_load_zu(
+		    &tctx->gctx->lifetimes[i], ATOMIC_RELAXED);
+	}
+}
+
+/*
+ * Returns false if the record seq is gone.  The ring may grow meanwhile, in
+ * which case *ring is updated to where the record went.
+ */
+static bool
+prof_recent_dump_record_copy(tsd_t *tsd, prof_recent_dump_record_t *dst,
+    prof_recent_ring_t **ring, size_t seq) {
+	prof_recent_t *slot;
+	while (true) {
+		slot = prof_recent_ring_slot(*ring, seq);
+		prof_recent_slot_lock(slot);
+		if (slot->seq == seq) {
+			break;
+		}
+		bool retired = atomic_load_b(&(*ring)->retired, ATOMIC_RELAXED);
+		prof_recent_slot_unlock(slot);
+		if (!retired) {
+			return false;
+		}
+		*ring = prof_recent_ring_successor(tsd, *ring);
+	}
+	dst->size = slot->size;
+	dst->usize = slot->usize;
+	dst->released = prof_recent_alloc_edata_get_no_lock(slot) == NULL;
+	nstime_copy(&dst->alloc_time, &slot->alloc_time);
+	nstime_copy(&dst->dalloc_time, &slot->dalloc_time);
+	assert(slot->alloc_tctx != NULL);
+	prof_recent_dump_tctx_copy(&dst->alloc, slot->alloc_tctx);
+	dst->has_dalloc = slot->dalloc_tctx != NULL;
+	if (dst->has_dalloc) {
+		prof_recent_dump_tctx_copy(&dst->dalloc, slot->dalloc_tctx);
+	}
+	prof_recent_slot_unlock(slot);
+	return true;
+}
+
 static void
-prof_recent_alloc_dump_bt(emitter_t *emitter, prof_tctx_t *tctx) {
+prof_recent_alloc_dump_bt(
+    emitter_t *emitter, const prof_recent_dump_tctx_t *tctx) {
 	char  bt_buf[2 * sizeof(intptr_t) + 3];
 	char *s = bt_buf;
-	assert(tctx != NULL);
-	prof_bt_t *bt = &tctx->gctx->bt;
-	for (size_t i = 0; i < bt->len; ++i) {
-		malloc_snprintf(bt_buf, sizeof(bt_buf), "%p", bt->vec[i]);
+	for (unsigned i = 0; i < tctx->bt_len; ++i) {
+		malloc_snprintf(bt_buf, sizeof(bt_buf), "%p", tctx->bt_vec[i]);
 		emitter_json_value(emitter, emitter_type_string, &s);
 	}
 }
 
 static void
-prof_recent_alloc_dump_node(emitter_t *emitter, prof_recent_t *node) {
+prof_recent_alloc_dump_lifetimes(
+    emitter_t *emitter, const prof_recent_dump_tctx_t *tctx) {
+	emitter_json_array_kv_begin(emitter, "alloc_lifetimes");
+	for (unsigned i = 0; i < PROF_LIFETIME_NBUCKETS; i++) {
+		emitter_json_value(
+		    emitter, emitter_type_size, &tctx->lifetimes[i]);
+	}
+	emitter_json_array_end(emitter);
+}
+
+static void
+prof_recent_alloc_dump_record(
+    emitter_t *emitter, const prof_recent_dump_record_t *record) {
 	emitter_json_object_begin(emitter);
 
-	emitter_json_kv(emitter, "size", emitter_type_size, &node->size);
-	emitter_json_kv(emitter, "usize", emitter_type_size, &node->usize);
-	bool released = prof_recent_alloc_edata_get_no_lock(node) == NULL;
-	emitter_json_kv(emitter, "released", emitter_type_bool, &released);
+	emitter_json_kv(emitter, "size", emitter_type_size, &record->size);
+	emitter_json_kv(emitter, "usize", emitter_type_size, &record->usize);
+	emitter_json_kv(
+	    emitter, "released", emitter_type_bool, &record->released);
 
 	emitter_json_kv(emitter, "alloc_thread_uid", emitter_type_uint64,
-	    &node->alloc_tctx->thr_uid);
-	prof_tdata_t *alloc_tdata = node->alloc_tctx->tdata;
-	assert(alloc_tdata != NULL);
-	if (!prof_thread_name_empty(alloc_tdata)) {
-		const char *thread_name = alloc_tdata->thread_name;
+	    &record->alloc.thr_uid);
+	if (record->alloc.thread_name[0] != '\0') {
+		const char *thread_name = record->alloc.thread_name;
 		emitter_json_kv(emitter, "alloc_thread_name",
 		    emitter_type_string, &thread_name);
 	}
-	uint64_t alloc_time_ns = nstime_ns(&node->alloc_time);
+	uint64_t alloc_time_ns = nstime_ns(&record->alloc_time);
 	emitter_json_kv(
 	    emitter, "alloc_time", emitter_type_uint64, &alloc_time_ns);
 	emitter_json_array_kv_begin(emitter, "alloc_trace");
-	prof_recent_alloc_dump_bt(emitter, node->alloc_tctx);
+	prof_recent_alloc_dump_bt(emitter, &record->alloc);
 	emitter_json_array_end(emitter);
+	if (opt_prof_lifetime) {
+		prof_recent_alloc_dump_lifetimes(emitter, &record->alloc);
+	}
 
-	if (released && node->dalloc_tctx != NULL) {
+	if (record->released && record->has_dalloc) {
 		emitter_json_kv(emitter, "dalloc_thread_uid",
-		    emitter_type_uint64, &node->dalloc_tctx->thr_uid);
-		prof_tdata_t *dalloc_tdata = node->dalloc_tctx->tdata;
-		assert(dalloc_tdata != NULL);
-		if (!prof_thread_name_empty(dalloc_tdata)) {
-			const char *thread_name = dalloc_tdata->thread_name;
+		    emitter_type_uint64, &record->dalloc.thr_uid);
+		if (record->dalloc.thread_name[0] != '\0') {
+			const char *thread_name = record->dalloc.thread_name;
 			emitter_json_kv(emitter, "dalloc_thread_name",
 			    emitter_type_string, &thread_name);
 		}
-		assert(!nstime_equals_zero(&node->dalloc_time));
-		uint64_t dalloc_time_ns = nstime_ns(&node->dalloc_time);
+		assert(!nstime_equals_zero(&record->dalloc_time));
+		uint64_t dalloc_time_ns = nstime_ns(&record->dalloc_time);
 		emitter_json_kv(emitter, "dalloc_time", emitter_type_uint64,
 		    &dalloc_time_ns);
 		emitter_json_array_kv_begin(emitter, "dalloc_trace");
-		prof_recent_alloc_dump_bt(emitter, node->dalloc_tctx);
+		prof_recent_alloc_dump_bt(emitter, &record->dalloc);
 		emitter_json_array_end(emitter);
+		if (opt_prof_lifetime) {
+			uint64_t lifetime_ns = dalloc_time_ns > alloc_time_ns
+			    ? dalloc_time_ns - alloc_time_ns
+			    : 0;
+			emitter_json_kv(emitter, "lifetime",
+			    emitter_type_uint64, &lifetime_ns);
+		}
 	}
 
 	emitter_json_object_end(emitter);
@@ -542,43 +714,54 @@ prof_recent_alloc_dump(tsd_t *tsd, write_cb_t *write_cb, void *cbopaque) {
 	emitter_t emitter;
 	emitter_init(
 	    &emitter, emitter_output_json_compact, buf_writer_cb, &buf_writer);
-	prof_recent_list_t temp_list;
+	/* On OOM, the dump shows no records. */
+	size_t record_size = sizeof(prof_recent_dump_record_t)
+	    + 2 * opt_prof_bt_max * sizeof(void *);
+	prof_recent_dump_record_t *record = (prof_recent_dump_record_t *)
+	    iallocztm(tsd_tsdn(tsd), record_size, sz_size2index(record_size),
+	        false, NULL, true, arena_get(tsd_tsdn(tsd), 0, false), true);
 
-	malloc_mutex_lock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	prof_recent_alloc_assert_count(tsd);
-	ssize_t dump_max = prof_recent_alloc_max_get(tsd);
-	ql_move(&temp_list, &prof_recent_alloc_list);
-	ssize_t dump_count = prof_recent_alloc_count;
-	prof_recent_alloc_count = 0;
-	prof_recent_alloc_assert_count(tsd);
-	malloc_mutex_unlock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
+	ssize_t dump_max = prof_recent_alloc_max_get();
 
 	emitter_begin(&emitter);
-	uint64_t sample_interval = (uint64_t)1U << lg_prof_sample;
+	uint64_t sample_interval = (uint64_t)1U << prof_lg_sample_effective();
 	emitter_json_kv(
 	    &emitter, "sample_interval", emitter_type_uint64, &sample_interval);
 	emitter_json_kv(
 	    &emitter, "recent_alloc_max", emitter_type_ssize, &dump_max);
 	emitter_json_array_kv_begin(&emitter, "recent_alloc");
-	prof_recent_t *node;
-	ql_foreach (node, &temp_list, link) {
-		prof_recent_alloc_dump_node(&emitter, node);
+	/*
+	 * No lock is held while emitting, so that write_cb may do as it
+	 * pleases: each record is copied under its slot lock, and rings are
+	 * never freed, so the walk just follows the records if they move to a
+	 * bigger ring.
+	 */
+	prof_recent_ring_t *ring = prof_recent_ring_get();
+	if (ring != NULL && record != NULL) {
+		void **bt_bufs = (void **)(record + 1);
+		record->alloc.bt_vec = bt_bufs;
+		record->dalloc.bt_vec = bt_bufs + opt_prof_bt_max;
+		/* Records made during the dump aren't shown. */
+		size_t seq_next = atomic_load_zu(
+		    &prof_recent_seq_next, ATOMIC_RELAXED);
+		for (size_t seq = prof_recent_window_start(
+		         ring, dump_max, seq_next);
+		    seq < seq_next; seq++) {
+			if (prof_recent_dump_record_copy(
+			        tsd, record, &ring, seq)) {
+				prof_recent_alloc_dump_record(
+				    &emitter, record);
+			}
+		}
 	}
 	emitter_json_array_end(&emitter);
 	emitter_end(&emitter);
 
-	malloc_mutex_lock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-	prof_recent_alloc_assert_count(tsd);
-	ql_concat(&temp_list, &prof_recent_alloc_list, link);
-	ql_move(&prof_recent_alloc_list, &temp_list);
-	prof_recent_alloc_count += dump_count;
-	prof_recent_alloc_restore_locked(tsd, &temp_list);
-	malloc_mutex_unlock(tsd_tsdn(tsd), &prof_recent_alloc_mtx);
-
 	buf_writer_terminate(tsd_tsdn(tsd), &buf_writer);
+	if (record != NULL) {
+		idalloctm(tsd_tsdn(tsd), record, NULL, NULL, true, true);
+	}
 	malloc_mutex_unlock(tsd_tsdn(tsd), &prof_recent_dump_mtx);
-
-	prof_recent_alloc_async_cleanup(tsd, &temp_list);
 }
 #undef PROF_RECENT_PRINT_BUFSIZE
 
@@ -586,6 +769,8 @@ bool
 prof_recent_init(void) {
 	cassert(config_prof);
 	prof_recent_alloc_max_init();
+	atomic_store_zu(&prof_recent_seq_next, 1, ATOMIC_RELAXED);
+	atomic_store_p(&prof_recent_ring, NULL, ATOMIC_RELAXED);
 
 	if (malloc_mutex_init(&prof_recent_alloc_mtx, "prof_recent_alloc",
 	        WITNESS_RANK_PROF_RECENT_ALLOC, malloc_mutex_rank_exclusive)) {
@@ -597,7 +782,43 @@ prof_recent_init(void) {
 		return true;
 	}
 
-	ql_new(&prof_recent_alloc_list);
-
 	return false;
 }
+
+/*
+ * Called with prof_recent_alloc_mtx held (so that the ring stays put) and
+ * every other lock a thread could hold while locking a slot, so the slots can
+ * be taken without risking a deadlock.
+ */
+void
+prof_recent_prefork(tsdn_t *tsdn) {
+	malloc_mutex_assert_owner(tsdn, &prof_recent_alloc_mtx);
+	prof_recent_ring_t *ring = prof_recent_ring_get();
+	if (ring == NULL) {
+		return;
+	}
+	for (size_t i = 0; i < ring->nslots; i++) {
+		prof_recent_slot_lock(&ring->slots[i]);
+	}
+}
+
+static void
+prof_recent_postfork(void) {
+	prof_recent_ring_t *ring = prof_recent_ring_get();
+	if (ring == NULL) {
+		return;
+	}
+	for (size_t i = 0; i < ring->nslots; i++) {
+		prof_recent_slot_unlock(&ring->slots[i]);
+	}
+}
+
+void
+prof_recent_postfork_parent(tsdn_t *tsdn) {
+	prof_recent_postfork();
+}
+
+void
+prof_recent_postfork_child(tsdn_t *tsdn) {
+	prof_recent_postfork();
+}
@@ -0,0 +1,258 @@
+#include "jemalloc/internal/jemalloc_preamble.h"
+#include "jemalloc/internal/jemalloc_internal_includes.h"
+
+#include "jemalloc/internal/assert.h"
+#include "jemalloc/internal/buf_writer.h"
+#include "jemalloc/internal/emitter.h"
+#include "jemalloc/internal/prof_data.h"
+#include "jemalloc/internal/prof_snapshot.h"
+
+#define LG_PROF_SNAPSHOT_NSLOTS_MIN 6
+#define PROF_SNAPSHOT_PRINT_BUFSIZE 65536
+
+typedef struct prof_snapshot_entry_s prof_snapshot_entry_t;
+struct prof_snapshot_entry_s {
+	/* prof_bt_hash() of the backtrace. */
+	size_t   hash[2];
+	uint64_t curobjs;
+	/* Never 0 for a slot in use. */
+	uint64_t curbytes;
+};
+
+typedef struct prof_snapshot_s prof_snapshot_t;
+struct prof_snapshot_s {
+	char name[PROF_SNAPSHOT_NAME_MAX];
+	/* Order of taking, for dropping the oldest; 0 if unused. */
+	uint64_t seq;
+	/* Open addressing hash table, at most half full. */
+	prof_snapshot_entry_t *slots;
+	unsigned               lg_nslots;
+	size_t                 nentries;
+};
+
+/* Protected by prof_dump_mtx, which taking and diffing snapshots need. */
+static prof_snapshot_t prof_snapshots[PROF_SNAPSHOT_MAX];
+static uint64_t        prof_snapshot_seq = 0;
+
+static prof_snapshot_entry_t *
+prof_snapshot_slots_alloc(tsdn_t *tsdn, unsigned lg_nslots) {
+	size_t size = sizeof(prof_snapshot_entry_t) << lg_nslots;
+	return (prof_snapshot_entry_t *)iallocztm(tsdn, size,
+	    sz_size2index(size), true, NULL, true,
+	    arena_get(TSDN_NULL, 0, true), true);
+}
+
+/* Returns the slot of hash, or the empty slot where it would go. */
+static prof_snapshot_entry_t *
+prof_snapshot_lookup(prof_snapshot_entry_t *slots, unsigned lg_nslots,
+    const size_t hash[2]) {
+	size_t mask = ((size_t)1 << lg_nslots) - 1;
+	for (size_t i = hash[0] & mask;; i = (i + 1) & mask) {
+		prof_snapshot_entry_t *slot = &slots[i];
+		if (slot->curbytes == 0
+		    || (slot->hash[0] == hash[0] && slot->hash[1] == hash[1])) {
+			return slot;
+		}
+	}
+}
+
+typedef struct prof_snapshot_take_arg_s prof_snapshot_take_arg_t;
+struct prof_snapshot_take_arg_s {
+	prof_snapshot_t *snapshot;
+	bool             oom;
+};
+
+static void
+prof_snapshot_take_cb(tsd_t *tsd, void *opaque, const prof_bt_t *bt,
+    uint64_t curobjs, uint64_t curbytes) {
+	prof_snapshot_take_arg_t *arg = (prof_snapshot_take_arg_t *)opaque;
+	prof_snapshot_t          *snapshot = arg->snapshot;
+	if (arg->oom || curbytes == 0) {
+		return;
+	}
+
+	if ((snapshot->nentries + 1) * 2 > ((size_t)1 << snapshot->lg_nslots)) {
+		unsigned               lg_nslots = snapshot->lg_nslots + 1;
+		prof_snapshot_entry_t *slots = prof_snapshot_slots_alloc(
+		    tsd_tsdn(tsd), lg_nslots);
+		if (slots == NULL) {
+			arg->oom = true;
+			return;
+		}
+		for (size_t i = 0; i < ((size_t)1 << snapshot->lg_nslots);
+		     i++) {
+			prof_snapshot_entry_t *old = &snapshot->slots[i];
+			if (old->curbytes != 0) {
+				*prof_snapshot_lookup(slots, lg_nslots,
+				    old->hash) = *old;
+			}
+		}
+		idalloctm(tsd_tsdn(tsd), snapshot->slots, NULL, NULL, true,
+		    true);
+		snapshot->slots = slots;
+		snapshot->lg_nslots = lg_nslots;
+	}
+
+	size_t hash[2];
+	prof_bt_hash((const void *)bt, hash);
+	prof_snapshot_entry_t *slot = prof_snapshot_lookup(
+	    snapshot->slots, snapshot->lg_nslots, hash);
+	/* Distinct backtraces whose hashes collide are counted together. */
+	if (slot->curbytes == 0) {
+		slot->hash[0] = hash[0];
+		slot->hash[1] = hash[1];
+		snapshot->nentries++;
+	}
+	slot->curobjs += curobjs;
+	slot->curbytes += curbytes;
+}
+
+static prof_snapshot_t *
+prof_snapshot_find(const char *name) {
+	for (unsigned i = 0; i < PROF_SNAPSHOT_MAX; i++) {
+		if (prof_snapshots[i].seq != 0
+		    && strcmp(prof_snapshots[i].name, name) == 0) {
+			return &prof_snapshots[i];
+		}
+	}
+	return NULL;
+}
+
+/* The snapshot of the same name, else an unused one, else the oldest. */
+static prof_snapshot_t *
+prof_snapshot_choose(const char *name) {
+	prof_snapshot_t *snapshot = prof_snapshot_find(name);
+	if (snapshot != NULL) {
+		return snapshot;
+	}
+	snapshot = &prof_snapshots[0];
+	for (unsigned i = 1; i < PROF_SNAPSHOT_MAX; i++) {
+		if (prof_snapshots[i].seq < snapshot->seq) {
+			snapshot = &prof_snapshots[i];
+		}
+	}
+	return snapshot;
+}
+
+bool
+prof_snapshot_take(tsd_t *tsd, const char *name) {
+	cassert(config_prof);
+	assert(strlen(name) < PROF_SNAPSHOT_NAME_MAX);
+
+	prof_tdata_t *tdata = prof_tdata_get(tsd, true);
+	if (tdata == NULL) {
+		return true;
+	}
+
+	pre_reentrancy(tsd, NULL);
+	malloc_mutex_lock(tsd_tsdn(tsd), &prof_dump_mtx);
+	prof_snapshot_t snapshot = {{0}, 0, NULL, LG_PROF_SNAPSHOT_NSLOTS_MIN,
+	    0};
+	snapshot.slots = prof_snapshot_slots_alloc(
+	    tsd_tsdn(tsd), snapshot.lg_nslots);
+	prof_snapshot_take_arg_t arg = {&snapshot, snapshot.slots == NULL};
+	if (!arg.oom) {
+		prof_dump_lg_sample = prof_lg_sample_effective();
+		prof_gctx_cnts_iter(tsd, tdata, prof_snapshot_take_cb, &arg);
+	}
+	if (arg.oom) {
+		if (snapshot.slots != NULL) {
+			idalloctm(tsd_tsdn(tsd), snapshot.slots, NULL, NULL,
+			    true, true);
+		}
+	} else {
+		prof_snapshot_t *old = prof_snapshot_choose(name);
+		if (old->slots != NULL) {
+			idalloctm(tsd_tsdn(tsd), old->slots, NULL, NULL, true,
+			    true);
+		}
+		strcpy(snapshot.name, name);
+		snapshot.seq = ++prof_snapshot_seq;
+		*old = snapshot;
+	}
+	malloc_mutex_unlock(tsd_tsdn(tsd), &prof_dump_mtx);
+	post_reentrancy(tsd);
+
+	return arg.oom;
+}
+
+typedef struct prof_snapshot_diff_arg_s prof_snapshot_diff_arg_t;
+struct prof_snapshot_diff_arg_s {
+	emitter_t             *emitter;
+	const prof_snapshot_t *snapshot;
+	size_t                 threshold;
+};
+
+static void
+prof_snapshot_diff_cb(tsd_t *tsd, void *opaque, const prof_bt_t *bt,
+    uint64_t curobjs, uint64_t curbytes) {
+	prof_snapshot_diff_arg_t *arg = (prof_snapshot_diff_arg_t *)opaque;
+
+	size_t hash[2];
+	prof_bt_hash((const void *)bt, hash);
+	const prof_snapshot_entry_t *base = prof_snapshot_lookup(
+	    arg->snapshot->slots, arg->snapshot->lg_nslots, hash);
+	if (curbytes <= base->curbytes
+	    || curbytes - base->curbytes <= arg->threshold) {
+		return;
+	}
+
+	emitter_t *emitter = arg->emitter;
+	emitter_json_object_begin(emitter);
+	emitter_json_array_kv_begin(emitter, "trace");
+	char  bt_buf[2 * sizeof(intptr_t) + 3];
+	char *s = bt_buf;
+	for (unsigned i = 0; i < bt->len; i++) {
+		malloc_snprintf(bt_buf, sizeof(bt_buf), "%p", bt->vec[i]);
+		emitter_json_value(emitter, emitter_type_string, &s);
+	}
+	emitter_json_array_end(emitter);
+	emitter_json_kv(emitter, "base_curobjs", emitter_type_uint64,
+	    &base->curobjs);
+	emitter_json_kv(emitter, "base_curbytes", emitter_type_uint64,
+	    &base->curbytes);
+	emitter_json_kv(emitter, "curobjs", emitter_type_uint64, &curobjs);
+	emitter_json_kv(emitter, "curbytes", emitter_type_uint64, &curbytes);
+	emitter_json_object_end(emitter);
+}
+
+bool
+prof_snapshot_diff(tsd_t *tsd, const char *name, size_t threshold,
+    write_cb_t *write_cb, void *cbopaque) {
+	cassert(config_prof);
+
+	prof_tdata_t *tdata = prof_tdata_get(tsd, true);
+	if (tdata == NULL) {
+		return true;
+	}
+
+	pre_reentrancy(tsd, NULL);
+	malloc_mutex_lock(tsd_tsdn(tsd), &prof_dump_mtx);
+	const prof_snapshot_t *snapshot = prof_snapshot_find(name);
+	if (snapshot == NULL) {
+		malloc_mutex_unlock(tsd_tsdn(tsd), &prof_dump_mtx);
+		post_reentrancy(tsd);
+		return true;
+	}
+
+	buf_writer_t buf_writer;
+	buf_writer_init(tsd_tsdn(tsd), &buf_writer, write_cb, cbopaque, NULL,
+	    PROF_SNAPSHOT_PRINT_BUFSIZE);
+	emitter_t emitter;
+	emitter_init(
+	    &emitter, emitter_output_json_compact, buf_writer_cb, &buf_writer);
+	emitter_begin(&emitter);
+	emitter_json_kv(&emitter, "snapshot", emitter_type_string, &name);
+	emitter_json_kv(&emitter, "threshold", emitter_type_size, &threshold);
+	emitter_json_array_kv_begin(&emitter, "grown");
+	prof_dump_lg_sample = prof_lg_sample_effective();
+	prof_snapshot_diff_arg_t arg = {&emitter, snapshot, threshold};
+	prof_gctx_cnts_iter(tsd, tdata, prof_snapshot_diff_cb, &arg);
+	emitter_json_array_end(&emitter);
+	emitter_end(&emitter);
+	buf_writer_terminate(tsd_tsdn(tsd), &buf_writer);
+
+	malloc_mutex_unlock(tsd_tsdn(tsd), &prof_dump_mtx);
+	post_reentrancy(tsd);
+	return false;
+}
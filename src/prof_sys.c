@@ -4,6 +4,7 @@
 #include "jemalloc/internal/buf_writer.h"
 #include "jemalloc/internal/ctl.h"
 #include "jemalloc/internal/malloc_io.h"
+#include "jemalloc/internal/prof_contention.h"
 #include "jemalloc/internal/prof_data.h"
 #include "jemalloc/internal/prof_sys.h"
 
@@ -37,6 +38,7 @@ static uint64_t prof_dump_seq;
 static uint64_t prof_dump_iseq;
 static uint64_t prof_dump_mseq;
 static uint64_t prof_dump_useq;
+static uint64_t prof_dump_cseq;
 
 static char *prof_prefix = NULL;
 
@@ -692,17 +694,21 @@ prof_dump_open(prof_dump_arg_t *arg, const char *filename) {
 prof_dump_write_file_t *JET_MUTABLE prof_dump_write_file = malloc_write_fd;
 
 static void
-prof_dump_flush(void *opaque, const char *s) {
+prof_dump_write_bytes(void *opaque, const void *s, size_t len) {
 	cassert(config_prof);
 	prof_dump_arg_t *arg = (prof_dump_arg_t *)opaque;
 	if (!arg->error) {
-		ssize_t err = prof_dump_write_file(
-		    arg->prof_dump_fd, s, strlen(s));
+		ssize_t err = prof_dump_write_file(arg->prof_dump_fd, s, len);
 		prof_dump_check_possible_error(arg, err == -1,
 		    "<jemalloc>: failed to write during heap profile flush\n");
 	}
 }
 
+static void
+prof_dump_flush(void *opaque, const char *s) {
+	prof_dump_write_bytes(opaque, s, strlen(s));
+}
+
 static void
 prof_dump_close(prof_dump_arg_t *arg) {
 	if (arg->prof_dump_fd != -1) {
@@ -847,14 +853,49 @@ prof_dump_maps(buf_writer_t *buf_writer) {
 }
 #endif /* __APPLE__ */
 
+static void
+prof_dump_pprof(
+    tsd_t *tsd, prof_dump_arg_t *arg, prof_tdata_t *tdata, bool leakcheck) {
+	prof_pprof_t pprof;
+	if (prof_pprof_init(tsd, &pprof, prof_dump_write_bytes, arg,
+	        prof_dump_buf, PROF_DUMP_BUFSIZE,
+	        (uint64_t)1 << prof_dump_lg_sample)) {
+		if (!arg->error) {
+			prof_dump_check_possible_error(arg, true,
+			    "<jemalloc>: out of memory during heap profile "
+			    "dump\n");
+		}
+		return;
+	}
+	prof_dump_pprof_impl(tsd, &pprof, tdata, leakcheck);
+
+	/* There's no memory map to read on MacOS. */
+	int mfd = (prof_dump_open_maps != NULL) ? prof_dump_open_maps() : -1;
+	bool oom = prof_pprof_finish(tsd, &pprof, mfd);
+	if (mfd != -1) {
+		close(mfd);
+	}
+	if (oom && !arg->error) {
+		prof_dump_check_possible_error(arg, true,
+		    "<jemalloc>: out of memory during heap profile dump, "
+		    "samples were left out\n");
+	}
+}
+
 static bool
 prof_dump(
     tsd_t *tsd, bool propagate_err, const char *filename, bool leakcheck) {
 	cassert(config_prof);
-	assert(tsd_reentrancy_level_get(tsd) == 0);
+	/*
+	 * Background threads dump on an internal tsd, which is never nominal,
+	 * and so is reentrant and has no tdata.  The dump does without: tdata
+	 * only serves to defer the dumps triggered from inside prof_enter().
+	 */
+	bool internal = !tsd_nominal(tsd);
+	assert(internal || tsd_reentrancy_level_get(tsd) == 0);
 
-	prof_tdata_t *tdata = prof_tdata_get(tsd, true);
-	if (tdata == NULL) {
+	prof_tdata_t *tdata = prof_tdata_get(tsd, !internal);
+	if (tdata == NULL && !internal) {
 		return true;
 	}
 
@@ -863,15 +904,21 @@ prof_dump(
 
 	pre_reentrancy(tsd, NULL);
 	malloc_mutex_lock(tsd_tsdn(tsd), &prof_dump_mtx);
+	prof_dump_lg_sample = prof_lg_sample_effective();
 
 	prof_dump_open(&arg, filename);
-	buf_writer_t buf_writer;
-	bool err = buf_writer_init(tsd_tsdn(tsd), &buf_writer, prof_dump_flush,
-	    &arg, prof_dump_buf, PROF_DUMP_BUFSIZE);
-	assert(!err);
-	prof_dump_impl(tsd, buf_writer_cb, &buf_writer, tdata, leakcheck);
-	prof_dump_maps(&buf_writer);
-	buf_writer_terminate(tsd_tsdn(tsd), &buf_writer);
+	if (opt_prof_pprof) {
+		prof_dump_pprof(tsd, &arg, tdata, leakcheck);
+	} else {
+		buf_writer_t buf_writer;
+		bool err = buf_writer_init(tsd_tsdn(tsd), &buf_writer,
+		    prof_dump_flush, &arg, prof_dump_buf, PROF_DUMP_BUFSIZE);
+		assert(!err);
+		prof_dump_impl(
+		    tsd, buf_writer_cb, &buf_writer, tdata, leakcheck);
+		prof_dump_maps(&buf_writer);
+		buf_writer_terminate(tsd_tsdn(tsd), &buf_writer);
+	}
 	prof_dump_close(&arg);
 
 	prof_dump_hook_t dump_hook = prof_dump_hook_get();
@@ -915,55 +962,61 @@ prof_prefix_is_empty(tsdn_t *tsdn) {
 }
 
 #define DUMP_FILENAME_BUFSIZE (PATH_MAX + 1)
+#define HEAP_DUMP_EXT (opt_prof_pprof ? "pb" : "heap")
 #define VSEQ_INVALID UINT64_C(0xffffffffffffffff)
 static void
-prof_dump_filename(tsd_t *tsd, char *filename, char v, uint64_t vseq) {
+prof_dump_filename(tsd_t *tsd, char *filename, char v, uint64_t vseq,
+    const char *ext) {
 	cassert(config_prof);
 
-	assert(tsd_reentrancy_level_get(tsd) == 0);
+	/* Background threads' internal tsd is reentrant; see prof_dump(). */
+	assert(tsd_reentrancy_level_get(tsd) == 0 || !tsd_nominal(tsd));
 	const char *prefix = prof_prefix_get(tsd_tsdn(tsd));
 
 	if (vseq != VSEQ_INVALID) {
 		if (opt_prof_pid_namespace) {
-			/* "<prefix>.<pid_namespace>.<pid>.<seq>.v<vseq>.heap" */
+			/*
+			 * "<prefix>.<pid_namespace>.<pid>.<seq>.v<vseq>.<ext>"
+			 */
 			malloc_snprintf(filename, DUMP_FILENAME_BUFSIZE,
-			    "%s.%ld.%d.%" FMTu64 ".%c%" FMTu64 ".heap", prefix,
+			    "%s.%ld.%d.%" FMTu64 ".%c%" FMTu64 ".%s", prefix,
 			    prof_get_pid_namespace(), prof_getpid(),
-			    prof_dump_seq, v, vseq);
+			    prof_dump_seq, v, vseq, ext);
 		} else {
-			/* "<prefix>.<pid>.<seq>.v<vseq>.heap" */
+			/* "<prefix>.<pid>.<seq>.v<vseq>.<ext>" */
 			malloc_snprintf(filename, DUMP_FILENAME_BUFSIZE,
-			    "%s.%d.%" FMTu64 ".%c%" FMTu64 ".heap", prefix,
-			    prof_getpid(), prof_dump_seq, v, vseq);
+			    "%s.%d.%" FMTu64 ".%c%" FMTu64 ".%s", prefix,
+			    prof_getpid(), prof_dump_seq, v, vseq, ext);
 		}
 	} else {
 		if (opt_prof_pid_namespace) {
-			/* "<prefix>.<pid_namespace>.<pid>.<seq>.<v>.heap" */
+			/* "<prefix>.<pid_namespace>.<pid>.<seq>.<v>.<ext>" */
 			malloc_snprintf(filename, DUMP_FILENAME_BUFSIZE,
-			    "%s.%ld.%d.%" FMTu64 ".%c.heap", prefix,
+			    "%s.%ld.%d.%" FMTu64 ".%c.%s", prefix,
 			    prof_get_pid_namespace(), prof_getpid(),
-			    prof_dump_seq, v);
+			    prof_dump_seq, v, ext);
 		} else {
-			/* "<prefix>.<pid>.<seq>.<v>.heap" */
+			/* "<prefix>.<pid>.<seq>.<v>.<ext>" */
 			malloc_snprintf(filename, DUMP_FILENAME_BUFSIZE,
-			    "%s.%d.%" FMTu64 ".%c.heap", prefix, prof_getpid(),
-			    prof_dump_seq, v);
+			    "%s.%d.%" FMTu64 ".%c.%s", prefix, prof_getpid(),
+			    prof_dump_seq, v, ext);
 		}
 	}
 	prof_dump_seq++;
 }
 
 void
-prof_get_default_filename(tsdn_t *tsdn, char *filename, uint64_t ind) {
+prof_get_default_filename(tsdn_t *tsdn, char *filename, uint64_t ind,
+    const char *ext) {
 	malloc_mutex_lock(tsdn, &prof_dump_filename_mtx);
 	if (opt_prof_pid_namespace) {
 		malloc_snprintf(filename, PROF_DUMP_FILENAME_LEN,
-		    "%s.%ld.%d.%" FMTu64 ".json", prof_prefix_get(tsdn),
-		    prof_get_pid_namespace(), prof_getpid(), ind);
+		    "%s.%ld.%d.%" FMTu64 ".%s", prof_prefix_get(tsdn),
+		    prof_get_pid_namespace(), prof_getpid(), ind, ext);
 	} else {
 		malloc_snprintf(filename, PROF_DUMP_FILENAME_LEN,
-		    "%s.%d.%" FMTu64 ".json", prof_prefix_get(tsdn),
-		    prof_getpid(), ind);
+		    "%s.%d.%" FMTu64 ".%s", prof_prefix_get(tsdn),
+		    prof_getpid(), ind, ext);
 	}
 	malloc_mutex_unlock(tsdn, &prof_dump_filename_mtx);
 }
@@ -974,7 +1027,7 @@ prof_fdump_impl(tsd_t *tsd) {
 
 	assert(!prof_prefix_is_empty(tsd_tsdn(tsd)));
 	malloc_mutex_lock(tsd_tsdn(tsd), &prof_dump_filename_mtx);
-	prof_dump_filename(tsd, filename, 'f', VSEQ_INVALID);
+	prof_dump_filename(tsd, filename, 'f', VSEQ_INVALID, HEAP_DUMP_EXT);
 	malloc_mutex_unlock(tsd_tsdn(tsd), &prof_dump_filename_mtx);
 	prof_dump(tsd, false, filename, opt_prof_leak);
 }
@@ -1015,7 +1068,7 @@ prof_idump_impl(tsd_t *tsd) {
 		return;
 	}
 	char filename[PATH_MAX + 1];
-	prof_dump_filename(tsd, filename, 'i', prof_dump_iseq);
+	prof_dump_filename(tsd, filename, 'i', prof_dump_iseq, HEAP_DUMP_EXT);
 	prof_dump_iseq++;
 	malloc_mutex_unlock(tsd_tsdn(tsd), &prof_dump_filename_mtx);
 	prof_dump(tsd, false, filename, false);
@@ -1032,7 +1085,8 @@ prof_mdump_impl(tsd_t *tsd, const char *filename) {
 			    tsd_tsdn(tsd), &prof_dump_filename_mtx);
 			return true;
 		}
-		prof_dump_filename(tsd, filename_buf, 'm', prof_dump_mseq);
+		prof_dump_filename(
+		    tsd, filename_buf, 'm', prof_dump_mseq, HEAP_DUMP_EXT);
 		prof_dump_mseq++;
 		malloc_mutex_unlock(tsd_tsdn(tsd), &prof_dump_filename_mtx);
 		filename = filename_buf;
@@ -1040,6 +1094,46 @@ prof_mdump_impl(tsd_t *tsd, const char *filename) {
 	return prof_dump(tsd, true, filename, false);
 }
 
+bool
+prof_contention_dump_impl(tsd_t *tsd, const char *filename) {
+	cassert(config_prof);
+	char filename_buf[DUMP_FILENAME_BUFSIZE];
+	if (filename == NULL) {
+		malloc_mutex_lock(tsd_tsdn(tsd), &prof_dump_filename_mtx);
+		if (prof_prefix_get(tsd_tsdn(tsd))[0] == '\0') {
+			malloc_mutex_unlock(
+			    tsd_tsdn(tsd), &prof_dump_filename_mtx);
+			return true;
+		}
+		prof_dump_filename(
+		    tsd, filename_buf, 'c', prof_dump_cseq, "contention");
+		prof_dump_cseq++;
+		malloc_mutex_unlock(tsd_tsdn(tsd), &prof_dump_filename_mtx);
+		filename = filename_buf;
+	}
+
+	prof_dump_arg_t arg = {/* handle_error_locally */ false,
+	    /* error */ false, /* prof_dump_fd */ -1};
+
+	pre_reentrancy(tsd, NULL);
+	malloc_mutex_lock(tsd_tsdn(tsd), &prof_dump_mtx);
+
+	prof_dump_open(&arg, filename);
+	buf_writer_t buf_writer;
+	bool err = buf_writer_init(tsd_tsdn(tsd), &buf_writer, prof_dump_flush,
+	    &arg, prof_dump_buf, PROF_DUMP_BUFSIZE);
+	assert(!err);
+	prof_contention_write(buf_writer_cb, &buf_writer);
+	prof_dump_maps(&buf_writer);
+	buf_writer_terminate(tsd_tsdn(tsd), &buf_writer);
+	prof_dump_close(&arg);
+
+	malloc_mutex_unlock(tsd_tsdn(tsd), &prof_dump_mtx);
+	post_reentrancy(tsd);
+
+	return arg.error;
+}
+
 void
 prof_gdump_impl(tsd_t *tsd) {
 	tsdn_t *tsdn = tsd_tsdn(tsd);
@@ -1049,7 +1143,7 @@ prof_gdump_impl(tsd_t *tsd) {
 		return;
 	}
 	char filename[DUMP_FILENAME_BUFSIZE];
-	prof_dump_filename(tsd, filename, 'u', prof_dump_useq);
+	prof_dump_filename(tsd, filename, 'u', prof_dump_useq, HEAP_DUMP_EXT);
 	prof_dump_useq++;
 	malloc_mutex_unlock(tsdn, &prof_dump_filename_mtx);
 	prof_dump(tsd, false, filename, false);
@@ -444,6 +444,34 @@ psset_insert(psset_t *psset, hpdata_t *ps) {
 	}
 }
 
+static size_t
+psset_resident_range(
+    hpdata_t *ps, pages_range_t *ranges, size_t nranges, size_t n) {
+	if (n < nranges) {
+		ranges[n].addr = hpdata_addr_get(ps);
+		ranges[n].size = HUGEPAGE;
+		ranges[n].huge = hpdata_huge_get(ps);
+	}
+	return n + 1;
+}
+
+size_t
+psset_resident_ranges(psset_t *psset, pages_range_t *ranges, size_t nranges) {
+	size_t n = 0;
+	for (pszind_t i = 0; i < PSSET_NPSIZES; i++) {
+		hpdata_age_heap_t *heap = &psset->pageslabs[i];
+		for (hpdata_t *ps = hpdata_age_heap_walk_next(heap, NULL);
+		     ps != NULL; ps = hpdata_age_heap_walk_next(heap, ps)) {
+			n = psset_resident_range(ps, ranges, nranges, n);
+		}
+	}
+	for (hpdata_t *ps = hpdata_empty_list_first(&psset->empty); ps != NULL;
+	     ps = hpdata_empty_list_next(&psset->empty, ps)) {
+		n = psset_resident_range(ps, ranges, nranges, n);
+	}
+	return n;
+}
+
 void
 psset_remove(psset_t *psset, hpdata_t *ps) {
 	hpdata_in_psset_set(ps, false);
@@ -270,6 +270,24 @@ mutex_stats_emit(emitter_t *emitter, emitter_row_t *row,
 #undef EMITTER_TYPE_uint64_t
 }
 
+/*
+ * Emits the wait time histogram of the mutex that mib[0..miblen) names.  JSON
+ * only; the tables are wide enough already.
+ */
+static void
+mutex_stats_emit_wait_hist(emitter_t *emitter, size_t mib[], size_t miblen) {
+	CTL_LEAF_PREPARE(mib, miblen, "wait_hist");
+	emitter_json_array_kv_begin(emitter, "wait_hist");
+	for (unsigned j = 0; j < MUTEX_PROF_WAIT_NBUCKETS; j++) {
+		mib[miblen + 1] = j;
+		uint64_t count;
+		size_t   sz = sizeof(count);
+		xmallctlbymib(mib, miblen + 2, &count, &sz, NULL, 0);
+		emitter_json_value(emitter, emitter_type_uint64, &count);
+	}
+	emitter_json_array_end(emitter);
+}
+
 #define COL_DECLARE(column_name) emitter_col_t col_##column_name;
 
 #define COL_INIT(row_name, column_name, left_or_right, col_width, etype)       \
@@ -788,6 +806,148 @@ stats_arena_extents_print(emitter_t *emitter, unsigned i) {
 	}
 }
 
+static void
+stats_arena_lec_print(emitter_t *emitter, unsigned i) {
+	uint64_t lec_hits, lec_misses, lec_evictions;
+
+	emitter_json_object_kv_begin(emitter, "lec");
+	CTL_M2_GET("stats.arenas.0.lec_hits", i, &lec_hits, uint64_t);
+	emitter_kv(emitter, "hits", "Total hits in large extent cache",
+	    emitter_type_uint64, &lec_hits);
+	CTL_M2_GET("stats.arenas.0.lec_misses", i, &lec_misses, uint64_t);
+	emitter_kv(emitter, "misses", "Total misses in large extent cache",
+	    emitter_type_uint64, &lec_misses);
+	CTL_M2_GET("stats.arenas.0.lec_evictions", i, &lec_evictions, uint64_t);
+	emitter_kv(emitter, "evictions",
+	    "Total evictions from large extent cache", emitter_type_uint64,
+	    &lec_evictions);
+	emitter_json_object_end(emitter); /* Close "lec". */
+}
+
+/* Printed once the arena has been through an arena.<i>.resident_scan. */
+static void
+stats_arena_resident_scan_print(emitter_t *emitter, unsigned i) {
+	size_t active_manual, dirty, muzzy, retained, hpa_nonfull,
+	    hpa_nonfull_huge;
+
+	CTL_M2_GET("stats.arenas.0.resident_scan.active_manual", i,
+	    &active_manual, size_t);
+	CTL_M2_GET("stats.arenas.0.resident_scan.dirty", i, &dirty, size_t);
+	CTL_M2_GET("stats.arenas.0.resident_scan.muzzy", i, &muzzy, size_t);
+	CTL_M2_GET(
+	    "stats.arenas.0.resident_scan.retained", i, &retained, size_t);
+	CTL_M2_GET("stats.arenas.0.resident_scan.hpa_nonfull", i, &hpa_nonfull,
+	    size_t);
+	CTL_M2_GET("stats.arenas.0.resident_scan.hpa_nonfull_huge", i,
+	    &hpa_nonfull_huge, size_t);
+	if (active_manual == 0 && dirty == 0 && muzzy == 0 && retained == 0
+	    && hpa_nonfull == 0) {
+		return;
+	}
+
+	emitter_json_object_kv_begin(emitter, "resident_scan");
+	emitter_kv(emitter, "active_manual",
+	    "Resident active bytes (scanned, manual arenas only)",
+	    emitter_type_size, &active_manual);
+	emitter_kv(emitter, "dirty", "Resident dirty bytes (scanned)",
+	    emitter_type_size, &dirty);
+	emitter_kv(emitter, "muzzy", "Resident muzzy bytes (scanned)",
+	    emitter_type_size, &muzzy);
+	emitter_kv(emitter, "retained", "Resident retained bytes (scanned)",
+	    emitter_type_size, &retained);
+	emitter_kv(emitter, "hpa_nonfull",
+	    "Resident non-full HPA pageslab bytes (scanned)", emitter_type_size,
+	    &hpa_nonfull);
+	emitter_kv(emitter, "hpa_nonfull_huge",
+	    "Resident non-full hugified HPA pageslab bytes (scanned)",
+	    emitter_type_size, &hpa_nonfull_huge);
+	emitter_json_object_end(emitter); /* Close "resident_scan". */
+}
+
+static void
+stats_arena_latency_print(emitter_t *emitter, unsigned i) {
+	unsigned nbuckets;
+	CTL_GET("arenas.nlatency_buckets", &nbuckets, unsigned);
+
+	emitter_row_t header_row;
+	emitter_row_init(&header_row);
+	emitter_row_t row;
+	emitter_row_init(&row);
+
+	COL_HDR(row, site, "latency:", left, 14, title)
+	COL_HDR(row, count, NULL, right, 13, uint64)
+	COL_HDR(row, mean_ns, NULL, right, 13, uint64)
+	COL_HDR(row, p50_ns, NULL, right, 13, uint64)
+	COL_HDR(row, p99_ns, NULL, right, 13, uint64)
+	COL_HDR(row, p999_ns, NULL, right, 13, uint64)
+
+	emitter_table_row(emitter, &header_row);
+	emitter_json_object_kv_begin(emitter, "latency");
+
+	size_t stats_arenas_mib[CTL_MAX_DEPTH];
+	CTL_LEAF_PREPARE(stats_arenas_mib, 0, "stats.arenas");
+	stats_arenas_mib[2] = i;
+	CTL_LEAF_PREPARE(stats_arenas_mib, 3, "latency");
+
+	size_t arenas_latency_bucket_mib[CTL_MAX_DEPTH];
+	CTL_LEAF_PREPARE(arenas_latency_bucket_mib, 0, "arenas.latency_bucket");
+
+	for (latency_site_t site = 0; site < latency_nsites; site++) {
+		const char *name = latency_site_names[site];
+		uint64_t    count, total_ns, p50_ns, p99_ns, p999_ns;
+
+		stats_arenas_mib[4] = site;
+		CTL_LEAF(stats_arenas_mib, 5, "count", &count, uint64_t);
+		CTL_LEAF(stats_arenas_mib, 5, "total_ns", &total_ns, uint64_t);
+		CTL_LEAF(stats_arenas_mib, 5, "p50_ns", &p50_ns, uint64_t);
+		CTL_LEAF(stats_arenas_mib, 5, "p99_ns", &p99_ns, uint64_t);
+		CTL_LEAF(stats_arenas_mib, 5, "p999_ns", &p999_ns, uint64_t);
+
+		emitter_json_object_kv_begin(emitter, name);
+		emitter_json_kv(emitter, "count", emitter_type_uint64, &count);
+		emitter_json_kv(
+		    emitter, "total_ns", emitter_type_uint64, &total_ns);
+		emitter_json_kv(emitter, "p50_ns", emitter_type_uint64, &p50_ns);
+		emitter_json_kv(emitter, "p99_ns", emitter_type_uint64, &p99_ns);
+		emitter_json_kv(
+		    emitter, "p999_ns", emitter_type_uint64, &p999_ns);
+
+		/* Only the non-empty buckets; most of them are. */
+		emitter_json_array_kv_begin(emitter, "buckets");
+		CTL_LEAF_PREPARE(stats_arenas_mib, 5, "buckets");
+		for (unsigned j = 0; j < nbuckets; j++) {
+			uint64_t bucket_count, lower_ns;
+			size_t sz = sizeof(uint64_t);
+			stats_arenas_mib[6] = j;
+			xmallctlbymib(stats_arenas_mib, 7, &bucket_count, &sz,
+			    NULL, 0);
+			if (bucket_count == 0) {
+				continue;
+			}
+			arenas_latency_bucket_mib[2] = j;
+			CTL_LEAF(arenas_latency_bucket_mib, 3, "lower_ns",
+			    &lower_ns, uint64_t);
+			emitter_json_object_begin(emitter);
+			emitter_json_kv(emitter, "lower_ns",
+			    emitter_type_uint64, &lower_ns);
+			emitter_json_kv(emitter, "count", emitter_type_uint64,
+			    &bucket_count);
+			emitter_json_object_end(emitter);
+		}
+		emitter_json_array_end(emitter); /* Close "buckets". */
+		emitter_json_object_end(emitter); /* Close the site. */
+
+		col_site.str_val = name;
+		col_count.uint64_val = count;
+		col_mean_ns.uint64_val = count == 0 ? 0 : total_ns / count;
+		col_p50_ns.uint64_val = p50_ns;
+		col_p99_ns.uint64_val = p99_ns;
+		col_p999_ns.uint64_val = p999_ns;
+		emitter_table_row(emitter, &row);
+	}
+	emitter_json_object_end(emitter); /* Close "latency". */
+}
+
 static void
 stats_arena_hpa_shard_sec_print(emitter_t *emitter, unsigned i) {
 	size_t sec_bytes;
@@ -1147,6 +1307,7 @@ stats_arena_mutexes_print(
 		mutex_stats_read_arena(
 		    stats_arenas_mib, 4, name, &col_name, col64, col32, uptime);
 		mutex_stats_emit(emitter, &row, col64, col32);
+		mutex_stats_emit_wait_hist(emitter, stats_arenas_mib, 5);
 		emitter_json_object_end(emitter); /* Close the mutex dict. */
 	}
 	emitter_json_object_end(emitter); /* End "mutexes". */
@@ -1172,7 +1333,7 @@ stats_arena_print(emitter_t *emitter, unsigned i, bool bins, bool large,
 	size_t   large_allocated;
 	uint64_t large_nmalloc, large_ndalloc, large_nrequests, large_nfills,
 	    large_nflushes;
-	size_t   tcache_bytes, tcache_stashed_bytes, abandoned_vm;
+	size_t   tcache_bytes, tcache_stashed_bytes, abandoned_vm, lec_bytes;
 	uint64_t uptime;
 
 	CTL_GET("arenas.page", &page, size_t);
@@ -1469,10 +1630,12 @@ stats_arena_print(emitter_t *emitter, unsigned i, bool bins, bool large,
 	GET_AND_EMIT_MEM_STAT(metadata_thp)
 	GET_AND_EMIT_MEM_STAT(tcache_bytes)
 	GET_AND_EMIT_MEM_STAT(tcache_stashed_bytes)
+	GET_AND_EMIT_MEM_STAT(lec_bytes)
 	GET_AND_EMIT_MEM_STAT(resident)
 	GET_AND_EMIT_MEM_STAT(abandoned_vm)
 	GET_AND_EMIT_MEM_STAT(extent_avail)
 #undef GET_AND_EMIT_MEM_STAT
+	stats_arena_resident_scan_print(emitter, i);
 
 	if (mutex) {
 		stats_arena_mutexes_print(emitter, i, uptime);
@@ -1482,6 +1645,7 @@ stats_arena_print(emitter_t *emitter, unsigned i, bool bins, bool large,
 	}
 	if (large) {
 		stats_arena_lextents_print(emitter, i, uptime);
+		stats_arena_lec_print(emitter, i);
 	}
 	if (extents) {
 		stats_arena_extents_print(emitter, i);
@@ -1489,6 +1653,9 @@ stats_arena_print(emitter_t *emitter, unsigned i, bool bins, bool large,
 	if (hpa) {
 		stats_arena_hpa_shard_print(emitter, i, uptime);
 	}
+	if (config_stats && opt_stats_latency_sample >= 0) {
+		stats_arena_latency_print(emitter, i);
+	}
 }
 
 JEMALLOC_COLD
@@ -1637,6 +1804,8 @@ stats_general_print(emitter_t *emitter) {
 	OPT_WRITE_UNSIGNED("narenas")
 	OPT_WRITE_CHAR_P("percpu_arena")
 	OPT_WRITE_SIZE_T("oversize_threshold")
+	OPT_WRITE_SIZE_T("lec_max_bytes")
+	OPT_WRITE_SIZE_T("lec_max_alloc")
 	OPT_WRITE_BOOL("hpa")
 	OPT_WRITE_SIZE_T("hpa_slab_max_alloc")
 	OPT_WRITE_SIZE_T("hpa_hugification_threshold")
@@ -1690,6 +1859,10 @@ stats_general_print(emitter_t *emitter) {
 	OPT_WRITE_SSIZE_T("lg_tcache_nslots_mul")
 	OPT_WRITE_SIZE_T("tcache_gc_incr_bytes")
 	OPT_WRITE_SIZE_T("tcache_gc_delay_bytes")
+	OPT_WRITE_SIZE_T("tcache_bytes_budget")
+	OPT_WRITE_SSIZE_T("tcache_idle_reclaim_ms")
+	OPT_WRITE_UNSIGNED("tcache_pool_max")
+	OPT_WRITE_BOOL("tcache_pool_keep_cached")
 	OPT_WRITE_UNSIGNED("lg_tcache_flush_small_div")
 	OPT_WRITE_UNSIGNED("lg_tcache_flush_large_div")
 	OPT_WRITE_UNSIGNED("debug_double_free_max_scan")
@@ -1701,18 +1874,27 @@ stats_general_print(emitter_t *emitter) {
 	OPT_WRITE_BOOL_MUTABLE(
 	    "prof_thread_active_init", "prof.thread_active_init")
 	OPT_WRITE_SSIZE_T_MUTABLE("lg_prof_sample", "prof.lg_sample")
+	OPT_WRITE_UNSIGNED("prof_overhead_ppm")
 	OPT_WRITE_BOOL("prof_accum")
+	OPT_WRITE_BOOL("prof_lifetime")
+	OPT_WRITE_BOOL("prof_callsite")
 	OPT_WRITE_SSIZE_T("lg_prof_interval")
 	OPT_WRITE_BOOL("prof_gdump")
+	OPT_WRITE_SSIZE_T("prof_bg_dump_ms")
 	OPT_WRITE_BOOL("prof_final")
 	OPT_WRITE_BOOL("prof_leak")
 	OPT_WRITE_BOOL("prof_leak_error")
+	OPT_WRITE_BOOL("prof_pprof")
+	OPT_WRITE_BOOL("prof_contention")
+	OPT_WRITE_SIZE_T("lg_prof_contention_sample")
 	OPT_WRITE_BOOL("stats_print")
 	OPT_WRITE_CHAR_P("stats_print_opts")
 	OPT_WRITE_BOOL("stats_print")
 	OPT_WRITE_CHAR_P("stats_print_opts")
 	OPT_WRITE_INT64("stats_interval")
 	OPT_WRITE_CHAR_P("stats_interval_opts")
+	OPT_WRITE_INT64("stats_latency_sample")
+	OPT_WRITE_BOOL("arena_stats_enabled")
 	OPT_WRITE_CHAR_P("zero_realloc")
 	OPT_WRITE_SIZE_T("process_madvise_max_batch")
 	OPT_WRITE_BOOL("disable_large_size_classes")
@@ -1858,6 +2040,94 @@ stats_general_print(emitter_t *emitter) {
 	emitter_json_object_end(emitter); /* Close "arenas" */
 }
 
+/* Lists the tags with any activity, once a non-zero tag has seen some. */
+JEMALLOC_COLD
+static void
+stats_tags_print(emitter_t *emitter) {
+	size_t mib[CTL_MAX_DEPTH];
+	CTL_LEAF_PREPARE(mib, 0, "stats.tags");
+
+	uint64_t allocated[ALLOC_TAG_NTAGS];
+	uint64_t deallocated[ALLOC_TAG_NTAGS];
+	int64_t  live[ALLOC_TAG_NTAGS];
+	bool     tagged = false;
+	for (unsigned i = 0; i < ALLOC_TAG_NTAGS; i++) {
+		mib[2] = i;
+		CTL_LEAF(mib, 3, "allocated", &allocated[i], uint64_t);
+		CTL_LEAF(mib, 3, "deallocated", &deallocated[i], uint64_t);
+		CTL_LEAF(mib, 3, "live", &live[i], int64_t);
+		if (i != 0 && (allocated[i] != 0 || deallocated[i] != 0)) {
+			tagged = true;
+		}
+	}
+	/* Everything is untagged unless the application uses thread.tag. */
+	if (!tagged) {
+		return;
+	}
+
+	emitter_json_array_kv_begin(emitter, "tags");
+	for (unsigned i = 0; i < ALLOC_TAG_NTAGS; i++) {
+		if (allocated[i] == 0 && deallocated[i] == 0) {
+			continue;
+		}
+
+		emitter_json_object_begin(emitter);
+		emitter_json_kv(emitter, "tag", emitter_type_unsigned, &i);
+		emitter_json_kv(
+		    emitter, "allocated", emitter_type_uint64, &allocated[i]);
+		emitter_json_kv(emitter, "deallocated", emitter_type_uint64,
+		    &deallocated[i]);
+		emitter_json_kv(emitter, "live", emitter_type_int64, &live[i]);
+		emitter_json_object_end(emitter);
+
+		emitter_table_printf(emitter,
+		    "Tag %u: allocated: %" FMTu64 ", deallocated: %" FMTu64
+		    ", live: %" FMTd64 "\n",
+		    i, allocated[i], deallocated[i], live[i]);
+	}
+	emitter_json_array_end(emitter); /* Close "tags". */
+}
+
+/* Lists the busiest allocation callsites, with opt.prof_callsite. */
+JEMALLOC_COLD
+static void
+stats_prof_callsites_print(emitter_t *emitter) {
+	if (!(config_prof && opt_prof && opt_prof_callsite)) {
+		return;
+	}
+	size_t mib[CTL_MAX_DEPTH];
+	CTL_LEAF_PREPARE(mib, 0, "stats.prof_callsites");
+
+	emitter_json_array_kv_begin(emitter, "prof_callsites");
+	emitter_table_printf(emitter, "Allocation callsites:\n");
+	for (unsigned i = 0; i < PROF_CALLSITE_NTOP; i++) {
+		void    *addr;
+		uint64_t count, bytes;
+		mib[2] = i;
+		CTL_LEAF(mib, 3, "addr", &addr, void *);
+		CTL_LEAF(mib, 3, "count", &count, uint64_t);
+		CTL_LEAF(mib, 3, "bytes", &bytes, uint64_t);
+		if (count == 0) {
+			break;
+		}
+
+		char        buf[2 + 2 * sizeof(void *) + 1];
+		const char *addrp = buf;
+		malloc_snprintf(buf, sizeof(buf), "%p", addr);
+
+		emitter_json_object_begin(emitter);
+		emitter_json_kv(emitter, "addr", emitter_type_string, &addrp);
+		emitter_json_kv(emitter, "count", emitter_type_uint64, &count);
+		emitter_json_kv(emitter, "bytes", emitter_type_uint64, &bytes);
+		emitter_json_object_end(emitter);
+
+		emitter_table_printf(emitter,
+		    "  %s: count: %" FMTu64 ", bytes: %" FMTu64 "\n", addrp,
+		    count, bytes);
+	}
+	emitter_json_array_end(emitter); /* Close "prof_callsites". */
+}
+
 JEMALLOC_COLD
 static void
 stats_print_helper(emitter_t *emitter, bool merged, bool destroyed,
@@ -1941,6 +2211,9 @@ stats_print_helper(emitter_t *emitter, bool merged, bool destroyed,
 	    num_background_threads, background_thread_num_runs,
 	    background_thread_run_interval);
 
+	stats_tags_print(emitter);
+	stats_prof_callsites_print(emitter);
+
 	if (mutex) {
 		emitter_row_t row;
 		emitter_col_t name;
@@ -1964,6 +2237,7 @@ stats_print_helper(emitter_t *emitter, bool merged, bool destroyed,
 			emitter_json_object_kv_begin(
 			    emitter, global_mutex_names[i]);
 			mutex_stats_emit(emitter, &row, col64, col32);
+			mutex_stats_emit_wait_hist(emitter, stats_mutexes_mib, 3);
 			emitter_json_object_end(emitter);
 		}
 
@@ -2044,6 +2318,412 @@ stats_print_helper(emitter_t *emitter, bool merged, bool destroyed,
 	}
 }
 
+/******************************************************************************/
+/*
+ * OpenMetrics output.  The samples of a metric family must be contiguous, so
+ * unlike the JSON and table modes (which emit each subtree as it is read),
+ * every family is a separate pass over the arenas / size classes it covers.
+ * All reads go through MIBs translated once per pass.
+ */
+
+typedef struct stats_om_metric_s stats_om_metric_t;
+struct stats_om_metric_s {
+	/* Relative to the subtree being exported, e.g. "small.nmalloc". */
+	const char           *ctl;
+	/* Family name, without the "jemalloc_" prefix. */
+	const char           *name;
+	emitter_metric_type_t type;
+	emitter_type_t        value_type;
+	const char           *help;
+};
+
+#define OM_GAUGE(ctl, name, value_type, help)                                  \
+	{ctl, name, emitter_metric_type_gauge, emitter_type_##value_type, help}
+#define OM_COUNTER(ctl, name, value_type, help)                                \
+	{ctl, name, emitter_metric_type_counter, emitter_type_##value_type,    \
+	    help}
+
+/* Relative to "stats". */
+static const stats_om_metric_t stats_om_global_metrics[] = {
+    OM_GAUGE("allocated", "allocated_bytes", size,
+        "Bytes allocated by the application."),
+    OM_GAUGE("active", "active_bytes", size,
+        "Bytes in active pages allocated by the application."),
+    OM_GAUGE("metadata", "metadata_bytes", size,
+        "Bytes dedicated to metadata."),
+    OM_GAUGE("resident", "resident_bytes", size,
+        "Bytes in physically resident data pages mapped by the allocator."),
+    OM_GAUGE("mapped", "mapped_bytes", size,
+        "Bytes in active extents mapped by the allocator."),
+    OM_GAUGE("retained", "retained_bytes", size,
+        "Bytes in virtual memory mappings that were retained."),
+    OM_COUNTER("zero_reallocs", "zero_reallocs", size,
+        "Calls to realloc(non-null-ptr, 0)."),
+};
+
+/* Relative to "stats.arenas.<i>". */
+static const stats_om_metric_t stats_om_arena_metrics[] = {
+    OM_GAUGE("nthreads", "arena_threads", unsigned,
+        "Threads currently assigned to the arena."),
+    OM_GAUGE("pactive", "arena_active_pages", size,
+        "Pages in active extents."),
+    OM_GAUGE("pdirty", "arena_dirty_pages", size,
+        "Pages within unused extents that are potentially dirty."),
+    OM_GAUGE("pmuzzy", "arena_muzzy_pages", size,
+        "Pages within unused extents that are muzzy."),
+    OM_GAUGE("mapped", "arena_mapped_bytes", size,
+        "Bytes in active extents mapped by the arena."),
+    OM_GAUGE("retained", "arena_retained_bytes", size,
+        "Bytes in virtual memory mappings retained by the arena."),
+    OM_GAUGE("base", "arena_base_bytes", size,
+        "Bytes dedicated to bootstrap-sensitive allocator metadata."),
+    OM_GAUGE("internal", "arena_internal_bytes", size,
+        "Bytes dedicated to internal allocations."),
+    OM_GAUGE("resident", "arena_resident_bytes", size,
+        "Bytes in physically resident pages mapped by the arena."),
+    OM_GAUGE("tcache_bytes", "arena_tcache_bytes", size,
+        "Bytes cached in thread caches."),
+    OM_COUNTER("dirty_npurge", "arena_dirty_purge_sweeps", uint64,
+        "Dirty page purge sweeps performed."),
+    OM_COUNTER("dirty_purged", "arena_dirty_purged_pages", uint64,
+        "Dirty pages purged."),
+    OM_COUNTER("muzzy_npurge", "arena_muzzy_purge_sweeps", uint64,
+        "Muzzy page purge sweeps performed."),
+    OM_COUNTER("muzzy_purged", "arena_muzzy_purged_pages", uint64,
+        "Muzzy pages purged."),
+    OM_GAUGE("small.allocated", "arena_small_allocated_bytes", size,
+        "Bytes allocated by small objects."),
+    OM_COUNTER("small.nmalloc", "arena_small_nmalloc", uint64,
+        "Small allocations served by the arena bins."),
+    OM_COUNTER("small.ndalloc", "arena_small_ndalloc", uint64,
+        "Small deallocations returned to the arena bins."),
+    OM_COUNTER("small.nrequests", "arena_small_nrequests", uint64,
+        "Small allocation requests."),
+    OM_GAUGE("large.allocated", "arena_large_allocated_bytes", size,
+        "Bytes allocated by large objects."),
+    OM_COUNTER("large.nmalloc", "arena_large_nmalloc", uint64,
+        "Large allocations served by the arena."),
+    OM_COUNTER("large.ndalloc", "arena_large_ndalloc", uint64,
+        "Large deallocations returned to the arena."),
+    OM_COUNTER("large.nrequests", "arena_large_nrequests", uint64,
+        "Large allocation requests."),
+};
+
+/* Relative to "stats.arenas.<i>.bins.<j>". */
+static const stats_om_metric_t stats_om_bin_metrics[] = {
+    OM_COUNTER("nmalloc", "bin_nmalloc", uint64,
+        "Allocations served by the bin."),
+    OM_COUNTER("ndalloc", "bin_ndalloc", uint64,
+        "Deallocations returned to the bin."),
+    OM_COUNTER("nrequests", "bin_nrequests", uint64,
+        "Allocation requests, including thread cache hits."),
+    OM_GAUGE("curregs", "bin_regions", size, "Current number of regions."),
+    OM_GAUGE("curslabs", "bin_slabs", size, "Current number of slabs."),
+    OM_COUNTER("nslabs", "bin_nslabs", uint64, "Slabs created."),
+    OM_COUNTER("nfills", "bin_nfills", uint64, "Thread cache fills."),
+    OM_COUNTER("nflushes", "bin_nflushes", uint64, "Thread cache flushes."),
+};
+
+/* Relative to "stats.arenas.<i>.lextents.<j>". */
+static const stats_om_metric_t stats_om_lextent_metrics[] = {
+    OM_COUNTER("nmalloc", "lextent_nmalloc", uint64,
+        "Allocations served by the arena."),
+    OM_COUNTER("ndalloc", "lextent_ndalloc", uint64,
+        "Deallocations returned to the arena."),
+    OM_COUNTER("nrequests", "lextent_nrequests", uint64,
+        "Allocation requests, including thread cache hits."),
+    OM_GAUGE("curlextents", "lextent_extents", size,
+        "Current number of large allocations."),
+};
+
+/* Relative to "stats.mutexes.<name>" and "stats.arenas.<i>.mutexes.<name>". */
+static const stats_om_metric_t stats_om_mutex_metrics[] = {
+    OM_COUNTER("num_ops", "num_ops", uint64, "Lock operations."),
+    OM_COUNTER("num_wait", "num_wait", uint64,
+        "Lock acquisitions that had to wait."),
+    OM_COUNTER("num_spin_acq", "num_spin_acq", uint64,
+        "Lock acquisitions that succeeded while spinning."),
+    OM_COUNTER("num_owner_switch", "num_owner_switch", uint64,
+        "Lock acquisitions by a thread other than the previous owner."),
+    OM_COUNTER("total_wait_time", "wait_time_ns", uint64,
+        "Nanoseconds spent waiting for the lock."),
+    OM_GAUGE("max_wait_time", "max_wait_time_ns", uint64,
+        "Longest single wait for the lock, in nanoseconds."),
+    OM_GAUGE("max_num_thds", "max_waiting_threads", uint32,
+        "Maximum number of threads waiting for the lock at once."),
+};
+
+#undef OM_GAUGE
+#undef OM_COUNTER
+
+#define STATS_OM_NMETRICS(metrics)                                             \
+	(sizeof(metrics) / sizeof(stats_om_metric_t))
+#define STATS_OM_LABELS_MAX 64
+
+typedef struct stats_om_arena_s stats_om_arena_t;
+struct stats_om_arena_s {
+	unsigned ind;
+	char     labels[STATS_OM_LABELS_MAX];
+};
+
+/* Large enough for any of the value types above. */
+typedef union {
+	unsigned u;
+	uint32_t u32;
+	uint64_t u64;
+	size_t   zu;
+} stats_om_value_t;
+
+static void
+stats_om_read(size_t *mib, size_t miblen, const char *ctl,
+    emitter_type_t value_type, stats_om_value_t *value) {
+	size_t sz;
+	switch (value_type) {
+	case emitter_type_unsigned:
+		sz = sizeof(unsigned);
+		break;
+	case emitter_type_uint32:
+		sz = sizeof(uint32_t);
+		break;
+	case emitter_type_uint64:
+		sz = sizeof(uint64_t);
+		break;
+	case emitter_type_size:
+		sz = sizeof(size_t);
+		break;
+	default:
+		unreachable();
+	}
+	size_t miblen_new = CTL_MAX_DEPTH;
+	xmallctlbymibname(
+	    mib, miblen, ctl, &miblen_new, (void *)value, &sz, NULL, 0);
+}
+
+static void
+stats_om_general_print(emitter_t *emitter) {
+	const char *version;
+	CTL_GET("version", &version, const char *);
+	char labels[STATS_OM_LABELS_MAX];
+	malloc_snprintf(labels, sizeof(labels), "version=\"%s\"", version);
+	unsigned one = 1;
+	emitter_metric_family_begin(emitter, "build_info",
+	    emitter_metric_type_gauge, "Version of the allocator.");
+	emitter_metric_sample(emitter, labels, emitter_type_unsigned, &one);
+}
+
+static void
+stats_om_global_print(emitter_t *emitter) {
+	size_t mib[CTL_MAX_DEPTH];
+	CTL_LEAF_PREPARE(mib, 0, "stats");
+	for (size_t k = 0; k < STATS_OM_NMETRICS(stats_om_global_metrics); k++) {
+		const stats_om_metric_t *metric = &stats_om_global_metrics[k];
+		stats_om_value_t         value;
+		stats_om_read(mib, 1, metric->ctl, metric->value_type, &value);
+		emitter_metric_family_begin(
+		    emitter, metric->name, metric->type, metric->help);
+		emitter_metric_sample(
+		    emitter, NULL, metric->value_type, &value);
+	}
+}
+
+static void
+stats_om_global_mutexes_print(emitter_t *emitter) {
+	size_t mib[CTL_MAX_DEPTH];
+	CTL_LEAF_PREPARE(mib, 0, "stats.mutexes");
+	char name[STATS_OM_LABELS_MAX];
+	char labels[STATS_OM_LABELS_MAX];
+	for (size_t k = 0; k < STATS_OM_NMETRICS(stats_om_mutex_metrics); k++) {
+		const stats_om_metric_t *metric = &stats_om_mutex_metrics[k];
+		malloc_snprintf(name, sizeof(name), "mutex_%s", metric->name);
+		/* The emitter holds on to name until the next family begins. */
+		emitter_metric_family_begin(
+		    emitter, name, metric->type, metric->help);
+		for (int i = 0; i < mutex_prof_num_global_mutexes; i++) {
+			CTL_LEAF_PREPARE(mib, 2, global_mutex_names[i]);
+			stats_om_value_t value;
+			stats_om_read(
+			    mib, 3, metric->ctl, metric->value_type, &value);
+			malloc_snprintf(labels, sizeof(labels),
+			    "mutex=\"%s\"", global_mutex_names[i]);
+			emitter_metric_sample(
+			    emitter, labels, metric->value_type, &value);
+		}
+	}
+}
+
+static void
+stats_om_arenas_print(emitter_t *emitter, const stats_om_arena_t *arenas,
+    unsigned narenas) {
+	size_t mib[CTL_MAX_DEPTH];
+	CTL_LEAF_PREPARE(mib, 0, "stats.arenas");
+	for (size_t k = 0; k < STATS_OM_NMETRICS(stats_om_arena_metrics); k++) {
+		const stats_om_metric_t *metric = &stats_om_arena_metrics[k];
+		emitter_metric_family_begin(
+		    emitter, metric->name, metric->type, metric->help);
+		for (unsigned i = 0; i < narenas; i++) {
+			mib[2] = arenas[i].ind;
+			stats_om_value_t value;
+			stats_om_read(
+			    mib, 3, metric->ctl, metric->value_type, &value);
+			emitter_metric_sample(emitter, arenas[i].labels,
+			    metric->value_type, &value);
+		}
+	}
+}
+
+/*
+ * Per size class families, for either bins or lextents.  Size classes that
+ * have never been allocated from are skipped, to keep the number of series
+ * proportional to what the application actually uses.
+ */
+static void
+stats_om_size_classes_print(emitter_t *emitter, const stats_om_arena_t *arenas,
+    unsigned narenas, bool large) {
+	const stats_om_metric_t *metrics = large ? stats_om_lextent_metrics
+	                                         : stats_om_bin_metrics;
+	size_t nmetrics = large ? STATS_OM_NMETRICS(stats_om_lextent_metrics)
+	                        : STATS_OM_NMETRICS(stats_om_bin_metrics);
+	unsigned nclasses;
+	if (large) {
+		CTL_GET("arenas.nlextents", &nclasses, unsigned);
+	} else {
+		CTL_GET("arenas.nbins", &nclasses, unsigned);
+	}
+
+	size_t stats_mib[CTL_MAX_DEPTH];
+	CTL_LEAF_PREPARE(stats_mib, 0, "stats.arenas");
+	size_t size_mib[CTL_MAX_DEPTH];
+	CTL_LEAF_PREPARE(size_mib, 0, large ? "arenas.lextent" : "arenas.bin");
+
+	char labels[STATS_OM_LABELS_MAX];
+	for (size_t k = 0; k < nmetrics; k++) {
+		const stats_om_metric_t *metric = &metrics[k];
+		emitter_metric_family_begin(
+		    emitter, metric->name, metric->type, metric->help);
+		for (unsigned i = 0; i < narenas; i++) {
+			stats_mib[2] = arenas[i].ind;
+			CTL_LEAF_PREPARE(
+			    stats_mib, 3, large ? "lextents" : "bins");
+			for (unsigned j = 0; j < nclasses; j++) {
+				stats_mib[4] = j;
+				uint64_t nmalloc;
+				CTL_LEAF(stats_mib, 5, "nmalloc", &nmalloc,
+				    uint64_t);
+				if (nmalloc == 0) {
+					continue;
+				}
+				stats_om_value_t value;
+				stats_om_read(stats_mib, 5, metric->ctl,
+				    metric->value_type, &value);
+				size_t size;
+				size_mib[2] = j;
+				CTL_LEAF(size_mib, 3, "size", &size, size_t);
+				malloc_snprintf(labels, sizeof(labels),
+				    "%s,size=\"%zu\"", arenas[i].labels, size);
+				emitter_metric_sample(emitter, labels,
+				    metric->value_type, &value);
+			}
+		}
+	}
+}
+
+static void
+stats_om_arena_mutexes_print(emitter_t *emitter,
+    const stats_om_arena_t *arenas, unsigned narenas) {
+	size_t mib[CTL_MAX_DEPTH];
+	CTL_LEAF_PREPARE(mib, 0, "stats.arenas");
+	char name[STATS_OM_LABELS_MAX];
+	char labels[STATS_OM_LABELS_MAX];
+	for (size_t k = 0; k < STATS_OM_NMETRICS(stats_om_mutex_metrics); k++) {
+		const stats_om_metric_t *metric = &stats_om_mutex_metrics[k];
+		malloc_snprintf(
+		    name, sizeof(name), "arena_mutex_%s", metric->name);
+		emitter_metric_family_begin(
+		    emitter, name, metric->type, metric->help);
+		for (unsigned i = 0; i < narenas; i++) {
+			mib[2] = arenas[i].ind;
+			CTL_LEAF_PREPARE(mib, 3, "mutexes");
+			for (int j = 0; j < mutex_prof_num_arena_mutexes; j++) {
+				CTL_LEAF_PREPARE(mib, 4, arena_mutex_names[j]);
+				stats_om_value_t value;
+				stats_om_read(mib, 5, metric->ctl,
+				    metric->value_type, &value);
+				malloc_snprintf(labels, sizeof(labels),
+				    "%s,mutex=\"%s\"", arenas[i].labels,
+				    arena_mutex_names[j]);
+				emitter_metric_sample(emitter, labels,
+				    metric->value_type, &value);
+			}
+		}
+	}
+}
+
+JEMALLOC_COLD
+static void
+stats_om_print(emitter_t *emitter, bool general, bool merged, bool destroyed,
+    bool unmerged, bool bins, bool large, bool mutex) {
+	if (general) {
+		stats_om_general_print(emitter);
+	}
+	if (!config_stats) {
+		return;
+	}
+	stats_om_global_print(emitter);
+	if (mutex) {
+		stats_om_global_mutexes_print(emitter);
+	}
+
+	/* Collect the arenas to export, and their label sets. */
+	unsigned narenas;
+	CTL_GET("arenas.narenas", &narenas, unsigned);
+	VARIABLE_ARRAY_UNSAFE(stats_om_arena_t, arenas, narenas + 2);
+	unsigned nexported = 0;
+	size_t   mib[3];
+	size_t   miblen = sizeof(mib) / sizeof(size_t);
+	xmallctlnametomib("arena.0.initialized", mib, &miblen);
+	if (merged) {
+		arenas[nexported].ind = MALLCTL_ARENAS_ALL;
+		malloc_snprintf(arenas[nexported].labels, STATS_OM_LABELS_MAX,
+		    "arena=\"merged\"");
+		nexported++;
+	}
+	if (destroyed) {
+		bool   initialized;
+		size_t sz = sizeof(bool);
+		mib[1] = MALLCTL_ARENAS_DESTROYED;
+		xmallctlbymib(mib, miblen, &initialized, &sz, NULL, 0);
+		if (initialized) {
+			arenas[nexported].ind = MALLCTL_ARENAS_DESTROYED;
+			malloc_snprintf(arenas[nexported].labels,
+			    STATS_OM_LABELS_MAX, "arena=\"destroyed\"");
+			nexported++;
+		}
+	}
+	for (unsigned i = 0; unmerged && i < narenas; i++) {
+		bool   initialized;
+		size_t sz = sizeof(bool);
+		mib[1] = i;
+		xmallctlbymib(mib, miblen, &initialized, &sz, NULL, 0);
+		if (initialized) {
+			arenas[nexported].ind = i;
+			malloc_snprintf(arenas[nexported].labels,
+			    STATS_OM_LABELS_MAX, "arena=\"%u\"", i);
+			nexported++;
+		}
+	}
+
+	stats_om_arenas_print(emitter, arenas, nexported);
+	if (bins) {
+		stats_om_size_classes_print(emitter, arenas, nexported, false);
+	}
+	if (large) {
+		stats_om_size_classes_print(emitter, arenas, nexported, true);
+	}
+	if (mutex) {
+		stats_om_arena_mutexes_print(emitter, arenas, nexported);
+	}
+}
+
 void
 stats_print(write_cb_t *write_cb, void *cbopaque, const char *opts) {
 	int      err;
@@ -2092,6 +2772,15 @@ stats_print(write_cb_t *write_cb, void *cbopaque, const char *opts) {
 	}
 
 	emitter_t emitter;
+	if (openmetrics) {
+		emitter_init(
+		    &emitter, emitter_output_openmetrics, write_cb, cbopaque);
+		emitter_begin(&emitter);
+		stats_om_print(&emitter, general, merged, destroyed, unmerged,
+		    bins, large, mutex);
+		emitter_end(&emitter);
+		return;
+	}
 	emitter_init(&emitter,
 	    json ? emitter_output_json_compact : emitter_output_table, write_cb,
 	    cbopaque);
@@ -7,6 +7,7 @@
 #include "jemalloc/internal/safety_check.h"
 #include "jemalloc/internal/san.h"
 #include "jemalloc/internal/sc.h"
+#include "jemalloc/internal/spin.h"
 
 /******************************************************************************/
 /* Data. */
@@ -37,6 +38,26 @@ ssize_t opt_lg_tcache_nslots_mul = 1;
  */
 size_t opt_tcache_gc_incr_bytes = 65536;
 
+/*
+ * Per-thread limit on the number of bytes held in the tcache; 0 means no limit
+ * beyond the per-bin ncached_max.  Enforced (softly) at GC events, see
+ * tcache_gc_budget().
+ */
+size_t opt_tcache_bytes_budget = 0;
+
+/*
+ * Flush the tcaches of threads that have not allocated or deallocated for this
+ * long, from the background thread.  -1 disables.
+ */
+ssize_t opt_tcache_idle_reclaim_ms = -1;
+
+/*
+ * Number of tcaches of exited threads kept around for adoption by new threads,
+ * and whether they keep their cached objects meanwhile.
+ */
+unsigned opt_tcache_pool_max = 0;
+bool     opt_tcache_pool_keep_cached = false;
+
 /*
  * With default settings, we may end up flushing small bins frequently with
  * small flush amounts.  To limit this tendency, we can set a number of bytes to
@@ -94,6 +115,23 @@ static tcaches_t *tcaches_avail;
 /* Protects tcaches{,_past,_avail}. */
 static malloc_mutex_t tcaches_mtx;
 
+/*
+ * Pool of detached tcaches, see tcache_pool_detach().  Same scheme as tcaches:
+ * an array of opt_tcache_pool_max elements, lazily allocated from b0.
+ */
+static tcache_pool_elm_t *tcache_pool;
+static unsigned           tcache_pool_past;
+static tcache_pool_elm_t *tcache_pool_avail;
+/*
+ * Detached tcaches ready for adoption (tcache_pool_elm_t *), most recently
+ * detached first.  Only modified with tcache_pool_mtx held, but loaded without
+ * it to skip the lock when the pool is empty.
+ */
+static atomic_p_t tcache_pool_ready;
+
+/* Protects tcache_pool{,_past,_avail}, and writes to tcache_pool_ready. */
+static malloc_mutex_t tcache_pool_mtx;
+
 /******************************************************************************/
 
 size_t
@@ -519,6 +557,87 @@ tcache_try_gc_bin(
 	return ret;
 }
 
+/* Returns bytes * num / den, for num <= den, without overflowing. */
+static size_t
+tcache_bytes_scale(size_t bytes, size_t num, size_t den) {
+	assert(num <= den && den != 0);
+	/*
+	 * Drop the low bits of the ratio until the product fits; the rounding
+	 * only ever errs towards keeping less.  den stays non-zero, since a den
+	 * of 1 means num <= 1, and then nothing overflows.
+	 */
+	while (num != 0 && bytes > SIZE_MAX / num) {
+		num >>= 1;
+		den >>= 1;
+	}
+	return bytes * num / den;
+}
+
+/*
+ * Bring the total number of cached bytes, stashed items included, back under
+ * the thread's budget.  Stashed items can't be handed out again, so they are
+ * flushed first.  The budget is then split across bins in proportion to the
+ * bytes each bin actually handed out since its last GC (ncached - low_water),
+ * which approximates its recent hit rate; items that stayed below low water
+ * are thus flushed first, and bins that have been idle get nothing.  Flushing
+ * happens from the bottom of the stack, i.e. the least recently cached items
+ * go first.
+ */
+static void
+tcache_gc_budget(tsd_t *tsd, tcache_slow_t *tcache_slow, tcache_t *tcache) {
+	size_t   budget = tcache_slow->bytes_budget;
+	unsigned tcache_nbins = tcache_nbins_get(tcache_slow);
+	size_t   cached = 0;
+	size_t   active = 0;
+	for (szind_t szind = 0; szind < tcache_nbins; szind++) {
+		cache_bin_t *cache_bin = &tcache->bins[szind];
+		if (tcache_bin_disabled(szind, cache_bin, tcache_slow)) {
+			continue;
+		}
+		size_t         sz = sz_index2size(szind);
+		cache_bin_sz_t ncached = cache_bin_ncached_get_local(cache_bin);
+		cache_bin_sz_t low_water = cache_bin_low_water_get(cache_bin);
+		cache_bin_sz_t nstashed = cache_bin_nstashed_get_local(
+		    cache_bin);
+		cached += (size_t)(ncached + nstashed) * sz;
+		active += (size_t)(ncached - low_water) * sz;
+	}
+	if (cached <= budget) {
+		return;
+	}
+
+	for (szind_t szind = 0; szind < tcache_nbins; szind++) {
+		cache_bin_t *cache_bin = &tcache->bins[szind];
+		if (tcache_bin_disabled(szind, cache_bin, tcache_slow)) {
+			continue;
+		}
+		bool is_small = (szind < SC_NBINS);
+		tcache_bin_flush_stashed(
+		    tsd, tcache, cache_bin, szind, is_small);
+		size_t         sz = sz_index2size(szind);
+		cache_bin_sz_t ncached = cache_bin_ncached_get_local(cache_bin);
+		cache_bin_sz_t low_water = cache_bin_low_water_get(cache_bin);
+		if (ncached == 0) {
+			continue;
+		}
+		size_t keep = (size_t)(ncached - low_water) * sz;
+		if (active > budget) {
+			keep = tcache_bytes_scale(keep, budget, active);
+		}
+		unsigned nkeep = (unsigned)(keep / sz);
+		if (nkeep >= ncached) {
+			continue;
+		}
+		if (is_small) {
+			tcache_bin_flush_small(
+			    tsd, tcache, cache_bin, szind, nkeep);
+		} else {
+			tcache_bin_flush_large(
+			    tsd, tcache, cache_bin, szind, nkeep);
+		}
+	}
+}
+
 static void
 tcache_gc_event(tsd_t *tsd) {
 	tcache_t *tcache = tcache_get(tsd);
@@ -529,6 +648,10 @@ tcache_gc_event(tsd_t *tsd) {
 	tcache_slow_t *tcache_slow = tsd_tcache_slowp_get(tsd);
 	assert(tcache_slow != NULL);
 
+	if (tcache_slow->bytes_budget != 0) {
+		tcache_gc_budget(tsd, tcache_slow, tcache);
+	}
+
 	/* When the new tcache gc is not enabled, GC one bin at a time. */
 	if (!opt_experimental_tcache_gc) {
 		szind_t szind = tcache_slow->next_gc_bin;
@@ -614,9 +737,13 @@ tcache_alloc_small_hard(tsdn_t *tsdn, arena_t *arena, tcache_t *tcache,
 	CACHE_BIN_PTR_ARRAY_DECLARE(ptrs, nfill_max);
 	cache_bin_init_ptr_array_for_fill(cache_bin, &ptrs, nfill_max);
 
+	latency_timer_t timer;
+	latency_timer_start(tsdn, &timer, latency_site_tcache_fill);
 	cache_bin_sz_t filled = arena_ptr_array_fill_small(tsdn, arena, binind,
 	    &ptrs, /* nfill_min */ nfill_min, /* nfill_max */ nfill_max,
 	    cache_bin->tstats);
+	latency_timer_stop(tsdn, &timer, &arena->stats.latency,
+	    LOCKEDINT_MTX(arena->stats.mtx));
 	cache_bin_finish_fill(cache_bin, &ptrs, filled);
 	assert(filled >= nfill_min && filled <= nfill_max);
 	assert(cache_bin_ncached_get_local(cache_bin) == filled);
@@ -794,6 +921,7 @@ tcache_arena_dissociate(
 		ql_remove(&arena->cache_bin_array_descriptor_ql,
 		    &tcache_slow->cache_bin_array_descriptor, link);
 		tcache_stats_merge(tsdn, tcache_slow->tcache, arena);
+		arena_large_stats_tcache_flush(tsdn, arena, tcache_slow);
 		malloc_mutex_unlock(tsdn, &arena->tcache_ql_mtx);
 	}
 	tcache_slow->arena = NULL;
@@ -812,11 +940,12 @@ tcache_default_settings_init(tcache_slow_t *tcache_slow) {
 	assert(global_do_not_change_tcache_maxclass != 0);
 	assert(global_do_not_change_tcache_nbins != 0);
 	tcache_slow->tcache_nbins = global_do_not_change_tcache_nbins;
+	tcache_slow->bytes_budget = opt_tcache_bytes_budget;
 }
 
+/* Initializes everything but the bins themselves. */
 static void
-tcache_init(tsd_t *tsd, tcache_slow_t *tcache_slow, tcache_t *tcache, void *mem,
-    const cache_bin_info_t *tcache_bin_info) {
+tcache_slow_init(tcache_slow_t *tcache_slow, tcache_t *tcache, void *mem) {
 	tcache->tcache_slow = tcache_slow;
 	tcache_slow->tcache = tcache;
 
@@ -827,6 +956,28 @@ tcache_init(tsd_t *tsd, tcache_slow_t *tcache_slow, tcache_t *tcache, void *mem,
 	tcache_slow->next_gc_bin_large = SC_NBINS;
 	tcache_slow->arena = NULL;
 	tcache_slow->dyn_alloc = mem;
+	tcache_slow->owner = NULL;
+	/* Keep the mark of an allocator call in progress. */
+	atomic_fetch_and_u8(
+	    &tcache_slow->reclaim_state, tcache_reclaim_busy, ATOMIC_RELAXED);
+	tcache_slow->idle_activity = 0;
+	nstime_init_zero(&tcache_slow->idle_since);
+	tcache_slow->idle_reclaimed = false;
+	memset(tcache_slow->lstats, 0, sizeof(tcache_slow->lstats));
+
+	unsigned tcache_nbins = tcache_nbins_get(tcache_slow);
+	for (unsigned i = 0; i < tcache_nbins && i < SC_NBINS; i++) {
+		tcache_bin_fill_ctl_init(tcache_slow, i);
+		tcache_slow->bin_refilled[i] = false;
+		tcache_slow->bin_flush_delay_items[i] =
+		    tcache_gc_item_delay_compute(i);
+	}
+}
+
+static void
+tcache_init(tsd_t *tsd, tcache_slow_t *tcache_slow, tcache_t *tcache, void *mem,
+    const cache_bin_info_t *tcache_bin_info) {
+	tcache_slow_init(tcache_slow, tcache, mem);
 
 	/*
 	 * We reserve cache bins for all small size classes, even if some may
@@ -838,12 +989,6 @@ tcache_init(tsd_t *tsd, tcache_slow_t *tcache_slow, tcache_t *tcache, void *mem,
 	size_t   cur_offset = 0;
 	cache_bin_preincrement(tcache_bin_info, tcache_nbins, mem, &cur_offset);
 	for (unsigned i = 0; i < tcache_nbins; i++) {
-		if (i < SC_NBINS) {
-			tcache_bin_fill_ctl_init(tcache_slow, i);
-			tcache_slow->bin_refilled[i] = false;
-			tcache_slow->bin_flush_delay_items[i] =
-			    tcache_gc_item_delay_compute(i);
-		}
 		cache_bin_t *cache_bin = &tcache->bins[i];
 		if (tcache_bin_info[i].ncached_max > 0) {
 			cache_bin_init(
@@ -949,6 +1094,87 @@ tcache_bin_info_compute(cache_bin_info_t tcache_bin_info[TCACHE_NBINS_MAX]) {
 	}
 }
 
+/* Whether elm can stand in for a freshly initialized tcache with these bins. */
+static bool
+tcache_pool_elm_matches(tcache_pool_elm_t *elm, unsigned tcache_nbins,
+    const cache_bin_info_t *tcache_bin_info) {
+	if (tcache_nbins_get(&elm->tcache_slow) != tcache_nbins) {
+		return false;
+	}
+	for (unsigned i = 0; i < TCACHE_NBINS_MAX; i++) {
+		if (cache_bin_ncached_max_get(&elm->tcache.bins[i])
+		    != tcache_bin_info[i].ncached_max) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * Tries to take over a pooled tcache, preferably one last used with arena, or
+ * else with the thread's arena if it has one already.  No arena is chosen
+ * here: that would associate the tcache before it is initialized.  On
+ * success, the bins of tcache are initialized and false is returned; the
+ * caller still has to associate it with an arena, like a new one.
+ */
+static bool
+tcache_pool_adopt(tsd_t *tsd, tcache_slow_t *tcache_slow, tcache_t *tcache,
+    arena_t *arena, const cache_bin_info_t *tcache_bin_info) {
+	if (opt_tcache_pool_max == 0
+	    || atomic_load_p(&tcache_pool_ready, ATOMIC_ACQUIRE) == NULL) {
+		/* A tcache detached concurrently may be missed; that's fine. */
+		return true;
+	}
+	if (arena == NULL) {
+		arena = tsd_arena_get(tsd);
+	}
+	unsigned tcache_nbins = tcache_nbins_get(tcache_slow);
+
+	malloc_mutex_lock(tsd_tsdn(tsd), &tcache_pool_mtx);
+	tcache_pool_elm_t *elm = NULL;
+	tcache_pool_elm_t *elm_prev = NULL;
+	tcache_pool_elm_t *prev = NULL;
+	for (tcache_pool_elm_t *cur = atomic_load_p(
+	         &tcache_pool_ready, ATOMIC_RELAXED);
+	     cur != NULL; prev = cur, cur = cur->next) {
+		if (!tcache_pool_elm_matches(
+		        cur, tcache_nbins, tcache_bin_info)) {
+			continue;
+		}
+		if (elm == NULL) {
+			elm = cur;
+			elm_prev = prev;
+		}
+		if (arena != NULL && cur->tcache_slow.arena == arena) {
+			elm = cur;
+			elm_prev = prev;
+			break;
+		}
+	}
+	if (elm != NULL) {
+		if (elm_prev == NULL) {
+			atomic_store_p(
+			    &tcache_pool_ready, elm->next, ATOMIC_RELEASE);
+		} else {
+			elm_prev->next = elm->next;
+		}
+	}
+	malloc_mutex_unlock(tsd_tsdn(tsd), &tcache_pool_mtx);
+	if (elm == NULL) {
+		return true;
+	}
+
+	/* Keep this thread's settings; only the bins are taken over. */
+	tcache_slow_init(tcache_slow, tcache, elm->tcache_slow.dyn_alloc);
+	memcpy(tcache->bins, elm->tcache.bins, sizeof(tcache->bins));
+
+	malloc_mutex_lock(tsd_tsdn(tsd), &tcache_pool_mtx);
+	elm->next = tcache_pool_avail;
+	tcache_pool_avail = elm;
+	malloc_mutex_unlock(tsd_tsdn(tsd), &tcache_pool_mtx);
+	return false;
+}
+
 static bool
 tsd_tcache_data_init_impl(
     tsd_t *tsd, arena_t *arena, const cache_bin_info_t *tcache_bin_info) {
@@ -956,26 +1182,31 @@ tsd_tcache_data_init_impl(
 	tcache_t      *tcache = tsd_tcachep_get_unsafe(tsd);
 
 	assert(cache_bin_still_zero_initialized(&tcache->bins[0]));
-	unsigned tcache_nbins = tcache_nbins_get(tcache_slow);
-	size_t   size, alignment;
-	cache_bin_info_compute_alloc(
-	    tcache_bin_info, tcache_nbins, &size, &alignment);
-
-	void *mem;
-	if (cache_bin_stack_use_thp()) {
-		/* Alignment is ignored since it comes from THP. */
-		assert(alignment == QUANTUM);
-		mem = b0_alloc_tcache_stack(tsd_tsdn(tsd), size);
-	} else {
-		size = sz_sa2u(size, alignment);
-		mem = ipallocztm(tsd_tsdn(tsd), size, alignment, true, NULL,
-		    true, arena_get(TSDN_NULL, 0, true));
-	}
-	if (mem == NULL) {
-		return true;
-	}
+	if (!malloc_initialized()
+	    || tcache_pool_adopt(
+	        tsd, tcache_slow, tcache, arena, tcache_bin_info)) {
+		unsigned tcache_nbins = tcache_nbins_get(tcache_slow);
+		size_t   size, alignment;
+		cache_bin_info_compute_alloc(
+		    tcache_bin_info, tcache_nbins, &size, &alignment);
 
-	tcache_init(tsd, tcache_slow, tcache, mem, tcache_bin_info);
+		void *mem;
+		if (cache_bin_stack_use_thp()) {
+			/* Alignment is ignored since it comes from THP. */
+			assert(alignment == QUANTUM);
+			mem = b0_alloc_tcache_stack(tsd_tsdn(tsd), size);
+		} else {
+			size = sz_sa2u(size, alignment);
+			mem = ipallocztm(tsd_tsdn(tsd), size, alignment, true,
+			    NULL, true, arena_get(TSDN_NULL, 0, true));
+		}
+		if (mem == NULL) {
+			return true;
+		}
+
+		tcache_init(tsd, tcache_slow, tcache, mem, tcache_bin_info);
+	}
+	tcache_slow->owner = tsd;
 	/*
 	 * Initialization is a bit tricky here.  After malloc init is done, all
 	 * threads can rely on arena_choose and associate tcache accordingly.
@@ -1117,6 +1348,17 @@ thread_tcache_max_set(tsd_t *tsd, size_t tcache_max) {
 	assert(tcache_nbins_get(tcache_slow) == sz_size2index(tcache_max) + 1);
 }
 
+void
+thread_tcache_bytes_budget_set(tsd_t *tsd, size_t bytes_budget) {
+	tcache_slow_t *tcache_slow = tsd_tcache_slowp_get(tsd);
+	tcache_slow->bytes_budget = bytes_budget;
+	/* Apply a lowered budget right away rather than at the next GC. */
+	tcache_t *tcache = tcache_get(tsd);
+	if (tcache != NULL && bytes_budget != 0) {
+		tcache_gc_budget(tsd, tcache_slow, tcache);
+	}
+}
+
 static bool
 tcache_bin_info_settings_parse(const char *bin_settings_segment_cur,
     size_t len_left, cache_bin_info_t tcache_bin_info[TCACHE_NBINS_MAX],
@@ -1209,22 +1451,125 @@ tcache_flush(tsd_t *tsd) {
 	tcache_flush_cache(tsd, tsd_tcachep_get(tsd));
 }
 
-static void
-tcache_destroy(tsd_t *tsd, tcache_t *tcache, bool tsd_tcache) {
+/* Returns NULL if the pool is full.  Called with tcache_pool_mtx held. */
+static tcache_pool_elm_t *
+tcache_pool_elm_alloc(tsdn_t *tsdn) {
+	malloc_mutex_assert_owner(tsdn, &tcache_pool_mtx);
+
+	if (tcache_pool == NULL) {
+		tcache_pool = base_alloc(tsdn, b0get(),
+		    sizeof(tcache_pool_elm_t) * opt_tcache_pool_max, CACHELINE);
+		if (tcache_pool == NULL) {
+			return NULL;
+		}
+	}
+	tcache_pool_elm_t *elm;
+	if (tcache_pool_avail != NULL) {
+		elm = tcache_pool_avail;
+		tcache_pool_avail = elm->next;
+	} else if (tcache_pool_past < opt_tcache_pool_max) {
+		elm = &tcache_pool[tcache_pool_past++];
+	} else {
+		elm = NULL;
+	}
+	return elm;
+}
+
+/*
+ * Instead of destroying the tcache of an exiting thread, keep its bin stacks
+ * (and with opt_tcache_pool_keep_cached, the cached objects too) for a future
+ * thread to adopt in tsd_tcache_data_init_impl().  Returns false on success;
+ * the tcache is dissociated from its arena either way.
+ */
+static bool
+tcache_pool_detach(tsd_t *tsd, tcache_t *tcache) {
 	tcache_slow_t *tcache_slow = tcache->tcache_slow;
-	tcache_flush_cache(tsd, tcache);
-	arena_t *arena = tcache_slow->arena;
+	arena_t       *arena = tcache_slow->arena;
+	/*
+	 * Manual arenas may be destroyed while a tcache sits in the pool; only
+	 * tcache_pool_flush() (called on arena reset) guards against cached
+	 * objects from them, not against stale arena pointers.
+	 */
+	if (opt_tcache_pool_max == 0 || !arena_is_auto(arena)) {
+		return true;
+	}
+	malloc_mutex_lock(tsd_tsdn(tsd), &tcache_pool_mtx);
+	tcache_pool_elm_t *elm = tcache_pool_elm_alloc(tsd_tsdn(tsd));
+	malloc_mutex_unlock(tsd_tsdn(tsd), &tcache_pool_mtx);
+	if (elm == NULL) {
+		return true;
+	}
+
+	if (!opt_tcache_pool_keep_cached) {
+		tcache_flush_cache(tsd, tcache);
+	}
+	/* Also merges (and resets) the bin stats. */
 	tcache_arena_dissociate(tsd_tsdn(tsd), tcache_slow, tcache);
 
-	if (tsd_tcache) {
-		cache_bin_t *cache_bin = &tcache->bins[0];
-		cache_bin_assert_empty(cache_bin);
+	memcpy(&elm->tcache, tcache, sizeof(tcache_t));
+	memcpy(&elm->tcache_slow, tcache_slow, sizeof(tcache_slow_t));
+	elm->tcache.tcache_slow = &elm->tcache_slow;
+	elm->tcache_slow.tcache = &elm->tcache;
+	elm->tcache_slow.arena = arena;
+	elm->tcache_slow.owner = NULL;
+
+	malloc_mutex_lock(tsd_tsdn(tsd), &tcache_pool_mtx);
+	elm->next = atomic_load_p(&tcache_pool_ready, ATOMIC_RELAXED);
+	atomic_store_p(&tcache_pool_ready, elm, ATOMIC_RELEASE);
+	malloc_mutex_unlock(tsd_tsdn(tsd), &tcache_pool_mtx);
+	return false;
+}
+
+/*
+ * Flushes the objects cached by pooled tcaches.  Needed before an arena reset,
+ * since unlike the tcaches of live threads, these are out of the application's
+ * reach.
+ */
+void
+tcache_pool_flush(tsd_t *tsd) {
+	if (!opt_tcache_pool_keep_cached) {
+		return;
 	}
-	if (tsd_tcache && cache_bin_stack_use_thp()) {
-		b0_dalloc_tcache_stack(tsd_tsdn(tsd), tcache_slow->dyn_alloc);
-	} else {
-		idalloctm(tsd_tsdn(tsd), tcache_slow->dyn_alloc, NULL, NULL,
-		    true, true);
+	malloc_mutex_lock(tsd_tsdn(tsd), &tcache_pool_mtx);
+	tcache_pool_elm_t *head = atomic_load_p(
+	    &tcache_pool_ready, ATOMIC_RELAXED);
+	atomic_store_p(&tcache_pool_ready, NULL, ATOMIC_RELAXED);
+	malloc_mutex_unlock(tsd_tsdn(tsd), &tcache_pool_mtx);
+	if (head == NULL) {
+		return;
+	}
+
+	tcache_pool_elm_t *tail = NULL;
+	for (tcache_pool_elm_t *elm = head; elm != NULL; elm = elm->next) {
+		tcache_flush_cache(tsd, &elm->tcache);
+		tail = elm;
+	}
+
+	malloc_mutex_lock(tsd_tsdn(tsd), &tcache_pool_mtx);
+	tail->next = atomic_load_p(&tcache_pool_ready, ATOMIC_RELAXED);
+	atomic_store_p(&tcache_pool_ready, head, ATOMIC_RELEASE);
+	malloc_mutex_unlock(tsd_tsdn(tsd), &tcache_pool_mtx);
+}
+
+void
+tcache_destroy(tsd_t *tsd, tcache_t *tcache, bool tsd_tcache) {
+	tcache_slow_t *tcache_slow = tcache->tcache_slow;
+	arena_t       *arena = tcache_slow->arena;
+	if (!tsd_tcache || tcache_pool_detach(tsd, tcache)) {
+		tcache_flush_cache(tsd, tcache);
+		tcache_arena_dissociate(tsd_tsdn(tsd), tcache_slow, tcache);
+
+		if (tsd_tcache) {
+			cache_bin_t *cache_bin = &tcache->bins[0];
+			cache_bin_assert_empty(cache_bin);
+		}
+		if (tsd_tcache && cache_bin_stack_use_thp()) {
+			b0_dalloc_tcache_stack(
+			    tsd_tsdn(tsd), tcache_slow->dyn_alloc);
+		} else {
+			idalloctm(tsd_tsdn(tsd), tcache_slow->dyn_alloc, NULL,
+			    NULL, true, true);
+		}
 	}
 
 	/*
@@ -1264,22 +1609,203 @@ tcache_cleanup(tsd_t *tsd) {
 	memset(tcache->bins, 0, sizeof(cache_bin_t) * TCACHE_NBINS_MAX);
 }
 
+/*
+ * Idle tcache reclamation.
+ *
+ * A thread that stops calling into the allocator keeps its tcache full
+ * indefinitely, since GC is driven by its own allocation activity.  When
+ * opt_tcache_idle_reclaim_ms >= 0, the background threads walk the tcache_ql
+ * of their arenas (which only exists with config_stats) and flush the tcaches
+ * of idle owners.  Idleness is guessed from the owner's thread_allocated /
+ * thread_deallocated counters, which it updates anyway; the owner fast paths
+ * are not changed at all.  The guess only decides when to try: the handshake
+ * below is what keeps the owner and the background thread apart.
+ *
+ * reclaim_state holds the phase of the protocol, and the owner's busy bit.
+ * The owner sets tcache_reclaim_busy for the duration of each allocator call
+ * that goes through a slow path (tcache_idle_reclaim_busy_begin() / _end()),
+ * i.e. any call that may do more than pop or push a cache bin without
+ * blocking, which the fast paths are limited to:
+ *
+ * 1. After the owner has been idle for opt_tcache_idle_reclaim_ms, the
+ *    background thread sets tcache_reclaim_pending, and forces the owner tsd
+ *    to recompute its state, i.e. off the fast paths.  Any later allocator
+ *    call by the owner goes through tsd_fetch_slow() and
+ *    tcache_idle_reclaim_busy_begin(), which call tcache_idle_reclaim_sync()
+ *    to cancel.  Thread exit instead clears owner under tcache_ql_mtx in
+ *    tcache_idle_reclaim_exit(), so that the tcache is never picked again,
+ *    before syncing.
+ * 2. If the owner is still idle opt_tcache_idle_reclaim_ms later, the
+ *    background thread claims the tcache, with a CAS from exactly pending to
+ *    active.  The CAS fails if the owner cancelled, or is still in the middle
+ *    of a slow path call that started before phase 1.  Once claimed, the
+ *    tcache is flushed, and the state goes back to none.  An owner calling in
+ *    meanwhile spins in tcache_idle_reclaim_sync() until the flush is done.
+ */
+
+void
+tcache_idle_reclaim_sync(tsd_t *tsd) {
+	tcache_slow_t *tcache_slow = tsd_tcache_slowp_get_unsafe(tsd);
+	uint8_t        state = atomic_load_u8(
+            &tcache_slow->reclaim_state, ATOMIC_ACQUIRE);
+	spin_t spinner = SPIN_INITIALIZER;
+	while (state & (tcache_reclaim_pending | tcache_reclaim_active)) {
+		if (state & tcache_reclaim_pending) {
+			/* If the claim comes first, this leaves it active. */
+			state = atomic_fetch_and_u8(&tcache_slow->reclaim_state,
+			    (uint8_t)~tcache_reclaim_pending, ATOMIC_ACQ_REL);
+			state &= (uint8_t)~tcache_reclaim_pending;
+			continue;
+		}
+		spin_adaptive(&spinner);
+		state = atomic_load_u8(
+		    &tcache_slow->reclaim_state, ATOMIC_ACQUIRE);
+	}
+}
+
+void
+tcache_idle_reclaim_exit(tsd_t *tsd) {
+	tcache_slow_t *tcache_slow = tsd_tcache_slowp_get_unsafe(tsd);
+	arena_t       *arena = tcache_slow->arena;
+	if (config_stats && arena != NULL && tcache_slow->owner != NULL) {
+		malloc_mutex_lock(tsd_tsdn(tsd), &arena->tcache_ql_mtx);
+		tcache_slow->owner = NULL;
+		malloc_mutex_unlock(tsd_tsdn(tsd), &arena->tcache_ql_mtx);
+	}
+	/* Cancel a pending reclaim, or wait for a flush already started. */
+	tcache_idle_reclaim_sync(tsd);
+}
+
+uint64_t
+tcache_idle_reclaim_interval_ns(void) {
+	if (!config_stats || opt_tcache_idle_reclaim_ms < 0) {
+		return BACKGROUND_THREAD_DEFERRED_MAX;
+	}
+	return (uint64_t)opt_tcache_idle_reclaim_ms * KQU(1000000);
+}
+
+/*
+ * Advances the protocol for one tcache; returns true if the caller now owns it
+ * (state active) and should flush it.
+ */
+static bool
+tcache_idle_reclaim_step(tsdn_t *tsdn, tcache_slow_t *tcache_slow,
+    const nstime_t *now, uint64_t idle_ns) {
+	tsd_t   *owner = tcache_slow->owner;
+	uint64_t activity = *tsd_thread_allocatedp_get_unsafe(owner)
+	    + *tsd_thread_deallocatedp_get_unsafe(owner);
+	uint8_t  state = atomic_load_u8(
+            &tcache_slow->reclaim_state, ATOMIC_ACQUIRE);
+	if (state & tcache_reclaim_active) {
+		return false;
+	}
+
+	if (activity != tcache_slow->idle_activity
+	    || nstime_compare(now, &tcache_slow->idle_since) < 0) {
+		tcache_slow->idle_activity = activity;
+		nstime_copy(&tcache_slow->idle_since, now);
+		tcache_slow->idle_reclaimed = false;
+		if (state & tcache_reclaim_pending) {
+			/* The owner may have cancelled already; that's fine. */
+			atomic_fetch_and_u8(&tcache_slow->reclaim_state,
+			    (uint8_t)~tcache_reclaim_pending, ATOMIC_RELAXED);
+		}
+		return false;
+	}
+	/*
+	 * Strictly more than idle_ns, so that the phases are always at least
+	 * one background thread sleep apart, even with a 0 setting.
+	 */
+	if (tcache_slow->idle_reclaimed
+	    || nstime_ns(now) - nstime_ns(&tcache_slow->idle_since)
+	        <= idle_ns) {
+		return false;
+	}
+
+	/* Idle for long enough; restart the clock for the next phase. */
+	nstime_copy(&tcache_slow->idle_since, now);
+	if (!(state & tcache_reclaim_pending)) {
+		atomic_fetch_or_u8(&tcache_slow->reclaim_state,
+		    tcache_reclaim_pending, ATOMIC_RELEASE);
+		if (tsd_force_recompute_one(tsdn, owner)) {
+			/* Owner is not nominal, i.e. about to go away. */
+			atomic_fetch_and_u8(&tcache_slow->reclaim_state,
+			    (uint8_t)~tcache_reclaim_pending, ATOMIC_RELAXED);
+		}
+		return false;
+	}
+	uint8_t expected = tcache_reclaim_pending;
+	if (!atomic_compare_exchange_strong_u8(&tcache_slow->reclaim_state,
+	        &expected, tcache_reclaim_active, ATOMIC_ACQ_REL,
+	        ATOMIC_RELAXED)) {
+		/* Cancelled by the owner, or the owner is busy. */
+		return false;
+	}
+	tcache_slow->idle_reclaimed = true;
+	return true;
+}
+
+void
+tcache_idle_reclaim(tsd_t *tsd, arena_t *arena) {
+	uint64_t idle_ns = tcache_idle_reclaim_interval_ns();
+	if (idle_ns == BACKGROUND_THREAD_DEFERRED_MAX) {
+		return;
+	}
+	tsdn_t  *tsdn = tsd_tsdn(tsd);
+	nstime_t now;
+	nstime_init_update(&now);
+
+	tcache_slow_t *victims[TCACHE_IDLE_RECLAIM_BATCH];
+	unsigned       nvictims;
+	do {
+		nvictims = 0;
+		malloc_mutex_lock(tsdn, &arena->tcache_ql_mtx);
+		tcache_slow_t *tcache_slow;
+		ql_foreach (tcache_slow, &arena->tcache_ql, link) {
+			if (tcache_slow->owner == NULL
+			    || !tcache_idle_reclaim_step(
+			        tsdn, tcache_slow, &now, idle_ns)) {
+				continue;
+			}
+			victims[nvictims++] = tcache_slow;
+			if (nvictims == TCACHE_IDLE_RECLAIM_BATCH) {
+				break;
+			}
+		}
+		malloc_mutex_unlock(tsdn, &arena->tcache_ql_mtx);
+
+		/*
+		 * The owners cannot dissociate (or do anything else with their
+		 * tcaches) until the state goes back to none.
+		 */
+		for (unsigned i = 0; i < nvictims; i++) {
+			tcache_flush_cache(tsd, victims[i]->tcache);
+			atomic_fetch_and_u8(&victims[i]->reclaim_state,
+			    (uint8_t)~tcache_reclaim_active, ATOMIC_RELEASE);
+		}
+	} while (nvictims == TCACHE_IDLE_RECLAIM_BATCH);
+}
+
 void
 tcache_stats_merge(tsdn_t *tsdn, tcache_t *tcache, arena_t *arena) {
 	cassert(config_stats);
 
-	/* Merge and reset tcache stats. */
+	/*
+	 * Merge and reset tcache stats; they are just dropped if the arena
+	 * doesn't keep stats.
+	 */
+	bool merge = arena_stats_enabled_get(arena);
 	for (unsigned i = 0; i < tcache_nbins_get(tcache->tcache_slow); i++) {
 		cache_bin_t *cache_bin = &tcache->bins[i];
 		if (tcache_bin_disabled(i, cache_bin, tcache->tcache_slow)) {
 			continue;
 		}
-		if (i < SC_NBINS) {
+		if (merge && i < SC_NBINS) {
 			bin_t *bin = arena_bin_choose(tsdn, arena, i, NULL);
 			malloc_mutex_lock(tsdn, &bin->lock);
 			bin->stats.nrequests += cache_bin->tstats.nrequests;
 			malloc_mutex_unlock(tsdn, &bin->lock);
-		} else {
+		} else if (merge) {
 			arena_stats_large_flush_nrequests_add(tsdn,
 			    &arena->stats, i, cache_bin->tstats.nrequests);
 		}
@@ -1413,22 +1939,33 @@ tcache_boot(tsdn_t *tsdn, base_t *base) {
 	        malloc_mutex_rank_exclusive)) {
 		return true;
 	}
+	if (malloc_mutex_init(&tcache_pool_mtx, "tcache_pool",
+	        WITNESS_RANK_TCACHE_POOL, malloc_mutex_rank_exclusive)) {
+		return true;
+	}
 
 	return false;
 }
 
 void
-tcache_prefork(tsdn_t *tsdn) {
+tcache_prefork0(tsdn_t *tsdn) {
 	malloc_mutex_prefork(tsdn, &tcaches_mtx);
 }
 
+void
+tcache_prefork1(tsdn_t *tsdn) {
+	malloc_mutex_prefork(tsdn, &tcache_pool_mtx);
+}
+
 void
 tcache_postfork_parent(tsdn_t *tsdn) {
+	malloc_mutex_postfork_parent(tsdn, &tcache_pool_mtx);
 	malloc_mutex_postfork_parent(tsdn, &tcaches_mtx);
 }
 
 void
 tcache_postfork_child(tsdn_t *tsdn) {
+	malloc_mutex_postfork_child(tsdn, &tcache_pool_mtx);
 	malloc_mutex_postfork_child(tsdn, &tcaches_mtx);
 }
 
@@ -4,6 +4,7 @@
 #include "jemalloc/internal/thread_event.h"
 #include "jemalloc/internal/thread_event_registry.h"
 #include "jemalloc/internal/peak_event.h"
+#include "jemalloc/internal/latency.h"
 
 static bool
 te_ctx_has_active_events(te_ctx_t *ctx) {
@@ -299,6 +300,17 @@ te_update_alloc_events(tsd_t *tsd, te_base_cb_t **to_trigger,
 		to_trigger[nto_trigger++] =
 		    te_alloc_handlers[te_alloc_prof_threshold];
 	}
+
+	if (opt_stats_latency_sample >= 0) {
+		assert(te_enabled_yes
+		    == te_alloc_handlers[te_alloc_latency_sample]->enabled());
+		if (te_update_wait(tsd, accumbytes, allow,
+		        &waits[te_alloc_latency_sample], wait,
+		        te_alloc_handlers[te_alloc_latency_sample], 0)) {
+			to_trigger[nto_trigger++] =
+			    te_alloc_handlers[te_alloc_latency_sample];
+		}
+	}
 #endif
 
 	for (te_alloc_t ue = te_alloc_user0; ue <= te_alloc_user3; ue++) {
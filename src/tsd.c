@@ -125,6 +125,27 @@ tsd_force_recompute(tsdn_t *tsdn) {
 	malloc_mutex_unlock(tsdn, &tsd_nominal_tsds_lock);
 }
 
+/*
+ * Like tsd_force_recompute(), for a single tsd.  Returns true (and does nothing)
+ * if the tsd is not in a nominal state.
+ */
+bool
+tsd_force_recompute_one(tsdn_t *tsdn, tsd_t *tsd) {
+	atomic_fence(ATOMIC_RELEASE);
+	malloc_mutex_lock(tsdn, &tsd_nominal_tsds_lock);
+	bool err = tsd_atomic_load(&tsd->state, ATOMIC_RELAXED)
+	    > tsd_state_nominal_max;
+	if (!err) {
+		tsd_atomic_store(
+		    &tsd->state, tsd_state_nominal_recompute, ATOMIC_RELAXED);
+		/* See comments in te_recompute_fast_threshold(). */
+		atomic_fence(ATOMIC_SEQ_CST);
+		te_next_event_fast_set_non_nominal(tsd);
+	}
+	malloc_mutex_unlock(tsdn, &tsd_nominal_tsds_lock);
+	return err;
+}
+
 void
 tsd_global_slow_inc(tsdn_t *tsdn) {
 	atomic_fetch_add_u32(&tsd_global_slow_count, 1, ATOMIC_RELAXED);
@@ -284,13 +305,20 @@ tsd_fetch_slow(tsd_t *tsd, bool minimal) {
 
 	if (tsd_state_get(tsd) == tsd_state_nominal_slow) {
 		/*
-		 * On slow path but no work needed.  Note that we can't
-		 * necessarily *assert* that we're slow, because we might be
-		 * slow because of an asynchronous modification to global state,
-		 * which might be asynchronously modified *back*.
+		 * On slow path but no work needed, other than checking for an
+		 * idle tcache reclaim.  Note that we can't necessarily *assert*
+		 * that we're slow, because we might be slow because of an
+		 * asynchronous modification to global state, which might be
+		 * asynchronously modified *back*.
 		 */
+		tcache_idle_reclaim_sync(tsd);
 	} else if (tsd_state_get(tsd) == tsd_state_nominal_recompute) {
 		tsd_slow_update(tsd);
+		/*
+		 * After the update, so that a reclaim started concurrently
+		 * either gets cancelled here, or leaves us non-nominal.
+		 */
+		tcache_idle_reclaim_sync(tsd);
 	} else if (tsd_state_get(tsd) == tsd_state_uninitialized) {
 		if (!minimal) {
 			if (tsd_booted) {
@@ -396,10 +424,18 @@ _malloc_tsd_cleanup_register(bool (*f)(void)) {
 
 static void
 tsd_do_data_cleanup(tsd_t *tsd) {
+	/*
+	 * Thread exit does not go through tsd_fetch_slow(); make sure the
+	 * background thread is not flushing our tcache, and won't start to.
+	 */
+	tcache_idle_reclaim_exit(tsd);
 	prof_tdata_cleanup(tsd);
 	iarena_cleanup(tsd);
 	arena_cleanup(tsd);
 	tcache_cleanup(tsd);
+	if (config_stats) {
+		alloc_tag_flush(tsd);
+	}
 	witnesses_cleanup(tsd_witness_tsdp_get_unsafe(tsd));
 	*tsd_reentrancy_levelp_get(tsd) = 1;
 }
@@ -425,6 +461,11 @@ tsd_cleanup(void *arg) {
 		JEMALLOC_FALLTHROUGH;
 	case tsd_state_nominal:
 	case tsd_state_nominal_slow:
+	case tsd_state_nominal_recompute:
+		/*
+		 * Recompute is left by a forced recompute (e.g. for an idle
+		 * tcache reclaim) if the thread exits without calling in again.
+		 */
 		tsd_do_data_cleanup(tsd);
 		tsd_state_set(tsd, tsd_state_purgatory);
 		tsd_set(tsd);
@@ -0,0 +1,297 @@
+#include "test/jemalloc_test.h"
+
+#include "jemalloc/internal/emitter.h"
+#include "jemalloc/internal/prof_log.h"
+
+#include <stdio.h>
+
+/*
+ * Converts a binary allocation log (see opt_prof_log_binary) to the JSON that
+ * prof.log_stop writes otherwise:
+ *
+ *   prof_log_json <log file>
+ *
+ * The records are gone through once for each part of the JSON; the info comes
+ * first there, but its duration is only known from the end record.
+ */
+
+typedef struct {
+	const uint8_t *buf;
+	size_t         len;
+	size_t         pos;
+	bool           error;
+} reader_t;
+
+static uint64_t
+read_varint(reader_t *r) {
+	uint64_t v = 0;
+	for (unsigned shift = 0; shift < 64 && r->pos < r->len; shift += 7) {
+		uint8_t b = r->buf[r->pos++];
+		v |= (uint64_t)(b & 0x7f) << shift;
+		if ((b & 0x80) == 0) {
+			return v;
+		}
+	}
+	r->error = true;
+	return 0;
+}
+
+/* Copies a string into str, truncating it to fit. */
+static void
+read_str(reader_t *r, char *str, size_t str_size) {
+	uint64_t len = read_varint(r);
+	if (r->error || len > r->len - r->pos) {
+		r->error = true;
+		str[0] = '\0';
+		return;
+	}
+	size_t n = len < str_size - 1 ? (size_t)len : str_size - 1;
+	memcpy(str, &r->buf[r->pos], n);
+	str[n] = '\0';
+	r->pos += len;
+}
+
+#define STR_MAX 256
+
+typedef struct {
+	prof_log_record_t type;
+	/* Info. */
+	char     version[STR_MAX];
+	uint64_t lg_sample_rate;
+	char     time_resolution[STR_MAX];
+	uint64_t pid;
+	/* Thread. */
+	uint64_t thr_uid;
+	char     thr_name[STR_MAX];
+	/* Trace; the frames are read by the caller. */
+	uint64_t nframes;
+	/* Alloc, with the fields in log order. */
+	uint64_t alloc[7];
+	/* End. */
+	uint64_t duration;
+} record_t;
+
+static const char *alloc_keys[7] = {"alloc_thread", "free_thread",
+    "alloc_trace", "free_trace", "alloc_timestamp", "free_timestamp",
+    "usize"};
+
+/* Returns false at the end of the log, or on a malformed record. */
+static bool
+read_record(reader_t *r, record_t *rec) {
+	if (r->error || r->pos == r->len) {
+		return false;
+	}
+	rec->type = (prof_log_record_t)r->buf[r->pos++];
+	switch (rec->type) {
+	case prof_log_record_info:
+		read_str(r, rec->version, sizeof(rec->version));
+		rec->lg_sample_rate = read_varint(r);
+		read_str(r, rec->time_resolution, sizeof(rec->time_resolution));
+		rec->pid = read_varint(r);
+		break;
+	case prof_log_record_thread:
+		rec->thr_uid = read_varint(r);
+		read_str(r, rec->thr_name, sizeof(rec->thr_name));
+		break;
+	case prof_log_record_trace:
+		rec->nframes = read_varint(r);
+		break;
+	case prof_log_record_alloc:
+		for (unsigned i = 0; i < 7; i++) {
+			rec->alloc[i] = read_varint(r);
+		}
+		break;
+	case prof_log_record_end:
+		rec->duration = read_varint(r);
+		break;
+	default:
+		r->error = true;
+	}
+	return !r->error;
+}
+
+static void
+reader_init(reader_t *r, const uint8_t *buf, size_t len) {
+	r->buf = buf;
+	r->len = len;
+	r->pos = PROF_LOG_BINARY_MAGIC_LEN;
+	r->error = false;
+}
+
+static void
+skip_frames(reader_t *r, uint64_t nframes) {
+	for (uint64_t i = 0; i < nframes && !r->error; i++) {
+		read_varint(r);
+	}
+}
+
+static void
+write_cb(void *opaque, const char *str) {
+	fputs(str, (FILE *)opaque);
+}
+
+static bool
+emit_json(const uint8_t *buf, size_t len) {
+	reader_t r;
+	record_t rec;
+	bool     have_info = false;
+	record_t info = {0};
+	uint64_t duration = 0;
+	bool     have_end = false;
+	uint64_t nthreads = 0;
+	uint64_t ntraces = 0;
+
+	/* Check the log as a whole first, and get the info and the duration. */
+	reader_init(&r, buf, len);
+	while (read_record(&r, &rec)) {
+		switch (rec.type) {
+		case prof_log_record_info:
+			have_info = true;
+			info = rec;
+			break;
+		case prof_log_record_thread:
+			nthreads++;
+			break;
+		case prof_log_record_trace:
+			skip_frames(&r, rec.nframes);
+			ntraces++;
+			break;
+		case prof_log_record_alloc:
+			if (rec.alloc[0] >= nthreads || rec.alloc[1] >= nthreads
+			    || rec.alloc[2] >= ntraces
+			    || rec.alloc[3] >= ntraces) {
+				fprintf(stderr, "Undefined thread or trace\n");
+				return true;
+			}
+			break;
+		case prof_log_record_end:
+			have_end = true;
+			duration = rec.duration;
+			break;
+		}
+	}
+	if (r.error || !have_info) {
+		fprintf(stderr, "Malformed log\n");
+		return true;
+	}
+	if (!have_end) {
+		fprintf(stderr, "Log cut short; no duration\n");
+	}
+
+	emitter_t emitter;
+	emitter_init(&emitter, emitter_output_json_compact, write_cb, stdout);
+	emitter_begin(&emitter);
+
+	emitter_json_object_kv_begin(&emitter, "info");
+	emitter_json_kv(&emitter, "duration", emitter_type_uint64, &duration);
+	const char *str = info.version;
+	emitter_json_kv(&emitter, "version", emitter_type_string, &str);
+	int lg_sample_rate = (int)info.lg_sample_rate;
+	emitter_json_kv(
+	    &emitter, "lg_sample_rate", emitter_type_int, &lg_sample_rate);
+	str = info.time_resolution;
+	emitter_json_kv(
+	    &emitter, "prof_time_resolution", emitter_type_string, &str);
+	int pid = (int)info.pid;
+	emitter_json_kv(&emitter, "pid", emitter_type_int, &pid);
+	emitter_json_object_end(&emitter);
+
+	emitter_json_array_kv_begin(&emitter, "threads");
+	reader_init(&r, buf, len);
+	while (read_record(&r, &rec)) {
+		if (rec.type == prof_log_record_trace) {
+			skip_frames(&r, rec.nframes);
+		}
+		if (rec.type != prof_log_record_thread) {
+			continue;
+		}
+		emitter_json_object_begin(&emitter);
+		emitter_json_kv(
+		    &emitter, "thr_uid", emitter_type_uint64, &rec.thr_uid);
+		str = rec.thr_name;
+		emitter_json_kv(
+		    &emitter, "thr_name", emitter_type_string, &str);
+		emitter_json_object_end(&emitter);
+	}
+	emitter_json_array_end(&emitter);
+
+	emitter_json_array_kv_begin(&emitter, "stack_traces");
+	reader_init(&r, buf, len);
+	char frame[2 * sizeof(intptr_t) + 3];
+	while (read_record(&r, &rec)) {
+		if (rec.type != prof_log_record_trace) {
+			continue;
+		}
+		emitter_json_array_begin(&emitter);
+		for (uint64_t i = 0; i < rec.nframes; i++) {
+			malloc_snprintf(frame, sizeof(frame), "%p",
+			    (void *)(uintptr_t)read_varint(&r));
+			str = frame;
+			emitter_json_value(&emitter, emitter_type_string, &str);
+		}
+		emitter_json_array_end(&emitter);
+	}
+	emitter_json_array_end(&emitter);
+
+	emitter_json_array_kv_begin(&emitter, "allocations");
+	reader_init(&r, buf, len);
+	while (read_record(&r, &rec)) {
+		if (rec.type == prof_log_record_trace) {
+			skip_frames(&r, rec.nframes);
+		}
+		if (rec.type != prof_log_record_alloc) {
+			continue;
+		}
+		emitter_json_object_begin(&emitter);
+		for (unsigned i = 0; i < 7; i++) {
+			emitter_json_kv(&emitter, alloc_keys[i],
+			    emitter_type_uint64, &rec.alloc[i]);
+		}
+		emitter_json_object_end(&emitter);
+	}
+	emitter_json_array_end(&emitter);
+
+	emitter_end(&emitter);
+	return false;
+}
+
+int
+main(int argc, char **argv) {
+	if (argc != 2) {
+		/* E.g. run by "make analyze"; there's nothing to convert. */
+		fprintf(stderr, "Usage: %s <log file>\n", argv[0]);
+		return test_status_skip;
+	}
+
+	FILE *f = fopen(argv[1], "rb");
+	if (f == NULL) {
+		fprintf(stderr, "Can't open %s\n", argv[1]);
+		return test_status_fail;
+	}
+	size_t   size = 0;
+	size_t   len = 0;
+	uint8_t *buf = NULL;
+	do {
+		if (len == size) {
+			size = size == 0 ? 65536 : 2 * size;
+			buf = (uint8_t *)realloc(buf, size);
+			if (buf == NULL) {
+				fprintf(stderr, "Out of memory\n");
+				return test_status_fail;
+			}
+		}
+		len += fread(&buf[len], 1, size - len, f);
+	} while (len == size);
+	fclose(f);
+
+	if (len < PROF_LOG_BINARY_MAGIC_LEN
+	    || memcmp(buf, PROF_LOG_BINARY_MAGIC, PROF_LOG_BINARY_MAGIC_LEN)
+	        != 0) {
+		fprintf(stderr, "Not a binary profiling log\n");
+		free(buf);
+		return test_status_fail;
+	}
+	bool err = emit_json(buf, len);
+	free(buf);
+	return err ? test_status_fail : test_status_pass;
+}
@@ -0,0 +1,250 @@
+#include "test/jemalloc_test.h"
+
+#define SZ (1U << 20)
+#define SZ_SMALL 1024U
+
+static void
+tag_set(unsigned tag) {
+	expect_d_eq(mallctl("thread.tag", NULL, NULL, &tag, sizeof(tag)), 0,
+	    "Unexpected mallctl failure setting thread.tag");
+}
+
+static void
+tag_read(unsigned tag, uint64_t *allocated, uint64_t *deallocated,
+    int64_t *live) {
+	uint64_t epoch = 1;
+	expect_d_eq(mallctl("epoch", NULL, NULL, &epoch, sizeof(epoch)), 0,
+	    "Unexpected mallctl failure");
+
+	char   name[64];
+	size_t sz = sizeof(uint64_t);
+	malloc_snprintf(name, sizeof(name), "stats.tags.%u.allocated", tag);
+	expect_d_eq(mallctl(name, allocated, &sz, NULL, 0), 0,
+	    "Unexpected mallctl failure for %s", name);
+	malloc_snprintf(name, sizeof(name), "stats.tags.%u.deallocated", tag);
+	expect_d_eq(mallctl(name, deallocated, &sz, NULL, 0), 0,
+	    "Unexpected mallctl failure for %s", name);
+	sz = sizeof(int64_t);
+	malloc_snprintf(name, sizeof(name), "stats.tags.%u.live", tag);
+	expect_d_eq(mallctl(name, live, &sz, NULL, 0), 0,
+	    "Unexpected mallctl failure for %s", name);
+}
+
+TEST_BEGIN(test_alloc_tag_mallctl) {
+	test_skip_if(!config_stats);
+
+	unsigned tag;
+	size_t   sz = sizeof(tag);
+	expect_d_eq(mallctl("thread.tag", &tag, &sz, NULL, 0), 0,
+	    "Unexpected mallctl failure");
+	expect_u_eq(tag, 0, "Threads should start out untagged");
+
+	unsigned bad = 32;
+	expect_d_eq(mallctl("thread.tag", NULL, NULL, &bad, sizeof(bad)),
+	    EINVAL, "Out of range tag should be rejected");
+	uint64_t u64;
+	sz = sizeof(u64);
+	expect_d_eq(mallctl("stats.tags.32.allocated", &u64, &sz, NULL, 0),
+	    ENOENT, "Out of range tag should not exist");
+
+	unsigned old, new = 3;
+	sz = sizeof(old);
+	expect_d_eq(mallctl("thread.tag", &old, &sz, &new, sizeof(new)), 0,
+	    "Unexpected mallctl failure");
+	expect_u_eq(old, 0, "Should read the previous tag");
+	expect_d_eq(mallctl("thread.tag", &tag, &sz, NULL, 0), 0,
+	    "Unexpected mallctl failure");
+	expect_u_eq(tag, 3, "Tag not updated");
+	tag_set(0);
+}
+TEST_END
+
+static char   stats_buf[1 << 16];
+static size_t stats_len;
+
+static void
+stats_write_cb(void *opaque, const char *str) {
+	size_t n = strlen(str);
+	if (n > sizeof(stats_buf) - 1 - stats_len) {
+		n = sizeof(stats_buf) - 1 - stats_len;
+	}
+	memcpy(&stats_buf[stats_len], str, n);
+	stats_len += n;
+	stats_buf[stats_len] = '\0';
+}
+
+/* Prints the global stats only, i.e. also the tags. */
+static void
+tag_stats_print(void) {
+	uint64_t epoch = 1;
+	expect_d_eq(mallctl("epoch", NULL, NULL, &epoch, sizeof(epoch)), 0,
+	    "Unexpected mallctl failure");
+	stats_len = 0;
+	stats_buf[0] = '\0';
+	malloc_stats_print(stats_write_cb, NULL, "mdablxeh");
+}
+
+TEST_BEGIN(test_alloc_tag_stats_print) {
+	test_skip_if(!config_stats);
+
+	void *p = mallocx(SZ, 0);
+	expect_ptr_not_null(p, "Unexpected mallocx failure");
+	if (!test_is_reentrant()) {
+		/* The first run, before any thread switched tags. */
+		tag_stats_print();
+		expect_ptr_null(strstr(stats_buf, "Tag "),
+		    "Untagged applications shouldn't get tag stats");
+	}
+
+	tag_set(5);
+	dallocx(mallocx(SZ, 0), 0);
+	tag_set(0);
+	tag_stats_print();
+	expect_ptr_not_null(strstr(stats_buf, "\nTag 0: "),
+	    "Tag 0 should be listed once tags are in use");
+	expect_ptr_not_null(strstr(stats_buf, "\nTag 5: "), "Missing tag 5");
+	expect_ptr_null(strstr(stats_buf, "\nTag 6: "),
+	    "Tags without activity shouldn't be listed");
+	dallocx(p, 0);
+}
+TEST_END
+
+TEST_BEGIN(test_alloc_tag_accounting) {
+	test_skip_if(!config_stats);
+
+	uint64_t allocated0, deallocated0, allocated, deallocated;
+	int64_t  live0, live;
+	tag_read(1, &allocated0, &deallocated0, &live0);
+
+	tag_set(1);
+	void *p = mallocx(SZ_SMALL, 0);
+	expect_ptr_not_null(p, "Unexpected mallocx failure");
+	tag_read(1, &allocated, &deallocated, &live);
+	expect_u64_ge(allocated - allocated0, SZ_SMALL,
+	    "Allocation not charged");
+	expect_u64_eq(deallocated, deallocated0, "Nothing was deallocated");
+	expect_d64_ge(live - live0, SZ_SMALL, "Live bytes not charged");
+
+	/* Small objects are charged to the tag current at free time. */
+	tag_set(2);
+	uint64_t allocated2, deallocated2;
+	int64_t  live2;
+	tag_read(2, &allocated2, &deallocated2, &live2);
+	dallocx(p, 0);
+	tag_read(1, &allocated0, &deallocated0, &live0);
+	expect_u64_eq(allocated0, allocated, "Tag 1 should be untouched");
+	expect_u64_eq(deallocated0, deallocated, "Tag 1 should be untouched");
+	tag_read(2, &allocated, &deallocated, &live);
+	expect_u64_ge(deallocated - deallocated2, SZ_SMALL,
+	    "Deallocation not charged to the current tag");
+	expect_d64_le(live, live2 - SZ_SMALL, "Live bytes should go down");
+	tag_set(0);
+}
+TEST_END
+
+TEST_BEGIN(test_alloc_tag_large) {
+	test_skip_if(!config_stats);
+
+	uint64_t allocated0, deallocated0, allocated, deallocated;
+	uint64_t allocated2, deallocated2;
+	int64_t  live0, live, live2;
+
+	tag_set(1);
+	tag_read(1, &allocated0, &deallocated0, &live0);
+	void *p = mallocx(SZ, 0);
+	expect_ptr_not_null(p, "Unexpected mallocx failure");
+	/* Grown in place or moved, it stays with tag 1. */
+	p = rallocx(p, 2 * SZ, 0);
+	expect_ptr_not_null(p, "Unexpected rallocx failure");
+
+	/* Large objects are debited from the tag they were allocated under. */
+	tag_set(2);
+	tag_read(2, &allocated2, &deallocated2, &live2);
+	dallocx(p, 0);
+	tag_read(2, &allocated, &deallocated, &live);
+	expect_u64_eq(allocated, allocated2, "Tag 2 allocated nothing");
+	expect_u64_lt(deallocated - deallocated2, SZ,
+	    "Large frees shouldn't be charged to the current tag");
+	tag_read(1, &allocated, &deallocated, &live);
+	expect_u64_ge(allocated - allocated0, 3 * SZ, "Allocations missing");
+	expect_u64_ge(deallocated - deallocated0, 3 * SZ,
+	    "Large frees should be charged to the allocating tag");
+	expect_d64_lt(live - live0, SZ, "Live bytes should be back");
+	tag_set(0);
+}
+TEST_END
+
+TEST_BEGIN(test_alloc_tag_large_tcache) {
+	test_skip_if(!config_stats);
+
+	size_t   sz = SC_LARGE_MINCLASS;
+	int64_t  live5_0, live6_0, live5, live6;
+	uint64_t allocated, deallocated;
+	tag_read(5, &allocated, &deallocated, &live5_0);
+	tag_read(6, &allocated, &deallocated, &live6_0);
+
+	tag_set(5);
+	void *p = mallocx(sz, 0);
+	expect_ptr_not_null(p, "Unexpected mallocx failure");
+	dallocx(p, 0);
+	/* Served from the tcache, it has to be recharged to tag 6. */
+	tag_set(6);
+	void *q = mallocx(sz, 0);
+	expect_ptr_not_null(q, "Unexpected mallocx failure");
+	if (opt_tcache && !test_is_reentrant()) {
+		expect_ptr_eq(p, q, "Expected the object to be reused");
+	}
+	dallocx(q, 0);
+	tag_set(0);
+
+	tag_read(5, &allocated, &deallocated, &live5);
+	tag_read(6, &allocated, &deallocated, &live6);
+	expect_d64_lt(live5 - live5_0, (int64_t)sz, "Tag 5 leaked bytes");
+	expect_d64_gt(live5 - live5_0, -(int64_t)sz, "Tag 5 was overdebited");
+	expect_d64_lt(live6 - live6_0, (int64_t)sz, "Tag 6 leaked bytes");
+	expect_d64_gt(live6 - live6_0, -(int64_t)sz, "Tag 6 was overdebited");
+}
+TEST_END
+
+static void *
+thd_start(void *arg) {
+	tag_set(4);
+	/* Leaked on purpose; only the thread exit reports it. */
+	void *p = mallocx(SZ, 0);
+	expect_ptr_not_null(p, "Unexpected mallocx failure");
+	*(void **)arg = p;
+	return NULL;
+}
+
+TEST_BEGIN(test_alloc_tag_thread_exit) {
+	test_skip_if(!config_stats);
+
+	uint64_t allocated0, deallocated0, allocated, deallocated;
+	int64_t  live0, live;
+	tag_read(4, &allocated0, &deallocated0, &live0);
+
+	thd_t thd;
+	void *p;
+	thd_create(&thd, thd_start, &p);
+	thd_join(thd, NULL);
+
+	tag_read(4, &allocated, &deallocated, &live);
+	expect_u64_ge(allocated - allocated0, SZ,
+	    "Exiting threads should report their activity");
+	expect_d64_ge(live - live0, SZ, "The object is still live");
+
+	/* Freed by another thread, it's still debited from tag 4. */
+	dallocx(p, 0);
+	tag_read(4, &allocated0, &deallocated0, &live0);
+	expect_u64_ge(deallocated0 - deallocated, SZ,
+	    "Cross-thread free not debited from the allocating tag");
+	expect_d64_le(live0, live - SZ, "Live bytes should go down");
+}
+TEST_END
+
+int
+main(void) {
+	return test(test_alloc_tag_stats_print, test_alloc_tag_mallctl,
+	    test_alloc_tag_accounting, test_alloc_tag_large,
+	    test_alloc_tag_large_tcache, test_alloc_tag_thread_exit);
+}
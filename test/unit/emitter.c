@@ -564,9 +564,67 @@ GENERATE_TEST(json_array)
 GENERATE_TEST(json_nested_array)
 GENERATE_TEST(table_row)
 
+static void
+emit_openmetrics(emitter_t *emitter) {
+	unsigned u = 7;
+	uint64_t u64 = 1234;
+	size_t   zu = 4096;
+
+	emitter_begin(emitter);
+	/* Everything but the metric calls is silent. */
+	emitter_json_object_kv_begin(emitter, "dict");
+	emitter_kv(emitter, "k", "K", emitter_type_unsigned, &u);
+	emitter_table_printf(emitter, "table\n");
+	emitter_json_object_end(emitter);
+
+	emitter_metric_family_begin(emitter, "threads",
+	    emitter_metric_type_gauge, "Number of threads.");
+	emitter_metric_sample(emitter, NULL, emitter_type_unsigned, &u);
+	emitter_metric_family_begin(
+	    emitter, "nmalloc", emitter_metric_type_counter, NULL);
+	emitter_metric_sample(
+	    emitter, "arena=\"0\"", emitter_type_uint64, &u64);
+	emitter_metric_sample(
+	    emitter, "arena=\"1\",size=\"8\"", emitter_type_size, &zu);
+	emitter_end(emitter);
+}
+
+static const char *openmetrics_output =
+    "# TYPE jemalloc_threads gauge\n"
+    "# HELP jemalloc_threads Number of threads.\n"
+    "jemalloc_threads 7\n"
+    "# TYPE jemalloc_nmalloc counter\n"
+    "jemalloc_nmalloc_total{arena=\"0\"} 1234\n"
+    "jemalloc_nmalloc_total{arena=\"1\",size=\"8\"} 4096\n"
+    "# EOF\n";
+
+TEST_BEGIN(test_openmetrics) {
+	emitter_t        emitter;
+	char             buf[MALLOC_PRINTF_BUFSIZE];
+	buf_descriptor_t buf_descriptor;
+
+	buf_descriptor.buf = buf;
+	buf_descriptor.len = MALLOC_PRINTF_BUFSIZE;
+	buf_descriptor.mid_quote = false;
+
+	emitter_init(&emitter, emitter_output_openmetrics, &forwarding_cb,
+	    &buf_descriptor);
+	emit_openmetrics(&emitter);
+	expect_str_eq(openmetrics_output, buf, "openmetrics output failure");
+
+	/* And the metric calls are silent in the other modes. */
+	buf_descriptor.buf = buf;
+	buf_descriptor.len = MALLOC_PRINTF_BUFSIZE;
+	emitter_init(
+	    &emitter, emitter_output_table, &forwarding_cb, &buf_descriptor);
+	emit_openmetrics(&emitter);
+	expect_str_eq("K: 7\ntable\n", buf, "table output failure");
+}
+TEST_END
+
 int
 main(void) {
 	return test_no_reentrancy(test_dict, test_table_printf,
 	    test_nested_dict, test_types, test_modal, test_json_array,
-	    test_json_nested_array, test_table_row);
+	    test_json_nested_array, test_table_row, test_openmetrics);
 }
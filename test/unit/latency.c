@@ -0,0 +1,196 @@
+#include "test/jemalloc_test.h"
+
+#include "jemalloc/internal/latency.h"
+
+TEST_BEGIN(test_latency_buckets) {
+	for (unsigned i = 0; i < LATENCY_NBUCKETS; i++) {
+		uint64_t lower = latency_bucket_lower_ns(i);
+		expect_u_eq(latency_bucket_ind(lower), i,
+		    "Lower bound of bucket %u maps to another bucket", i);
+		if (i + 1 < LATENCY_NBUCKETS) {
+			uint64_t next = latency_bucket_lower_ns(i + 1);
+			expect_u64_lt(lower, next,
+			    "Bucket bounds should be increasing");
+			expect_u_eq(latency_bucket_ind(next - 1), i,
+			    "Upper bound of bucket %u maps to another bucket",
+			    i);
+			/* The relative width is bounded by the sub-buckets. */
+			expect_u64_le((next - lower) * LATENCY_NSUB,
+			    lower < LATENCY_NSUB ? LATENCY_NSUB : lower,
+			    "Bucket %u is too wide", i);
+		}
+	}
+	expect_u_eq(latency_bucket_ind(UINT64_MAX), LATENCY_NBUCKETS - 1,
+	    "Huge durations should be clamped into the last bucket");
+	expect_u_eq(latency_bucket_ind((uint64_t)1 << LATENCY_LG_MAX),
+	    LATENCY_NBUCKETS - 1,
+	    "Huge durations should be clamped into the last bucket");
+}
+TEST_END
+
+static void
+hist_add(latency_hist_t *hist, uint64_t ns, uint64_t n) {
+	locked_inc_u64_unsynchronized(&hist->count, n);
+	locked_inc_u64_unsynchronized(&hist->total_ns, ns * n);
+	locked_inc_u64_unsynchronized(&hist->buckets[latency_bucket_ind(ns)], n);
+}
+
+TEST_BEGIN(test_latency_quantile) {
+	latency_hist_t hist;
+	memset(&hist, 0, sizeof(hist));
+	expect_u64_eq(latency_hist_quantile_ns(&hist, 500000), 0,
+	    "Empty histograms have no quantiles");
+
+	hist_add(&hist, 100, 990);
+	hist_add(&hist, 10000, 9);
+	hist_add(&hist, 1000000, 1);
+
+	uint64_t p50 = latency_hist_quantile_ns(&hist, 500000);
+	uint64_t p99 = latency_hist_quantile_ns(&hist, 990000);
+	uint64_t p999 = latency_hist_quantile_ns(&hist, 999000);
+	uint64_t p100 = latency_hist_quantile_ns(&hist, 1000000);
+
+	expect_u_eq(latency_bucket_ind(p50), latency_bucket_ind(100),
+	    "Wrong median");
+	expect_u64_ge(p50, 100, "Quantiles are bucket upper bounds");
+	expect_u_eq(latency_bucket_ind(p99), latency_bucket_ind(100),
+	    "Wrong 99th percentile");
+	expect_u_eq(latency_bucket_ind(p999), latency_bucket_ind(10000),
+	    "Wrong 99.9th percentile");
+	expect_u_eq(latency_bucket_ind(p100), latency_bucket_ind(1000000),
+	    "Wrong maximum");
+
+	latency_stats_t a, b;
+	memset(&a, 0, sizeof(a));
+	memset(&b, 0, sizeof(b));
+	hist_add(&a.hists[latency_site_pa_alloc], 100, 3);
+	hist_add(&b.hists[latency_site_pa_alloc], 200, 2);
+	latency_stats_accum(&a, &b);
+	expect_u64_eq(locked_read_u64_unsynchronized(
+	                  &a.hists[latency_site_pa_alloc].count),
+	    5, "Counts should be summed");
+	expect_u64_eq(locked_read_u64_unsynchronized(
+	                  &a.hists[latency_site_pa_alloc].total_ns),
+	    700, "Durations should be summed");
+}
+TEST_END
+
+static uint64_t
+latency_stat_get(unsigned arena_ind, const char *site, const char *leaf) {
+	char name[128];
+	malloc_snprintf(name, sizeof(name), "stats.arenas.%u.latency.%s.%s",
+	    arena_ind, site, leaf);
+	uint64_t v;
+	size_t   sz = sizeof(v);
+	expect_d_eq(mallctl(name, &v, &sz, NULL, 0), 0,
+	    "Unexpected mallctl failure for %s", name);
+	return v;
+}
+
+TEST_BEGIN(test_latency_mallctl) {
+	test_skip_if(!config_stats);
+
+	int64_t sample;
+	size_t  sz = sizeof(sample);
+	expect_d_eq(mallctl("opt.stats_latency_sample", &sample, &sz, NULL, 0),
+	    0, "Unexpected mallctl failure");
+	expect_d64_eq(sample, 0, "Unexpected opt.stats_latency_sample");
+
+	unsigned nbuckets;
+	sz = sizeof(nbuckets);
+	expect_d_eq(mallctl("arenas.nlatency_buckets", &nbuckets, &sz, NULL, 0),
+	    0, "Unexpected mallctl failure");
+	expect_u_eq(nbuckets, LATENCY_NBUCKETS, "Wrong number of buckets");
+
+	uint64_t lower;
+	sz = sizeof(lower);
+	expect_d_eq(mallctl("arenas.latency_bucket.5.lower_ns", &lower, &sz,
+	                NULL, 0),
+	    0, "Unexpected mallctl failure");
+	expect_u64_eq(lower, latency_bucket_lower_ns(5), "Wrong lower bound");
+	char name[64];
+	malloc_snprintf(name, sizeof(name), "arenas.latency_bucket.%u.lower_ns",
+	    nbuckets);
+	expect_d_eq(mallctl(name, &lower, &sz, NULL, 0), ENOENT,
+	    "Out of range bucket should not exist");
+
+	unsigned arena_ind;
+	sz = sizeof(arena_ind);
+	expect_d_eq(mallctl("arenas.create", &arena_ind, &sz, NULL, 0), 0,
+	    "Unexpected mallctl failure");
+
+	/*
+	 * Every allocation arms all the sites, so the operations below are all
+	 * timed; rearm them first in case creating the arena used some up.
+	 */
+	free(malloc(1));
+	void *p = mallocx(
+	    SC_LARGE_MINCLASS, MALLOCX_ARENA(arena_ind) | MALLOCX_TCACHE_NONE);
+	expect_ptr_not_null(p, "Unexpected mallocx failure");
+	expect_d_eq(mallctl("thread.tcache.flush", NULL, NULL, NULL, 0), 0,
+	    "Unexpected mallctl failure");
+	void *q = mallocx(1, MALLOCX_ARENA(arena_ind));
+	expect_ptr_not_null(q, "Unexpected mallocx failure");
+
+	uint64_t epoch = 1;
+	expect_d_eq(mallctl("epoch", NULL, NULL, &epoch, sizeof(epoch)), 0,
+	    "Unexpected mallctl failure");
+
+	expect_u64_gt(latency_stat_get(arena_ind, "large_alloc", "count"), 0,
+	    "Large allocation should have been sampled");
+	expect_u64_gt(latency_stat_get(arena_ind, "pa_alloc", "count"), 0,
+	    "Nested page allocation should have been sampled");
+	expect_u64_gt(latency_stat_get(arena_ind, "tcache_fill", "count"), 0,
+	    "tcache fill should have been sampled");
+
+	for (unsigned site = 0; site < latency_nsites; site++) {
+		const char *site_name = latency_site_names[site];
+		uint64_t    count = latency_stat_get(arena_ind, site_name,
+                    "count");
+		uint64_t    sum = 0;
+		for (unsigned j = 0; j < nbuckets; j++) {
+			malloc_snprintf(name, sizeof(name), "buckets.%u", j);
+			sum += latency_stat_get(arena_ind, site_name, name);
+		}
+		expect_u64_eq(sum, count,
+		    "Bucket counts of %s should add up to the count",
+		    site_name);
+		uint64_t p50 = latency_stat_get(arena_ind, site_name, "p50_ns");
+		uint64_t p99 = latency_stat_get(arena_ind, site_name, "p99_ns");
+		uint64_t p999 = latency_stat_get(
+		    arena_ind, site_name, "p999_ns");
+		expect_u64_le(p50, p99, "Quantiles should be ordered");
+		expect_u64_le(p99, p999, "Quantiles should be ordered");
+		if (count == 0) {
+			expect_u64_eq(p999, 0, "No samples, no quantiles");
+		}
+	}
+
+	/* Not selecting latency leaves the histograms alone. */
+	uint64_t count = latency_stat_get(arena_ind, "large_alloc", "count");
+	void    *r = mallocx(
+            SC_LARGE_MINCLASS, MALLOCX_ARENA(arena_ind) | MALLOCX_TCACHE_NONE);
+	expect_ptr_not_null(r, "Unexpected mallocx failure");
+	malloc_snprintf(name, sizeof(name), "arena.%u.stats_refresh", arena_ind);
+	unsigned what = MALLCTL_STATS_REFRESH_LARGE;
+	expect_d_eq(mallctl(name, NULL, NULL, &what, sizeof(what)), 0,
+	    "Unexpected mallctl failure");
+	expect_u64_eq(latency_stat_get(arena_ind, "large_alloc", "count"),
+	    count, "Latency stats should not have been refreshed");
+	what = MALLCTL_STATS_REFRESH_LATENCY;
+	expect_d_eq(mallctl(name, NULL, NULL, &what, sizeof(what)), 0,
+	    "Unexpected mallctl failure");
+	expect_u64_gt(latency_stat_get(arena_ind, "large_alloc", "count"),
+	    count, "Latency stats should have been refreshed");
+
+	dallocx(p, MALLOCX_TCACHE_NONE);
+	dallocx(q, 0);
+	dallocx(r, MALLOCX_TCACHE_NONE);
+}
+TEST_END
+
+int
+main(void) {
+	return test(
+	    test_latency_buckets, test_latency_quantile, test_latency_mallctl);
+}
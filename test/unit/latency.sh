@@ -0,0 +1,3 @@
+#!/bin/sh
+
+export MALLOC_CONF="stats_latency_sample:0"
@@ -0,0 +1,276 @@
+#include "test/jemalloc_test.h"
+
+#include "jemalloc/internal/lec.h"
+
+static base_t *
+test_base_new(void) {
+	return base_new(TSDN_NULL, /* ind */ 123, &ehooks_default_extent_hooks,
+	    /* metadata_use_hooks */ true);
+}
+
+static size_t
+test_lec_bytes(tsdn_t *tsdn, lec_t *lec) {
+	lec_stats_t stats = {0};
+	lec_stats_merge(tsdn, lec, &stats);
+	return stats.bytes;
+}
+
+TEST_BEGIN(test_lec_disabled) {
+	tsdn_t *tsdn = tsd_tsdn(tsd_fetch());
+	base_t *base = test_base_new();
+	lec_t   lec;
+
+	expect_false(lec_init(tsdn, &lec, base, 0, 16 * PAGE),
+	    "Unexpected initialization failure");
+	expect_false(lec_is_used(&lec), "max_bytes of 0 should disable lec");
+	expect_ptr_null(lec_alloc(tsdn, &lec, PAGE),
+	    "Disabled lec should not serve allocations");
+
+	base_delete(tsdn, base);
+}
+TEST_END
+
+TEST_BEGIN(test_lec_alloc_exact_size) {
+	tsdn_t *tsdn = tsd_tsdn(tsd_fetch());
+	base_t *base = test_base_new();
+	lec_t   lec;
+	expect_false(lec_init(tsdn, &lec, base, 64 * PAGE, 16 * PAGE),
+	    "Unexpected initialization failure");
+
+	expect_ptr_null(lec_alloc(tsdn, &lec, 4 * PAGE), "lec is empty");
+	expect_ptr_null(
+	    lec_alloc(tsdn, &lec, 32 * PAGE), "Size above max_alloc");
+
+	edata_list_active_t to_evict;
+	edata_list_active_init(&to_evict);
+	edata_t edata1, edata2;
+	edata_size_set(&edata1, 4 * PAGE);
+	edata_size_set(&edata2, 2 * PAGE);
+	lec_dalloc(tsdn, &lec, &edata1, &to_evict);
+	lec_dalloc(tsdn, &lec, &edata2, &to_evict);
+	expect_true(edata_list_active_empty(&to_evict),
+	    "Nothing should be evicted below max_bytes");
+	expect_zu_eq(test_lec_bytes(tsdn, &lec), 6 * PAGE,
+	    "lec should hold what was freed");
+
+	expect_ptr_null(lec_alloc(tsdn, &lec, 3 * PAGE),
+	    "Only exact size matches should be returned");
+	expect_ptr_eq(lec_alloc(tsdn, &lec, 4 * PAGE), &edata1,
+	    "Expected the cached extent of the requested size");
+	expect_ptr_eq(lec_alloc(tsdn, &lec, 2 * PAGE), &edata2,
+	    "Expected the cached extent of the requested size");
+	expect_zu_eq(test_lec_bytes(tsdn, &lec), 0, "lec should be empty");
+
+	lec_stats_t stats = {0};
+	lec_stats_merge(tsdn, &lec, &stats);
+	expect_u64_eq(stats.nhits, 2, "Incorrect hit count");
+	expect_u64_eq(stats.nmisses, 2, "Incorrect miss count");
+
+	base_delete(tsdn, base);
+}
+TEST_END
+
+TEST_BEGIN(test_lec_max_bytes) {
+	tsdn_t *tsdn = tsd_tsdn(tsd_fetch());
+	base_t *base = test_base_new();
+	lec_t   lec;
+	expect_false(lec_init(tsdn, &lec, base, 4 * PAGE, 4 * PAGE),
+	    "Unexpected initialization failure");
+
+	edata_list_active_t to_evict;
+	edata_list_active_init(&to_evict);
+	enum { NALLOCS = 6 };
+	edata_t edatas[NALLOCS];
+	for (unsigned i = 0; i < NALLOCS; i++) {
+		edata_size_set(&edatas[i], PAGE);
+		expect_b_eq(lec_dalloc(tsdn, &lec, &edatas[i], &to_evict),
+		    i >= 4, "Should only report going over max_bytes");
+	}
+	expect_true(edata_list_active_empty(&to_evict),
+	    "Going over max_bytes is left to lec_gc()");
+
+	lec_gc(tsdn, &lec, /* interval_ms */ 0, &to_evict);
+	expect_zu_eq(test_lec_bytes(tsdn, &lec), 4 * PAGE,
+	    "lec_gc() should bring lec back to max_bytes");
+	/* The least recently freed ones go first. */
+	expect_ptr_eq(edata_list_active_first(&to_evict), &edatas[0],
+	    "Expected the coldest extent to be evicted first");
+	expect_ptr_eq(edata_list_active_last(&to_evict), &edatas[1],
+	    "Expected the two coldest extents to be evicted");
+	expect_ptr_eq(lec_alloc(tsdn, &lec, PAGE), &edatas[NALLOCS - 1],
+	    "Expected the hottest extent to be reused first");
+
+	base_delete(tsdn, base);
+}
+TEST_END
+
+TEST_BEGIN(test_lec_max_bytes_hard) {
+	tsdn_t *tsdn = tsd_tsdn(tsd_fetch());
+	base_t *base = test_base_new();
+	lec_t   lec;
+	expect_false(lec_init(tsdn, &lec, base, 4 * PAGE, 4 * PAGE),
+	    "Unexpected initialization failure");
+
+	edata_list_active_t to_evict;
+	edata_list_active_init(&to_evict);
+	enum { NSMALL = 8 };
+	edata_t small[NSMALL + 1], big;
+	for (unsigned i = 0; i < NSMALL; i++) {
+		edata_size_set(&small[i], PAGE);
+		lec_dalloc(tsdn, &lec, &small[i], &to_evict);
+	}
+	expect_true(edata_list_active_empty(&to_evict),
+	    "lec can go up to twice max_bytes before lec_gc() runs");
+
+	/* Past that, bins only make room for themselves. */
+	edata_size_set(&big, 2 * PAGE);
+	lec_dalloc(tsdn, &lec, &big, &to_evict);
+	expect_ptr_eq(edata_list_active_first(&to_evict), &big,
+	    "An extent without room in its bin shouldn't be cached");
+	edata_list_active_remove(&to_evict, &big);
+	edata_size_set(&small[NSMALL], PAGE);
+	lec_dalloc(tsdn, &lec, &small[NSMALL], &to_evict);
+	expect_zu_eq(test_lec_bytes(tsdn, &lec), 8 * PAGE,
+	    "lec can't hold more than twice max_bytes");
+	expect_ptr_eq(edata_list_active_first(&to_evict), &small[0],
+	    "Expected the coldest extent of the bin to be evicted");
+
+	base_delete(tsdn, base);
+}
+TEST_END
+
+TEST_BEGIN(test_lec_max_bytes_across_bins) {
+	tsdn_t *tsdn = tsd_tsdn(tsd_fetch());
+	base_t *base = test_base_new();
+	lec_t   lec;
+	expect_false(lec_init(tsdn, &lec, base, 4 * PAGE, 4 * PAGE),
+	    "Unexpected initialization failure");
+
+	edata_list_active_t to_evict;
+	edata_list_active_init(&to_evict);
+	enum { NSMALL = 4 };
+	edata_t small[NSMALL], big;
+	for (unsigned i = 0; i < NSMALL; i++) {
+		edata_size_set(&small[i], PAGE);
+		lec_dalloc(tsdn, &lec, &small[i], &to_evict);
+	}
+	/* Goes to an empty bin, while the PAGE bin holds all of max_bytes. */
+	edata_size_set(&big, 2 * PAGE);
+	lec_dalloc(tsdn, &lec, &big, &to_evict);
+	lec_gc(tsdn, &lec, /* interval_ms */ 0, &to_evict);
+
+	expect_zu_eq(test_lec_bytes(tsdn, &lec), 4 * PAGE,
+	    "lec can't hold more than max_bytes");
+	expect_ptr_eq(edata_list_active_first(&to_evict), &small[0],
+	    "Expected the least recently freed extents to be evicted");
+	expect_ptr_eq(edata_list_active_last(&to_evict), &small[1],
+	    "Expected the least recently freed extents to be evicted");
+	expect_ptr_eq(lec_alloc(tsdn, &lec, 2 * PAGE), &big,
+	    "The extent just freed should stay cached");
+
+	base_delete(tsdn, base);
+}
+TEST_END
+
+TEST_BEGIN(test_lec_gc) {
+	tsdn_t *tsdn = tsd_tsdn(tsd_fetch());
+	base_t *base = test_base_new();
+	lec_t   lec;
+	expect_false(lec_init(tsdn, &lec, base, 64 * PAGE, 4 * PAGE),
+	    "Unexpected initialization failure");
+
+	edata_list_active_t to_evict;
+	edata_list_active_init(&to_evict);
+	edata_t edata1, edata2, edata3;
+	edata_size_set(&edata1, PAGE);
+	edata_size_set(&edata2, PAGE);
+	edata_size_set(&edata3, 2 * PAGE);
+	lec_dalloc(tsdn, &lec, &edata1, &to_evict);
+	lec_dalloc(tsdn, &lec, &edata2, &to_evict);
+	lec_dalloc(tsdn, &lec, &edata3, &to_evict);
+
+	/* The first pass only establishes the low water marks. */
+	lec_gc(tsdn, &lec, /* interval_ms */ 0, &to_evict);
+	expect_true(edata_list_active_empty(&to_evict),
+	    "Extents freed during the interval should stay cached");
+
+	/* Reuse one PAGE extent; the other one stays idle. */
+	expect_ptr_eq(lec_alloc(tsdn, &lec, PAGE), &edata2, "");
+	lec_dalloc(tsdn, &lec, &edata2, &to_evict);
+
+	lec_gc(tsdn, &lec, /* interval_ms */ 0, &to_evict);
+	expect_ptr_eq(edata_list_active_first(&to_evict), &edata1,
+	    "Idle extents should be evicted");
+	expect_ptr_eq(edata_list_active_last(&to_evict), &edata3,
+	    "Idle extents should be evicted");
+	edata_list_active_remove(&to_evict, &edata1);
+	edata_list_active_remove(&to_evict, &edata3);
+	expect_true(edata_list_active_empty(&to_evict),
+	    "Only idle bytes should be evicted");
+	expect_zu_eq(test_lec_bytes(tsdn, &lec), PAGE,
+	    "Recently reused extent should stay cached");
+
+	lec_flush(tsdn, &lec, &to_evict);
+	expect_ptr_eq(edata_list_active_first(&to_evict), &edata2,
+	    "Flush should evict everything");
+	expect_zu_eq(test_lec_bytes(tsdn, &lec), 0, "lec should be empty");
+
+	base_delete(tsdn, base);
+}
+TEST_END
+
+TEST_BEGIN(test_lec_arena) {
+	test_skip_if(!config_stats);
+
+	unsigned arena_ind;
+	size_t   sz = sizeof(arena_ind);
+	expect_d_eq(mallctl("arenas.create", &arena_ind, &sz, NULL, 0), 0,
+	    "Unexpected mallctl() failure");
+	int flags = MALLOCX_ARENA(arena_ind) | MALLOCX_TCACHE_NONE;
+
+	size_t usize = 16 * PAGE;
+	void  *p = mallocx(usize, flags);
+	expect_ptr_not_null(p, "Unexpected mallocx() failure");
+	dallocx(p, flags);
+	p = mallocx(usize, flags);
+	expect_ptr_not_null(p, "Unexpected mallocx() failure");
+
+	uint64_t epoch = 1;
+	expect_d_eq(mallctl("epoch", NULL, NULL, &epoch, sizeof(epoch)), 0,
+	    "Unexpected mallctl() failure");
+	size_t   mib[4];
+	size_t   miblen = sizeof(mib) / sizeof(size_t);
+	uint64_t hits;
+	sz = sizeof(hits);
+	expect_d_eq(mallctlnametomib("stats.arenas.0.lec_hits", mib, &miblen),
+	    0, "Unexpected mallctlnametomib() failure");
+	mib[2] = arena_ind;
+	expect_d_eq(mallctlbymib(mib, miblen, &hits, &sz, NULL, 0), 0,
+	    "Unexpected mallctlbymib() failure");
+	expect_u64_eq(hits, 1, "Second allocation should reuse the extent");
+
+	dallocx(p, flags);
+	/* Purging empties the cache. */
+	char cmd[64];
+	malloc_snprintf(cmd, sizeof(cmd), "arena.%u.purge", arena_ind);
+	expect_d_eq(mallctl(cmd, NULL, NULL, NULL, 0), 0,
+	    "Unexpected mallctl() failure");
+	expect_d_eq(mallctl("epoch", NULL, NULL, &epoch, sizeof(epoch)), 0,
+	    "Unexpected mallctl() failure");
+	size_t bytes;
+	sz = sizeof(bytes);
+	expect_d_eq(mallctlnametomib("stats.arenas.0.lec_bytes", mib, &miblen),
+	    0, "Unexpected mallctlnametomib() failure");
+	mib[2] = arena_ind;
+	expect_d_eq(mallctlbymib(mib, miblen, &bytes, &sz, NULL, 0), 0,
+	    "Unexpected mallctlbymib() failure");
+	expect_zu_eq(bytes, 0, "Purge should flush the large extent cache");
+}
+TEST_END
+
+int
+main(void) {
+	return test(test_lec_disabled, test_lec_alloc_exact_size,
+	    test_lec_max_bytes, test_lec_max_bytes_hard,
+	    test_lec_max_bytes_across_bins, test_lec_gc, test_lec_arena);
+}
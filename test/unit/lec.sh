@@ -0,0 +1,3 @@
+#!/bin/sh
+
+export MALLOC_CONF="lec_max_bytes:16777216,dirty_decay_ms:-1"
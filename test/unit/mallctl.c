@@ -328,6 +328,7 @@ TEST_BEGIN(test_mallctl_opt) {
 	TEST_MALLCTL_OPT(const char *, stats_print_opts, always);
 	TEST_MALLCTL_OPT(int64_t, stats_interval, always);
 	TEST_MALLCTL_OPT(const char *, stats_interval_opts, always);
+	TEST_MALLCTL_OPT(bool, arena_stats_enabled, stats);
 	TEST_MALLCTL_OPT(const char *, junk, fill);
 	TEST_MALLCTL_OPT(bool, zero, fill);
 	TEST_MALLCTL_OPT(bool, utrace, utrace);
@@ -342,16 +343,23 @@ TEST_BEGIN(test_mallctl_opt) {
 	TEST_MALLCTL_OPT(bool, prof_active, prof);
 	TEST_MALLCTL_OPT(unsigned, prof_bt_max, prof);
 	TEST_MALLCTL_OPT(ssize_t, lg_prof_sample, prof);
+	TEST_MALLCTL_OPT(unsigned, prof_overhead_ppm, prof);
 	TEST_MALLCTL_OPT(ssize_t, experimental_lg_prof_threshold, prof);
 	TEST_MALLCTL_OPT(bool, prof_accum, prof);
+	TEST_MALLCTL_OPT(bool, prof_lifetime, prof);
 	TEST_MALLCTL_OPT(bool, prof_pid_namespace, prof);
 	TEST_MALLCTL_OPT(ssize_t, lg_prof_interval, prof);
 	TEST_MALLCTL_OPT(bool, prof_gdump, prof);
 	TEST_MALLCTL_OPT(bool, prof_final, prof);
 	TEST_MALLCTL_OPT(bool, prof_leak, prof);
 	TEST_MALLCTL_OPT(bool, prof_leak_error, prof);
+	TEST_MALLCTL_OPT(bool, prof_pprof, prof);
+	TEST_MALLCTL_OPT(ssize_t, prof_bg_dump_ms, prof);
 	TEST_MALLCTL_OPT(ssize_t, prof_recent_alloc_max, prof);
 	TEST_MALLCTL_OPT(bool, prof_stats, prof);
+	TEST_MALLCTL_OPT(bool, prof_callsite, prof);
+	TEST_MALLCTL_OPT(bool, prof_contention, prof);
+	TEST_MALLCTL_OPT(size_t, lg_prof_contention_sample, prof);
 	TEST_MALLCTL_OPT(bool, prof_sys_thread_name, prof);
 	TEST_MALLCTL_OPT(ssize_t, lg_san_uaf_align, uaf_detection);
 	TEST_MALLCTL_OPT(unsigned, debug_double_free_max_scan, always);
@@ -1438,6 +1446,152 @@ TEST_BEGIN(test_thread_event_hook) {
 }
 TEST_END
 
+/* Mirrors the element layout expected by experimental.batch_read. */
+typedef struct {
+	const size_t *mib;
+	size_t        miblen;
+	void         *oldp;
+	size_t        oldlen;
+	int           ret;
+} batch_read_elm_t;
+
+TEST_BEGIN(test_batch_read) {
+	size_t mib_narenas[CTL_MAX_DEPTH], mib_page[CTL_MAX_DEPTH],
+	    mib_bin[CTL_MAX_DEPTH], mib_stats[CTL_MAX_DEPTH];
+	size_t len_narenas = CTL_MAX_DEPTH, len_page = CTL_MAX_DEPTH,
+	       len_bin = CTL_MAX_DEPTH, len_stats = CTL_MAX_DEPTH;
+	expect_d_eq(mallctlnametomib("arenas.narenas", mib_narenas,
+	                &len_narenas), 0, "Unexpected mallctlnametomib() failure");
+	expect_d_eq(mallctlnametomib("arenas.page", mib_page, &len_page), 0,
+	    "Unexpected mallctlnametomib() failure");
+	/* A partial MIB. */
+	expect_d_eq(mallctlnametomib("arenas.bin.0", mib_bin, &len_bin), 0,
+	    "Unexpected mallctlnametomib() failure");
+	int stats_expected = config_stats ? 0 : ENOENT;
+	expect_d_eq(mallctlnametomib("stats.allocated", mib_stats, &len_stats),
+	    stats_expected, "Unexpected mallctlnametomib() result");
+
+	unsigned narenas = 0;
+	size_t   page = 0, allocated = 0;
+	size_t   bin_val = 0;
+	batch_read_elm_t elms[4] = {
+	    {mib_narenas, len_narenas, &narenas, sizeof(narenas), -1},
+	    {mib_page, len_page, &page, sizeof(page), -1},
+	    {mib_bin, len_bin, &bin_val, sizeof(bin_val), -1},
+	    {mib_stats, len_stats, &allocated, sizeof(allocated), -1}};
+	size_t nelms = config_stats ? 4 : 3;
+
+	uint64_t epoch_before, epoch;
+	size_t   sz = sizeof(epoch_before);
+	expect_d_eq(mallctl("epoch", (void *)&epoch_before, &sz, NULL, 0), 0,
+	    "Unexpected mallctl() failure");
+	sz = sizeof(epoch);
+	expect_d_eq(mallctl("experimental.batch_read", (void *)&epoch, &sz,
+	                (void *)elms, nelms * sizeof(batch_read_elm_t)),
+	    0, "Unexpected mallctl() failure");
+	expect_u64_gt(epoch, epoch_before, "Stats should have been refreshed");
+
+	unsigned narenas_ref;
+	sz = sizeof(narenas_ref);
+	expect_d_eq(mallctl("arenas.narenas", (void *)&narenas_ref, &sz, NULL,
+	                0), 0, "Unexpected mallctl() failure");
+	expect_d_eq(elms[0].ret, 0, "Unexpected read failure");
+	expect_u_eq(narenas, narenas_ref, "Unexpected value");
+	expect_zu_eq(elms[0].oldlen, sizeof(narenas), "Unexpected length");
+	expect_d_eq(elms[1].ret, 0, "Unexpected read failure");
+	expect_zu_eq(page, PAGE, "Unexpected value");
+	expect_d_eq(elms[2].ret, ENOENT, "Partial MIBs should not be readable");
+	if (config_stats) {
+		expect_d_eq(elms[3].ret, 0, "Unexpected read failure");
+		expect_zu_gt(allocated, 0, "Unexpected value");
+	}
+
+	/* Without refresh. */
+	elms[0].ret = -1;
+	expect_d_eq(mallctl("experimental.batch_read", NULL, NULL,
+	                (void *)elms, sizeof(batch_read_elm_t)),
+	    0, "Unexpected mallctl() failure");
+	expect_d_eq(elms[0].ret, 0, "Unexpected read failure");
+
+	/* Anything but a read is rejected, without being run. */
+	const char *not_reads[] = {"arena.0.purge", "thread.tcache.flush",
+	    "prof.dump", "arenas.create", "stats.mutexes.reset"};
+	for (unsigned i = 0; i < sizeof(not_reads) / sizeof(not_reads[0]);
+	     i++) {
+		size_t mib[CTL_MAX_DEPTH];
+		size_t miblen = CTL_MAX_DEPTH;
+		if (mallctlnametomib(not_reads[i], mib, &miblen) != 0) {
+			/* E.g. stats.mutexes.reset without stats. */
+			continue;
+		}
+		unsigned         val = 0;
+		batch_read_elm_t elm = {mib, miblen, &val, sizeof(val), -1};
+		expect_d_eq(mallctl("experimental.batch_read", NULL, NULL,
+		                (void *)&elm, sizeof(elm)),
+		    0, "Unexpected mallctl() failure");
+		expect_d_eq(elm.ret, EINVAL, "%s should be rejected",
+		    not_reads[i]);
+	}
+	expect_d_eq(mallctl("arenas.narenas", (void *)&narenas, &sz, NULL, 0),
+	    0, "Unexpected mallctl() failure");
+	expect_u_eq(narenas, narenas_ref, "No arena should have been created");
+	elms[0].oldp = NULL;
+	expect_d_eq(mallctl("experimental.batch_read", NULL, NULL,
+	                (void *)elms, sizeof(batch_read_elm_t)),
+	    0, "Unexpected mallctl() failure");
+	expect_d_eq(elms[0].ret, EINVAL, "Elements without oldp are rejected");
+
+	/* Malformed arguments. */
+	expect_d_eq(mallctl("experimental.batch_read", NULL, NULL,
+	                (void *)elms, sizeof(batch_read_elm_t) + 1),
+	    EINVAL, "Malformed input should be rejected");
+	expect_d_eq(mallctl("experimental.batch_read", NULL, NULL, NULL, 0),
+	    EINVAL, "Empty input should be rejected");
+	sz = sizeof(uint32_t);
+	expect_d_eq(mallctl("experimental.batch_read", (void *)&epoch, &sz,
+	                (void *)elms, sizeof(batch_read_elm_t)),
+	    EINVAL, "Malformed output should be rejected");
+}
+TEST_END
+
+TEST_BEGIN(test_name_cache_revalidation) {
+	test_skip_if(!config_stats);
+
+	unsigned arena_ind;
+	size_t   sz = sizeof(arena_ind);
+	expect_d_eq(mallctl("arenas.create", (void *)&arena_ind, &sz, NULL, 0),
+	    0, "Unexpected mallctl() failure");
+	uint64_t epoch = 1;
+	expect_d_eq(mallctl("epoch", NULL, NULL, (void *)&epoch, sizeof(epoch)),
+	    0, "Unexpected mallctl() failure");
+
+	char name[64];
+	malloc_snprintf(
+	    name, sizeof(name), "stats.arenas.%u.nthreads", arena_ind);
+	unsigned nthreads;
+	for (unsigned i = 0; i < 2; i++) {
+		/* The second lookup hits the name cache. */
+		sz = sizeof(nthreads);
+		expect_d_eq(mallctl(name, (void *)&nthreads, &sz, NULL, 0), 0,
+		    "Unexpected mallctl() failure");
+	}
+
+	char cmd[64];
+	malloc_snprintf(cmd, sizeof(cmd), "arena.%u.destroy", arena_ind);
+	expect_d_eq(mallctl(cmd, NULL, NULL, NULL, 0), 0,
+	    "Unexpected mallctl() failure");
+	expect_d_eq(mallctl("epoch", NULL, NULL, (void *)&epoch, sizeof(epoch)),
+	    0, "Unexpected mallctl() failure");
+	sz = sizeof(nthreads);
+	expect_d_eq(mallctl(name, (void *)&nthreads, &sz, NULL, 0), ENOENT,
+	    "Cached names of destroyed arenas should not resolve");
+	size_t mib[CTL_MAX_DEPTH];
+	size_t miblen = CTL_MAX_DEPTH;
+	expect_d_eq(mallctlnametomib(name, mib, &miblen), ENOENT,
+	    "Cached names of destroyed arenas should not resolve");
+}
+TEST_END
+
 int
 main(void) {
 	return test(test_mallctl_errors, test_mallctlnametomib_errors,
@@ -1456,5 +1610,6 @@ main(void) {
 	    test_stats_arenas_hpa_shard_counters,
 	    test_stats_arenas_hpa_shard_slabs, test_hooks,
 	    test_hooks_exhaustion, test_thread_idle, test_thread_peak,
-	    test_thread_activity_callback, test_thread_event_hook);
+	    test_thread_activity_callback, test_thread_event_hook,
+	    test_batch_read, test_name_cache_revalidation);
 }
@@ -0,0 +1,134 @@
+#include "test/jemalloc_test.h"
+
+#define NTHREADS 8
+#define NINCRS 200000
+
+typedef struct {
+	malloc_mutex_t mtx;
+	unsigned       x;
+} thd_start_arg_t;
+
+static void *
+thd_start(void *varg) {
+	thd_start_arg_t *arg = (thd_start_arg_t *)varg;
+	tsdn_t          *tsdn = tsdn_fetch();
+
+	for (unsigned i = 0; i < NINCRS; i++) {
+		malloc_mutex_lock(tsdn, &arg->mtx);
+		arg->x++;
+		malloc_mutex_unlock(tsdn, &arg->mtx);
+	}
+	return NULL;
+}
+
+TEST_BEGIN(test_mutex_trylock) {
+	malloc_mutex_t mtx;
+	tsdn_t        *tsdn = tsdn_fetch();
+
+	expect_false(malloc_mutex_init(&mtx, "test", WITNESS_RANK_OMIT,
+	                 malloc_mutex_rank_exclusive),
+	    "Unexpected malloc_mutex_init() failure");
+	expect_false(malloc_mutex_trylock(tsdn, &mtx),
+	    "Trylock of an unlocked mutex should succeed");
+	malloc_mutex_assert_owner(tsdn, &mtx);
+	malloc_mutex_unlock(tsdn, &mtx);
+	malloc_mutex_lock(tsdn, &mtx);
+	malloc_mutex_unlock(tsdn, &mtx);
+}
+TEST_END
+
+TEST_BEGIN(test_mutex_race) {
+	thd_start_arg_t arg;
+	thd_t           thds[NTHREADS];
+	tsdn_t         *tsdn = tsdn_fetch();
+
+	/* Enough threads for the waiters to queue up now and then. */
+	expect_false(malloc_mutex_init(&arg.mtx, "test", WITNESS_RANK_OMIT,
+	                 malloc_mutex_rank_exclusive),
+	    "Unexpected malloc_mutex_init() failure");
+	arg.x = 0;
+	for (unsigned i = 0; i < NTHREADS; i++) {
+		thd_create(&thds[i], thd_start, (void *)&arg);
+	}
+	for (unsigned i = 0; i < NTHREADS; i++) {
+		thd_join(thds[i], NULL);
+	}
+	expect_u_eq(
+	    arg.x, NTHREADS * NINCRS, "Race-related counter corruption");
+
+	if (!config_stats) {
+		return;
+	}
+	mutex_prof_data_t data;
+	malloc_mutex_lock(tsdn, &arg.mtx);
+	malloc_mutex_prof_read(tsdn, &data, &arg.mtx);
+	malloc_mutex_unlock(tsdn, &arg.mtx);
+	expect_u64_eq(data.n_lock_ops, NTHREADS * NINCRS + 1,
+	    "Unexpected number of lock operations");
+	uint64_t nwaits = 0;
+	for (unsigned i = 0; i < MUTEX_PROF_WAIT_NBUCKETS; i++) {
+		nwaits += data.wait_hist[i];
+	}
+	expect_u64_eq(nwaits, data.n_wait_times,
+	    "The wait histogram should count every wait-acquired lock");
+}
+TEST_END
+
+TEST_BEGIN(test_mutex_wait_bucket) {
+	expect_u_eq(mutex_prof_wait_bucket(0), 0, "Wrong bucket");
+	expect_u_eq(mutex_prof_wait_bucket((1U << MUTEX_PROF_WAIT_LG_MIN) - 1),
+	    0, "Wrong bucket");
+	for (unsigned j = 1; j < MUTEX_PROF_WAIT_NBUCKETS - 1; j++) {
+		uint64_t lower = (uint64_t)1
+		    << (MUTEX_PROF_WAIT_LG_MIN + 2 * (j - 1));
+		uint64_t upper = (uint64_t)1 << (MUTEX_PROF_WAIT_LG_MIN + 2 * j);
+		expect_u_eq(mutex_prof_wait_bucket(lower), j,
+		    "Wrong bucket for %" FMTu64 " ns", lower);
+		expect_u_eq(mutex_prof_wait_bucket(upper - 1), j,
+		    "Wrong bucket for %" FMTu64 " ns", upper - 1);
+	}
+	expect_u_eq(mutex_prof_wait_bucket(UINT64_MAX),
+	    MUTEX_PROF_WAIT_NBUCKETS - 1,
+	    "Long waits should go into the last bucket");
+}
+TEST_END
+
+TEST_BEGIN(test_mutex_wait_hist_mallctl) {
+	test_skip_if(!config_stats);
+
+	uint64_t epoch = 1;
+	expect_d_eq(mallctl("epoch", NULL, NULL, &epoch, sizeof(epoch)), 0,
+	    "Unexpected mallctl failure");
+
+	uint64_t num_wait, count, sum;
+	size_t   sz = sizeof(uint64_t);
+	char     name[128];
+	const char *prefixes[] = {
+	    "stats.mutexes.ctl", "stats.arenas.0.mutexes.large"};
+	for (unsigned i = 0; i < sizeof(prefixes) / sizeof(prefixes[0]); i++) {
+		malloc_snprintf(name, sizeof(name), "%s.num_wait", prefixes[i]);
+		expect_d_eq(mallctl(name, &num_wait, &sz, NULL, 0), 0,
+		    "Unexpected mallctl failure for %s", name);
+		sum = 0;
+		for (unsigned j = 0; j < MUTEX_PROF_WAIT_NBUCKETS; j++) {
+			malloc_snprintf(name, sizeof(name), "%s.wait_hist.%u",
+			    prefixes[i], j);
+			expect_d_eq(mallctl(name, &count, &sz, NULL, 0), 0,
+			    "Unexpected mallctl failure for %s", name);
+			sum += count;
+		}
+		expect_u64_eq(sum, num_wait,
+		    "Histogram of %s should add up to num_wait", prefixes[i]);
+		malloc_snprintf(name, sizeof(name), "%s.wait_hist.%u",
+		    prefixes[i], MUTEX_PROF_WAIT_NBUCKETS);
+		expect_d_eq(mallctl(name, &count, &sz, NULL, 0), ENOENT,
+		    "Out of range bucket should not exist");
+	}
+}
+TEST_END
+
+int
+main(void) {
+	return test(test_mutex_trylock, test_mutex_race, test_mutex_wait_bucket,
+	    test_mutex_wait_hist_mallctl);
+}
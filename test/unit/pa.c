@@ -44,6 +44,7 @@ struct test_data_s {
 	base_t          *base;
 	emap_t           emap;
 	pa_shard_stats_t stats;
+	latency_stats_t  latency;
 	malloc_mutex_t   stats_mtx;
 	extent_hooks_t   hooks;
 };
@@ -73,7 +74,7 @@ init_test_data(ssize_t dirty_decay_ms, ssize_t muzzy_decay_ms) {
 	const size_t pa_oversize_threshold = 8 * 1024 * 1024;
 	err = pa_shard_init(TSDN_NULL, &test_data->shard, &test_data->central,
 	    &test_data->emap, test_data->base, /* ind */ 1, &test_data->stats,
-	    &test_data->stats_mtx, &time, pa_oversize_threshold, dirty_decay_ms,
+	    &test_data->latency, &test_data->stats_mtx, &time, pa_oversize_threshold, dirty_decay_ms,
 	    muzzy_decay_ms);
 	assert_false(err, "");
 
@@ -3,6 +3,7 @@
 #include "jemalloc/internal/ph.h"
 
 #define BFS_ENUMERATE_MAX 30
+#define NNODES_MAX 25
 typedef struct node_s node_t;
 ph_structs(heap, node_t, BFS_ENUMERATE_MAX);
 
@@ -150,6 +151,24 @@ label_return:
 	return nnodes;
 }
 
+/* Returns the number of nodes walked, and checks none of them is repeated. */
+static unsigned
+heap_walk_validate(heap_t *heap, node_t *nodes, unsigned nnodes_max) {
+	bool     seen[NNODES_MAX] = {false};
+	unsigned nnodes = 0;
+
+	assert(nnodes_max <= NNODES_MAX);
+	for (node_t *node = heap_walk_next(heap, NULL); node != NULL;
+	     node = heap_walk_next(heap, node)) {
+		size_t i = node - nodes;
+		expect_zu_lt(i, nnodes_max, "Walked a foreign node");
+		expect_false(seen[i], "Walked a node twice");
+		seen[i] = true;
+		nnodes++;
+	}
+	return nnodes;
+}
+
 TEST_BEGIN(test_ph_empty) {
 	heap_t heap;
 
@@ -182,7 +201,7 @@ node_remove_any(heap_t *heap) {
 }
 
 TEST_BEGIN(test_ph_random) {
-#define NNODES 25
+#define NNODES NNODES_MAX
 #define NBAGS 250
 #define SEED 42
 	sfmt_t  *sfmt;
@@ -254,6 +273,8 @@ TEST_BEGIN(test_ph_random) {
 			}
 			expect_lu_eq(
 			    node_count, j, "Unexpected enumeration results.");
+			expect_u_eq(heap_walk_validate(&heap, nodes, j), j,
+			    "Walk should visit every node");
 
 			/* Remove nodes. */
 			switch (i % 6) {
@@ -264,6 +285,9 @@ TEST_BEGIN(test_ph_random) {
 					node_remove(&heap, &nodes[k]);
 					expect_u_eq(heap_validate(&heap),
 					    j - k - 1, "Incorrect node count");
+					expect_u_eq(
+					    heap_walk_validate(&heap, nodes, j),
+					    j - k - 1, "Incorrect walk count");
 				}
 				break;
 			case 1:
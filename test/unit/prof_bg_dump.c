@@ -0,0 +1,127 @@
+#include "test/jemalloc_test.h"
+
+#include "jemalloc/internal/prof_sys.h"
+
+#define BG_DUMP_MS 500
+
+static atomic_u_t ndumps;
+static nstime_t   dump_time[2];
+static bool       dumped_on_caller;
+#ifdef JEMALLOC_BACKGROUND_THREAD
+static pthread_t caller;
+#endif
+
+static int
+prof_dump_open_file_intercept(const char *filename, int mode) {
+#ifdef JEMALLOC_BACKGROUND_THREAD
+	if (pthread_equal(pthread_self(), caller)) {
+		dumped_on_caller = true;
+	}
+#endif
+	unsigned ind = atomic_load_u(&ndumps, ATOMIC_RELAXED);
+	if (ind < 2) {
+		nstime_init_update(&dump_time[ind]);
+	}
+	atomic_store_u(&ndumps, ind + 1, ATOMIC_RELEASE);
+
+	int fd = open("/dev/null", O_WRONLY);
+	assert_d_ne(fd, -1, "Unexpected open() failure");
+	return fd;
+}
+
+static unsigned
+wait_for_dumps(unsigned n) {
+	/* Generous, for slow machines; the dumps should take a second or so. */
+	for (unsigned i = 0;
+	     i < 3000 && atomic_load_u(&ndumps, ATOMIC_ACQUIRE) < n; i++) {
+		sleep_ns(10 * 1000 * 1000);
+	}
+	return atomic_load_u(&ndumps, ATOMIC_ACQUIRE);
+}
+
+static void
+background_thread_set(bool enable) {
+	expect_d_eq(mallctl("background_thread", NULL, NULL, (void *)&enable,
+	                sizeof(enable)),
+	    0, "Unexpected mallctl() failure");
+}
+
+static void *
+thd_wakeup(void *unused) {
+	prof_bg_thread0_wakeup(tsdn_fetch());
+	return NULL;
+}
+
+TEST_BEGIN(test_bg_dump_idle) {
+	test_skip_if(!config_prof);
+	test_skip_if(!have_background_thread);
+
+	/* Nothing pending: thread 0 shouldn't wake up for profiling. */
+	expect_u64_eq(prof_bg_dump_ns_until(), BACKGROUND_THREAD_DEFERRED_MAX,
+	    "Unexpected wakeup with no deferred dump");
+
+	/* A trigger that couldn't wake thread 0 makes it check again soon. */
+	tsdn_t *tsdn = tsdn_fetch();
+	thd_t   thd;
+	malloc_mutex_lock(tsdn, &background_thread_info[0].mtx);
+	thd_create(&thd, thd_wakeup, NULL);
+	thd_join(thd, NULL);
+	malloc_mutex_unlock(tsdn, &background_thread_info[0].mtx);
+	expect_u64_lt(prof_bg_dump_ns_until(), BACKGROUND_THREAD_DEFERRED_MAX,
+	    "A missed wakeup should be followed by a recheck");
+
+	prof_bg_thread0_wakeup_clear();
+	expect_u64_eq(prof_bg_dump_ns_until(), BACKGROUND_THREAD_DEFERRED_MAX,
+	    "Unexpected wakeup with no deferred dump");
+}
+TEST_END
+
+TEST_BEGIN(test_bg_gdump) {
+	test_skip_if(!config_prof);
+	test_skip_if(!have_background_thread);
+	test_skip_if(opt_hpa);
+
+#ifdef JEMALLOC_BACKGROUND_THREAD
+	caller = pthread_self();
+#endif
+	prof_dump_open_file = prof_dump_open_file_intercept;
+	background_thread_set(true);
+	bool active = true;
+	expect_d_eq(
+	    mallctl("prof.active", NULL, NULL, (void *)&active, sizeof(active)),
+	    0, "Unexpected mallctl failure while activating profiling");
+
+	/* Nothing was dumped lately, so the first trigger dumps right away. */
+	void *p = mallocx((1U << SC_LG_LARGE_MINCLASS), 0);
+	expect_ptr_not_null(p, "Unexpected mallocx() failure");
+	expect_u_eq(wait_for_dumps(1), 1, "Expected a deferred dump");
+
+	/* The next ones wait for the interval to pass, and coalesce. */
+	void *q = mallocx((1U << SC_LG_LARGE_MINCLASS), 0);
+	expect_ptr_not_null(q, "Unexpected mallocx() failure");
+	void *r = mallocx((1U << SC_LG_LARGE_MINCLASS), 0);
+	expect_ptr_not_null(r, "Unexpected mallocx() failure");
+	expect_u_eq(wait_for_dumps(2), 2, "Expected one more deferred dump");
+
+	active = false;
+	expect_d_eq(
+	    mallctl("prof.active", NULL, NULL, (void *)&active, sizeof(active)),
+	    0, "Unexpected mallctl failure while deactivating profiling");
+	background_thread_set(false);
+
+	expect_false(dumped_on_caller,
+	    "Dumps should have been left to the background thread");
+	nstime_subtract(&dump_time[1], &dump_time[0]);
+	expect_u64_ge(nstime_ns(&dump_time[1]), BG_DUMP_MS / 2 * KQU(1000000),
+	    "Dumps should have been rate limited");
+
+	dallocx(p, 0);
+	dallocx(q, 0);
+	dallocx(r, 0);
+}
+TEST_END
+
+int
+main(void) {
+	return test_no_reentrancy(test_bg_dump_idle, test_bg_gdump);
+}
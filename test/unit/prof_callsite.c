@@ -0,0 +1,152 @@
+#include "test/jemalloc_test.h"
+
+#include "jemalloc/internal/prof_callsite.h"
+#include "jemalloc/internal/prof_data.h"
+
+#define SZ 4096
+#define NPTRS 64
+/* Enough to hold the code of the allocating helpers below. */
+#define FUNC_MAX 256
+
+static void *ptrs[NPTRS];
+
+/*
+ * Each helper has exactly one allocation callsite, whose return address lies
+ * within the helper's code.
+ */
+JEMALLOC_NOINLINE static void
+alloc_a(unsigned i) {
+	ptrs[i] = mallocx(SZ, 0);
+	assert_ptr_not_null(ptrs[i], "Unexpected mallocx() failure");
+}
+
+JEMALLOC_NOINLINE static void
+alloc_b(unsigned i) {
+	ptrs[i] = mallocx(SZ, 0);
+	assert_ptr_not_null(ptrs[i], "Unexpected mallocx() failure");
+}
+
+JEMALLOC_NOINLINE static void
+alloc_c(unsigned i) {
+	ptrs[i] = mallocx(SZ, 0);
+	assert_ptr_not_null(ptrs[i], "Unexpected mallocx() failure");
+}
+
+static void
+free_all(unsigned n) {
+	for (unsigned i = 0; i < n; i++) {
+		dallocx(ptrs[i], 0);
+	}
+}
+
+/* Sums the counts of the reported callsites within func. */
+static void
+callsite_get(void (*func)(unsigned), uint64_t *count, uint64_t *bytes,
+    unsigned *rank) {
+	uint64_t epoch = 1;
+	expect_d_eq(mallctl("epoch", NULL, NULL, (void *)&epoch, sizeof(epoch)),
+	    0, "Unexpected mallctl() failure");
+
+	uintptr_t start = (uintptr_t)func;
+	*count = 0;
+	*bytes = 0;
+	*rank = PROF_CALLSITE_NTOP;
+	size_t mib[4];
+	size_t miblen = sizeof(mib) / sizeof(size_t);
+	expect_d_eq(mallctlnametomib("stats.prof_callsites.0.addr", mib,
+	                &miblen),
+	    0, "Unexpected mallctlnametomib() failure");
+	for (unsigned i = 0; i < PROF_CALLSITE_NTOP; i++) {
+		void    *addr;
+		uint64_t c, b;
+		size_t   sz = sizeof(addr);
+		mib[2] = i;
+		mib[3] = 0;
+		expect_d_eq(mallctlbymib(mib, 4, (void *)&addr, &sz, NULL, 0),
+		    0, "Unexpected mallctlbymib() failure");
+		sz = sizeof(c);
+		mib[3] = 1;
+		expect_d_eq(mallctlbymib(mib, 4, (void *)&c, &sz, NULL, 0), 0,
+		    "Unexpected mallctlbymib() failure");
+		mib[3] = 2;
+		expect_d_eq(mallctlbymib(mib, 4, (void *)&b, &sz, NULL, 0), 0,
+		    "Unexpected mallctlbymib() failure");
+		if (c == 0) {
+			break;
+		}
+		if ((uintptr_t)addr > start
+		    && (uintptr_t)addr < start + FUNC_MAX) {
+			*count += c;
+			*bytes += b;
+			if (*rank == PROF_CALLSITE_NTOP) {
+				*rank = i;
+			}
+		}
+	}
+}
+
+TEST_BEGIN(test_prof_callsite_top) {
+	test_skip_if(!config_prof || !config_stats);
+
+	uint64_t count_a, bytes_a, count_b, bytes_b;
+	unsigned rank_a, rank_b;
+	callsite_get(alloc_a, &count_a, &bytes_a, &rank_a);
+	expect_u64_eq(count_a, 0, "No allocations made yet");
+
+	/* With lg_prof_sample:0, every allocation is sampled. */
+	for (unsigned i = 0; i < NPTRS / 4; i++) {
+		alloc_a(i);
+	}
+	free_all(NPTRS / 4);
+	for (unsigned i = 0; i < NPTRS; i++) {
+		alloc_b(i);
+	}
+	free_all(NPTRS);
+
+	callsite_get(alloc_a, &count_a, &bytes_a, &rank_a);
+	callsite_get(alloc_b, &count_b, &bytes_b, &rank_b);
+	expect_u64_eq(count_a, NPTRS / 4, "Unexpected count");
+	expect_u64_eq(bytes_a, (NPTRS / 4) * SZ, "Unexpected bytes");
+	expect_u64_eq(count_b, NPTRS, "Unexpected count");
+	expect_u64_eq(bytes_b, NPTRS * SZ, "Unexpected bytes");
+	expect_u_lt(rank_b, rank_a, "Busier callsites should come first");
+
+	/* Freed objects stay counted, and nothing was tracked as sampled. */
+	prof_cnt_t cnt;
+	prof_cnt_all(&cnt);
+	expect_u64_eq(cnt.curobjs, 0, "No object should have been sampled");
+}
+TEST_END
+
+static void *
+thd_start(void *arg) {
+	unsigned n = *(unsigned *)arg;
+	for (unsigned i = 0; i < n; i++) {
+		alloc_c(i);
+	}
+	free_all(n);
+	return NULL;
+}
+
+TEST_BEGIN(test_prof_callsite_thread_exit) {
+	test_skip_if(!config_prof || !config_stats);
+
+	/* Fewer than a flush's worth; only the exit gets them out. */
+	unsigned n = PROF_CALLSITE_FLUSH_NSAMPLES / 2;
+	thd_t    thd;
+	thd_create(&thd, thd_start, &n);
+	thd_join(thd, NULL);
+
+	uint64_t count, bytes;
+	unsigned rank;
+	callsite_get(alloc_c, &count, &bytes, &rank);
+	expect_u64_eq(count, n, "Counts should be flushed at thread exit");
+	expect_u64_eq(bytes, n * SZ, "Unexpected bytes");
+}
+TEST_END
+
+int
+main(void) {
+	return test_no_reentrancy(
+	    test_prof_callsite_top, test_prof_callsite_thread_exit);
+}
@@ -0,0 +1,238 @@
+#include "test/jemalloc_test.h"
+
+#include "jemalloc/internal/prof_sys.h"
+
+#define NTHREADS 4
+#define NINCRS 20000
+
+static const char *test_filename = "test_filename";
+
+static char   dump_out[1 << 16];
+static size_t dump_out_len;
+
+static int
+prof_dump_open_file_intercept(const char *filename, int mode) {
+	expect_ptr_eq(filename, test_filename,
+	    "Dump file name should be \"%s\"", test_filename);
+	int fd = open("/dev/null", O_WRONLY);
+	assert_d_ne(fd, -1, "Unexpected open() failure");
+	return fd;
+}
+
+static ssize_t
+prof_dump_write_file_intercept(int fd, const void *s, size_t len) {
+	size_t n = len;
+	if (n > sizeof(dump_out) - 1 - dump_out_len) {
+		n = sizeof(dump_out) - 1 - dump_out_len;
+	}
+	memcpy(&dump_out[dump_out_len], s, n);
+	dump_out_len += n;
+	dump_out[dump_out_len] = '\0';
+	return (ssize_t)len;
+}
+
+static void
+contention_dump(void) {
+	prof_dump_open_file_t  *open_file_orig = prof_dump_open_file;
+	prof_dump_write_file_t *write_file_orig = prof_dump_write_file;
+
+	prof_dump_open_file = prof_dump_open_file_intercept;
+	prof_dump_write_file = prof_dump_write_file_intercept;
+	dump_out_len = 0;
+	dump_out[0] = '\0';
+	expect_d_eq(mallctl("prof.contention_dump", NULL, NULL,
+	                (void *)&test_filename, sizeof(test_filename)),
+	    0, "Unexpected mallctl failure while dumping");
+	prof_dump_open_file = open_file_orig;
+	prof_dump_write_file = write_file_orig;
+}
+
+/* Sums up the sample counts of the records in dump_out. */
+static uint64_t
+contention_dump_count(void) {
+	uint64_t count = 0;
+	char    *line = dump_out;
+	while (*line != '\0') {
+		char *end = strchr(line, '\n');
+		assert_ptr_not_null(end, "Unterminated line in the dump");
+		*end = '\0';
+		if (strstr(line, " @ ") != NULL) {
+			char *p;
+			uintmax_t wait_ns = malloc_strtoumax(line, &p, 10);
+			expect_c_eq(*p, ' ', "Malformed record \"%s\"", line);
+			uintmax_t n = malloc_strtoumax(p + 1, NULL, 10);
+			expect_u64_gt(n, 0, "Records should have samples");
+			expect_u64_ge(wait_ns, 0, "Unexpected wait time");
+			count += n;
+		}
+		*end = '\n';
+		line = end + 1;
+	}
+	return count;
+}
+
+typedef struct {
+	malloc_mutex_t mtx;
+	unsigned       x;
+} thd_start_arg_t;
+
+static void *
+thd_start(void *varg) {
+	thd_start_arg_t *arg = (thd_start_arg_t *)varg;
+	/* Only threads with initialized tsd get sampled. */
+	free(malloc(1));
+	tsdn_t *tsdn = tsdn_fetch();
+
+	for (unsigned i = 0; i < NINCRS; i++) {
+		malloc_mutex_lock(tsdn, &arg->mtx);
+		arg->x++;
+		malloc_mutex_unlock(tsdn, &arg->mtx);
+	}
+	return NULL;
+}
+
+TEST_BEGIN(test_contention_opts) {
+	test_skip_if(!config_prof);
+
+	bool   enabled;
+	size_t lg_sample;
+	size_t sz = sizeof(enabled);
+	expect_d_eq(mallctl("opt.prof_contention", &enabled, &sz, NULL, 0), 0,
+	    "Unexpected mallctl failure");
+	expect_true(enabled, "Contention profiling should be on");
+	sz = sizeof(lg_sample);
+	expect_d_eq(mallctl("opt.lg_prof_contention_sample", &lg_sample, &sz,
+	                NULL, 0),
+	    0, "Unexpected mallctl failure");
+	expect_zu_eq(lg_sample, 0, "Every blocking acquisition should count");
+}
+TEST_END
+
+TEST_BEGIN(test_contention_dump) {
+	test_skip_if(!config_prof);
+
+	expect_d_eq(mallctl("prof.contention_reset", NULL, NULL, NULL, 0), 0,
+	    "Unexpected mallctl failure while resetting");
+	contention_dump();
+	expect_ptr_eq(strstr(dump_out, "--- contention\n"), dump_out,
+	    "Missing header");
+	expect_ptr_not_null(strstr(dump_out, "\ncycles/second = 1000000000\n"),
+	    "Missing clock rate");
+	expect_ptr_not_null(strstr(dump_out, "\nsampling period = 1\n"),
+	    "Missing sampling period");
+	expect_ptr_not_null(strstr(dump_out, "\ndiscarded samples = 0\n"),
+	    "Missing discarded samples");
+	expect_u64_eq(contention_dump_count(), 0,
+	    "No samples expected after a reset");
+
+	thd_start_arg_t arg;
+	thd_t           thds[NTHREADS];
+	tsdn_t         *tsdn = tsdn_fetch();
+	expect_false(malloc_mutex_init(&arg.mtx, "test", WITNESS_RANK_OMIT,
+	                 malloc_mutex_rank_exclusive),
+	    "Unexpected malloc_mutex_init() failure");
+	arg.x = 0;
+	/* Hold the mutex for a while, so that the threads have to block. */
+	malloc_mutex_lock(tsdn, &arg.mtx);
+	for (unsigned i = 0; i < NTHREADS; i++) {
+		thd_create(&thds[i], thd_start, (void *)&arg);
+	}
+	sleep_ns(10 * 1000 * 1000);
+	malloc_mutex_unlock(tsdn, &arg.mtx);
+	for (unsigned i = 0; i < NTHREADS; i++) {
+		thd_join(thds[i], NULL);
+	}
+	expect_u_eq(arg.x, NTHREADS * NINCRS, "Race-related counter corruption");
+
+	contention_dump();
+	uint64_t count = contention_dump_count();
+	expect_u64_gt(count, 0, "Expected sampled waits");
+	if (config_stats) {
+		/*
+		 * Every wait of the test mutex got sampled; other mutexes may
+		 * have added some more.
+		 */
+		mutex_prof_data_t data;
+		malloc_mutex_lock(tsdn, &arg.mtx);
+		malloc_mutex_prof_read(tsdn, &data, &arg.mtx);
+		malloc_mutex_unlock(tsdn, &arg.mtx);
+		expect_u64_ge(count, data.n_wait_times,
+		    "Sampled waits missing from the profile");
+	}
+
+	expect_d_eq(mallctl("prof.contention_reset", NULL, NULL, NULL, 0), 0,
+	    "Unexpected mallctl failure while resetting");
+	contention_dump();
+	expect_u64_eq(contention_dump_count(), 0,
+	    "No samples expected after a reset");
+}
+TEST_END
+
+static unsigned bt_hook_calls;
+
+static void
+counting_bt_hook(void **vec, unsigned *len, unsigned max_len) {
+	bt_hook_calls++;
+	*len = 0;
+}
+
+TEST_BEGIN(test_contention_bt_no_hook) {
+	test_skip_if(!config_prof);
+
+	/*
+	 * Waiting threads may hold other allocator mutexes; the backtrace must
+	 * not go through the (possibly allocating) unwinder hook.  Allocation
+	 * sampling is paused so that it doesn't call the hook either.
+	 */
+	bool   active = false;
+	bool   old_active;
+	size_t sz = sizeof(old_active);
+	expect_d_eq(mallctl("prof.active", &old_active, &sz, (void *)&active,
+	                sizeof(active)),
+	    0, "Unexpected mallctl failure");
+	prof_backtrace_hook_t hook = &counting_bt_hook;
+	prof_backtrace_hook_t old_hook;
+	sz = sizeof(old_hook);
+	expect_d_eq(mallctl("experimental.hooks.prof_backtrace", &old_hook, &sz,
+	                (void *)&hook, sizeof(hook)),
+	    0, "Unexpected mallctl failure");
+	expect_d_eq(mallctl("prof.contention_reset", NULL, NULL, NULL, 0), 0,
+	    "Unexpected mallctl failure while resetting");
+
+	thd_start_arg_t arg;
+	thd_t           thds[NTHREADS];
+	tsdn_t         *tsdn = tsdn_fetch();
+	expect_false(malloc_mutex_init(&arg.mtx, "test", WITNESS_RANK_OMIT,
+	                 malloc_mutex_rank_exclusive),
+	    "Unexpected malloc_mutex_init() failure");
+	arg.x = 0;
+	bt_hook_calls = 0;
+	malloc_mutex_lock(tsdn, &arg.mtx);
+	for (unsigned i = 0; i < NTHREADS; i++) {
+		thd_create(&thds[i], thd_start, (void *)&arg);
+	}
+	sleep_ns(10 * 1000 * 1000);
+	malloc_mutex_unlock(tsdn, &arg.mtx);
+	for (unsigned i = 0; i < NTHREADS; i++) {
+		thd_join(thds[i], NULL);
+	}
+	expect_u_eq(bt_hook_calls, 0,
+	    "Contention sampling should not call the backtrace hook");
+
+	contention_dump();
+	expect_u64_gt(contention_dump_count(), 0, "Expected sampled waits");
+
+	expect_d_eq(mallctl("experimental.hooks.prof_backtrace", NULL, NULL,
+	                (void *)&old_hook, sizeof(old_hook)),
+	    0, "Unexpected mallctl failure");
+	expect_d_eq(mallctl("prof.active", NULL, NULL, (void *)&old_active,
+	                sizeof(old_active)),
+	    0, "Unexpected mallctl failure");
+}
+TEST_END
+
+int
+main(void) {
+	return test(test_contention_opts, test_contention_dump,
+	    test_contention_bt_no_hook);
+}
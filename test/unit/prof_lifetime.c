@@ -0,0 +1,127 @@
+#include "test/jemalloc_test.h"
+
+#include "jemalloc/internal/prof_sys.h"
+
+#define DUMP_MAX (1U << 20)
+
+static char   dump_buf[DUMP_MAX + 1];
+static size_t dump_len;
+
+static int
+prof_dump_open_file_intercept(const char *filename, int mode) {
+	int fd = open("/dev/null", O_WRONLY);
+	assert_d_ne(fd, -1, "Unexpected open() failure");
+	return fd;
+}
+
+static ssize_t
+prof_dump_write_file_intercept(int fd, const void *s, size_t len) {
+	assert_zu_le(dump_len + len, DUMP_MAX, "Dump too large for the test");
+	memcpy(&dump_buf[dump_len], s, len);
+	dump_len += len;
+	dump_buf[dump_len] = '\0';
+	return (ssize_t)len;
+}
+
+/* Sums the lifetimes: lines of the dump, bucket by bucket. */
+static unsigned
+dump_lifetimes(size_t lifetimes[PROF_LIFETIME_NBUCKETS]) {
+	prof_dump_open_file_t  *open_file_orig = prof_dump_open_file;
+	prof_dump_write_file_t *write_file_orig = prof_dump_write_file;
+	prof_dump_open_file = prof_dump_open_file_intercept;
+	prof_dump_write_file = prof_dump_write_file_intercept;
+
+	dump_len = 0;
+	const char *filename = "test_filename";
+	expect_d_eq(mallctl("prof.dump", NULL, NULL, (void *)&filename,
+	                sizeof(filename)),
+	    0, "Unexpected mallctl failure while dumping");
+
+	prof_dump_open_file = open_file_orig;
+	prof_dump_write_file = write_file_orig;
+
+	memset(lifetimes, 0, PROF_LIFETIME_NBUCKETS * sizeof(size_t));
+	unsigned nlines = 0;
+	const char *key = "  lifetimes:";
+	for (char *line = strstr(dump_buf, key); line != NULL;
+	     line = strstr(line, key)) {
+		line += strlen(key);
+		for (unsigned i = 0; i < PROF_LIFETIME_NBUCKETS; i++) {
+			char *end;
+			lifetimes[i] += strtoul(line, &end, 10);
+			assert_ptr_ne(end, line, "Expected %u buckets",
+			    PROF_LIFETIME_NBUCKETS);
+			line = end;
+		}
+		expect_c_eq(*line, '\n', "Unexpected bucket");
+		nlines++;
+	}
+	return nlines;
+}
+
+TEST_BEGIN(test_prof_lifetime) {
+	test_skip_if(!config_prof);
+
+	size_t before[PROF_LIFETIME_NBUCKETS];
+	dump_lifetimes(before);
+
+	void *p = mallocx(12345, 0);
+	assert_ptr_not_null(p, "Unexpected mallocx() failure");
+	dallocx(p, 0);
+	/* Lifetimes of 10ms and more start at bucket 5. */
+	p = mallocx(12345, 0);
+	assert_ptr_not_null(p, "Unexpected mallocx() failure");
+	sleep_ns(20 * 1000 * 1000);
+	dallocx(p, 0);
+
+	size_t after[PROF_LIFETIME_NBUCKETS];
+	expect_u_gt(dump_lifetimes(after), 0, "Expected lifetimes lines");
+	size_t nfreed = 0;
+	size_t nlong = 0;
+	for (unsigned i = 0; i < PROF_LIFETIME_NBUCKETS; i++) {
+		expect_zu_ge(after[i], before[i], "Lifetime counts went down");
+		nfreed += after[i] - before[i];
+		if (i >= 5) {
+			nlong += after[i] - before[i];
+		}
+	}
+	expect_zu_ge(nfreed, 2, "Expected both frees to be counted");
+	expect_zu_gt(nlong, 0, "Expected a lifetime of at least 10ms");
+}
+TEST_END
+
+#define RECENT_MAX 4096
+static char   recent_buf[RECENT_MAX + 1];
+static size_t recent_len;
+
+static void
+recent_write_cb(void *cbopaque, const char *s) {
+	size_t len = strlen(s);
+	assert_zu_le(recent_len + len, RECENT_MAX, "Dump too large");
+	memcpy(&recent_buf[recent_len], s, len + 1);
+	recent_len += len;
+}
+
+TEST_BEGIN(test_prof_lifetime_recent) {
+	test_skip_if(!config_prof);
+
+	void *p = mallocx(12345, 0);
+	assert_ptr_not_null(p, "Unexpected mallocx() failure");
+	dallocx(p, 0);
+
+	static void *in[2] = {recent_write_cb, NULL};
+	recent_len = 0;
+	assert_d_eq(mallctl("experimental.prof_recent.alloc_dump", NULL, NULL,
+	                in, sizeof(in)),
+	    0, "Unexpected mallctl failure while dumping");
+	expect_ptr_not_null(strstr(recent_buf, "\"alloc_lifetimes\":["),
+	    "Expected lifetime histograms");
+	expect_ptr_not_null(
+	    strstr(recent_buf, "\"lifetime\":"), "Expected a released record");
+}
+TEST_END
+
+int
+main(void) {
+	return test_no_reentrancy(test_prof_lifetime, test_prof_lifetime_recent);
+}
@@ -0,0 +1,202 @@
+#include "test/jemalloc_test.h"
+
+#include "jemalloc/internal/prof_log.h"
+#include "jemalloc/internal/prof_sys.h"
+
+#define LOG_MAX (1U << 22)
+#define N_ALLOCS 2000
+
+static uint8_t log_buf[LOG_MAX];
+static size_t  log_len;
+
+static int
+prof_dump_open_file_intercept(const char *filename, int mode) {
+	int fd = open("/dev/null", O_WRONLY);
+	assert_d_ne(fd, -1, "Unexpected open() failure");
+	return fd;
+}
+
+/* Writes are serialized by the log, even from background thread 0. */
+static ssize_t
+prof_dump_write_file_intercept(int fd, const void *s, size_t len) {
+	if (config_debug) {
+		/* Appending to the log shouldn't wait for the file. */
+		expect_false(witness_owner(tsd_witness_tsdp_get(tsd_fetch()),
+		                 &log_mtx.witness),
+		    "Log written with log_mtx held");
+	}
+	assert_zu_le(log_len + len, LOG_MAX, "Log too large for the test");
+	memcpy(&log_buf[log_len], s, len);
+	log_len += len;
+	return (ssize_t)len;
+}
+
+static uint64_t
+read_varint(size_t *pos) {
+	uint64_t v = 0;
+	for (unsigned shift = 0; *pos < log_len; shift += 7) {
+		uint8_t b = log_buf[(*pos)++];
+		v |= (uint64_t)(b & 0x7f) << shift;
+		if ((b & 0x80) == 0) {
+			return v;
+		}
+	}
+	assert_not_reached("Truncated varint");
+	return 0;
+}
+
+static void
+skip_str(size_t *pos) {
+	uint64_t len = read_varint(pos);
+	assert_u64_le(len, log_len - *pos, "Truncated string");
+	*pos += len;
+}
+
+typedef struct {
+	size_t nthreads;
+	size_t ntraces;
+	size_t nallocs;
+} log_counts_t;
+
+/* Checks the structure of the log and counts its records. */
+static void
+decode_log(log_counts_t *counts) {
+	memset(counts, 0, sizeof(*counts));
+	assert_zu_ge(log_len, PROF_LOG_BINARY_MAGIC_LEN, "Log too short");
+	expect_d_eq(
+	    memcmp(log_buf, PROF_LOG_BINARY_MAGIC, PROF_LOG_BINARY_MAGIC_LEN),
+	    0, "Bad magic");
+
+	size_t pos = PROF_LOG_BINARY_MAGIC_LEN;
+	bool   ended = false;
+	for (bool first = true; pos < log_len; first = false) {
+		expect_false(ended, "The end record should come last");
+		prof_log_record_t type = (prof_log_record_t)log_buf[pos++];
+		expect_true(first == (type == prof_log_record_info),
+		    "The info record should come first, and only then");
+		switch (type) {
+		case prof_log_record_info:
+			skip_str(&pos);
+			expect_u64_eq(read_varint(&pos), 0,
+			    "Unexpected lg_sample_rate");
+			skip_str(&pos);
+			expect_u64_eq(read_varint(&pos), (uint64_t)getpid(),
+			    "Unexpected pid");
+			break;
+		case prof_log_record_thread:
+			read_varint(&pos);
+			skip_str(&pos);
+			counts->nthreads++;
+			break;
+		case prof_log_record_trace: {
+			uint64_t nframes = read_varint(&pos);
+			expect_u64_gt(nframes, 0, "Empty backtrace");
+			for (uint64_t i = 0; i < nframes; i++) {
+				read_varint(&pos);
+			}
+			counts->ntraces++;
+			break;
+		}
+		case prof_log_record_alloc: {
+			uint64_t v[7];
+			for (unsigned i = 0; i < 7; i++) {
+				v[i] = read_varint(&pos);
+			}
+			expect_u64_lt(v[0], counts->nthreads,
+			    "Allocating thread used before its record");
+			expect_u64_lt(v[1], counts->nthreads,
+			    "Freeing thread used before its record");
+			expect_u64_lt(v[2], counts->ntraces,
+			    "Allocation trace used before its record");
+			expect_u64_lt(v[3], counts->ntraces,
+			    "Free trace used before its record");
+			expect_u64_le(v[4], v[5], "Freed before allocated");
+			counts->nallocs++;
+			break;
+		}
+		case prof_log_record_end:
+			read_varint(&pos);
+			ended = true;
+			break;
+		default:
+			assert_not_reached("Unknown record type %d", (int)type);
+		}
+	}
+	expect_true(ended, "Missing end record");
+}
+
+static void *
+thd_start(void *arg) {
+	for (unsigned i = 0; i < N_ALLOCS; i++) {
+		void *p = mallocx(1 + (i % 64), 0);
+		assert_ptr_not_null(p, "Unexpected mallocx() failure");
+		dallocx(p, 0);
+	}
+	return NULL;
+}
+
+static void
+log_allocs(bool background_thread) {
+	prof_dump_open_file_t  *open_file_orig = prof_dump_open_file;
+	prof_dump_write_file_t *write_file_orig = prof_dump_write_file;
+	prof_dump_open_file = prof_dump_open_file_intercept;
+	prof_dump_write_file = prof_dump_write_file_intercept;
+	log_len = 0;
+
+	const char *filename = "prof_log_binary_test";
+	expect_d_eq(mallctl("prof.log_start", NULL, NULL, (void *)&filename,
+	                sizeof(filename)),
+	    0, "Unexpected mallctl failure when starting logging");
+
+	thd_start(NULL);
+	thd_t thd;
+	thd_create(&thd, thd_start, NULL);
+	thd_join(thd, NULL);
+
+	/* The log streams out; nothing is kept for each allocation. */
+	expect_zu_eq(prof_log_alloc_count(), 0, "Allocations kept in memory");
+	if (!background_thread) {
+		expect_zu_gt(log_len, 0, "Nothing written before log_stop");
+	}
+	size_t nthreads = prof_log_thr_count();
+	size_t ntraces = prof_log_bt_count();
+
+	expect_d_eq(mallctl("prof.log_stop", NULL, NULL, NULL, 0), 0,
+	    "Unexpected mallctl failure when stopping logging");
+	prof_dump_open_file = open_file_orig;
+	prof_dump_write_file = write_file_orig;
+
+	log_counts_t counts;
+	decode_log(&counts);
+	expect_zu_eq(counts.nthreads, nthreads, "Unexpected thread records");
+	expect_zu_eq(counts.ntraces, ntraces, "Unexpected trace records");
+	expect_zu_ge(counts.nthreads, 2, "Expected both threads");
+	expect_zu_ge(counts.nallocs, 2 * N_ALLOCS, "Missing allocations");
+}
+
+TEST_BEGIN(test_prof_log_binary) {
+	test_skip_if(!config_prof);
+	log_allocs(false);
+}
+TEST_END
+
+TEST_BEGIN(test_prof_log_binary_background_thread) {
+	test_skip_if(!config_prof || !have_background_thread);
+
+	bool enable = true;
+	expect_d_eq(mallctl("background_thread", NULL, NULL, (void *)&enable,
+	                sizeof(enable)),
+	    0, "Unexpected mallctl failure");
+	log_allocs(true);
+	enable = false;
+	expect_d_eq(mallctl("background_thread", NULL, NULL, (void *)&enable,
+	                sizeof(enable)),
+	    0, "Unexpected mallctl failure");
+}
+TEST_END
+
+int
+main(void) {
+	return test_no_reentrancy(
+	    test_prof_log_binary, test_prof_log_binary_background_thread);
+}
@@ -0,0 +1,119 @@
+#include "test/jemalloc_test.h"
+
+#include "jemalloc/internal/prof_data.h"
+#include "jemalloc/internal/prof_sys.h"
+
+#define NPTRS 16
+#define ADAPT_TIMEOUT_MS 5000
+#define HEADER_MAX 256
+
+static char   dump_buf[HEADER_MAX + 1];
+static size_t dump_len;
+
+static int
+prof_dump_open_file_intercept(const char *filename, int mode) {
+	int fd = open("/dev/null", O_WRONLY);
+	assert_d_ne(fd, -1, "Unexpected open() failure");
+	return fd;
+}
+
+/* Only the start of the dump is kept; the header is all the test needs. */
+static ssize_t
+prof_dump_write_file_intercept(int fd, const void *s, size_t len) {
+	size_t n = HEADER_MAX - dump_len;
+	if (n > len) {
+		n = len;
+	}
+	memcpy(&dump_buf[dump_len], s, n);
+	dump_len += n;
+	dump_buf[dump_len] = '\0';
+	return (ssize_t)len;
+}
+
+static size_t
+get_size_t(const char *name) {
+	size_t v;
+	size_t sz = sizeof(v);
+	expect_d_eq(mallctl(name, (void *)&v, &sz, NULL, 0), 0,
+	    "Unexpected mallctl() failure for %s", name);
+	return v;
+}
+
+TEST_BEGIN(test_prof_overhead) {
+	test_skip_if(!config_prof);
+
+	size_t lg_sample = get_size_t("prof.lg_sample");
+	prof_cnt_t cnt_before;
+	prof_cnt_all(&cnt_before);
+
+	/* Sampled at whatever the rate is now. */
+	void *ptrs[NPTRS];
+	for (unsigned i = 0; i < NPTRS; i++) {
+		ptrs[i] = mallocx(4096, 0);
+		assert_ptr_not_null(ptrs[i], "Unexpected mallocx() failure");
+	}
+
+	/* Everything is sampled, so the 1ppm budget can't hold for long. */
+	nstime_t start;
+	nstime_init_update(&start);
+	while (get_size_t("prof.lg_sample_effective") == lg_sample
+	    && nstime_ms_since(&start) < ADAPT_TIMEOUT_MS) {
+		for (unsigned i = 0; i < 100; i++) {
+			void *p = mallocx(1024, 0);
+			assert_ptr_not_null(p, "Unexpected mallocx() failure");
+			dallocx(p, 0);
+		}
+	}
+	size_t lg_effective = get_size_t("prof.lg_sample_effective");
+	expect_zu_gt(lg_effective, lg_sample, "Sampling rate should drop");
+	expect_zu_lt(lg_effective, lg_sample + PROF_SAMPLE_NSTEPS,
+	    "Sampling rate dropped too far");
+	expect_zu_eq(get_size_t("prof.lg_sample"), lg_sample,
+	    "The configured rate should stay as is");
+
+	/* Each object gives back what it added, at the rate it was taken. */
+	for (unsigned i = 0; i < NPTRS; i++) {
+		dallocx(ptrs[i], 0);
+	}
+	prof_cnt_t cnt_after;
+	prof_cnt_all(&cnt_after);
+	expect_u64_eq(cnt_after.curobjs, cnt_before.curobjs,
+	    "Unexpected live objects");
+	expect_u64_eq(cnt_after.curobjs_shifted_unbiased,
+	    cnt_before.curobjs_shifted_unbiased,
+	    "Unbiased object count should be back where it was");
+	expect_u64_eq(cnt_after.curbytes_unbiased, cnt_before.curbytes_unbiased,
+	    "Unbiased byte count should be back where it was");
+
+	/* Dumps report the rate in effect. */
+	prof_dump_open_file_t  *open_file_orig = prof_dump_open_file;
+	prof_dump_write_file_t *write_file_orig = prof_dump_write_file;
+	prof_dump_open_file = prof_dump_open_file_intercept;
+	prof_dump_write_file = prof_dump_write_file_intercept;
+	dump_len = 0;
+	lg_effective = get_size_t("prof.lg_sample_effective");
+	const char *filename = "test_filename";
+	expect_d_eq(mallctl("prof.dump", NULL, NULL, (void *)&filename,
+	                sizeof(filename)),
+	    0, "Unexpected mallctl failure while dumping");
+	prof_dump_open_file = open_file_orig;
+	prof_dump_write_file = write_file_orig;
+	char header[64];
+	malloc_snprintf(header, sizeof(header), "heap_v2/%" FMTu64 "\n",
+	    (uint64_t)1 << lg_effective);
+	expect_d_eq(strncmp(dump_buf, header, strlen(header)), 0,
+	    "Expected the effective rate in the dump header");
+
+	/* A reset starts over from the new rate. */
+	expect_d_eq(mallctl("prof.reset", NULL, NULL, (void *)&lg_sample,
+	                sizeof(lg_sample)),
+	    0, "Unexpected mallctl failure while resetting");
+	expect_zu_eq(get_size_t("prof.lg_sample_effective"), lg_sample,
+	    "Reset should undo the adjustment");
+}
+TEST_END
+
+int
+main(void) {
+	return test_no_reentrancy(test_prof_overhead);
+}
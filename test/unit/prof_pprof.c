@@ -0,0 +1,269 @@
+#include "test/jemalloc_test.h"
+
+#include "jemalloc/internal/prof_sys.h"
+
+/*
+ * A small profile.proto decoder, just enough to check the structure of what
+ * the dump wrote.
+ */
+#define DUMP_MAX (1U << 20)
+#define NSTRS_MAX 64
+#define NLOCS_MAX 4096
+
+static unsigned char dump_buf[DUMP_MAX];
+static size_t        dump_len;
+
+#define FAKE_MAP_START 0x1000
+#define FAKE_MAP_LIMIT 0x7fffffffffff
+static const char *fake_maps =
+    "1000-7fffffffffff r-xp 00001000 fd:01 1234     /fake/binary\n"
+    "2000-3000 rw-p 00000000 00:00 0 \n";
+
+static int
+prof_dump_open_file_intercept(const char *filename, int mode) {
+	int fd = open("/dev/null", O_WRONLY);
+	assert_d_ne(fd, -1, "Unexpected open() failure");
+	return fd;
+}
+
+static ssize_t
+prof_dump_write_file_intercept(int fd, const void *s, size_t len) {
+	assert_zu_le(dump_len + len, DUMP_MAX, "Dump too large for the test");
+	memcpy(&dump_buf[dump_len], s, len);
+	dump_len += len;
+	return (ssize_t)len;
+}
+
+static int
+prof_dump_open_maps_intercept(void) {
+	int fds[2];
+	assert_d_eq(pipe(fds), 0, "Unexpected pipe() failure");
+	size_t len = strlen(fake_maps);
+	assert_zd_eq(write(fds[1], fake_maps, len), (ssize_t)len,
+	    "Unexpected write() failure");
+	close(fds[1]);
+	return fds[0];
+}
+
+static uint64_t
+read_varint(const unsigned char *buf, size_t len, size_t *pos) {
+	uint64_t v = 0;
+	for (unsigned shift = 0; *pos < len; shift += 7) {
+		unsigned char b = buf[(*pos)++];
+		v |= (uint64_t)(b & 0x7f) << shift;
+		if ((b & 0x80) == 0) {
+			return v;
+		}
+	}
+	expect_true(false, "Truncated varint");
+	return 0;
+}
+
+/*
+ * Walks the fields of a message; returns false at the end.  For
+ * length-delimited fields, *v is the length and *body the contents.
+ */
+static bool
+next_field(const unsigned char *buf, size_t len, size_t *pos,
+    unsigned *field, uint64_t *v, const unsigned char **body) {
+	if (*pos >= len) {
+		return false;
+	}
+	uint64_t key = read_varint(buf, len, pos);
+	*field = (unsigned)(key >> 3);
+	switch (key & 7) {
+	case 0:
+		*v = read_varint(buf, len, pos);
+		*body = NULL;
+		break;
+	case 2:
+		*v = read_varint(buf, len, pos);
+		*body = &buf[*pos];
+		assert_zu_le(*pos + *v, len, "Truncated field");
+		*pos += *v;
+		break;
+	default:
+		assert_not_reached("Unexpected wire type %u", (unsigned)(key & 7));
+	}
+	return true;
+}
+
+typedef struct {
+	const unsigned char *str[NSTRS_MAX];
+	size_t               str_len[NSTRS_MAX];
+	unsigned             nstrs;
+	uint64_t             sample_type[4];
+	unsigned             nsample_types;
+	uint64_t             period;
+	unsigned             nmappings;
+	uint64_t             mapping_filename;
+	uint64_t             loc_mapping_id[NLOCS_MAX + 1];
+	uint64_t             loc_addr[NLOCS_MAX + 1];
+	unsigned             nlocs;
+} profile_t;
+
+static bool
+str_eq(const profile_t *profile, uint64_t ind, const char *s) {
+	return ind < profile->nstrs && profile->str_len[ind] == strlen(s)
+	    && memcmp(profile->str[ind], s, strlen(s)) == 0;
+}
+
+static void
+decode_submessage(const unsigned char *buf, size_t len, uint64_t *fields,
+    unsigned nfields) {
+	size_t               pos = 0;
+	unsigned             field;
+	uint64_t             v;
+	const unsigned char *body;
+	memset(fields, 0, nfields * sizeof(uint64_t));
+	while (next_field(buf, len, &pos, &field, &v, &body)) {
+		if (field < nfields && body == NULL) {
+			fields[field] = v;
+		}
+	}
+}
+
+/* First pass: everything but the samples. */
+static void
+decode_profile(profile_t *profile) {
+	size_t               pos = 0;
+	unsigned             field;
+	uint64_t             v;
+	const unsigned char *body;
+	uint64_t             fields[6];
+
+	memset(profile, 0, sizeof(*profile));
+	while (next_field(dump_buf, dump_len, &pos, &field, &v, &body)) {
+		switch (field) {
+		case 1: /* sample_type */
+			assert_u_lt(profile->nsample_types, 4,
+			    "Too many sample types");
+			decode_submessage(body, v, fields, 3);
+			profile->sample_type[profile->nsample_types++] =
+			    fields[1];
+			break;
+		case 3: /* mapping */
+			decode_submessage(body, v, fields, 6);
+			profile->nmappings++;
+			expect_u64_eq(fields[1], profile->nmappings,
+			    "Unexpected mapping id");
+			expect_u64_eq(fields[2], FAKE_MAP_START,
+			    "Unexpected mapping start");
+			expect_u64_eq(fields[3], FAKE_MAP_LIMIT,
+			    "Unexpected mapping limit");
+			expect_u64_eq(fields[4], 0x1000,
+			    "Unexpected mapping offset");
+			profile->mapping_filename = fields[5];
+			break;
+		case 4: /* location */
+			decode_submessage(body, v, fields, 4);
+			assert_u64_ge(fields[1], 1, "Location ids start at 1");
+			assert_u64_le(fields[1], NLOCS_MAX, "Too many locations");
+			profile->loc_mapping_id[fields[1]] = fields[2];
+			profile->loc_addr[fields[1]] = fields[3];
+			profile->nlocs++;
+			break;
+		case 6: /* string_table */
+			assert_u_lt(profile->nstrs, NSTRS_MAX, "Too many strings");
+			profile->str[profile->nstrs] = body;
+			profile->str_len[profile->nstrs] = v;
+			profile->nstrs++;
+			break;
+		case 12: /* period */
+			profile->period = v;
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+TEST_BEGIN(test_pprof_dump) {
+	test_skip_if(!config_prof);
+
+	prof_dump_open_file_t  *open_file_orig = prof_dump_open_file;
+	prof_dump_write_file_t *write_file_orig = prof_dump_write_file;
+	prof_dump_open_maps_t  *open_maps_orig = prof_dump_open_maps;
+	prof_dump_open_file = prof_dump_open_file_intercept;
+	prof_dump_write_file = prof_dump_write_file_intercept;
+	prof_dump_open_maps = prof_dump_open_maps_intercept;
+
+	size_t sz = 12345;
+	void  *p = mallocx(sz, 0);
+	assert_ptr_not_null(p, "Unexpected mallocx() failure");
+
+	dump_len = 0;
+	const char *filename = "test_filename";
+	expect_d_eq(mallctl("prof.dump", NULL, NULL, (void *)&filename,
+	                sizeof(filename)),
+	    0, "Unexpected mallctl failure while dumping");
+	dallocx(p, 0);
+
+	prof_dump_open_file = open_file_orig;
+	prof_dump_write_file = write_file_orig;
+	prof_dump_open_maps = open_maps_orig;
+
+	profile_t *profile = (profile_t *)malloc(sizeof(profile_t));
+	assert_ptr_not_null(profile, "Unexpected malloc() failure");
+	decode_profile(profile);
+
+	expect_true(str_eq(profile, 0, ""), "String table must start empty");
+	expect_u_eq(profile->nsample_types, 2, "Expected inuse values only");
+	expect_true(str_eq(profile, profile->sample_type[0], "inuse_objects"),
+	    "Unexpected first sample type");
+	expect_true(str_eq(profile, profile->sample_type[1], "inuse_space"),
+	    "Unexpected second sample type");
+	expect_u64_eq(profile->period, 1, "Period should be 2^lg_prof_sample");
+	expect_u_eq(profile->nmappings, 1, "Only executable mappings count");
+	expect_true(str_eq(profile, profile->mapping_filename, "/fake/binary"),
+	    "Unexpected mapping file name");
+	expect_u_gt(profile->nlocs, 0, "Expected locations");
+	for (unsigned i = 1; i <= profile->nlocs; i++) {
+		if (profile->loc_addr[i] >= FAKE_MAP_START
+		    && profile->loc_addr[i] < FAKE_MAP_LIMIT) {
+			expect_u64_eq(profile->loc_mapping_id[i], 1,
+			    "Location should be in the fake mapping");
+		}
+	}
+
+	/* Second pass: the samples. */
+	size_t               pos = 0;
+	unsigned             field;
+	uint64_t             v;
+	const unsigned char *body;
+	bool                 found = false;
+	while (next_field(dump_buf, dump_len, &pos, &field, &v, &body)) {
+		if (field != 2) {
+			continue;
+		}
+		size_t               spos = 0;
+		unsigned             sfield;
+		uint64_t             sv;
+		const unsigned char *sbody;
+		uint64_t             values[2] = {0, 0};
+		while (next_field(body, v, &spos, &sfield, &sv, &sbody)) {
+			assert_ptr_not_null(sbody, "Expected packed fields");
+			size_t ppos = 0;
+			for (unsigned i = 0; ppos < sv; i++) {
+				uint64_t x = read_varint(sbody, sv, &ppos);
+				if (sfield == 1) {
+					expect_true(x >= 1 && x <= profile->nlocs,
+					    "Unknown location id %" FMTu64, x);
+				} else if (sfield == 2 && i < 2) {
+					values[i] = x;
+				}
+			}
+		}
+		if (values[0] >= 1 && values[1] >= sz) {
+			found = true;
+		}
+	}
+	expect_true(found, "Expected a sample for the live allocation");
+	free(profile);
+}
+TEST_END
+
+int
+main(void) {
+	return test_no_reentrancy(test_pprof_dump);
+}
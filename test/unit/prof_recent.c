@@ -149,11 +149,20 @@ confirm_record_released(prof_recent_t *n) {
 	    "dalloc_tctx in record should not be NULL for released pointer");
 }
 
+/* Fills records, oldest first, and returns how many there are. */
+#define NRECORDS_MAX 1024
+static prof_recent_t *records[NRECORDS_MAX];
+
+static unsigned
+records_get(void) {
+	return (unsigned)prof_recent_alloc_records_test(records, NRECORDS_MAX);
+}
+
 TEST_BEGIN(test_prof_recent_alloc) {
 	test_skip_if(!config_prof);
 
 	bool           b;
-	unsigned       i, c;
+	unsigned       i, c, j, nrecords;
 	size_t         req_size;
 	void          *p;
 	prof_recent_t *n;
@@ -171,8 +180,8 @@ TEST_BEGIN(test_prof_recent_alloc) {
 		p = malloc(req_size);
 		confirm_malloc(p);
 		if (i < OPT_ALLOC_MAX - 1) {
-			assert_false(ql_empty(&prof_recent_alloc_list),
-			    "Empty recent allocation");
+			assert_u_ne(
+			    records_get(), 0, "Empty recent allocation");
 			free(p);
 			/*
 			 * The recorded allocations may still include some
@@ -182,7 +191,9 @@ TEST_BEGIN(test_prof_recent_alloc) {
 			continue;
 		}
 		c = 0;
-		ql_foreach (n, &prof_recent_alloc_list, link) {
+		nrecords = records_get();
+		for (j = 0; j < nrecords; j++) {
+			n = records[j];
 			++c;
 			confirm_record_size(n, i + c - OPT_ALLOC_MAX);
 			if (c == OPT_ALLOC_MAX) {
@@ -211,7 +222,9 @@ TEST_BEGIN(test_prof_recent_alloc) {
 		p = malloc(req_size);
 		assert_ptr_not_null(p, "malloc failed unexpectedly");
 		c = 0;
-		ql_foreach (n, &prof_recent_alloc_list, link) {
+		nrecords = records_get();
+		for (j = 0; j < nrecords; j++) {
+			n = records[j];
 			confirm_record_size(n, c + OPT_ALLOC_MAX);
 			confirm_record_released(n);
 			++c;
@@ -238,7 +251,9 @@ TEST_BEGIN(test_prof_recent_alloc) {
 		p = malloc(req_size);
 		confirm_malloc(p);
 		c = 0;
-		ql_foreach (n, &prof_recent_alloc_list, link) {
+		nrecords = records_get();
+		for (j = 0; j < nrecords; j++) {
+			n = records[j];
 			++c;
 			confirm_record_size(n,
 			    /* Is the allocation from the third batch? */
@@ -269,7 +284,9 @@ TEST_BEGIN(test_prof_recent_alloc) {
 	                &future, sizeof(ssize_t)),
 	    0, "Write error");
 	c = 0;
-	ql_foreach (n, &prof_recent_alloc_list, link) {
+	nrecords = records_get();
+	for (j = 0; j < nrecords; j++) {
+		n = records[j];
 		confirm_record_size(n, c + 3 * OPT_ALLOC_MAX);
 		confirm_record_released(n);
 		++c;
@@ -285,7 +302,9 @@ TEST_BEGIN(test_prof_recent_alloc) {
 	                &future, sizeof(ssize_t)),
 	    0, "Write error");
 	c = 0;
-	ql_foreach (n, &prof_recent_alloc_list, link) {
+	nrecords = records_get();
+	for (j = 0; j < nrecords; j++) {
+		n = records[j];
 		confirm_record_size(n, c + 3 * OPT_ALLOC_MAX);
 		confirm_record_released(n);
 		++c;
@@ -301,7 +320,9 @@ TEST_BEGIN(test_prof_recent_alloc) {
 	                &future, sizeof(ssize_t)),
 	    0, "Write error");
 	c = 0;
-	ql_foreach (n, &prof_recent_alloc_list, link) {
+	nrecords = records_get();
+	for (j = 0; j < nrecords; j++) {
+		n = records[j];
 		++c;
 		confirm_record_size(n, c + 3 * OPT_ALLOC_MAX);
 		confirm_record_released(n);
@@ -315,7 +336,9 @@ TEST_BEGIN(test_prof_recent_alloc) {
 	                &future, sizeof(ssize_t)),
 	    0, "Write error");
 	c = 0;
-	ql_foreach (n, &prof_recent_alloc_list, link) {
+	nrecords = records_get();
+	for (j = 0; j < nrecords; j++) {
+		n = records[j];
 		++c;
 		confirm_record_size(n, c + 3 * OPT_ALLOC_MAX);
 		confirm_record_released(n);
@@ -328,28 +351,25 @@ TEST_BEGIN(test_prof_recent_alloc) {
 	assert_d_eq(mallctl("experimental.prof_recent.alloc_max", NULL, NULL,
 	                &future, sizeof(ssize_t)),
 	    0, "Write error");
-	assert_false(ql_empty(&prof_recent_alloc_list), "Recent list is empty");
-	n = ql_first(&prof_recent_alloc_list);
+	assert_u_eq(
+	    records_get(), 1, "Recent list should only contain one record");
+	n = records[0];
 	confirm_record_size(n, 4 * OPT_ALLOC_MAX - 1);
 	confirm_record_released(n);
-	n = ql_next(&prof_recent_alloc_list, n, link);
-	assert_ptr_null(n, "Recent list should only contain one record");
 
 	/* Completely turn off. */
 	future = 0;
 	assert_d_eq(mallctl("experimental.prof_recent.alloc_max", NULL, NULL,
 	                &future, sizeof(ssize_t)),
 	    0, "Write error");
-	assert_true(
-	    ql_empty(&prof_recent_alloc_list), "Recent list should be empty");
+	assert_u_eq(records_get(), 0, "Recent list should be empty");
 
 	/* Restore the settings. */
 	future = OPT_ALLOC_MAX;
 	assert_d_eq(mallctl("experimental.prof_recent.alloc_max", NULL, NULL,
 	                &future, sizeof(ssize_t)),
 	    0, "Write error");
-	assert_true(
-	    ql_empty(&prof_recent_alloc_list), "Recent list should be empty");
+	assert_u_eq(records_get(), 0, "Recent list should be empty");
 
 	confirm_prof_setup();
 }
@@ -574,6 +594,137 @@ TEST_END
 #undef DUMP_ERROR
 #undef DUMP_OUT_SIZE
 
+/* More than the smallest ring can hold. */
+#define N_GROW 300
+static void *grow_ptrs[N_GROW];
+
+TEST_BEGIN(test_prof_recent_alloc_grow) {
+	test_skip_if(!config_prof);
+
+	confirm_prof_setup();
+	ssize_t future = -1;
+	assert_d_eq(mallctl("experimental.prof_recent.alloc_max", NULL, NULL,
+	                &future, sizeof(ssize_t)),
+	    0, "Write error");
+
+	for (unsigned i = 0; i < N_GROW; i++) {
+		grow_ptrs[i] = malloc(i + 1);
+		confirm_malloc(grow_ptrs[i]);
+	}
+	unsigned nrecords = records_get();
+	assert_u_ge(nrecords, N_GROW, "No record should be evicted");
+	for (unsigned i = 0; i < N_GROW; i++) {
+		prof_recent_t *n = records[nrecords - N_GROW + i];
+		expect_zu_eq(n->size, i + 1, "Records should stay in order");
+		confirm_record_living(n);
+	}
+	for (unsigned i = 0; i < N_GROW; i++) {
+		free(grow_ptrs[i]);
+	}
+	nrecords = records_get();
+	for (unsigned i = 0; i < N_GROW; i++) {
+		confirm_record_released(records[nrecords - N_GROW + i]);
+	}
+
+	future = OPT_ALLOC_MAX;
+	assert_d_eq(mallctl("experimental.prof_recent.alloc_max", NULL, NULL,
+	                &future, sizeof(ssize_t)),
+	    0, "Write error");
+	assert_u_eq(records_get(), OPT_ALLOC_MAX,
+	    "Lowering the limit should evict the older records");
+	expect_zu_eq(records[OPT_ALLOC_MAX - 1]->size, N_GROW,
+	    "The newest record should be kept");
+
+	confirm_prof_setup();
+}
+TEST_END
+
+#undef N_GROW
+#undef NRECORDS_MAX
+
+/* Enough records for the dump to overflow its buffer. */
+#define N_CB 1024
+static void      *cb_ptrs[N_CB];
+static unsigned   cb_calls;
+static atomic_u_t cb_stage;
+
+/*
+ * Records more allocations (growing the ring) and updates the max, both of
+ * which need prof_recent_alloc_mtx, while the dump is calling out.
+ */
+static void *
+f_dump_helper(void *arg) {
+	while (atomic_load_u(&cb_stage, ATOMIC_ACQUIRE) == 0) {
+		sleep_ns(1000 * 1000);
+	}
+	void *ptrs[N_CB];
+	for (unsigned i = 0; i < N_CB; i++) {
+		ptrs[i] = malloc(1);
+	}
+	ssize_t max = -1;
+	assert_d_eq(mallctl("experimental.prof_recent.alloc_max", NULL, NULL,
+	                &max, sizeof(ssize_t)),
+	    0, "Write error");
+	for (unsigned i = 0; i < N_CB; i++) {
+		free(ptrs[i]);
+	}
+	atomic_store_u(&cb_stage, 2, ATOMIC_RELEASE);
+	return NULL;
+}
+
+static void
+test_dump_wait_write_cb(void *not_used, const char *str) {
+	if (cb_calls++ != 0) {
+		return;
+	}
+	/* Wait (for at most 10s) without touching the allocator. */
+	atomic_store_u(&cb_stage, 1, ATOMIC_RELEASE);
+	for (unsigned i = 0; i < 10 * 1000
+	    && atomic_load_u(&cb_stage, ATOMIC_ACQUIRE) != 2;
+	    i++) {
+		sleep_ns(1000 * 1000);
+	}
+}
+
+TEST_BEGIN(test_prof_recent_alloc_dump_unlocked) {
+	test_skip_if(!config_prof);
+
+	confirm_prof_setup();
+	ssize_t max = -1;
+	assert_d_eq(mallctl("experimental.prof_recent.alloc_max", NULL, NULL,
+	                &max, sizeof(ssize_t)),
+	    0, "Write error");
+	for (unsigned i = 0; i < N_CB; i++) {
+		cb_ptrs[i] = malloc(1);
+		confirm_malloc(cb_ptrs[i]);
+	}
+
+	cb_calls = 0;
+	atomic_store_u(&cb_stage, 0, ATOMIC_RELAXED);
+	thd_t thd;
+	thd_create(&thd, f_dump_helper, NULL);
+	void *in[2] = {test_dump_wait_write_cb, NULL};
+	assert_d_eq(mallctl("experimental.prof_recent.alloc_dump", NULL, NULL,
+	                in, sizeof(in)),
+	    0, "Dump mallctl raised error");
+	expect_u_gt(cb_calls, 1, "The dump should not fit in one write");
+	expect_u_eq(atomic_load_u(&cb_stage, ATOMIC_ACQUIRE), 2,
+	    "Recording and updating the max shouldn't wait for the dump");
+	thd_join(thd, NULL);
+
+	for (unsigned i = 0; i < N_CB; i++) {
+		free(cb_ptrs[i]);
+	}
+	max = OPT_ALLOC_MAX;
+	assert_d_eq(mallctl("experimental.prof_recent.alloc_max", NULL, NULL,
+	                &max, sizeof(ssize_t)),
+	    0, "Write error");
+	confirm_prof_setup();
+}
+TEST_END
+
+#undef N_CB
+
 #define N_THREADS 8
 #define N_PTRS 512
 #define N_CTLS 8
@@ -693,5 +844,6 @@ int
 main(void) {
 	return test(test_confirm_setup, test_prof_recent_off,
 	    test_prof_recent_on, test_prof_recent_alloc,
-	    test_prof_recent_alloc_dump, test_prof_recent_stress);
+	    test_prof_recent_alloc_dump, test_prof_recent_alloc_grow,
+	    test_prof_recent_alloc_dump_unlocked, test_prof_recent_stress);
 }
@@ -0,0 +1,166 @@
+#include "test/jemalloc_test.h"
+
+#include "jemalloc/internal/prof_snapshot.h"
+
+#define SZ 4096
+#define NPTRS 32
+#define OUT_MAX (1U << 20)
+/* Enough distinct backtraces for the snapshot's table to grow. */
+#define NBTS 200
+
+static void  *ptrs[NPTRS];
+static char   out[OUT_MAX];
+static size_t out_len;
+
+typedef struct {
+	const char *name;
+	size_t      threshold;
+	write_cb_t *write_cb;
+	void       *cbopaque;
+} diff_packet_t;
+
+static void
+write_cb(void *opaque, const char *s) {
+	size_t len = strlen(s);
+	assert_zu_lt(out_len + len, OUT_MAX, "Diff too large for the test");
+	memcpy(&out[out_len], s, len + 1);
+	out_len += len;
+}
+
+JEMALLOC_NOINLINE static void
+leak(void) {
+	for (unsigned i = 0; i < NPTRS; i++) {
+		ptrs[i] = mallocx(SZ, 0);
+		assert_ptr_not_null(ptrs[i], "Unexpected mallocx() failure");
+	}
+}
+
+static void
+snapshot(const char *name) {
+	expect_d_eq(
+	    mallctl("prof.snapshot", NULL, NULL, (void *)&name, sizeof(name)),
+	    0, "Unexpected mallctl() failure");
+}
+
+static int
+diff(const char *name, size_t threshold) {
+	diff_packet_t packet = {name, threshold, write_cb, NULL};
+	out_len = 0;
+	out[0] = '\0';
+	return mallctl("prof.diff", NULL, NULL, (void *)&packet,
+	    sizeof(packet));
+}
+
+/* The largest live byte count reported in the diff, and how many grew. */
+static uint64_t
+diff_max_curbytes(unsigned *ngrown) {
+	uint64_t    max = 0;
+	const char *key = ",\"curbytes\":";
+	*ngrown = 0;
+	for (const char *p = strstr(out, key); p != NULL;
+	     p = strstr(p + 1, key)) {
+		uint64_t v = strtoull(p + strlen(key), NULL, 10);
+		if (v > max) {
+			max = v;
+		}
+		(*ngrown)++;
+	}
+	return max;
+}
+
+TEST_BEGIN(test_prof_snapshot_diff) {
+	test_skip_if(!config_prof);
+
+	snapshot("base");
+	leak();
+
+	unsigned ngrown;
+	expect_d_eq(diff("base", 0), 0, "Unexpected mallctl() failure");
+	expect_ptr_not_null(strstr(out, "\"snapshot\":\"base\""),
+	    "Missing snapshot name");
+	expect_u64_ge(diff_max_curbytes(&ngrown), NPTRS * SZ,
+	    "The leak should be reported");
+	expect_u_ge(ngrown, 1, "Expected a grown backtrace");
+
+	expect_d_eq(diff("base", 100 * NPTRS * SZ), 0,
+	    "Unexpected mallctl() failure");
+	expect_ptr_not_null(
+	    strstr(out, "\"grown\":[]"), "Nothing grew by that much");
+
+	snapshot("after");
+	expect_d_eq(diff("after", 0), 0, "Unexpected mallctl() failure");
+	expect_u64_lt(diff_max_curbytes(&ngrown), NPTRS * SZ,
+	    "The leak was already there at the snapshot");
+
+	for (unsigned i = 0; i < NPTRS; i++) {
+		dallocx(ptrs[i], 0);
+	}
+	expect_d_eq(diff("base", 0), 0, "Unexpected mallctl() failure");
+	expect_u64_lt(diff_max_curbytes(&ngrown), NPTRS * SZ,
+	    "The leak is gone");
+}
+TEST_END
+
+TEST_BEGIN(test_prof_snapshot_many) {
+	test_skip_if(!config_prof);
+
+	snapshot("before");
+	void *bt_ptrs[NBTS];
+	for (unsigned i = 0; i < NBTS; i++) {
+		bt_ptrs[i] = btalloc(1, i);
+		assert_ptr_not_null(bt_ptrs[i], "Unexpected btalloc() failure");
+	}
+
+	unsigned ngrown;
+	expect_d_eq(diff("before", 0), 0, "Unexpected mallctl() failure");
+	diff_max_curbytes(&ngrown);
+	expect_u_ge(ngrown, NBTS, "Each backtrace should have grown");
+
+	snapshot("many");
+	expect_d_eq(diff("many", 0), 0, "Unexpected mallctl() failure");
+	diff_max_curbytes(&ngrown);
+	expect_u_lt(ngrown, NBTS, "Backtraces should be in the snapshot");
+
+	for (unsigned i = 0; i < NBTS; i++) {
+		dallocx(bt_ptrs[i], 0);
+	}
+}
+TEST_END
+
+TEST_BEGIN(test_prof_snapshot_names) {
+	test_skip_if(!config_prof);
+
+	expect_d_eq(diff("missing", 0), EINVAL, "No such snapshot");
+	const char *name = NULL;
+	expect_d_eq(
+	    mallctl("prof.snapshot", NULL, NULL, (void *)&name, sizeof(name)),
+	    EINVAL, "A snapshot needs a name");
+	char long_name[PROF_SNAPSHOT_NAME_MAX + 1];
+	memset(long_name, 'a', PROF_SNAPSHOT_NAME_MAX);
+	long_name[PROF_SNAPSHOT_NAME_MAX] = '\0';
+	name = long_name;
+	expect_d_eq(
+	    mallctl("prof.snapshot", NULL, NULL, (void *)&name, sizeof(name)),
+	    EINVAL, "Name too long");
+
+	/* One more than fits drops the oldest. */
+	char names[PROF_SNAPSHOT_MAX + 1][8];
+	for (unsigned i = 0; i <= PROF_SNAPSHOT_MAX; i++) {
+		malloc_snprintf(names[i], sizeof(names[i]), "s%u", i);
+		snapshot(names[i]);
+	}
+	expect_d_eq(diff(names[0], 0), EINVAL, "Oldest should be dropped");
+	for (unsigned i = 1; i <= PROF_SNAPSHOT_MAX; i++) {
+		expect_d_eq(diff(names[i], 0), 0, "Snapshot should be kept");
+	}
+	/* Taking a snapshot again under its name keeps the others. */
+	snapshot(names[1]);
+	expect_d_eq(diff(names[2], 0), 0, "Snapshot should be kept");
+}
+TEST_END
+
+int
+main(void) {
+	return test_no_reentrancy(test_prof_snapshot_diff,
+	    test_prof_snapshot_many, test_prof_snapshot_names);
+}
@@ -1,6 +1,10 @@
 #include "test/jemalloc_test.h"
 
 #include "jemalloc/internal/prof_data.h"
+#include "jemalloc/internal/prof_sys.h"
+
+#define NTHREADS 4
+#define NALLOCS_PER_THREAD 64
 
 TEST_BEGIN(test_prof_realloc) {
 	tsd_t      *tsd;
@@ -41,7 +45,112 @@ TEST_BEGIN(test_prof_realloc) {
 }
 TEST_END
 
+static void *
+thd_start(void *varg) {
+	unsigned thd_ind = *(unsigned *)varg;
+	void    *ptrs[NALLOCS_PER_THREAD];
+
+	/* Distinct backtraces, spread over the bt2gctx shards. */
+	for (unsigned i = 0; i < NALLOCS_PER_THREAD; i++) {
+		ptrs[i] = btalloc(1, thd_ind * NALLOCS_PER_THREAD + i);
+		expect_ptr_not_null(ptrs[i], "Unexpected btalloc() failure");
+	}
+	expect_zu_ge(prof_bt_count(), NALLOCS_PER_THREAD,
+	    "Expected a backtrace per live sampled allocation");
+	for (unsigned i = 0; i < NALLOCS_PER_THREAD; i++) {
+		dallocx(ptrs[i], 0);
+	}
+	return NULL;
+}
+
+TEST_BEGIN(test_prof_gctx_destroy) {
+	thd_t    thds[NTHREADS];
+	unsigned thd_args[NTHREADS];
+
+	test_skip_if(!config_prof);
+
+	size_t bt_count = prof_bt_count();
+	for (unsigned i = 0; i < NTHREADS; i++) {
+		thd_args[i] = i;
+		thd_create(&thds[i], thd_start, (void *)&thd_args[i]);
+	}
+	for (unsigned i = 0; i < NTHREADS; i++) {
+		thd_join(thds[i], NULL);
+	}
+	expect_zu_eq(prof_bt_count(), bt_count,
+	    "Backtraces without live allocations should have been destroyed");
+}
+TEST_END
+
+static void *dump_ptrs[NALLOCS_PER_THREAD];
+static bool  dump_thd_done;
+
+static void *
+dump_thd_start(void *varg) {
+	/* Send the tctx's of the dumped allocations to purgatory. */
+	for (unsigned i = 0; i < NALLOCS_PER_THREAD; i++) {
+		dallocx(dump_ptrs[i], 0);
+	}
+	/* And create (and destroy) backtraces that the dump doesn't include. */
+	return thd_start(varg);
+}
+
+static int
+prof_dump_open_file_intercept(const char *filename, int mode) {
+	int fd = open("/dev/null", O_WRONLY);
+	assert_d_ne(fd, -1, "Unexpected open() failure");
+	return fd;
+}
+
+static ssize_t
+prof_dump_write_file_intercept(int fd, const void *s, size_t len) {
+	/*
+	 * Once the dump gets to the backtraces, it holds no profiling locks
+	 * while writing, and other threads can sample as they please.
+	 */
+	if (!dump_thd_done && memchr(s, '@', len) != NULL) {
+		witness_assert_depth_to_rank(
+		    tsdn_witness_tsdp_get(tsd_tsdn(tsd_fetch())),
+		    WITNESS_RANK_PROF_BT2GCTX, 0);
+		thd_t    thd;
+		unsigned thd_arg = NTHREADS;
+		thd_create(&thd, dump_thd_start, (void *)&thd_arg);
+		thd_join(thd, NULL);
+		dump_thd_done = true;
+	}
+	return (ssize_t)len;
+}
+
+TEST_BEGIN(test_prof_dump_concurrent) {
+	test_skip_if(!config_prof);
+
+	prof_dump_open_file_t  *open_file_orig = prof_dump_open_file;
+	prof_dump_write_file_t *write_file_orig = prof_dump_write_file;
+	prof_dump_open_file = prof_dump_open_file_intercept;
+	prof_dump_write_file = prof_dump_write_file_intercept;
+
+	size_t bt_count = prof_bt_count();
+	for (unsigned i = 0; i < NALLOCS_PER_THREAD; i++) {
+		dump_ptrs[i] = btalloc(
+		    1, (NTHREADS + 1) * NALLOCS_PER_THREAD + i);
+		expect_ptr_not_null(
+		    dump_ptrs[i], "Unexpected btalloc() failure");
+	}
+	dump_thd_done = false;
+	expect_d_eq(mallctl("prof.dump", NULL, NULL, NULL, 0), 0,
+	    "Unexpected error while dumping heap profile");
+	expect_true(dump_thd_done, "Expected the dump to write backtraces");
+
+	prof_dump_open_file = open_file_orig;
+	prof_dump_write_file = write_file_orig;
+
+	expect_zu_eq(prof_bt_count(), bt_count,
+	    "Backtraces without live allocations should have been destroyed");
+}
+TEST_END
+
 int
 main(void) {
-	return test_no_reentrancy(test_prof_realloc);
+	return test_no_reentrancy(test_prof_realloc, test_prof_gctx_destroy,
+	    test_prof_dump_concurrent);
 }
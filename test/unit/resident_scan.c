@@ -0,0 +1,130 @@
+#include "test/jemalloc_test.h"
+
+#define SZ (4U << 20)
+
+static unsigned
+arena_create(void) {
+	unsigned arena_ind;
+	size_t   sz = sizeof(arena_ind);
+	expect_d_eq(mallctl("arenas.create", &arena_ind, &sz, NULL, 0), 0,
+	    "Unexpected mallctl failure");
+	return arena_ind;
+}
+
+static int
+resident_scan(unsigned arena_ind) {
+	char name[64];
+	malloc_snprintf(name, sizeof(name), "arena.%u.resident_scan", arena_ind);
+	return mallctl(name, NULL, NULL, NULL, 0);
+}
+
+/* Waits out the rate limit. */
+static void
+resident_scan_retry(unsigned arena_ind) {
+	int err;
+	while ((err = resident_scan(arena_ind)) == EAGAIN) {
+		sleep_ns(10 * 1000 * 1000);
+	}
+	expect_d_eq(err, 0, "Unexpected arena.<i>.resident_scan failure");
+}
+
+static size_t
+resident_scan_read(unsigned arena_ind, const char *kind) {
+	uint64_t epoch = 1;
+	expect_d_eq(mallctl("epoch", NULL, NULL, &epoch, sizeof(epoch)), 0,
+	    "Unexpected mallctl failure");
+
+	char   name[128];
+	size_t resident;
+	size_t sz = sizeof(resident);
+	malloc_snprintf(name, sizeof(name),
+	    "stats.arenas.%u.resident_scan.%s", arena_ind, kind);
+	expect_d_eq(mallctl(name, &resident, &sz, NULL, 0), 0,
+	    "Unexpected mallctl failure for %s", name);
+	return resident;
+}
+
+TEST_BEGIN(test_resident_scan_errors) {
+	test_skip_if(!config_stats);
+
+	unsigned narenas;
+	size_t   sz = sizeof(narenas);
+	expect_d_eq(mallctl("arenas.narenas", &narenas, &sz, NULL, 0), 0,
+	    "Unexpected mallctl failure");
+	expect_d_eq(resident_scan(narenas), EFAULT,
+	    "Scanning a nonexistent arena should fail");
+	unsigned arena_ind = arena_create();
+	expect_d_eq(resident_scan(arena_ind), 0, "Unexpected scan failure");
+	expect_d_eq(resident_scan(arena_ind), EAGAIN,
+	    "Back to back scans should be rate limited");
+}
+TEST_END
+
+TEST_BEGIN(test_resident_scan_active) {
+	test_skip_if(!config_stats);
+#ifndef JEMALLOC_HAVE_MINCORE
+	test_skip("mincore(2) not available");
+#endif
+
+	unsigned arena_ind = arena_create();
+	int      flags = MALLOCX_ARENA(arena_ind) | MALLOCX_TCACHE_NONE;
+	void    *p = mallocx(SZ, flags);
+	expect_ptr_not_null(p, "Unexpected mallocx failure");
+	memset(p, 1, SZ);
+
+	resident_scan_retry(arena_ind);
+	expect_zu_ge(resident_scan_read(arena_ind, "active_manual"), SZ,
+	    "Touched pages should be resident");
+	dallocx(p, flags);
+
+	/* The automatic arenas don't keep track of their active extents. */
+	p = mallocx(SZ, MALLOCX_TCACHE_NONE);
+	expect_ptr_not_null(p, "Unexpected mallocx failure");
+	memset(p, 1, SZ);
+	resident_scan_retry(0);
+	expect_zu_eq(resident_scan_read(0, "active_manual"), 0,
+	    "Active extents of automatic arenas should not be scanned");
+	dallocx(p, MALLOCX_TCACHE_NONE);
+}
+TEST_END
+
+TEST_BEGIN(test_resident_scan_dirty) {
+	test_skip_if(!config_stats);
+#ifndef JEMALLOC_HAVE_MINCORE
+	test_skip("mincore(2) not available");
+#endif
+
+	unsigned arena_ind = arena_create();
+	char     name[64];
+	ssize_t  decay_ms = -1;
+	malloc_snprintf(
+	    name, sizeof(name), "arena.%u.dirty_decay_ms", arena_ind);
+	expect_d_eq(mallctl(name, NULL, NULL, &decay_ms, sizeof(decay_ms)), 0,
+	    "Unexpected mallctl failure");
+
+	int   flags = MALLOCX_ARENA(arena_ind) | MALLOCX_TCACHE_NONE;
+	void *p = mallocx(SZ, flags);
+	expect_ptr_not_null(p, "Unexpected mallocx failure");
+	memset(p, 1, SZ);
+	dallocx(p, flags);
+
+	resident_scan_retry(arena_ind);
+	expect_zu_ge(resident_scan_read(arena_ind, "dirty"), SZ,
+	    "Freed pages should stay resident until purged");
+
+	malloc_snprintf(name, sizeof(name), "arena.%u.purge", arena_ind);
+	expect_d_eq(mallctl(name, NULL, NULL, NULL, 0), 0,
+	    "Unexpected mallctl failure");
+	resident_scan_retry(arena_ind);
+	expect_zu_eq(resident_scan_read(arena_ind, "dirty"), 0,
+	    "Purging should leave no dirty pages");
+	expect_zu_lt(resident_scan_read(arena_ind, "retained"), SZ,
+	    "Purged pages should not be resident");
+}
+TEST_END
+
+int
+main(void) {
+	return test(test_resident_scan_errors, test_resident_scan_active,
+	    test_resident_scan_dirty);
+}
@@ -549,11 +549,241 @@ TEST_BEGIN(test_approximate_stats_active) {
 }
 TEST_END
 
+static void
+arena_stats_refresh(unsigned arena_ind, const unsigned *what) {
+	char cmd[64];
+	malloc_snprintf(cmd, sizeof(cmd), "arena.%u.stats_refresh", arena_ind);
+	expect_d_eq(mallctl(cmd, NULL, NULL, (void *)what,
+	                what == NULL ? 0 : sizeof(*what)),
+	    0, "Unexpected mallctl() failure");
+}
+
+static uint64_t
+arena_stats_read_u64(unsigned arena_ind, const char *name) {
+	char cmd[128];
+	malloc_snprintf(cmd, sizeof(cmd), "stats.arenas.%u.%s", arena_ind, name);
+	uint64_t val;
+	size_t   sz = sizeof(val);
+	expect_d_eq(mallctl(cmd, (void *)&val, &sz, NULL, 0), 0,
+	    "Unexpected mallctl() failure");
+	return val;
+}
+
+TEST_BEGIN(test_stats_arena_refresh) {
+	test_skip_if(!config_stats);
+
+	unsigned arena_ind;
+	size_t   sz = sizeof(arena_ind);
+	expect_d_eq(mallctl("arenas.create", (void *)&arena_ind, &sz, NULL, 0),
+	    0, "Unexpected mallctl() failure");
+	int flags = MALLOCX_ARENA(arena_ind) | MALLOCX_TCACHE_NONE;
+
+	uint64_t epoch = 1;
+	expect_d_eq(mallctl("epoch", NULL, NULL, (void *)&epoch, sizeof(epoch)),
+	    0, "Unexpected mallctl() failure");
+	uint64_t summary_large = arena_stats_read_u64(
+	    MALLCTL_ARENAS_ALL, "large.nmalloc");
+
+	arena_stats_refresh(arena_ind, NULL);
+	uint64_t small = arena_stats_read_u64(arena_ind, "small.nmalloc");
+	uint64_t large = arena_stats_read_u64(arena_ind, "large.nmalloc");
+
+	void *p_small = mallocx(1, flags);
+	expect_ptr_not_null(p_small, "Unexpected mallocx() failure");
+	void *p_large = mallocx(SC_LARGE_MINCLASS, flags);
+	expect_ptr_not_null(p_large, "Unexpected mallocx() failure");
+
+	unsigned what = MALLCTL_STATS_REFRESH_LARGE;
+	arena_stats_refresh(arena_ind, &what);
+	expect_u64_eq(arena_stats_read_u64(arena_ind, "large.nmalloc"),
+	    large + 1, "Large stats should have been refreshed");
+	expect_u64_eq(arena_stats_read_u64(arena_ind, "small.nmalloc"), small,
+	    "Bin stats should not have been refreshed");
+	expect_u64_eq(arena_stats_read_u64(MALLCTL_ARENAS_ALL, "large.nmalloc"),
+	    summary_large, "Summary stats should not have been refreshed");
+
+	what = MALLCTL_STATS_REFRESH_BINS;
+	arena_stats_refresh(arena_ind, &what);
+	expect_u64_eq(arena_stats_read_u64(arena_ind, "small.nmalloc"),
+	    small + 1, "Bin stats should have been refreshed");
+	expect_u64_eq(arena_stats_read_u64(arena_ind, "large.nmalloc"),
+	    large + 1, "Large stats should have been kept");
+
+	arena_stats_refresh(MALLCTL_ARENAS_ALL, &what);
+	expect_u64_ge(arena_stats_read_u64(MALLCTL_ARENAS_ALL, "large.nmalloc"),
+	    summary_large + 1, "Summary stats should have been refreshed");
+
+	char cmd[64];
+	what = ~MALLCTL_STATS_REFRESH_ALL;
+	malloc_snprintf(cmd, sizeof(cmd), "arena.%u.stats_refresh", arena_ind);
+	expect_d_eq(mallctl(cmd, NULL, NULL, (void *)&what, sizeof(what)),
+	    EINVAL, "Unknown flags should be rejected");
+	expect_d_eq(mallctl(cmd, (void *)&what, &sz, NULL, 0), EPERM,
+	    "stats_refresh should be write-only");
+
+	dallocx(p_small, flags);
+	dallocx(p_large, flags);
+}
+TEST_END
+
+#define NLARGE_LOCAL 16
+
+static size_t
+arena_stats_read_zu(unsigned arena_ind, const char *name) {
+	char cmd[128];
+	malloc_snprintf(cmd, sizeof(cmd), "stats.arenas.%u.%s", arena_ind, name);
+	size_t val;
+	size_t sz = sizeof(val);
+	expect_d_eq(mallctl(cmd, (void *)&val, &sz, NULL, 0), 0,
+	    "Unexpected mallctl() failure");
+	return val;
+}
+
+static void
+expect_large_stats(unsigned arena_ind, uint64_t nmalloc, uint64_t ndalloc) {
+	arena_stats_refresh(arena_ind, NULL);
+	expect_u64_eq(arena_stats_read_u64(arena_ind, "lextents.0.nmalloc"),
+	    nmalloc, "Wrong nmalloc");
+	expect_u64_eq(arena_stats_read_u64(arena_ind, "lextents.0.ndalloc"),
+	    ndalloc, "Wrong ndalloc");
+	expect_zu_eq(arena_stats_read_zu(arena_ind, "lextents.0.curlextents"),
+	    nmalloc - ndalloc, "Wrong curlextents");
+	expect_zu_eq(arena_stats_read_zu(arena_ind, "large.allocated"),
+	    (nmalloc - ndalloc) * SC_LARGE_MINCLASS, "Wrong large.allocated");
+}
+
+static void *
+thd_large_local_start(void *arg) {
+	unsigned arena_ind = *(unsigned *)arg;
+	unsigned old_arena_ind;
+	size_t   sz = sizeof(unsigned);
+	expect_d_eq(mallctl("thread.arena", (void *)&old_arena_ind, &sz,
+	                (void *)&arena_ind, sizeof(arena_ind)),
+	    0, "Unexpected mallctl() failure");
+
+	int   flags = MALLOCX_ARENA(arena_ind) | MALLOCX_TCACHE_NONE;
+	void **ptrs = mallocx(NLARGE_LOCAL * sizeof(void *), 0);
+	expect_ptr_not_null(ptrs, "Unexpected mallocx() failure");
+	for (unsigned i = 0; i < NLARGE_LOCAL; i++) {
+		ptrs[i] = mallocx(SC_LARGE_MINCLASS, flags);
+		expect_ptr_not_null(ptrs[i], "Unexpected mallocx() failure");
+	}
+	for (unsigned i = 0; i < NLARGE_LOCAL / 2; i++) {
+		dallocx(ptrs[i], flags);
+	}
+	/* Counted in this thread's tcache; readers must still see it all. */
+	expect_large_stats(arena_ind, NLARGE_LOCAL, NLARGE_LOCAL / 2);
+
+	/* Leaving the arena flushes the counts into it. */
+	expect_d_eq(mallctl("thread.arena", NULL, NULL,
+	                (void *)&old_arena_ind, sizeof(old_arena_ind)),
+	    0, "Unexpected mallctl() failure");
+	expect_large_stats(arena_ind, NLARGE_LOCAL, NLARGE_LOCAL / 2);
+	return ptrs;
+}
+
+TEST_BEGIN(test_stats_large_local) {
+	test_skip_if(!config_stats);
+
+	unsigned arena_ind;
+	size_t   sz = sizeof(arena_ind);
+	expect_d_eq(mallctl("arenas.create", (void *)&arena_ind, &sz, NULL, 0),
+	    0, "Unexpected mallctl() failure");
+	expect_large_stats(arena_ind, 0, 0);
+
+	thd_t  thd;
+	void **ptrs;
+	thd_create(&thd, thd_large_local_start, (void *)&arena_ind);
+	thd_join(thd, (void **)&ptrs);
+	expect_large_stats(arena_ind, NLARGE_LOCAL, NLARGE_LOCAL / 2);
+
+	/*
+	 * Frees of extents counted locally elsewhere; this thread's tcache is
+	 * not in the arena, so these go to the arena's counters directly.
+	 */
+	int flags = MALLOCX_ARENA(arena_ind) | MALLOCX_TCACHE_NONE;
+	for (unsigned i = NLARGE_LOCAL / 2; i < NLARGE_LOCAL; i++) {
+		dallocx(ptrs[i], flags);
+	}
+	dallocx(ptrs, 0);
+	expect_large_stats(arena_ind, NLARGE_LOCAL, NLARGE_LOCAL);
+}
+TEST_END
+
+TEST_BEGIN(test_stats_arena_disabled) {
+	test_skip_if(!config_stats);
+
+	unsigned arena_ind;
+	size_t   sz = sizeof(arena_ind);
+	expect_d_eq(mallctl("arenas.create", (void *)&arena_ind, &sz, NULL, 0),
+	    0, "Unexpected mallctl() failure");
+	int  flags = MALLOCX_ARENA(arena_ind) | MALLOCX_TCACHE_NONE;
+	char cmd[64];
+	malloc_snprintf(cmd, sizeof(cmd), "arena.%u.stats_enabled", arena_ind);
+
+	bool enabled;
+	sz = sizeof(enabled);
+	expect_d_eq(mallctl(cmd, (void *)&enabled, &sz, NULL, 0), 0,
+	    "Unexpected mallctl() failure");
+	expect_b_eq(enabled, opt_arena_stats_enabled,
+	    "New arenas should start out with opt.arena_stats_enabled");
+	test_skip_if(!enabled);
+
+	/* Allocated with stats on, freed with stats off. */
+	void *p_small = mallocx(1, flags);
+	expect_ptr_not_null(p_small, "Unexpected mallocx() failure");
+	void *p_large = mallocx(SC_LARGE_MINCLASS, flags);
+	expect_ptr_not_null(p_large, "Unexpected mallocx() failure");
+	arena_stats_refresh(arena_ind, NULL);
+	expect_u64_gt(arena_stats_read_u64(arena_ind, "small.nmalloc"), 0,
+	    "Small allocation should have been counted");
+	expect_u64_gt(arena_stats_read_u64(arena_ind, "large.nmalloc"), 0,
+	    "Large allocation should have been counted");
+
+	bool disable = false;
+	expect_d_eq(mallctl(cmd, (void *)&enabled, &sz, (void *)&disable,
+	                sizeof(disable)),
+	    0, "Unexpected mallctl() failure");
+	expect_true(enabled, "Should read the previous value");
+	bool enable = true;
+	expect_d_eq(mallctl(cmd, NULL, NULL, (void *)&enable, sizeof(enable)),
+	    EINVAL, "Stats should not be turned back on");
+	expect_d_eq(mallctl(cmd, (void *)&enabled, &sz, NULL, 0), 0,
+	    "Unexpected mallctl() failure");
+	expect_false(enabled, "Stats should have been turned off");
+
+	void *q_small = mallocx(1, flags);
+	expect_ptr_not_null(q_small, "Unexpected mallocx() failure");
+	void *q_large = mallocx(SC_LARGE_MINCLASS, flags);
+	expect_ptr_not_null(q_large, "Unexpected mallocx() failure");
+	arena_stats_refresh(arena_ind, NULL);
+	expect_u64_eq(arena_stats_read_u64(arena_ind, "small.nmalloc"), 0,
+	    "Bin stats should not be reported");
+	expect_u64_eq(arena_stats_read_u64(arena_ind, "large.nmalloc"), 0,
+	    "Large stats should not be reported");
+	expect_zu_gt(arena_stats_read_zu(arena_ind, "pactive"), 0,
+	    "Page level stats should still be reported");
+
+	dallocx(p_small, flags);
+	dallocx(p_large, flags);
+	dallocx(q_small, flags);
+	dallocx(q_large, flags);
+	arena_stats_refresh(arena_ind, NULL);
+
+	malloc_snprintf(cmd, sizeof(cmd), "arena.%u.stats_enabled",
+	    MALLCTL_ARENAS_ALL);
+	expect_d_eq(mallctl(cmd, (void *)&enabled, &sz, NULL, 0), EFAULT,
+	    "Only actual arenas have stats_enabled");
+}
+TEST_END
+
 int
 main(void) {
 	return test_no_reentrancy(test_stats_summary, test_stats_large,
 	    test_stats_arenas_summary, test_stats_arenas_small,
 	    test_stats_arenas_large, test_stats_arenas_bins,
 	    test_stats_arenas_lextents, test_stats_tcache_bytes_small,
-	    test_stats_tcache_bytes_large, test_approximate_stats_active);
+	    test_stats_tcache_bytes_large, test_approximate_stats_active,
+	    test_stats_arena_refresh, test_stats_large_local,
+	    test_stats_arena_disabled);
 }
@@ -1222,7 +1222,124 @@ TEST_BEGIN(test_stats_print_json) {
 }
 TEST_END
 
+static size_t
+count_occurrences(const char *haystack, const char *needle) {
+	size_t n = 0;
+	for (const char *p = strstr(haystack, needle); p != NULL;
+	     p = strstr(p + 1, needle)) {
+		n++;
+	}
+	return n;
+}
+
+/*
+ * Checks that buf is well-formed OpenMetrics output: each family is declared
+ * exactly once, followed by its samples only, and the output ends with
+ * "# EOF".
+ */
+static void
+expect_openmetrics_valid(const char *buf, const char *opts) {
+	char        family[128] = "";
+	char        type_line[160];
+	const char *eof = "# EOF\n";
+	size_t      len = strlen(buf);
+
+	expect_zu_ge(len, strlen(eof), "Output too short, opts=\"%s\"", opts);
+	expect_str_eq(&buf[len - strlen(eof)], eof,
+	    "Output should end with \"# EOF\", opts=\"%s\"", opts);
+
+	for (const char *line = buf; *line != '\0';) {
+		const char *end = strchr(line, '\n');
+		assert_ptr_not_null(end, "Unterminated line, opts=\"%s\"", opts);
+		if (strncmp(line, "# TYPE jemalloc_", 16) == 0) {
+			const char *name = line + 16;
+			size_t      name_len = strcspn(name, " ");
+			assert_zu_lt(name_len, sizeof(family), "Name too long");
+			memcpy(family, name, name_len);
+			family[name_len] = '\0';
+			malloc_snprintf(type_line, sizeof(type_line),
+			    "# TYPE jemalloc_%s ", family);
+			expect_zu_eq(count_occurrences(buf, type_line), 1,
+			    "Family %s declared more than once, opts=\"%s\"",
+			    family, opts);
+		} else if (strncmp(line, "# ", 2) != 0) {
+			expect_true(strncmp(line, "jemalloc_", 9) == 0
+			        && strncmp(line + 9, family, strlen(family))
+			            == 0,
+			    "Sample outside of its family, opts=\"%s\"", opts);
+			const char *value = end;
+			while (value[-1] != ' ') {
+				value--;
+				expect_true(*value >= '0' && *value <= '9',
+				    "Non-numeric sample value, opts=\"%s\"",
+				    opts);
+			}
+		}
+		line = end + 1;
+	}
+}
+
+TEST_BEGIN(test_stats_print_openmetrics) {
+	const char *opts[] = {
+	    "P",
+	    "Pg",
+	    "Pm",
+	    "Pa",
+	    "Pb",
+	    "Pl",
+	    "Px",
+	    "Pgmablx",
+	    "JP",
+	};
+
+	/* Make sure some bins and large size classes have been used. */
+	void *small = mallocx(1, 0);
+	void *large = mallocx(SC_LARGE_MINCLASS, 0);
+	expect_ptr_not_null(small, "Unexpected mallocx() failure");
+	expect_ptr_not_null(large, "Unexpected mallocx() failure");
+
+	for (unsigned j = 0; j < sizeof(opts) / sizeof(const char *); j++) {
+		parser_t parser;
+		parser_init(&parser, true);
+		malloc_stats_print(write_cb, (void *)&parser, opts[j]);
+		assert_ptr_not_null(parser.buf, "No output, opts=\"%s\"",
+		    opts[j]);
+		expect_openmetrics_valid(parser.buf, opts[j]);
+
+		bool general = strchr(opts[j], 'g') == NULL;
+		bool bins = config_stats && strchr(opts[j], 'b') == NULL
+		    && (strchr(opts[j], 'm') == NULL
+		        || strchr(opts[j], 'a') == NULL);
+		bool large_classes = config_stats
+		    && strchr(opts[j], 'l') == NULL
+		    && (strchr(opts[j], 'm') == NULL
+		        || strchr(opts[j], 'a') == NULL);
+		bool mutex = config_stats && strchr(opts[j], 'x') == NULL;
+		expect_b_eq(strstr(parser.buf, "jemalloc_build_info{") != NULL,
+		    general, "Unexpected build info, opts=\"%s\"", opts[j]);
+		expect_b_eq(strstr(parser.buf, "jemalloc_bin_") != NULL, bins,
+		    "Unexpected bin stats, opts=\"%s\"", opts[j]);
+		expect_b_eq(strstr(parser.buf, "jemalloc_lextent_") != NULL,
+		    large_classes, "Unexpected large stats, opts=\"%s\"",
+		    opts[j]);
+		expect_b_eq(strstr(parser.buf, "mutex=") != NULL, mutex,
+		    "Unexpected mutex stats, opts=\"%s\"", opts[j]);
+		if (config_stats) {
+			expect_b_eq(
+			    strstr(parser.buf, "arena=\"merged\"") != NULL,
+			    strchr(opts[j], 'm') == NULL,
+			    "Unexpected merged stats, opts=\"%s\"", opts[j]);
+		}
+		parser_fini(&parser);
+	}
+
+	dallocx(small, 0);
+	dallocx(large, 0);
+}
+TEST_END
+
 int
 main(void) {
-	return test(test_json_parser, test_stats_print_json);
+	return test(test_json_parser, test_stats_print_json,
+	    test_stats_print_openmetrics);
 }
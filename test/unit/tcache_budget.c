@@ -0,0 +1,134 @@
+#include "test/jemalloc_test.h"
+
+#define BUDGET_DEFAULT ((size_t)128 << 10)
+#define NALLOCS 32
+#define ALLOC_SIZE ((size_t)16 << 10)
+
+static size_t
+tcache_bytes_read_local(void) {
+	size_t    tcache_bytes = 0;
+	tsd_t    *tsd = tsd_fetch();
+	tcache_t *tcache = tcache_get(tsd);
+	for (szind_t i = 0; i < tcache_nbins_get(tcache->tcache_slow); i++) {
+		cache_bin_t *cache_bin = &tcache->bins[i];
+		if (tcache_bin_disabled(i, cache_bin, tcache->tcache_slow)) {
+			continue;
+		}
+		cache_bin_sz_t ncached = cache_bin_ncached_get_local(cache_bin);
+		tcache_bytes += ncached * sz_index2size(i);
+	}
+	return tcache_bytes;
+}
+
+static void
+fill_tcache_size(size_t size) {
+	void *ptrs[NALLOCS];
+	for (unsigned i = 0; i < NALLOCS; i++) {
+		ptrs[i] = mallocx(size, 0);
+		expect_ptr_not_null(ptrs[i], "Unexpected mallocx() failure");
+	}
+	for (unsigned i = 0; i < NALLOCS; i++) {
+		dallocx(ptrs[i], 0);
+	}
+}
+
+static void
+fill_tcache(void) {
+	fill_tcache_size(ALLOC_SIZE);
+}
+
+static size_t
+thread_budget_get(void) {
+	size_t budget;
+	size_t sz = sizeof(budget);
+	expect_d_eq(mallctl("thread.tcache.bytes_budget", (void *)&budget, &sz,
+	                NULL, 0),
+	    0, "Unexpected mallctl() failure");
+	return budget;
+}
+
+static void
+thread_budget_set(size_t budget) {
+	expect_d_eq(mallctl("thread.tcache.bytes_budget", NULL, NULL,
+	                (void *)&budget, sizeof(budget)),
+	    0, "Unexpected mallctl() failure");
+}
+
+TEST_BEGIN(test_budget_default) {
+	size_t budget;
+	size_t sz = sizeof(budget);
+	expect_d_eq(mallctl("opt.tcache_bytes_budget", (void *)&budget, &sz,
+	                NULL, 0),
+	    0, "Unexpected mallctl() failure");
+	expect_zu_eq(budget, BUDGET_DEFAULT, "Unexpected option value");
+	expect_zu_eq(thread_budget_get(), BUDGET_DEFAULT,
+	    "Threads should start with the default budget");
+}
+TEST_END
+
+TEST_BEGIN(test_budget_gc) {
+	test_skip_if(!opt_tcache);
+
+	thread_budget_set(BUDGET_DEFAULT);
+	expect_d_eq(mallctl("thread.tcache.flush", NULL, NULL, NULL, 0), 0,
+	    "Unexpected mallctl() failure");
+	fill_tcache();
+	/*
+	 * The budget is checked at GC events, which happen once per ALLOC_SIZE
+	 * bytes (see tcache_budget.sh); so at most the item freed after the
+	 * last one can be above budget.
+	 */
+	expect_zu_le(tcache_bytes_read_local(), BUDGET_DEFAULT + ALLOC_SIZE,
+	    "Tcache should stay around its byte budget");
+	expect_zu_gt(tcache_bytes_read_local(), 0,
+	    "Tcache should not be emptied");
+}
+TEST_END
+
+TEST_BEGIN(test_budget_lowered) {
+	test_skip_if(!opt_tcache);
+
+	thread_budget_set(0);
+	expect_d_eq(mallctl("thread.tcache.flush", NULL, NULL, NULL, 0), 0,
+	    "Unexpected mallctl() failure");
+	fill_tcache();
+	expect_zu_eq(tcache_bytes_read_local(), NALLOCS * ALLOC_SIZE,
+	    "Without a budget, everything freed should be cached");
+
+	size_t budget = NALLOCS * ALLOC_SIZE / 4;
+	thread_budget_set(budget);
+	expect_zu_eq(thread_budget_get(), budget, "Budget not updated");
+	size_t tcache_bytes = tcache_bytes_read_local();
+	expect_zu_le(tcache_bytes, budget,
+	    "Lowering the budget should be applied immediately");
+	expect_zu_gt(tcache_bytes, 0, "Tcache should not be emptied");
+
+	thread_budget_set(BUDGET_DEFAULT);
+}
+TEST_END
+
+TEST_BEGIN(test_budget_sub_page) {
+	test_skip_if(!opt_tcache);
+
+	thread_budget_set(0);
+	expect_d_eq(mallctl("thread.tcache.flush", NULL, NULL, NULL, 0), 0,
+	    "Unexpected mallctl() failure");
+	size_t size = 64;
+	fill_tcache_size(size);
+	size_t budget = NALLOCS * size / 2;
+	assert_zu_lt(budget, PAGE, "Budget should be below a page");
+	thread_budget_set(budget);
+	size_t tcache_bytes = tcache_bytes_read_local();
+	expect_zu_le(tcache_bytes, budget, "Tcache should fit in its budget");
+	expect_zu_gt(tcache_bytes, 0,
+	    "A budget below a page should not empty the tcache");
+
+	thread_budget_set(BUDGET_DEFAULT);
+}
+TEST_END
+
+int
+main(void) {
+	return test(test_budget_default, test_budget_gc, test_budget_lowered,
+	    test_budget_sub_page);
+}
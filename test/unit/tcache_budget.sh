@@ -0,0 +1,3 @@
+#!/bin/sh
+
+export MALLOC_CONF="tcache_nslots_large:64,tcache_gc_incr_bytes:16384,tcache_bytes_budget:131072"
@@ -0,0 +1,176 @@
+#include "test/jemalloc_test.h"
+
+#define NALLOCS 64
+#define ALLOC_SIZE 64
+/* Give up waiting for the background thread after this long. */
+#define WAIT_MAX_MS 10000
+
+static atomic_p_t  worker_tcache;
+static atomic_b_t  worker_resume;
+/* Whether the worker, marked as in an allocator call, may finish it. */
+static atomic_b_t  worker_unbusy;
+/* Whether the worker exits right away once resumed. */
+static bool        worker_exit_idle;
+
+static cache_bin_sz_t
+tcache_ncached(tcache_t *tcache) {
+	szind_t ind = sz_size2index(ALLOC_SIZE);
+	return cache_bin_ncached_get_local(&tcache->bins[ind]);
+}
+
+static void
+alloc_free(void) {
+	void *ptrs[NALLOCS];
+	for (unsigned i = 0; i < NALLOCS; i++) {
+		ptrs[i] = mallocx(ALLOC_SIZE, 0);
+		expect_ptr_not_null(ptrs[i], "Unexpected mallocx() failure");
+	}
+	for (unsigned i = 0; i < NALLOCS; i++) {
+		dallocx(ptrs[i], 0);
+	}
+}
+
+static void *
+thd_start(void *arg) {
+	alloc_free();
+	tcache_t *tcache = tcache_get(tsd_fetch());
+	expect_ptr_not_null(tcache, "Expected a tcache");
+	expect_u_gt(tcache_ncached(tcache), 0, "Frees should be cached");
+	atomic_store_p(&worker_tcache, tcache, ATOMIC_RELEASE);
+
+	/* Go idle; no allocator calls until resumed. */
+	while (!atomic_load_b(&worker_resume, ATOMIC_ACQUIRE)) {
+		sleep_ns(1000 * 1000);
+	}
+
+	if (worker_exit_idle) {
+		/* Exit still idle, i.e. with the forced recompute pending. */
+		return NULL;
+	}
+	/* The tcache must still be fully usable. */
+	alloc_free();
+	expect_u_gt(tcache_ncached(tcache), 0, "Frees should be cached");
+	return NULL;
+}
+
+static void
+wait_flag(atomic_b_t *flag) {
+	while (!atomic_load_b(flag, ATOMIC_ACQUIRE)) {
+		sleep_ns(1000 * 1000);
+	}
+}
+
+/* Goes idle as if stuck in the middle of a slow path allocator call. */
+static void *
+thd_busy_start(void *arg) {
+	alloc_free();
+	tsd_t    *tsd = tsd_fetch();
+	tcache_t *tcache = tcache_get(tsd);
+	expect_ptr_not_null(tcache, "Expected a tcache");
+	bool busy = tcache_idle_reclaim_busy_begin(tsd);
+	expect_true(busy, "Expected to be marked busy");
+	atomic_store_p(&worker_tcache, tcache, ATOMIC_RELEASE);
+
+	wait_flag(&worker_unbusy);
+	tcache_idle_reclaim_busy_end(tsd, busy);
+	/* Now really idle. */
+	wait_flag(&worker_resume);
+	return NULL;
+}
+
+static void *
+alloc_free_sleep(void *arg) {
+	alloc_free();
+	sleep_ns(50 * 1000 * 1000);
+	return NULL;
+}
+
+static void
+idle_reclaim(bool exit_idle) {
+	worker_exit_idle = exit_idle;
+	atomic_store_p(&worker_tcache, NULL, ATOMIC_RELAXED);
+	atomic_store_b(&worker_resume, false, ATOMIC_RELAXED);
+	thd_t thd;
+	thd_create(&thd, thd_start, NULL);
+
+	tcache_t *tcache;
+	while ((tcache = atomic_load_p(&worker_tcache, ATOMIC_ACQUIRE))
+	    == NULL) {
+		sleep_ns(1000 * 1000);
+	}
+	unsigned waited_ms = 0;
+	while (tcache_ncached(tcache) != 0 && waited_ms < WAIT_MAX_MS) {
+		sleep_ns(10 * 1000 * 1000);
+		waited_ms += 10;
+	}
+	expect_u_eq(tcache_ncached(tcache), 0,
+	    "Idle thread's tcache should have been flushed");
+
+	atomic_store_b(&worker_resume, true, ATOMIC_RELEASE);
+	thd_join(thd, NULL);
+}
+
+TEST_BEGIN(test_idle_reclaim) {
+	test_skip_if(!have_background_thread);
+	test_skip_if(!config_stats);
+	test_skip_if(!opt_tcache);
+
+	idle_reclaim(false);
+}
+TEST_END
+
+TEST_BEGIN(test_idle_reclaim_busy) {
+	test_skip_if(!have_background_thread);
+	test_skip_if(!config_stats);
+	test_skip_if(!opt_tcache);
+
+	atomic_store_p(&worker_tcache, NULL, ATOMIC_RELAXED);
+	atomic_store_b(&worker_unbusy, false, ATOMIC_RELAXED);
+	atomic_store_b(&worker_resume, false, ATOMIC_RELAXED);
+	thd_t thd;
+	thd_create(&thd, thd_busy_start, NULL);
+
+	tcache_t *tcache;
+	while ((tcache = atomic_load_p(&worker_tcache, ATOMIC_ACQUIRE))
+	    == NULL) {
+		sleep_ns(1000 * 1000);
+	}
+	/* Many idle periods, but the owner never left its call. */
+	sleep_ns(500 * 1000 * 1000);
+	expect_u_gt(tcache_ncached(tcache), 0,
+	    "Tcache flushed while its owner was in an allocator call");
+
+	atomic_store_b(&worker_unbusy, true, ATOMIC_RELEASE);
+	unsigned waited_ms = 0;
+	while (tcache_ncached(tcache) != 0 && waited_ms < WAIT_MAX_MS) {
+		sleep_ns(10 * 1000 * 1000);
+		waited_ms += 10;
+	}
+	expect_u_eq(tcache_ncached(tcache), 0,
+	    "Idle thread's tcache should have been flushed");
+
+	atomic_store_b(&worker_resume, true, ATOMIC_RELEASE);
+	thd_join(thd, NULL);
+}
+TEST_END
+
+TEST_BEGIN(test_idle_reclaim_exit) {
+	test_skip_if(!have_background_thread);
+	test_skip_if(!config_stats);
+	test_skip_if(!opt_tcache);
+
+	/* Threads exiting while idle or being looked at must be fine. */
+	idle_reclaim(true);
+	for (unsigned i = 0; i < 8; i++) {
+		thd_t thd;
+		thd_create(&thd, alloc_free_sleep, NULL);
+		thd_join(thd, NULL);
+	}
+}
+TEST_END
+
+int
+main(void) {
+	return test_no_reentrancy(test_idle_reclaim, test_idle_reclaim_busy,
+	    test_idle_reclaim_exit);
+}
@@ -0,0 +1,3 @@
+#!/bin/sh
+
+export MALLOC_CONF="background_thread:true,tcache_idle_reclaim_ms:0"
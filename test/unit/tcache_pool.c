@@ -0,0 +1,128 @@
+#include "test/jemalloc_test.h"
+
+#define NALLOCS 16
+#define ALLOC_SIZE 64
+#define NTHREADS 8
+#define NROUNDS 32
+
+typedef struct thd_result_s thd_result_t;
+struct thd_result_s {
+	/* Bin stacks of the tcache the thread started with. */
+	void          *dyn_alloc;
+	/* Objects cached in the ALLOC_SIZE bin before the thread allocated. */
+	cache_bin_sz_t ncached_initial;
+};
+
+static cache_bin_sz_t
+tcache_ncached(tcache_t *tcache) {
+	szind_t ind = sz_size2index(ALLOC_SIZE);
+	return cache_bin_ncached_get_local(&tcache->bins[ind]);
+}
+
+static void *
+thd_start(void *arg) {
+	thd_result_t *result = (thd_result_t *)arg;
+	tsd_t        *tsd = tsd_fetch();
+	tcache_t     *tcache = tcache_get(tsd);
+	expect_ptr_not_null(tcache, "Expected a tcache");
+	result->dyn_alloc = tsd_tcache_slowp_get(tsd)->dyn_alloc;
+	result->ncached_initial = tcache_ncached(tcache);
+
+	void *ptrs[NALLOCS];
+	for (unsigned i = 0; i < NALLOCS; i++) {
+		ptrs[i] = mallocx(ALLOC_SIZE, 0);
+		expect_ptr_not_null(ptrs[i], "Unexpected mallocx() failure");
+	}
+	for (unsigned i = 0; i < NALLOCS; i++) {
+		dallocx(ptrs[i], 0);
+	}
+	expect_u_gt(tcache_ncached(tcache), 0, "Frees should be cached");
+	return NULL;
+}
+
+static void
+run_thread(thd_result_t *result) {
+	thd_t thd;
+	thd_create(&thd, thd_start, (void *)result);
+	thd_join(thd, NULL);
+}
+
+TEST_BEGIN(test_pool_reuse) {
+	test_skip_if(!opt_tcache);
+	test_skip_if(opt_tcache_pool_max == 0);
+
+	thd_result_t first, second;
+	run_thread(&first);
+	run_thread(&second);
+	/* The main thread never exits, so the pool held only one tcache. */
+	expect_ptr_eq(first.dyn_alloc, second.dyn_alloc,
+	    "The second thread should adopt the first thread's tcache");
+	if (opt_tcache_pool_keep_cached) {
+		expect_u_gt(second.ncached_initial, 0,
+		    "Cached objects should survive in the pool");
+	} else {
+		expect_u_eq(second.ncached_initial, 0,
+		    "Pooled tcaches should have been flushed");
+	}
+}
+TEST_END
+
+TEST_BEGIN(test_pool_arena_reset) {
+	test_skip_if(!opt_tcache);
+	test_skip_if(opt_tcache_pool_max == 0);
+
+	unsigned arena_ind;
+	size_t   sz = sizeof(arena_ind);
+	expect_d_eq(mallctl("arenas.create", (void *)&arena_ind, &sz, NULL, 0),
+	    0, "Unexpected arenas.create failure");
+
+	thd_result_t result;
+	run_thread(&result);
+
+	/* Reset must flush the pool, wherever the cached objects came from. */
+	char cmd[64];
+	malloc_snprintf(cmd, sizeof(cmd), "arena.%u.reset", arena_ind);
+	expect_d_eq(mallctl(cmd, NULL, NULL, NULL, 0), 0,
+	    "Unexpected arena.<i>.reset failure");
+
+	run_thread(&result);
+	expect_u_eq(result.ncached_initial, 0,
+	    "Arena reset should flush pooled tcaches");
+}
+TEST_END
+
+static void *
+churn_thd_start(void *arg) {
+	/* Allocate from an arena the thread hasn't been bound to yet. */
+	void *ptrs[NALLOCS];
+	for (unsigned i = 0; i < NALLOCS; i++) {
+		ptrs[i] = malloc(ALLOC_SIZE);
+		expect_ptr_not_null(ptrs[i], "Unexpected malloc() failure");
+	}
+	for (unsigned i = 0; i < NALLOCS; i++) {
+		free(ptrs[i]);
+	}
+	return NULL;
+}
+
+TEST_BEGIN(test_pool_churn) {
+	test_skip_if(!opt_tcache);
+	test_skip_if(opt_tcache_pool_max == 0);
+
+	/* More threads than pooled tcaches, exiting and adopting at once. */
+	for (unsigned round = 0; round < NROUNDS; round++) {
+		thd_t thds[NTHREADS];
+		for (unsigned i = 0; i < NTHREADS; i++) {
+			thd_create(&thds[i], churn_thd_start, NULL);
+		}
+		for (unsigned i = 0; i < NTHREADS; i++) {
+			thd_join(thds[i], NULL);
+		}
+	}
+}
+TEST_END
+
+int
+main(void) {
+	return test(test_pool_reuse, test_pool_arena_reset, test_pool_churn);
+}
@@ -0,0 +1,3 @@
+#!/bin/sh
+
+export MALLOC_CONF="tcache_pool_max:4,tcache_pool_keep_cached:true"